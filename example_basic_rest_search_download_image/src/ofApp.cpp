@@ -38,6 +38,57 @@ void ofApp::setup()
     //    client.search(query);
     //
 
+    // Download the small size of each image rather than the full size.
+    fetcher.setPreferredSize(ofxTwitter::MediaEntitySize::Type::SMALL);
+
+    // Decode thumbnails for display.
+    decoder.setTargetSize(ofxTwitter::MediaEntitySize::Type::THUMB);
+}
+
+
+void ofApp::update()
+{
+    // Collect completed downloads without blocking.
+    auto iter = downloads.begin();
+
+    while (iter != downloads.end())
+    {
+        if (iter->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            const auto& result = iter->get();
+
+            if (result.isSuccess())
+            {
+                downloaded++;
+                ofLogNotice("ofApp::update") << "Downloaded " << result.path;
+                decoder.decode(result);
+            }
+
+            iter = downloads.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    // Decoding happens on worker threads, so the main thread only uploads
+    // the finished pixels to the GPU.
+    ofxTwitter::MediaDecoder::Frame frame;
+
+    while (decoder.tryReceive(frame))
+    {
+        if (frame.isSuccess())
+        {
+            thumbnails.emplace_front();
+            thumbnails.front().loadData(*frame.pixels);
+
+            if (thumbnails.size() > 40)
+            {
+                thumbnails.pop_back();
+            }
+        }
+    }
 }
 
 
@@ -45,10 +96,28 @@ void ofApp::draw()
 {
     ofBackground(0);
 
+    float x = 0;
+    float y = 100;
+
+    for (auto& thumbnail: thumbnails)
+    {
+        thumbnail.draw(x, y, 100, 100);
+
+        x += 100;
+
+        if (x + 100 > ofGetWidth())
+        {
+            x = 0;
+            y += 100;
+        }
+    }
+
     std::stringstream ss;
     ss << "  Received: " << count << std::endl;
+    ss << "Downloaded: " << downloaded << std::endl;
+    ss << "   Pending: " << downloads.size() << std::endl;
     ss << "  See downloaded images in" << std::endl;
-    ss << "  the bin/data directory.";
+    ss << "  the bin/data/media directory.";
 
     ofDrawBitmapStringHighlight(ss.str(), 14, 14);
 }
@@ -58,13 +127,12 @@ void ofApp::onStatus(const ofxTwitter::Status& status)
 {
     count++;
 
-    for (auto e: status.extendedEntities().mediaEntities())
+    for (const auto& e: status.extendedEntities().mediaEntities())
     {
         if (e.type() == ofxTwitter::MediaEntity::Type::PHOTO)
         {
-            std::string filename = e.mediaFilename();
-            ofSaveURLAsync(e.mediaURL(), filename);
-            ofLogNotice("ofApp::onStatus") << "Downloading " << filename;
+            // Repeated media, e.g. from retweets, is only downloaded once.
+            downloads.push_back(fetcher.fetch(e));
         }
     }
 }
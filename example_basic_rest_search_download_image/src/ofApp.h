@@ -16,6 +16,7 @@ class ofApp: public ofBaseApp
 {
 public:
     void setup() override;
+    void update() override;
     void draw() override;
 
     void onStatus(const ofxTwitter::Status& status);
@@ -25,6 +26,19 @@ public:
 
     ofxTwitter::SearchClient client;
 
+    /// \brief Downloads media into bin/data/media with bounded concurrency.
+    ofxTwitter::MediaFetcher fetcher { ofToDataPath("media", true) };
+
+    /// \brief Downloads that have not completed yet.
+    std::vector<std::shared_future<ofxTwitter::MediaFetcher::Result>> downloads;
+
+    /// \brief Decodes downloaded images into thumbnails off the main thread.
+    ofxTwitter::MediaDecoder decoder;
+
+    /// \brief The most recent thumbnails.
+    std::deque<ofTexture> thumbnails;
+
     uint64_t count = 0;
+    uint64_t downloaded = 0;
 
 };
@@ -74,7 +74,14 @@ void ofApp::draw()
         received = ofToString(static_cast<double>(count) / total * 100, 2);
     }
 
-    ss << "% Received: " << received;
+    ss << "% Received: " << received << std::endl;
+
+    // Each client keeps lock-free metrics that can be polled at any time.
+    const auto& metrics = client.metrics();
+    const auto& parse = metrics.histogram(ofxTwitter::ClientMetrics::Stage::PARSE);
+
+    ss << "     Bytes: " << metrics.bytesReceived() << std::endl;
+    ss << " Parse p99: " << parse.percentile(99) << " us";
 
     ofDrawBitmapStringHighlight(ss.str(), 14, 20);
 }
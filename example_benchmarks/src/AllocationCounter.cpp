@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+
+
+/// \brief The number of counters in scope on this thread.
+thread_local int activeCounters = 0;
+
+/// \brief The number of allocations counted on this thread.
+thread_local uint64_t allocationCount = 0;
+
+
+void* allocate(std::size_t size)
+{
+    if (activeCounters > 0)
+    {
+        ++allocationCount;
+    }
+
+    return std::malloc(size ? size : 1);
+}
+
+
+void* allocate(std::size_t size, std::align_val_t alignment)
+{
+    if (activeCounters > 0)
+    {
+        ++allocationCount;
+    }
+
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t padded = ((size ? size : 1) + align - 1) / align * align;
+    return std::aligned_alloc(align, padded);
+}
+
+
+} // namespace
+
+
+AllocationCounter::AllocationCounter():
+    _start(allocationCount)
+{
+    ++activeCounters;
+}
+
+
+AllocationCounter::~AllocationCounter()
+{
+    --activeCounters;
+}
+
+
+uint64_t AllocationCounter::count() const
+{
+    return allocationCount - _start;
+}
+
+
+void* operator new(std::size_t size)
+{
+    if (void* pointer = allocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+
+
+void* operator new[](std::size_t size)
+{
+    if (void* pointer = allocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* pointer = allocate(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void* pointer = allocate(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate(size, alignment);
+}
+
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate(size, alignment);
+}
+
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
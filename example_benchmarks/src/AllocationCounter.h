@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+
+
+/// \brief Counts the allocations made on the current thread while in scope.
+///
+/// Standard containers and strings allocate through the global operator new,
+/// so the app provides every replaceable form of it. Outside of a counter's
+/// scope, and on other threads, the replacements only forward to malloc and
+/// free, which is what the default implementations do. Counters may be
+/// nested, and each counts the allocations made since it was created.
+class AllocationCounter
+{
+public:
+    /// \brief Start counting on the current thread.
+    AllocationCounter();
+
+    /// \brief Stop counting on the current thread.
+    ~AllocationCounter();
+
+    /// \returns the number of allocations made on this thread since the
+    /// counter was created.
+    uint64_t count() const;
+
+private:
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator = (const AllocationCounter&) = delete;
+
+    /// \brief The thread's allocation count when the counter was created.
+    uint64_t _start = 0;
+
+};
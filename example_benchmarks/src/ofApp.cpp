@@ -0,0 +1,316 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include "AllocationCounter.h"
+#include "Poco/Net/HTMLForm.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/OAuth10Credentials.h"
+
+
+void ofApp::setup()
+{
+    benchmarkBulkDecoder();
+    benchmarkAccessors();
+    benchmarkSigner();
+    benchmarkCodec();
+    ofExit();
+}
+
+
+void ofApp::benchmarkBulkDecoder()
+{
+    const std::size_t count = 100000;
+
+    std::string data;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        data += statusLine(i + 1);
+        data += "\r\n";
+    }
+
+    double megabytes = data.size() / (1024.0 * 1024.0);
+
+    ofLogNotice("ofApp::benchmarkBulkDecoder") << "Decoding " << count << " statuses (" << ofToString(megabytes, 1) << " MB).";
+
+    std::size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    double baseline = 0;
+
+    for (std::size_t threads = 1; threads <= hardwareThreads; threads *= 2)
+    {
+        // parallelFor() also runs chunks on the calling thread, so a pool of
+        // n workers decodes on n + 1 threads. The single-threaded baseline
+        // uses one chunk, which is decoded on the calling thread alone.
+        ofxTwitter::ThreadPool pool(std::max(std::size_t(1), threads - 1));
+        ofxTwitter::BulkDecoder decoder(pool);
+
+        if (threads == 1)
+        {
+            decoder.setChunkSize(data.size());
+        }
+
+        // Statuses are passed to a sink rather than collected, so that the
+        // measurement is not dominated by memory allocation.
+        std::atomic<std::size_t> decoded(0);
+
+        uint64_t start = ofGetElapsedTimeMicros();
+
+        decoder.decode(data.data(), data.size(), [&](const ofxTwitter::Status& status)
+        {
+            if (status.id() > 0) ++decoded;
+        });
+
+        double seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+
+        if (threads == 1)
+        {
+            baseline = seconds;
+        }
+
+        ofLogNotice("ofApp::benchmarkBulkDecoder") << std::setw(2) << threads << " threads: " << ofToString(megabytes / seconds, 1) << " MB/s, speedup " << ofToString(baseline / seconds, 2);
+
+        if (decoded != count)
+        {
+            ofLogError("ofApp::benchmarkBulkDecoder") << "Decoded " << decoded << " of " << count << " statuses.";
+        }
+    }
+}
+
+
+void ofApp::benchmarkAccessors()
+{
+    const std::size_t count = 10000;
+
+    std::vector<ofxTwitter::Status> statuses;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        statuses.push_back(ofxTwitter::Status::fromJSON(ofJson::parse(statusLine(i + 1))));
+    }
+
+    std::size_t checksum = 0;
+
+    // The listener as written against the by-value accessors, where each
+    // call returned a copy of the member.
+    uint64_t copyAllocations = 0;
+    uint64_t start = ofGetElapsedTimeMicros();
+
+    {
+        AllocationCounter allocations;
+
+        for (const auto& status: statuses)
+        {
+            std::string text = status.text();
+            std::string screenName = status.user() ? status.user()->screenName() : "";
+            ofxTwitter::Entities entities = status.extendedEntities();
+            ofxTwitter::Entities::MediaEntities media = entities.mediaEntities();
+
+            for (const auto& entity: media)
+            {
+                ofxTwitter::MediaEntity::Sizes sizes = entity.sizes();
+                std::string url = entity.mediaURL();
+                checksum += sizes.size() + url.size();
+            }
+
+            ofxTwitter::Entities::HashTagEntities hashtags = status.entities().hashTagEntities();
+            checksum += text.size() + screenName.size() + hashtags.size();
+        }
+
+        copyAllocations = allocations.count();
+    }
+
+    uint64_t copyMicros = ofGetElapsedTimeMicros() - start;
+
+    // The same listener binding the returned references.
+    uint64_t referenceAllocations = 0;
+    start = ofGetElapsedTimeMicros();
+
+    {
+        AllocationCounter allocations;
+
+        for (const auto& status: statuses)
+        {
+            const std::string& text = status.text();
+            const std::string& screenName = status.user() ? status.user()->screenName() : text;
+
+            for (const auto& entity: status.extendedEntities().mediaEntities())
+            {
+                checksum += entity.sizes().size() + entity.mediaURL().size();
+            }
+
+            checksum += text.size() + screenName.size() + status.entities().hashTagEntities().size();
+        }
+
+        referenceAllocations = allocations.count();
+    }
+
+    uint64_t referenceMicros = ofGetElapsedTimeMicros() - start;
+
+    ofLogNotice("ofApp::benchmarkAccessors") << "Listener over " << count << " statuses (checksum " << checksum << ").";
+    ofLogNotice("ofApp::benchmarkAccessors") << "     Copies: " << ofToString(double(copyAllocations) / count, 1) << " allocations per status, " << copyMicros << " us";
+    ofLogNotice("ofApp::benchmarkAccessors") << " References: " << ofToString(double(referenceAllocations) / count, 1) << " allocations per status, " << referenceMicros << " us";
+}
+
+
+void ofApp::benchmarkSigner()
+{
+    const std::size_t count = 100000;
+
+    ofxHTTP::OAuth10Credentials credentials("xvz1evFS4wEEPTGEFPHBog",
+                                            "kAcSOqF21Fu85e7zjz7ZN2U4ZRhfV3WpwPAoE3Z7kBw",
+                                            "370773112-GmHxMAgYyLbNEtIKZeRNFsMKPR9EyMZeS9weJAEb",
+                                            "LswwdoUaIvS8ltyTt5jkRh4J50vUPVVHtR2YPi5kE");
+
+    ofxTwitter::SearchQuery query("#openFrameworks OR #ofxTwitter");
+    query.setCount(100);
+    query.setResultType(ofxTwitter::SearchQuery::ResultType::RECENT);
+    query.setLanguage("en");
+
+    const std::string url = ofxTwitter::SearchQuery::RESOURCE_URL;
+    std::size_t checksum = 0;
+
+    // Poco derives the signing key and encodes every parameter per request.
+    Poco::Net::OAuth10Credentials pocoCredentials(credentials.consumerKey(),
+                                                  credentials.consumerSecret(),
+                                                  credentials.accessToken(),
+                                                  credentials.accessTokenSecret());
+
+    uint64_t start = ofGetElapsedTimeMicros();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        query.setSinceId(i + 1);
+
+        Poco::Net::HTMLForm form;
+
+        for (const auto& parameter: query)
+        {
+            form.set(parameter.first, parameter.second);
+        }
+
+        Poco::Net::HTTPRequest request(Poco::Net::HTTPRequest::HTTP_GET, url);
+        pocoCredentials.authenticate(request, Poco::URI(url), form);
+        checksum += request.get("Authorization").size();
+    }
+
+    double pocoSeconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+
+    // The signer encodes the parameters per request.
+    ofxTwitter::OAuth10Signer signer(credentials);
+
+    start = ofGetElapsedTimeMicros();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        query.setSinceId(i + 1);
+        checksum += signer.authorization("GET", url, ofxTwitter::OAuth10Signer::EncodedParameters(query)).size();
+    }
+
+    double signerSeconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+
+    // The signer reuses the encoded parameters.
+    ofxTwitter::OAuth10Signer::EncodedParameters parameters(query);
+
+    start = ofGetElapsedTimeMicros();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        parameters.set("since_id", std::to_string(i + 1));
+        checksum += signer.authorization("GET", url, parameters).size();
+    }
+
+    double cachedSeconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+
+    ofLogNotice("ofApp::benchmarkSigner") << "Signing " << count << " search requests (checksum " << checksum << ").";
+    ofLogNotice("ofApp::benchmarkSigner") << std::setw(27) << "Poco: " << ofToString(count / pocoSeconds, 0) << " signatures/s";
+    ofLogNotice("ofApp::benchmarkSigner") << std::setw(27) << "Signer: " << ofToString(count / signerSeconds, 0) << " signatures/s, speedup " << ofToString(pocoSeconds / signerSeconds, 2);
+    ofLogNotice("ofApp::benchmarkSigner") << std::setw(27) << "Signer, reused parameters: " << ofToString(count / cachedSeconds, 0) << " signatures/s, speedup " << ofToString(pocoSeconds / cachedSeconds, 2);
+}
+
+
+void ofApp::benchmarkCodec()
+{
+    const std::size_t count = 20000;
+
+    std::vector<std::string> lines;
+    std::vector<std::string> encoded;
+    std::size_t lineBytes = 0;
+    std::size_t encodedBytes = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        lines.push_back(statusLine(i + 1));
+        encoded.push_back(ofxTwitter::BinaryCodec::serialize(ofxTwitter::Status::fromJSON(ofJson::parse(lines.back()))));
+        lineBytes += lines.back().size();
+        encodedBytes += encoded.back().size();
+    }
+
+    std::size_t checksum = 0;
+
+    uint64_t start = ofGetElapsedTimeMicros();
+
+    for (const auto& line: lines)
+    {
+        checksum += ofxTwitter::Status::fromJSON(ofJson::parse(line)).id();
+    }
+
+    double jsonSeconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+
+    start = ofGetElapsedTimeMicros();
+
+    for (const auto& bytes: encoded)
+    {
+        ofxTwitter::Status status;
+
+        if (ofxTwitter::BinaryCodec::deserialize(bytes, status))
+        {
+            checksum -= status.id();
+        }
+    }
+
+    double codecSeconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+
+    ofLogNotice("ofApp::benchmarkCodec") << "Decoding " << count << " statuses (" << lineBytes / count << " bytes of JSON, " << encodedBytes / count << " bytes encoded).";
+    ofLogNotice("ofApp::benchmarkCodec") << std::setw(13) << "fromJSON: " << ofToString(count / jsonSeconds, 0) << " statuses/s";
+    ofLogNotice("ofApp::benchmarkCodec") << std::setw(13) << "BinaryCodec: " << ofToString(count / codecSeconds, 0) << " statuses/s, speedup " << ofToString(jsonSeconds / codecSeconds, 2);
+
+    if (checksum != 0)
+    {
+        ofLogError("ofApp::benchmarkCodec") << "The decoded ids differ.";
+    }
+}
+
+
+std::string ofApp::statusLine(int64_t id)
+{
+    std::string idString = std::to_string(id);
+
+    return "{\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\","
+           "\"id\":" + idString + ",\"id_str\":\"" + idString + "\","
+           "\"text\":\"Benchmarking #openFrameworks with @bakercp https://t.co/abc\","
+           "\"lang\":\"en\",\"retweet_count\":12,\"favorite_count\":34,"
+           "\"entities\":{"
+               "\"hashtags\":[{\"text\":\"openFrameworks\",\"indices\":[13,28]}],"
+               "\"user_mentions\":[{\"id\":1,\"id_str\":\"1\",\"screen_name\":\"bakercp\",\"name\":\"Christopher Baker\",\"indices\":[34,42]}],"
+               "\"urls\":[{\"url\":\"https://t.co/abc\",\"expanded_url\":\"https://openframeworks.cc\",\"display_url\":\"openframeworks.cc\",\"indices\":[43,59]}]},"
+           "\"extended_entities\":{\"media\":[{"
+               "\"id\":" + idString + ",\"id_str\":\"" + idString + "\",\"type\":\"photo\","
+               "\"media_url_https\":\"https://pbs.twimg.com/media/" + idString + ".jpg\","
+               "\"url\":\"https://t.co/abc\",\"display_url\":\"pic.twitter.com/abc\","
+               "\"expanded_url\":\"https://twitter.com/bakercp/status/" + idString + "/photo/1\","
+               "\"indices\":[43,59],"
+               "\"sizes\":{\"thumb\":{\"w\":150,\"h\":150,\"resize\":\"crop\"},"
+                          "\"small\":{\"w\":680,\"h\":453,\"resize\":\"fit\"},"
+                          "\"medium\":{\"w\":1200,\"h\":800,\"resize\":\"fit\"},"
+                          "\"large\":{\"w\":2048,\"h\":1365,\"resize\":\"fit\"}}}]},"
+           "\"user\":{\"id\":1,\"id_str\":\"1\",\"name\":\"Christopher Baker\","
+               "\"screen_name\":\"bakercp\",\"location\":\"Chicago\","
+               "\"description\":\"Artist.\",\"followers_count\":1000,"
+               "\"friends_count\":100,\"statuses_count\":5000,"
+               "\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\"}}";
+}
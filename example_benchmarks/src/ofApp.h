@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxTwitter.h"
+
+
+/// \brief Measures the throughput of the addon's hot paths.
+///
+/// Each benchmark uses synthetic input, so no credentials or network access
+/// are needed. Results are written to the log and the app then exits.
+/// Build in release mode before comparing numbers.
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+
+    /// \brief Measure BulkDecoder throughput against the number of threads.
+    void benchmarkBulkDecoder();
+
+    /// \brief Count the allocations made by a typical status listener.
+    ///
+    /// The listener reads the text, author and media sizes of each status,
+    /// once copying each member as the former by-value accessors did and
+    /// once binding the const references the accessors now return.
+    void benchmarkAccessors();
+
+    /// \brief Measure OAuth 1.0a signing throughput.
+    ///
+    /// Search requests are signed with Poco::Net::OAuth10Credentials, as
+    /// OAuth10HTTPClient does, and with an OAuth10Signer, once encoding the
+    /// parameters for every request and once reusing encoded parameters of
+    /// which only since_id changes.
+    void benchmarkSigner();
+
+    /// \brief Measure BinaryCodec decoding against Status::fromJSON.
+    ///
+    /// The same statuses are decoded from their JSON lines and from their
+    /// serialized form.
+    void benchmarkCodec();
+
+    /// \returns a synthetic status line with entities and a user.
+    /// \param id The status id.
+    static std::string statusLine(int64_t id);
+
+};
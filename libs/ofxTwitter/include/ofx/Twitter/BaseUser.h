@@ -40,7 +40,7 @@ public:
     int64_t id() const;
 
     /// \returns the user's screen name or empty if unavailable.
-    std::string screenName() const;
+    const std::string& screenName() const;
 
 protected:
     /// \brief The user id.
@@ -81,7 +81,7 @@ public:
     virtual ~BaseNamedUser();
 
     /// \returns the user's name if available.
-    std::string name() const;
+    const std::string& name() const;
 
 protected:
     /// \brief The user's name.
@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include "ofx/Twitter/Entities.h"
+#include "ofx/Twitter/Place.h"
+#include "ofx/Twitter/Status.h"
+#include "ofx/Twitter/User.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A compact, versioned binary encoding for the model classes.
+///
+/// This is intended for caches and inter-process fan-out, where decoding
+/// with fromJSON() would parse the same JSON repeatedly.
+///
+/// An encoded value starts with the magic "OFXT", a varint format version
+/// and a byte identifying the encoded class. A table of unique strings
+/// follows, each a varint length and the bytes, and then the body. In the
+/// body, integers are zigzag varints, strings are varint indices into the
+/// string table (0 is the empty string) and each object starts with a varint
+/// bitmap of the fields that differ from their defaults. Only those fields
+/// are written, and boolean fields are stored in the bitmap alone.
+///
+/// The original JSON is not encoded, so json() is empty after decoding, and
+/// matcher annotations are not preserved.
+class BinaryCodec
+{
+public:
+    /// \brief Encode a Status.
+    /// \param status The Status to encode.
+    /// \returns the encoded bytes.
+    static std::string serialize(const Status& status);
+
+    /// \brief Encode a User.
+    /// \param user The User to encode.
+    /// \returns the encoded bytes.
+    static std::string serialize(const User& user);
+
+    /// \brief Encode a Place.
+    /// \param place The Place to encode.
+    /// \returns the encoded bytes.
+    static std::string serialize(const Place& place);
+
+    /// \brief Encode Entities.
+    /// \param entities The Entities to encode.
+    /// \returns the encoded bytes.
+    static std::string serialize(const Entities& entities);
+
+    /// \brief Decode a Status.
+    /// \param data The encoded bytes.
+    /// \param size The number of encoded bytes.
+    /// \param status The decoded Status.
+    /// \returns true if the data was decoded successfully.
+    static bool deserialize(const char* data, std::size_t size, Status& status);
+
+    /// \brief Decode a User.
+    /// \param data The encoded bytes.
+    /// \param size The number of encoded bytes.
+    /// \param user The decoded User.
+    /// \returns true if the data was decoded successfully.
+    static bool deserialize(const char* data, std::size_t size, User& user);
+
+    /// \brief Decode a Place.
+    /// \param data The encoded bytes.
+    /// \param size The number of encoded bytes.
+    /// \param place The decoded Place.
+    /// \returns true if the data was decoded successfully.
+    static bool deserialize(const char* data, std::size_t size, Place& place);
+
+    /// \brief Decode Entities.
+    /// \param data The encoded bytes.
+    /// \param size The number of encoded bytes.
+    /// \param entities The decoded Entities.
+    /// \returns true if the data was decoded successfully.
+    static bool deserialize(const char* data, std::size_t size, Entities& entities);
+
+    /// \brief Decode a value from a string.
+    /// \param data The encoded bytes.
+    /// \param value The decoded value.
+    /// \returns true if the data was decoded successfully.
+    template <typename T>
+    static bool deserialize(const std::string& data, T& value)
+    {
+        return deserialize(data.data(), data.size(), value);
+    }
+
+    /// \brief The current format version.
+    static const uint64_t VERSION;
+
+    /// \brief The magic bytes at the start of an encoded value.
+    static const std::string MAGIC;
+
+private:
+    class Encoder;
+    class Decoder;
+
+    template <typename T>
+    static std::string _serialize(uint8_t kind, const T& value);
+
+    template <typename T>
+    static bool _deserialize(uint8_t kind, const char* data, std::size_t size, T& value);
+
+    static void _write(Encoder& e, const Status& status);
+    static void _write(Encoder& e, const User& user);
+    static void _write(Encoder& e, const Profile& profile);
+    static void _write(Encoder& e, const Place& place);
+    static void _write(Encoder& e, const Entities& entities);
+    static void _write(Encoder& e, const MediaEntity& entity);
+    static void _write(Encoder& e, const AdditionalMediaInfo& info);
+
+    static void _read(Decoder& d, Status& status);
+    static void _read(Decoder& d, User& user);
+    static void _read(Decoder& d, Profile& profile);
+    static void _read(Decoder& d, Place& place);
+    static void _read(Decoder& d, Entities& entities);
+    static void _read(Decoder& d, MediaEntity& entity);
+    static void _read(Decoder& d, AdditionalMediaInfo& info);
+
+};
+
+
+} } // namespace ofx::Twitter
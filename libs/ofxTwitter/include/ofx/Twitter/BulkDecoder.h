@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ofFileUtils.h"
+#include "ofx/Twitter/Status.h"
+#include "ofx/Twitter/StatusBatch.h"
+#include "ofx/Twitter/ThreadPool.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Decodes newline-delimited statuses in parallel.
+///
+/// The input is split at line boundaries into chunks that are decoded on a
+/// ThreadPool. This is intended for archived streams, e.g. files written by
+/// saving each line received from a streaming endpoint.
+///
+/// Lines that are not statuses, such as keep-alives and notices, are skipped.
+/// Lines that fail to decode are skipped and counted.
+class BulkDecoder
+{
+public:
+    /// \brief A function called for each decoded status.
+    typedef std::function<void(const Status&)> Sink;
+
+    /// \brief Create a BulkDecoder.
+    /// \param pool The pool to decode on. It must outlive the decoder.
+    BulkDecoder(ThreadPool& pool = ThreadPool::instance());
+
+    /// \brief Decode all statuses in a buffer.
+    /// \param data The newline-delimited input.
+    /// \param size The size of the input in bytes.
+    /// \returns the decoded statuses in input order.
+    std::vector<Status> decode(const char* data, std::size_t size);
+
+    /// \brief Decode all statuses in a string.
+    /// \param data The newline-delimited input.
+    /// \returns the decoded statuses in input order.
+    std::vector<Status> decode(const std::string& data);
+
+    /// \brief Decode all statuses in a buffer.
+    /// \param buffer The newline-delimited input.
+    /// \returns the decoded statuses in input order.
+    std::vector<Status> decode(const ofBuffer& buffer);
+
+    /// \brief Decode all statuses in a file.
+    ///
+    /// The file is read and decoded in line-aligned blocks, so the input is
+    /// never held in memory all at once.
+    ///
+    /// \param path The path of the newline-delimited input file.
+    /// \returns the decoded statuses in input order.
+    std::vector<Status> decodeFile(const std::filesystem::path& path);
+
+    /// \brief Decode all statuses in a file and pass each to a sink.
+    ///
+    /// The file is read and decoded in line-aligned blocks, so memory use does
+    /// not grow with the size of the file. The sink is called concurrently
+    /// from pool threads and must be thread-safe. The first exception thrown
+    /// by the sink is rethrown once the current block is decoded.
+    ///
+    /// \param path The path of the newline-delimited input file.
+    /// \param sink The function to call for each status.
+    /// \returns the number of statuses decoded.
+    std::size_t decodeFile(const std::filesystem::path& path, const Sink& sink);
+
+    /// \brief Decode all statuses in a buffer and pass each to a sink.
+    ///
+    /// Statuses are not collected, so memory use does not grow with the size
+    /// of the input. The sink is called concurrently from pool threads in no
+    /// particular order and must be thread-safe. The first exception thrown
+    /// by the sink is rethrown once all chunks are decoded.
+    ///
+    /// \param data The newline-delimited input.
+    /// \param size The size of the input in bytes.
+    /// \param sink The function to call for each status.
+    /// \returns the number of statuses decoded.
+    std::size_t decode(const char* data, std::size_t size, const Sink& sink);
+
+    /// \brief Decode all statuses in a buffer into a StatusBatch.
+    ///
+    /// Each chunk is decoded into its own batch, and the batches are then
+    /// appended in input order, so statuses are moved rather than copied.
+    ///
+    /// \param data The newline-delimited input.
+    /// \param size The size of the input in bytes.
+    /// \param batch The batch to append the statuses to.
+    /// \returns the number of statuses decoded.
+    std::size_t decode(const char* data, std::size_t size, StatusBatch& batch);
+
+    /// \brief Set the approximate number of bytes decoded per task.
+    /// \param chunkSize The chunk size in bytes.
+    void setChunkSize(std::size_t chunkSize);
+
+    /// \returns the approximate number of bytes decoded per task.
+    std::size_t getChunkSize() const;
+
+    /// \returns the number of lines that failed to decode in the last call.
+    std::size_t errorCount() const;
+
+    /// \brief The default chunk size in bytes.
+    static const std::size_t DEFAULT_CHUNK_SIZE;
+
+private:
+    /// \brief A line-aligned range of the input.
+    struct Chunk
+    {
+        const char* begin;
+        const char* end;
+    };
+
+    /// \brief Read a file in line-aligned blocks.
+    ///
+    /// Each block holds about getChunkSize() bytes for every task the pool
+    /// can run at once, so that all threads stay busy while only one block
+    /// is held in memory. The error count is accumulated over all blocks.
+    ///
+    /// \param path The path of the newline-delimited input file.
+    /// \param block The function to decode each block with.
+    void _readFile(const std::filesystem::path& path,
+                   const std::function<void(const char*, std::size_t)>& block);
+
+    /// \brief Split the input into line-aligned chunks.
+    std::vector<Chunk> _split(const char* data, std::size_t size) const;
+
+    /// \brief Decode each status line in a chunk.
+    /// \returns the number of lines that failed to decode.
+    static std::size_t _decode(const Chunk& chunk,
+                               const std::function<void(Status&&)>& callback);
+
+    /// \brief The pool to decode on.
+    ThreadPool& _pool;
+
+    /// \brief The approximate number of bytes per chunk.
+    std::size_t _chunkSize = DEFAULT_CHUNK_SIZE;
+
+    /// \brief The number of lines that failed to decode in the last call.
+    std::atomic<std::size_t> _errorCount;
+
+};
+
+
+} } // namespace ofx::Twitter
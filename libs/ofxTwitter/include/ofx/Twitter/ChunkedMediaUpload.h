@@ -0,0 +1,232 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "Poco/Net/NameValueCollection.h"
+#include "ofFileUtils.h"
+#include "ofx/HTTP/OAuth10HTTPClient.h"
+#include "ofx/Twitter/MediaUpload.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Uploads media files with the chunked INIT, APPEND, FINALIZE and
+/// STATUS commands.
+///
+/// The file is read in fixed size segments into a small set of buffers that
+/// are reused for the whole upload, so memory use does not depend on the file
+/// size. Segments are sent as raw multipart data without Base64 encoding, and
+/// several APPEND commands are kept in flight while the next segments are
+/// read.
+///
+/// Failed segments are retried with exponential backoff. If resumable uploads
+/// are enabled and a segment still fails, the upload state is saved and the
+/// next upload of the same file resumes with the segments that were not
+/// acknowledged, as long as the media id has not expired. Resumable uploads
+/// are off by default, since the state is written next to the media file
+/// unless a state directory is set.
+///
+/// Usage:
+///
+///     ofxTwitter::ChunkedMediaUpload upload(credentials);
+///     auto response = upload.upload("video.mp4");
+///     statusUpdate.setMediaId(response.mediaId());
+///
+/// \sa https://developer.twitter.com/en/docs/media/upload-media/uploading-media/chunked-media-upload
+class ChunkedMediaUpload
+{
+public:
+    /// \brief A function that executes an upload command.
+    ///
+    /// The fields contain the command and its parameters. For APPEND, data
+    /// and size refer to the segment, otherwise data is nullptr. The function
+    /// returns the response JSON, which is empty for APPEND, and reports
+    /// failures by throwing. It may be called from several threads at once.
+    typedef std::function<ofJson(const Poco::Net::NameValueCollection& fields,
+                                 const char* data,
+                                 std::size_t size)> Transport;
+
+    /// \brief Create a ChunkedMediaUpload with the given credentials.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    ChunkedMediaUpload(const HTTP::OAuth10Credentials& credentials);
+
+    /// \brief Create a ChunkedMediaUpload with a custom transport.
+    /// \param transport The function that executes commands.
+    ChunkedMediaUpload(Transport transport);
+
+    /// \brief Destroy the ChunkedMediaUpload.
+    ~ChunkedMediaUpload();
+
+    /// \brief Upload a media file.
+    ///
+    /// This blocks until the media is uploaded and, for media that requires
+    /// processing, until processing has finished.
+    ///
+    /// \param path The path of the media file.
+    /// \param mediaType The MIME type, or empty to guess it from the extension.
+    /// \param mediaCategory The media category, e.g. "tweet_video", or empty
+    /// to derive it from the media type.
+    /// \returns the FINALIZE or final STATUS response.
+    /// \throws Poco::FileNotFoundException if the file does not exist,
+    /// Poco::DataException if Twitter rejects the media, or another
+    /// Poco::Exception if the upload fails.
+    MediaUploadResponse upload(const std::filesystem::path& path,
+                               const std::string& mediaType = "",
+                               const std::string& mediaCategory = "");
+
+    /// \brief Upload media from memory.
+    ///
+    /// Segments are sent directly from the buffer, which must remain valid
+    /// until the call returns. Uploads from memory are not resumable.
+    ///
+    /// \param buffer The encoded media.
+    /// \param mediaType The MIME type.
+    /// \param mediaCategory The media category, e.g. "tweet_image", or empty
+    /// to derive it from the media type.
+    /// \returns the FINALIZE or final STATUS response.
+    /// \throws Poco::Exception if the upload fails.
+    MediaUploadResponse upload(const ofBuffer& buffer,
+                               const std::string& mediaType,
+                               const std::string& mediaCategory = "");
+
+    /// \brief Set the segment size in bytes.
+    ///
+    /// Twitter accepts segments of up to 5 MB.
+    ///
+    /// \param chunkSize The segment size in bytes.
+    void setChunkSize(std::size_t chunkSize);
+
+    /// \returns the segment size in bytes.
+    std::size_t chunkSize() const;
+
+    /// \brief Set the maximum number of APPEND commands in flight.
+    ///
+    /// Each command in flight holds one segment buffer.
+    ///
+    /// \param maxInFlight The maximum number of concurrent commands.
+    void setMaxInFlight(std::size_t maxInFlight);
+
+    /// \returns the maximum number of APPEND commands in flight.
+    std::size_t maxInFlight() const;
+
+    /// \brief Set the number of times a failed segment is retried.
+    /// \param maxRetries The number of retries.
+    void setMaxRetries(std::size_t maxRetries);
+
+    /// \returns the number of times a failed segment is retried.
+    std::size_t maxRetries() const;
+
+    /// \brief Enable or disable resuming interrupted uploads.
+    ///
+    /// Disabled by default.
+    ///
+    /// \param resumable True to save and resume the upload state.
+    void setResumable(bool resumable);
+
+    /// \returns true if interrupted uploads are resumed.
+    bool isResumable() const;
+
+    /// \brief Set the directory where upload state is saved.
+    ///
+    /// The directory is created when needed. If empty, the state is saved
+    /// next to the media file.
+    ///
+    /// \param stateDirectory The state directory.
+    void setStateDirectory(const std::filesystem::path& stateDirectory);
+
+    /// \returns the directory where upload state is saved, or empty.
+    std::filesystem::path stateDirectory() const;
+
+    /// \brief Get the path of the saved state for a media file.
+    /// \param path The path of the media file.
+    /// \returns the state path.
+    std::filesystem::path statePath(const std::filesystem::path& path) const;
+
+    /// \brief Guess the MIME type of a media file from its extension.
+    /// \param path The path of the media file.
+    /// \returns the MIME type, or "application/octet-stream".
+    static std::string mediaTypeForPath(const std::filesystem::path& path);
+
+    /// \brief Execute an upload command over HTTP.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param fields The command fields.
+    /// \param data The APPEND segment, or nullptr.
+    /// \param size The segment size.
+    /// \returns the response JSON.
+    /// \throws Poco::DataException if the request is rejected with a client
+    /// error, or Poco::IOException if the command fails otherwise.
+    static ofJson execute(const HTTP::OAuth10Credentials& credentials,
+                          const Poco::Net::NameValueCollection& fields,
+                          const char* data,
+                          std::size_t size);
+
+    /// \brief The default segment size, 4 MB.
+    static const std::size_t DEFAULT_CHUNK_SIZE;
+
+    /// \brief The default maximum number of APPEND commands in flight.
+    static const std::size_t DEFAULT_MAX_IN_FLIGHT;
+
+    /// \brief The default number of retries per segment.
+    static const std::size_t DEFAULT_MAX_RETRIES;
+
+    /// \brief The maximum time to wait for media processing in seconds.
+    static const uint64_t MAX_PROCESSING_SECS;
+
+private:
+    /// \brief A function that provides the segment at the given offset.
+    ///
+    /// The function may read the segment into the buffer. It returns a
+    /// pointer to the segment, or nullptr on failure.
+    typedef std::function<const char*(uint64_t offset,
+                                      std::size_t size,
+                                      std::vector<char>& buffer)> Reader;
+
+    /// \brief Upload media.
+    /// \param totalBytes The media size in bytes.
+    /// \param read The function providing segments.
+    /// \param mediaType The MIME type.
+    /// \param mediaCategory The media category, or empty.
+    /// \param path The media file used to resume, or empty.
+    /// \returns the FINALIZE or final STATUS response.
+    MediaUploadResponse _upload(uint64_t totalBytes,
+                                Reader read,
+                                const std::string& mediaType,
+                                const std::string& mediaCategory,
+                                const std::filesystem::path& path);
+
+    /// \brief Execute a command, throwing on response errors.
+    MediaUploadResponse _command(const Poco::Net::NameValueCollection& fields);
+
+    /// \brief The function that executes commands.
+    Transport _transport;
+
+    /// \brief The segment size in bytes.
+    std::size_t _chunkSize = DEFAULT_CHUNK_SIZE;
+
+    /// \brief The maximum number of APPEND commands in flight.
+    std::size_t _maxInFlight = DEFAULT_MAX_IN_FLIGHT;
+
+    /// \brief The number of retries per segment.
+    std::size_t _maxRetries = DEFAULT_MAX_RETRIES;
+
+    /// \brief True if interrupted uploads are resumed.
+    bool _resumable = false;
+
+    /// \brief The directory where upload state is saved, or empty.
+    std::filesystem::path _stateDirectory;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "ofJson.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A lock-free latency histogram.
+///
+/// Values are recorded in microseconds. Each power-of-two range is split into
+/// a fixed number of linear sub-buckets, in the style of an HDR histogram,
+/// so the relative error of any reported value is bounded by
+/// 1 / SUB_BUCKET_COUNT regardless of magnitude.
+///
+/// Recording is wait-free and may be done from any thread. Reads are not
+/// atomic with respect to each other, so a snapshot taken while values are
+/// being recorded may be off by the values recorded during the read.
+class LatencyHistogram
+{
+public:
+    /// \brief Create an empty LatencyHistogram.
+    LatencyHistogram();
+
+    /// \brief Record a single value.
+    /// \param micros The value to record in microseconds.
+    void record(uint64_t micros);
+
+    /// \brief Clear all recorded values.
+    void reset();
+
+    /// \returns the number of recorded values.
+    uint64_t count() const;
+
+    /// \returns the sum of all recorded values in microseconds.
+    uint64_t sum() const;
+
+    /// \returns the smallest recorded value, or 0 if empty.
+    uint64_t min() const;
+
+    /// \returns the largest recorded value, or 0 if empty.
+    uint64_t max() const;
+
+    /// \returns the mean of all recorded values, or 0 if empty.
+    double mean() const;
+
+    /// \brief Estimate a percentile.
+    /// \param percentile The percentile to estimate in the range [0, 100].
+    /// \returns the upper bound of the bucket containing the percentile.
+    uint64_t percentile(double percentile) const;
+
+    /// \returns a JSON summary of the histogram.
+    ofJson toJSON() const;
+
+    /// \brief The number of bits used for linear sub-buckets.
+    static constexpr std::size_t SUB_BUCKET_BITS = 3;
+
+    /// \brief The number of linear sub-buckets per power of two.
+    static constexpr std::size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    /// \brief The total number of buckets needed to cover 64-bit values.
+    static constexpr std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+private:
+    /// \returns the bucket index for the given value.
+    static std::size_t _bucketIndex(uint64_t value);
+
+    /// \returns the largest value that maps to the given bucket index.
+    static uint64_t _bucketUpperBound(std::size_t index);
+
+    /// \brief The bucket counts.
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> _buckets;
+
+    /// \brief The number of recorded values.
+    std::atomic<uint64_t> _count;
+
+    /// \brief The sum of all recorded values.
+    std::atomic<uint64_t> _sum;
+
+    /// \brief The smallest recorded value.
+    std::atomic<uint64_t> _min;
+
+    /// \brief The largest recorded value.
+    std::atomic<uint64_t> _max;
+
+};
+
+
+/// \brief Lock-free runtime metrics for a Twitter client.
+///
+/// Each client owns one ClientMetrics object that is updated from its
+/// network thread and may be read from any thread. The read, parse and
+/// deliver histograms together show where time is spent: a client that is
+/// network-bound will spend most of its time in READ, while a client that is
+/// CPU-bound will show PARSE and DELIVER times approaching the READ time.
+class ClientMetrics
+{
+public:
+    /// \brief The events counted by the client.
+    enum class Event
+    {
+        /// \brief A connection was opened.
+        CONNECT,
+        /// \brief A connection was closed.
+        DISCONNECT,
+        /// \brief A raw message was received.
+        MESSAGE,
+        /// \brief A Status was received.
+        STATUS,
+        /// \brief A StatusDeletedNotice was received.
+        STATUS_DELETED_NOTICE,
+        /// \brief A LocationDeletedNotice was received.
+        LOCATION_DELETED_NOTICE,
+        /// \brief A LimitNotice was received.
+        LIMIT_NOTICE,
+        /// \brief A StatusWithheldNotice was received.
+        STATUS_WITHHELD_NOTICE,
+        /// \brief A UserWithheldNotice was received.
+        USER_WITHHELD_NOTICE,
+        /// \brief A DisconnectNotice was received.
+        DISCONNECT_NOTICE,
+        /// \brief A StallWarning was received.
+        STALL_WARNING,
+        /// \brief An API Error was received.
+        API_ERROR,
+        /// \brief An exception was caught.
+        EXCEPTION
+    };
+
+    /// \brief The timed processing stages.
+    enum class Stage
+    {
+        /// \brief Time spent waiting for and reading data from the network.
+        READ,
+        /// \brief Time spent parsing JSON and decoding model objects.
+        PARSE,
+        /// \brief Time spent handing decoded objects to the consumer.
+        DELIVER
+    };
+
+    /// \brief Create a zeroed ClientMetrics.
+    ClientMetrics();
+
+    /// \brief Count an event.
+    ///
+    /// Counting a CONNECT event starts a new LimitNotice track total.
+    ///
+    /// \param event The event to count.
+    /// \param count The number of events.
+    void increment(Event event, uint64_t count = 1);
+
+    /// \returns the number of times the given event has occurred.
+    uint64_t count(Event event) const;
+
+    /// \brief Add to the number of bytes received.
+    /// \param bytes The number of bytes received.
+    void addBytesReceived(uint64_t bytes);
+
+    /// \returns the total number of bytes received.
+    uint64_t bytesReceived() const;
+
+    /// \brief Update the undelivered status count from a LimitNotice.
+    ///
+    /// LimitNotice::track() reports a running total for the current
+    /// connection, so the value replaces the previous one.
+    ///
+    /// \param track The value of LimitNotice::track().
+    void setLimitTrack(uint64_t track);
+
+    /// \returns the total undelivered statuses reported by LimitNotices
+    /// across all connections.
+    uint64_t limitTrackTotal() const;
+
+    /// \brief Record that events were queued for delivery.
+    /// \param event The event type queued.
+    /// \param count The number of events queued.
+    void addQueued(Event event, uint64_t count = 1);
+
+    /// \brief Record that events were removed from a delivery queue.
+    /// \param event The event type removed.
+    /// \param count The number of events removed.
+    void removeQueued(Event event, uint64_t count = 1);
+
+    /// \returns the number of undelivered events of the given type.
+    uint64_t queueDepth(Event event) const;
+
+    /// \brief Record a stage duration measured from \p start until now.
+    /// \param stage The stage to record.
+    /// \param start The start time returned by now().
+    /// \returns the current time, for use as the start of the next stage.
+    uint64_t record(Stage stage, uint64_t start);
+
+    /// \returns the histogram for the given stage.
+    const LatencyHistogram& histogram(Stage stage) const;
+
+    /// \brief Reset all counters, gauges and histograms.
+    void reset();
+
+    /// \returns a JSON snapshot of all metrics.
+    ofJson toJSON() const;
+
+    /// \returns a monotonic timestamp in microseconds.
+    static uint64_t now();
+
+    /// \returns the lowercase name of the given event.
+    static std::string to_string(Event event);
+
+    /// \returns the lowercase name of the given stage.
+    static std::string to_string(Stage stage);
+
+    /// \brief The number of Event values.
+    static constexpr std::size_t EVENT_COUNT = static_cast<std::size_t>(Event::EXCEPTION) + 1;
+
+    /// \brief The number of Stage values.
+    static constexpr std::size_t STAGE_COUNT = static_cast<std::size_t>(Stage::DELIVER) + 1;
+
+private:
+    /// \brief Event counters.
+    std::array<std::atomic<uint64_t>, EVENT_COUNT> _counts;
+
+    /// \brief Delivery queue depths.
+    std::array<std::atomic<int64_t>, EVENT_COUNT> _queueDepths;
+
+    /// \brief Stage histograms.
+    std::array<LatencyHistogram, STAGE_COUNT> _histograms;
+
+    /// \brief The total number of bytes received.
+    std::atomic<uint64_t> _bytesReceived;
+
+    /// \brief The last LimitNotice track value for the current connection.
+    std::atomic<uint64_t> _limitTrackCurrent;
+
+    /// \brief The sum of final LimitNotice track values from closed connections.
+    std::atomic<uint64_t> _limitTrackPrevious;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ofFileUtils.h"
+#include "ofx/Twitter/Status.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A column of fixed width values.
+///
+/// The validity bitmap follows the Arrow convention: bit i % 8 of byte i / 8
+/// is set if row i has a value. Rows without a value hold zero.
+template <typename T>
+class FixedColumn
+{
+public:
+    /// \brief Append a value.
+    void append(T value, bool valid = true);
+
+    /// \returns true if the row has a value.
+    bool isValid(std::size_t row) const;
+
+    /// \brief The values, one per row.
+    std::vector<T> values;
+
+    /// \brief The validity bitmap.
+    std::vector<uint8_t> validity;
+
+};
+
+
+/// \brief A column of variable length strings.
+///
+/// The bytes of row i are data[offsets[i], offsets[i + 1]). Strings are not
+/// null terminated.
+class StringColumn
+{
+public:
+    StringColumn();
+
+    /// \brief Append a string.
+    void append(const std::string& value, bool valid = true);
+
+    /// \returns the string in the given row.
+    std::string get(std::size_t row) const;
+
+    /// \returns true if the row has a value.
+    bool isValid(std::size_t row) const;
+
+    /// \returns the number of rows.
+    std::size_t size() const;
+
+    /// \brief The row offsets into data. Holds size() + 1 entries.
+    std::vector<uint32_t> offsets;
+
+    /// \brief The concatenated string bytes.
+    std::vector<char> data;
+
+    /// \brief The validity bitmap.
+    std::vector<uint8_t> validity;
+
+};
+
+
+/// \brief A column of variable length lists.
+///
+/// The elements of row i are values[offsets[i], offsets[i + 1]).
+template <typename Values>
+class ListColumn
+{
+public:
+    ListColumn(): offsets(1, 0)
+    {
+    }
+
+    /// \brief Close the current row after its elements were appended to
+    /// values.
+    void endRow();
+
+    /// \returns the number of rows.
+    std::size_t size() const
+    {
+        return offsets.size() - 1;
+    }
+
+    /// \brief The row offsets into values. Holds size() + 1 entries.
+    std::vector<uint32_t> offsets;
+
+    /// \brief The flattened elements.
+    Values values;
+
+};
+
+
+/// \brief Flattens statuses into contiguous typed columns.
+///
+/// Each field is stored in its own contiguous buffer so that analytics code
+/// can scan a field across many statuses without touching the others.
+/// Strings and entity lists are stored as offsets into a single data buffer,
+/// in the spirit of the Apache Arrow memory layout.
+///
+/// Entities are taken from the extended tweet when one is present.
+///
+/// Usage:
+///
+///     ofxTwitter::ColumnarBatch batch;
+///     for (const auto& status: statuses) batch.append(status);
+///     batch.save("statuses.col");
+class ColumnarBatch
+{
+public:
+    /// \brief The type of a column in a saved file.
+    enum class ColumnType: uint8_t
+    {
+        /// \brief int64_t values.
+        INT64 = 1,
+        /// \brief uint64_t values.
+        UINT64 = 2,
+        /// \brief double values.
+        FLOAT64 = 3,
+        /// \brief uint32_t offsets followed by string bytes.
+        STRING = 4,
+        /// \brief uint32_t list offsets followed by int64_t values.
+        INT64_LIST = 5,
+        /// \brief uint32_t list offsets followed by a STRING column.
+        STRING_LIST = 6
+    };
+
+    /// \brief Append a status as a new row.
+    /// \param status The status to append.
+    void append(const Status& status);
+
+    /// \brief Reserve space for a number of rows.
+    /// \param rows The expected number of rows.
+    void reserve(std::size_t rows);
+
+    /// \returns the number of rows.
+    std::size_t size() const;
+
+    /// \brief Remove all rows.
+    void clear();
+
+    /// \brief Write the batch.
+    ///
+    /// The file starts with the 8 byte magic "OFXTCOL1", a uint64 row count
+    /// and a uint32 column count. Each column follows as a uint16 name
+    /// length, the name, a uint8 ColumnType and a uint8 buffer count. Each
+    /// buffer is a uint64 byte length followed by the bytes, which start on
+    /// an 8 byte boundary. Buffers are written in the order validity,
+    /// offsets, values (list columns write their list offsets before the
+    /// element buffers). Values are in host byte order, which is little
+    /// endian on all platforms supported by openFrameworks.
+    ///
+    /// \param ostr The stream to write to.
+    /// \returns true if the batch was written successfully.
+    bool write(std::ostream& ostr) const;
+
+    /// \brief Write the batch to a file.
+    /// \param path The output file path.
+    /// \returns true if the file was written successfully.
+    bool save(const std::filesystem::path& path) const;
+
+    /// \brief The magic bytes at the start of a saved file.
+    static const std::string MAGIC;
+
+    /// \brief The status ids.
+    FixedColumn<int64_t> id;
+
+    /// \brief The creation times in milliseconds since the Unix epoch.
+    FixedColumn<int64_t> createdAt;
+
+    /// \brief The stream timestamps in milliseconds since the Unix epoch.
+    FixedColumn<uint64_t> timestamp;
+
+    /// \brief The BCP 47 language codes.
+    StringColumn language;
+
+    /// \brief The author ids, invalid when the user is missing.
+    FixedColumn<int64_t> userId;
+
+    /// \brief The author screen names, invalid when the user is missing.
+    StringColumn userScreenName;
+
+    /// \brief The ids of the statuses being replied to, invalid if none.
+    FixedColumn<int64_t> inReplyToStatusId;
+
+    /// \brief The ids of the retweeted statuses, invalid if none.
+    FixedColumn<int64_t> retweetedStatusId;
+
+    /// \brief The ids of the quoted statuses, invalid if none.
+    FixedColumn<int64_t> quotedStatusId;
+
+    /// \brief The retweet counts, invalid when not reported.
+    FixedColumn<int64_t> retweetCount;
+
+    /// \brief The favorite counts, invalid when not reported.
+    FixedColumn<int64_t> favoriteCount;
+
+    /// \brief The quote counts, invalid when not reported.
+    FixedColumn<int64_t> quoteCount;
+
+    /// \brief The reply counts, invalid when not reported.
+    FixedColumn<int64_t> replyCount;
+
+    /// \brief The latitudes, invalid when there are no coordinates.
+    FixedColumn<double> latitude;
+
+    /// \brief The longitudes, invalid when there are no coordinates.
+    FixedColumn<double> longitude;
+
+    /// \brief The hashtags of each status, without the leading #.
+    ListColumn<StringColumn> hashtags;
+
+    /// \brief The cashtag symbols of each status, without the leading $.
+    ListColumn<StringColumn> symbols;
+
+    /// \brief The mentioned user ids of each status.
+    ListColumn<std::vector<int64_t>> mentionIds;
+
+    /// \brief The expanded URLs of each status.
+    ListColumn<StringColumn> urls;
+
+    /// \brief The media ids of each status.
+    ListColumn<std::vector<int64_t>> mediaIds;
+
+};
+
+
+template <typename T>
+void FixedColumn<T>::append(T value, bool valid)
+{
+    std::size_t row = values.size();
+
+    if (row % 8 == 0)
+    {
+        validity.push_back(0);
+    }
+
+    if (valid)
+    {
+        validity.back() |= uint8_t(1 << (row % 8));
+        values.push_back(value);
+    }
+    else
+    {
+        values.push_back(T());
+    }
+}
+
+
+template <typename T>
+bool FixedColumn<T>::isValid(std::size_t row) const
+{
+    return (validity[row / 8] >> (row % 8)) & 1;
+}
+
+
+template <typename Values>
+void ListColumn<Values>::endRow()
+{
+    offsets.push_back(uint32_t(values.size()));
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ofx/HTTP/OAuth10HTTPClient.h"
+#include "ofx/Twitter/BaseResponse.h"
+#include "ofx/Twitter/OAuth10Signer.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A set of credentials that requests are spread across.
+///
+/// Twitter rate limits are counted per token and per endpoint, so a single
+/// token caps the throughput of each endpoint. The pool tracks the RateLimit
+/// of every credential for every endpoint and routes each request to the
+/// credential with the most budget left. Credentials whose budget is
+/// exhausted are skipped until their limit resets.
+///
+/// A request is routed by acquiring a credential for its endpoint and
+/// releasing it with the response's rate limit:
+///
+///     std::size_t index = 0;
+///
+///     if (pool.tryAcquire(SearchQuery::RESOURCE_URL, index))
+///     {
+///         pool.signer(index)->sign(request, query);
+///         auto response = client.execute(request);
+///         pool.release(index, SearchQuery::RESOURCE_URL, RateLimit::fromHeaders(*response));
+///     }
+///
+/// RESTClient and BaseSearchClient can do this automatically.
+///
+/// Budgets are estimated until a response reports the real limit: an
+/// acquired credential counts as one request until it is released, and a
+/// credential with no known limit for an endpoint is preferred over any
+/// credential with a known limit.
+class CredentialPool
+{
+public:
+    /// \brief Create an empty CredentialPool.
+    CredentialPool();
+
+    /// \brief Create a CredentialPool.
+    /// \param credentials The credentials to add.
+    CredentialPool(const std::vector<HTTP::OAuth10Credentials>& credentials);
+
+    /// \brief Destroy the CredentialPool.
+    ~CredentialPool();
+
+    /// \brief Add credentials to the pool.
+    /// \param credentials The credentials to add.
+    /// \returns the index of the credentials.
+    std::size_t add(const HTTP::OAuth10Credentials& credentials);
+
+    /// \brief Add credentials from a JSON file.
+    ///
+    /// The file holds a single credentials object or an array of them.
+    ///
+    /// \param path The path to the JSON file.
+    /// \returns the number of credentials added.
+    std::size_t addFromFile(const std::filesystem::path& path);
+
+    /// \returns the number of credentials in the pool.
+    std::size_t size() const;
+
+    /// \param index The index of the credentials.
+    /// \returns the credentials at the index.
+    HTTP::OAuth10Credentials credentials(std::size_t index) const;
+
+    /// \param index The index of the credentials.
+    /// \returns the signer for the credentials at the index, which is
+    /// shared by all requests made with them.
+    std::shared_ptr<OAuth10Signer> signer(std::size_t index) const;
+
+    /// \brief Acquire the credential with the most budget for an endpoint.
+    /// \param endpoint The resource URL of the endpoint.
+    /// \param index Set to the index of the acquired credentials.
+    /// \returns false if all credentials are exhausted for the endpoint.
+    bool tryAcquire(const std::string& endpoint, std::size_t& index);
+
+    /// \brief Release acquired credentials.
+    ///
+    /// The rate limit is ignored if it is empty, e.g. when the request
+    /// failed before a response was received.
+    ///
+    /// \param index The index of the credentials.
+    /// \param endpoint The resource URL of the endpoint.
+    /// \param rateLimit The rate limit reported by the response.
+    void release(std::size_t index,
+                 const std::string& endpoint,
+                 const RateLimit& rateLimit = RateLimit());
+
+    /// \param index The index of the credentials.
+    /// \param endpoint The resource URL of the endpoint.
+    /// \returns the last rate limit reported for the credentials.
+    RateLimit rateLimit(std::size_t index, const std::string& endpoint) const;
+
+    /// \param endpoint The resource URL of the endpoint.
+    /// \returns the number of requests left for the endpoint across all
+    /// credentials with known limits.
+    uint64_t remaining(const std::string& endpoint) const;
+
+    /// \param endpoint The resource URL of the endpoint.
+    /// \returns the Unix time in seconds when a credential is next available
+    /// for the endpoint, or 0 if one is available now.
+    uint64_t nextReset(const std::string& endpoint) const;
+
+    /// \brief Get the endpoint of a request.
+    /// \param request The request.
+    /// \returns the request URI without its query.
+    static std::string endpoint(const HTTP::Request& request);
+
+private:
+    /// \brief The budget of one credential for one endpoint.
+    struct Budget
+    {
+        /// \brief The last reported rate limit.
+        RateLimit rateLimit;
+
+        /// \brief The number of requests acquired and not released.
+        uint64_t acquired = 0;
+    };
+
+    /// \brief Credentials and their budgets.
+    struct Entry
+    {
+        HTTP::OAuth10Credentials credentials;
+        std::shared_ptr<OAuth10Signer> signer;
+        std::map<std::string, Budget> budgets;
+    };
+
+    /// \brief Estimate the requests left in a budget.
+    /// \param budget The budget.
+    /// \param now The current Unix time in seconds.
+    /// \returns the estimate, or UINT64_MAX less the acquired requests if
+    /// the limit is unknown or has reset.
+    static uint64_t _estimate(const Budget& budget, uint64_t now);
+
+    /// \returns the current Unix time in seconds.
+    static uint64_t _now();
+
+    /// \brief The credentials.
+    std::vector<Entry> _entries;
+
+    /// \brief Guards the entries.
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::Twitter
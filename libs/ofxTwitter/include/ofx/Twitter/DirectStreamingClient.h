@@ -0,0 +1,213 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <functional>
+#include "ofx/Twitter/StreamingClient.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A receiver for events delivered by a DirectStreamingClient.
+///
+/// All callbacks have empty default implementations, so subclasses only need
+/// to override the events they are interested in.
+///
+/// Unless an executor is set on the client, callbacks are invoked directly
+/// on the streaming thread. They should return quickly, since the next
+/// message is not read until the callback returns.
+class StreamingSink
+{
+public:
+    /// \brief Destroy the StreamingSink.
+    virtual ~StreamingSink()
+    {
+    }
+
+    virtual void onConnect()
+    {
+    }
+
+    virtual void onDisconnect()
+    {
+    }
+
+    virtual void onStatus(const Status& status)
+    {
+    }
+
+    virtual void onStatusDeletedNotice(const StatusDeletedNotice& notice)
+    {
+    }
+
+    virtual void onLocationDeletedNotice(const LocationDeletedNotice& notice)
+    {
+    }
+
+    virtual void onLimitNotice(const LimitNotice& notice)
+    {
+    }
+
+    virtual void onStatusWithheldNotice(const StatusWithheldNotice& notice)
+    {
+    }
+
+    virtual void onUserWitheldNotice(const UserWithheldNotice& notice)
+    {
+    }
+
+    virtual void onDisconnectNotice(const DisconnectNotice& notice)
+    {
+    }
+
+    virtual void onStallWarning(const StallWarning& notice)
+    {
+    }
+
+    virtual void onException(const std::exception& exc)
+    {
+    }
+
+    virtual void onMessage(const ofJson& message)
+    {
+    }
+
+    /// \returns true if onMessage() should receive raw messages.
+    ///
+    /// Sinks that do not override onMessage() can return false, so that
+    /// notices are decoded without building the raw message.
+    virtual bool wantsMessages() const
+    {
+        return true;
+    }
+
+};
+
+
+/// \brief A Twitter Streaming Client that delivers events without queuing.
+///
+/// Unlike StreamingClient, events are not passed through ThreadChannels and
+/// do not depend on the openFrameworks update loop, so no call to
+/// syncEvents() is needed. This makes the client suitable for headless
+/// applications.
+///
+/// By default events are passed by reference to the StreamingSink on the
+/// streaming thread as soon as they are decoded. If an Executor is set, each
+/// event is copied into a task and handed to the executor instead, e.g. to
+/// run it on a worker pool or an application event loop.
+class DirectStreamingClient: public BaseStreamingClient
+{
+public:
+    /// \brief A function that runs a delivery task.
+    typedef std::function<void(std::function<void()>)> Executor;
+
+    /// \brief Create a default DirectStreamingClient.
+    /// \param sink The sink to deliver events to, or nullptr.
+    /// \param executor The executor to deliver events on, or nullptr.
+    DirectStreamingClient(StreamingSink* sink = nullptr,
+                          Executor executor = nullptr);
+
+    /// \brief Create a DirectStreamingClient with the given credentials.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param sink The sink to deliver events to, or nullptr.
+    /// \param executor The executor to deliver events on, or nullptr.
+    DirectStreamingClient(const HTTP::OAuth10Credentials& credentials,
+                          StreamingSink* sink = nullptr,
+                          Executor executor = nullptr);
+
+    /// \brief Destroy the DirectStreamingClient.
+    ///
+    /// The streaming thread is stopped before the client is destroyed.
+    virtual ~DirectStreamingClient();
+
+    /// \brief Set the sink that receives events.
+    ///
+    /// The sink may be changed while the client is running. The sink must
+    /// remain valid until it has been replaced or the client is stopped.
+    ///
+    /// \param sink The sink to deliver events to, or nullptr to drop events.
+    void setSink(StreamingSink* sink);
+
+    /// \returns the current sink, or nullptr if none is set.
+    StreamingSink* sink() const;
+
+    /// \brief Set the executor used to deliver events.
+    ///
+    /// The executor may only be changed while the client is stopped. Tasks
+    /// refer to the client, so the executor must run or discard all of its
+    /// pending tasks before the client is destroyed.
+    ///
+    /// \param executor The executor, or nullptr to deliver on the streaming
+    /// thread.
+    void setExecutor(Executor executor);
+
+private:
+    /// \brief Deliver an event without a value to the sink.
+    /// \param callback The sink callback to invoke.
+    void _deliver(void (StreamingSink::*callback)());
+
+    /// \brief Deliver an event to the sink.
+    ///
+    /// The value is passed by reference when delivering directly and is only
+    /// copied when it must outlive the call, i.e. when an executor is set.
+    ///
+    /// \param callback The sink callback to invoke.
+    /// \param value The event value.
+    template <typename T>
+    void _deliver(void (StreamingSink::*callback)(const T&), const T& value);
+
+    virtual void _onConnect() override;
+    virtual void _onDisconnect() override;
+    virtual void _onStatus(const Status& status) override;
+    virtual void _onStatusDeletedNotice(const StatusDeletedNotice& notice) override;
+    virtual void _onLocationDeletedNotice(const LocationDeletedNotice& notice) override;
+    virtual void _onLimitNotice(const LimitNotice& notice) override;
+    virtual void _onStatusWithheldNotice(const StatusWithheldNotice& notice) override;
+    virtual void _onUserWitheldNotice(const UserWithheldNotice& notice) override;
+    virtual void _onDisconnectNotice(const DisconnectNotice& notice) override;
+    virtual void _onStallWarning(const StallWarning& notice) override;
+    virtual void _onException(const std::exception& exc) override;
+    virtual void _onMessage(const ofJson& message) override;
+    virtual bool _wantsMessages() const override;
+
+    /// \brief The current sink.
+    std::atomic<StreamingSink*> _sink;
+
+    /// \brief The optional executor.
+    Executor _executor;
+
+};
+
+
+template <typename T>
+void DirectStreamingClient::_deliver(void (StreamingSink::*callback)(const T&),
+                                     const T& value)
+{
+    if (_executor)
+    {
+        // The sink is resolved when the task runs so that tasks queued before
+        // a call to setSink() are not delivered to the old sink.
+        _executor([this, callback, value]()
+        {
+            StreamingSink* sink = _sink.load(std::memory_order_acquire);
+            if (sink) (sink->*callback)(value);
+        });
+    }
+    else
+    {
+        StreamingSink* sink = _sink.load(std::memory_order_acquire);
+        if (sink) (sink->*callback)(value);
+    }
+}
+
+
+} } // namespace ofx::Twitter
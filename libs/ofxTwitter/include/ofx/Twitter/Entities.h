@@ -76,7 +76,7 @@ public:
     virtual ~SymbolEntity();
 
     /// \returns the symbol text.
-    std::string symbol() const;
+    const std::string& symbol() const;
 
     std::string indexedText() const override;
 
@@ -109,7 +109,7 @@ public:
     virtual ~HashTagEntity();
 
     /// \returns the hashtag text.
-    std::string hashTag() const;
+    const std::string& hashTag() const;
 
     std::string indexedText() const override;
 
@@ -149,13 +149,13 @@ public:
     virtual ~URLEntity();
 
     /// \returns the URL that was extracted.
-    std::string url() const;
+    const std::string& url() const;
 
     /// \returns the displayable URL.
-    std::string displayURL() const;
+    const std::string& displayURL() const;
 
     /// \returns The fully resolved URL.
-    std::string expandedURL() const;
+    const std::string& expandedURL() const;
 
     std::string indexedText() const override;
 
@@ -201,13 +201,13 @@ public:
     virtual ~QuotedStatusPermalink();
     
     /// \returns the URL that was extracted.
-    std::string url() const;
+    const std::string& url() const;
     
     /// \returns the displayable URL.
-    std::string displayURL() const;
+    const std::string& displayURL() const;
     
     /// \returns The fully resolved URL.
-    std::string expandedURL() const;
+    const std::string& expandedURL() const;
     
     /// \brief Extract the QuotedStatusPermalink from JSON.
     /// \param json The source JSON.
@@ -349,7 +349,7 @@ public:
     uint64_t duration() const;
 
     /// \returns the variants of the video.
-    std::vector<Variant> variants() const;
+    const std::vector<Variant>& variants() const;
 
     /// \brief Extract the VideoInfo from JSON.
     /// \param json The source JSON.
@@ -376,13 +376,13 @@ public:
     bool monetizable() const;
 
     /// \returns the description.
-    std::string description() const;
+    const std::string& description() const;
 
     /// \returns true if the media is embeddable.
     bool embeddable() const;
 
     /// \returns the title.
-    std::string title() const;
+    const std::string& title() const;
 
     /// \returns a shared pointer to a source user if available.
     std::shared_ptr<User> sourceUser() const;
@@ -395,10 +395,12 @@ public:
 private:
     bool _montetizable = false;
     std::string _description;
-    bool _embeddable;
+    bool _embeddable = false;
     std::string _title;
     std::shared_ptr<User> _sourceUser;
 
+    friend class BinaryCodec;
+
 };
 
 
@@ -474,10 +476,10 @@ public:
     virtual ~MediaEntity();
 
     /// \returns the URL of the media file.
-    std::string mediaURL() const;
+    const std::string& mediaURL() const;
 
     /// \returns the SSL URL of the media file.
-    std::string secureMediaURL() const;
+    const std::string& secureMediaURL() const;
 
     /// \returns the media ID.
     int64_t mediaID() const;
@@ -489,7 +491,7 @@ public:
     std::string mediaFileExtension() const;
 
     /// \returns the available sizes.
-    Sizes sizes() const;
+    const Sizes& sizes() const;
 
     /// \returns the media type.
     Type type() const;
@@ -501,10 +503,10 @@ public:
     int64_t sourceUserID() const;
 
     /// \returns the video info if the media type is a video.
-    VideoInfo videoInfo() const;
+    const VideoInfo& videoInfo() const;
 
     /// \returns the AdditionalMediaInfo if available.
-    AdditionalMediaInfo additionalMediaEntity() const;
+    const AdditionalMediaInfo& additionalMediaEntity() const;
 
     /// \brief Extract the MediaEntity from JSON.
     /// \param json The source JSON.
@@ -541,6 +543,8 @@ private:
     /// \brief Additional media info, if available.
     AdditionalMediaInfo _additionalMediaInfo;
 
+    friend class BinaryCodec;
+
 };
 
 
@@ -592,11 +596,11 @@ public:
 
     virtual ~Entities();
 
-    HashTagEntities hashTagEntities() const;
-    SymbolEntities symbolEntities() const;
-    MediaEntities mediaEntities() const;
-    URLEntities urlEntities() const;
-    UserMentionEntities userMentionEntities() const;
+    const HashTagEntities& hashTagEntities() const;
+    const SymbolEntities& symbolEntities() const;
+    const MediaEntities& mediaEntities() const;
+    const URLEntities& urlEntities() const;
+    const UserMentionEntities& userMentionEntities() const;
 
     /// \brief Extract the Entities from JSON.
     /// \param json The source JSON.
@@ -610,6 +614,8 @@ private:
     URLEntities _URLEntities;
     UserMentionEntities _userMentionEntities;
 
+    friend class BinaryCodec;
+
 };
 
 
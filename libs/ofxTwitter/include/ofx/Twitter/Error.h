@@ -36,7 +36,7 @@ public:
     int64_t code() const;
 
     /// \returns the error message.
-    std::string message() const;
+    const std::string& message() const;
 
     /// \returns the Error as JSON.
     ofJson toJSON() const;
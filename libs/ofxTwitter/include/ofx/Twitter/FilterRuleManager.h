@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "ofx/Twitter/DirectStreamingClient.h"
+#include "ofx/Twitter/FilterQuery.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Maintains a filter stream whose rules can be edited while it runs.
+///
+/// Changing the rules of a BaseStreamingClient closes its connection before
+/// the new one is opened, and statuses are lost in between. The rule manager
+/// instead collects rule edits for a short debounce period, then opens a
+/// second connection with the new rules next to the running one. When the new
+/// stream is connected it becomes the active stream and the old one is
+/// closed. Statuses delivered by both streams during the overlap are passed
+/// to the sink only once.
+///
+/// A stream is connected once Twitter accepts the request, before any
+/// message or keep-alive arrives, so quiet rules switch as quickly as busy
+/// ones. If the new stream does not connect within SWITCH_TIMEOUT it is
+/// closed, the old stream is kept, and the switch is tried again.
+///
+/// Events other than statuses are only delivered from the active stream, so
+/// the sink does not see connects and disconnects caused by a switch. As
+/// with DirectStreamingClient, callbacks are invoked on the streaming
+/// threads.
+///
+/// \note Each account may only hold one standing connection, and opening a
+/// second one closes the first. The overlap therefore needs a second set of
+/// credentials, and the streams alternate between the two sets. With a
+/// single set the old stream is closed before the new one is opened, and
+/// statuses may be lost in between.
+class FilterRuleManager
+{
+public:
+    /// \brief Create a FilterRuleManager that switches without an overlap.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param sink The sink to deliver events to.
+    /// \param debounce The time to collect rule edits, in milliseconds.
+    FilterRuleManager(const HTTP::OAuth10Credentials& credentials,
+                      StreamingSink* sink,
+                      uint64_t debounce = DEFAULT_DEBOUNCE);
+
+    /// \brief Create a FilterRuleManager that overlaps streams.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param standbyCredentials The credentials of a second account, used
+    /// by every other stream.
+    /// \param sink The sink to deliver events to.
+    /// \param debounce The time to collect rule edits, in milliseconds.
+    FilterRuleManager(const HTTP::OAuth10Credentials& credentials,
+                      const HTTP::OAuth10Credentials& standbyCredentials,
+                      StreamingSink* sink,
+                      uint64_t debounce = DEFAULT_DEBOUNCE);
+
+    /// \brief Destroy the FilterRuleManager.
+    ///
+    /// All streams are stopped.
+    ~FilterRuleManager();
+
+    /// \brief Add a track phrase.
+    /// \param track The phrase to track.
+    void addTrack(const std::string& track);
+
+    /// \brief Remove a track phrase.
+    /// \param track The phrase to remove.
+    void removeTrack(const std::string& track);
+
+    /// \brief Add a user to follow.
+    /// \param userId The user id to follow.
+    void addFollow(const std::string& userId);
+
+    /// \brief Remove a followed user.
+    /// \param userId The user id to remove.
+    void removeFollow(const std::string& userId);
+
+    /// \brief Add a location to filter.
+    /// \param location The bounding box to add.
+    void addLocation(const Geo::CoordinateBounds& location);
+
+    /// \brief Remove a location.
+    /// \param location The bounding box to remove.
+    void removeLocation(const Geo::CoordinateBounds& location);
+
+    /// \brief Replace all rules.
+    ///
+    /// Nothing changes if the rules are the same as the current rules.
+    ///
+    /// \param tracks The phrases to track.
+    /// \param follows The user ids to follow.
+    /// \param locations The bounding boxes to filter.
+    void setRules(const std::vector<std::string>& tracks,
+                  const std::vector<std::string>& follows,
+                  const std::vector<Geo::CoordinateBounds>& locations);
+
+    /// \brief Remove all rules.
+    ///
+    /// The stream is closed once the change is applied.
+    void clear();
+
+    /// \returns the current rules as a query.
+    FilterQuery query() const;
+
+    /// \returns the rules of the active stream as a query.
+    FilterQuery activeQuery() const;
+
+    /// \returns true if a stream with new rules is waiting to take over.
+    bool isSwitching() const;
+
+    /// \returns the number of completed switches.
+    uint64_t switchCount() const;
+
+    /// \brief Open streams with a transport instead of the HTTP client.
+    ///
+    /// The transport applies to streams opened after the call.
+    ///
+    /// \param transport The transport, or nullptr to use the HTTP client.
+    void setTransport(BaseStreamingClient::Transport transport);
+
+    /// \brief The default debounce period in milliseconds.
+    static const uint64_t DEFAULT_DEBOUNCE;
+
+    /// \brief The time a new stream has to connect.
+    static const uint64_t SWITCH_TIMEOUT;
+
+    /// \brief The number of recent status ids kept to remove duplicates.
+    static const std::size_t DEDUPLICATION_WINDOW;
+
+private:
+    /// \brief A stream and the sink that routes its events to the manager.
+    class Connection: public StreamingSink
+    {
+    public:
+        Connection(FilterRuleManager& manager,
+                   std::size_t credentialIndex,
+                   const FilterQuery& query);
+
+        virtual ~Connection();
+
+        virtual void onConnect() override;
+        virtual void onDisconnect() override;
+        virtual void onStatus(const Status& status) override;
+        virtual void onStatusDeletedNotice(const StatusDeletedNotice& notice) override;
+        virtual void onLocationDeletedNotice(const LocationDeletedNotice& notice) override;
+        virtual void onLimitNotice(const LimitNotice& notice) override;
+        virtual void onStatusWithheldNotice(const StatusWithheldNotice& notice) override;
+        virtual void onUserWitheldNotice(const UserWithheldNotice& notice) override;
+        virtual void onDisconnectNotice(const DisconnectNotice& notice) override;
+        virtual void onStallWarning(const StallWarning& notice) override;
+        virtual void onException(const std::exception& exc) override;
+        virtual void onMessage(const ofJson& message) override;
+        virtual bool wantsMessages() const override;
+
+        /// \brief The index of the stream's credentials.
+        const std::size_t credentialIndex;
+
+        /// \brief The rules of the stream.
+        const FilterQuery query;
+
+    private:
+        /// \brief Forward an event if this is the active stream.
+        template <typename T>
+        void _forward(void (StreamingSink::*callback)(const T&), const T& value);
+
+        FilterRuleManager& _manager;
+
+        /// \brief The stream, declared last so it stops first.
+        DirectStreamingClient _client;
+
+    };
+
+    /// \brief Record a rule edit. Requires _mutex.
+    void _changed();
+
+    /// \brief Build a query from the current rules. Requires _mutex.
+    FilterQuery _query() const;
+
+    /// \brief Promote a connection that is waiting to take over.
+    /// \param connection The connection that connected.
+    /// \returns true if the connection was promoted.
+    bool _promote(Connection* connection);
+
+    /// \brief Deliver a status unless it was already delivered.
+    /// \param status The status.
+    void _onStatus(const Status& status);
+
+    /// \returns true if the connection is the active stream.
+    bool _isActive(const Connection* connection) const;
+
+    /// \brief Apply rule edits and time out switches until stopped.
+    void _run();
+
+    /// \returns the current steady time in milliseconds.
+    static uint64_t _now();
+
+    /// \brief The credentials, one set per concurrent stream.
+    std::vector<HTTP::OAuth10Credentials> _credentials;
+
+    /// \brief The transport for new streams, or nullptr.
+    BaseStreamingClient::Transport _transport;
+
+    /// \brief The sink to deliver events to.
+    StreamingSink* _sink = nullptr;
+
+    /// \brief The debounce period in milliseconds.
+    uint64_t _debounce = DEFAULT_DEBOUNCE;
+
+    std::set<std::string> _tracks;
+    std::set<std::string> _follows;
+    std::vector<Geo::CoordinateBounds> _locations;
+
+    /// \brief The rule version, incremented by each edit.
+    uint64_t _version = 0;
+
+    /// \brief The time of the last edit.
+    uint64_t _changedAt = 0;
+
+    /// \brief The stream delivering events.
+    std::unique_ptr<Connection> _active;
+    uint64_t _activeVersion = 0;
+
+    /// \brief The stream waiting to take over.
+    std::unique_ptr<Connection> _standby;
+    uint64_t _standbyVersion = 0;
+    uint64_t _standbyStartedAt = 0;
+
+    /// \brief Streams that are no longer used and must be stopped.
+    std::vector<std::unique_ptr<Connection>> _retired;
+
+    uint64_t _switchCount = 0;
+
+    bool _stopping = false;
+
+    /// \brief Guards the rules and connections.
+    mutable std::mutex _mutex;
+
+    /// \brief Signalled when the rules or connections change.
+    std::condition_variable _condition;
+
+    /// \brief The recently delivered status ids.
+    std::unordered_set<int64_t> _seen;
+
+    /// \brief The recently delivered status ids in order.
+    std::deque<int64_t> _seenOrder;
+
+    /// \brief Guards the delivered status ids.
+    std::mutex _seenMutex;
+
+    /// \brief The thread applying edits.
+    std::thread _thread;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ofx/Geo/CoordinateBounds.h"
+#include "ofx/Twitter/Status.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief An incremental spatial index of recent Status locations.
+///
+/// Locations are bucketed into a uniform latitude / longitude grid. Each
+/// grid cell keeps its entries in insertion order, so expired entries can be
+/// evicted from the front of the cells without scanning. Bounding box and
+/// radius queries only visit the cells that overlap the query region.
+///
+/// Entries store the Status id, location and time rather than the Status
+/// itself, keeping the memory cost of each entry small. Applications that
+/// need the full Status can keep their own map from id to Status.
+///
+/// All methods are thread-safe, so the index can be fed from a streaming
+/// thread while it is queried from the main thread.
+class GeoIndex
+{
+public:
+    /// \brief A single indexed location.
+    struct Entry
+    {
+        /// \brief The Status id.
+        int64_t id = -1;
+
+        /// \brief The location.
+        Geo::Coordinate coordinate;
+
+        /// \brief The time in milliseconds since the Unix epoch.
+        uint64_t timestamp = 0;
+    };
+
+    /// \brief Create a GeoIndex.
+    /// \param cellSize The grid cell size in degrees.
+    /// \param maxAge The age in milliseconds after which entries are evicted,
+    /// or 0 to keep entries until evict() is called.
+    GeoIndex(double cellSize = DEFAULT_CELL_SIZE, uint64_t maxAge = 0);
+
+    /// \brief Index a Status.
+    ///
+    /// The location is taken from Utils::location() and the time from
+    /// Utils::timestamp().
+    ///
+    /// \param status The status to index.
+    /// \returns true if the status had a location and was indexed.
+    bool insert(const Status& status);
+
+    /// \brief Index a location.
+    ///
+    /// Entries are expected to be inserted in roughly increasing time order.
+    /// Out of order entries are still returned correctly by queries, but may
+    /// be evicted later than their age requires.
+    ///
+    /// \param id The Status id.
+    /// \param coordinate The location.
+    /// \param timestamp The time in milliseconds since the Unix epoch.
+    void insert(int64_t id, const Geo::Coordinate& coordinate, uint64_t timestamp);
+
+    /// \brief Remove all entries older than the given time.
+    /// \param olderThan The time in milliseconds since the Unix epoch.
+    void evict(uint64_t olderThan);
+
+    /// \brief Find the entries inside a bounding box.
+    ///
+    /// Bounding boxes that cross the antimeridian (i.e. the western
+    /// longitude is greater than the eastern longitude) are supported.
+    ///
+    /// \param bounds The bounding box.
+    /// \param since Only return entries at or after this time.
+    /// \returns the matching entries.
+    std::vector<Entry> query(const Geo::CoordinateBounds& bounds,
+                             uint64_t since = 0) const;
+
+    /// \brief Find the entries within a distance of a point.
+    /// \param center The center of the search.
+    /// \param radius The search radius in meters.
+    /// \param since Only return entries at or after this time.
+    /// \returns the matching entries.
+    std::vector<Entry> query(const Geo::Coordinate& center,
+                             double radius,
+                             uint64_t since = 0) const;
+
+    /// \brief Set the maximum entry age.
+    /// \param maxAge The age in milliseconds after which entries are evicted,
+    /// or 0 to keep entries until evict() is called.
+    void setMaxAge(uint64_t maxAge);
+
+    /// \returns the maximum entry age in milliseconds, or 0 if unlimited.
+    uint64_t maxAge() const;
+
+    /// \returns the number of indexed entries.
+    std::size_t size() const;
+
+    /// \brief Remove all entries.
+    void clear();
+
+    /// \brief The default grid cell size in degrees.
+    static const double DEFAULT_CELL_SIZE;
+
+    /// \brief The mean radius of the Earth in meters.
+    static const double EARTH_RADIUS;
+
+private:
+    /// \returns the grid row for the given latitude.
+    int64_t _row(double latitude) const;
+
+    /// \returns the grid column for the given longitude.
+    int64_t _column(double longitude) const;
+
+    /// \returns the cell key for the given row and column.
+    uint64_t _key(int64_t row, int64_t column) const;
+
+    /// \brief Append the entries in a box that does not cross the antimeridian.
+    void _query(double south,
+                double west,
+                double north,
+                double east,
+                uint64_t since,
+                std::vector<Entry>& results) const;
+
+    /// \brief Evict entries without locking.
+    void _evict(uint64_t olderThan);
+
+    /// \brief The grid cell size in degrees.
+    double _cellSize = DEFAULT_CELL_SIZE;
+
+    /// \brief The number of grid rows.
+    int64_t _rows = 0;
+
+    /// \brief The number of grid columns.
+    int64_t _columns = 0;
+
+    /// \brief The maximum entry age in milliseconds.
+    uint64_t _maxAge = 0;
+
+    /// \brief The newest timestamp seen.
+    uint64_t _newest = 0;
+
+    /// \brief The non-empty grid cells.
+    std::unordered_map<uint64_t, std::deque<Entry>> _cells;
+
+    /// \brief The cell key of every entry in insertion order.
+    std::deque<uint64_t> _order;
+
+    /// \brief Guards all members.
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ofFileUtils.h"
+#include "ofImage.h"
+#include "ofx/Twitter/ThreadPool.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Encodes images into pooled buffers.
+///
+/// Encoded buffers are handed out as shared pointers and return to the pool
+/// when the last reference is released. A reused buffer keeps its capacity,
+/// so once the pool is warm, encoding a stream of similar images does not
+/// allocate.
+///
+/// Encoding can run on the calling thread or on the encoder's own threads.
+/// The buffers can be sent without further copies with
+/// MediaUploadRequest::setMedia() or ChunkedMediaUpload::upload().
+///
+/// Usage:
+///
+///     ofxTwitter::ImageEncoder encoder;
+///     auto encoded = encoder.encodeAsync(pixels);
+///     ...
+///     request.setMedia(encoded.get());
+class ImageEncoder
+{
+public:
+    /// \brief Create an ImageEncoder.
+    /// \param threadCount The number of asynchronous encoding threads, or 0
+    /// to use the hardware concurrency.
+    /// \param maxPooledBuffers The maximum number of idle buffers to keep.
+    ImageEncoder(std::size_t threadCount = 1,
+                 std::size_t maxPooledBuffers = DEFAULT_MAX_POOLED_BUFFERS);
+
+    /// \brief Destroy the ImageEncoder.
+    ///
+    /// Pending asynchronous encodes finish before the encoder is destroyed.
+    /// Buffers may outlive the encoder.
+    ~ImageEncoder();
+
+    /// \brief Encode an image on the calling thread.
+    /// \param pixels The image to encode.
+    /// \param format The image format.
+    /// \param quality The compression quality.
+    /// \returns the encoded image.
+    /// \throws Poco::IOException if the image cannot be encoded.
+    std::shared_ptr<const ofBuffer> encode(const ofPixels& pixels,
+                                           ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
+                                           ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
+
+    /// \brief Encode an image on the encoding threads.
+    ///
+    /// The pixels are taken by value, so callers that no longer need them
+    /// can move them in to avoid a copy.
+    ///
+    /// \param pixels The image to encode.
+    /// \param format The image format.
+    /// \param quality The compression quality.
+    /// \returns a future for the encoded image.
+    std::future<std::shared_ptr<const ofBuffer>> encodeAsync(ofPixels pixels,
+                                                             ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
+                                                             ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
+
+    /// \returns the number of idle buffers in the pool.
+    std::size_t pooled() const;
+
+    /// \brief Get the MIME type of an image format.
+    /// \param format The image format.
+    /// \returns the MIME type.
+    static std::string mediaType(ofImageFormat format);
+
+    /// \brief The default maximum number of idle buffers.
+    static const std::size_t DEFAULT_MAX_POOLED_BUFFERS;
+
+private:
+    /// \brief The buffer pool, shared with outstanding buffers.
+    struct State
+    {
+        /// \brief The idle buffers.
+        std::vector<std::unique_ptr<ofBuffer>> buffers;
+
+        /// \brief The maximum number of idle buffers.
+        std::size_t maxBuffers = 0;
+
+        /// \brief Guards the buffers.
+        mutable std::mutex mutex;
+    };
+
+    /// \brief Return a buffer to the pool or free it.
+    /// \param state The pool state, if the encoder still exists.
+    /// \param buffer The buffer to return.
+    static void _release(std::weak_ptr<State> state, ofBuffer* buffer);
+
+    /// \brief The buffer pool.
+    std::shared_ptr<State> _state;
+
+    /// \brief The asynchronous encoding threads.
+    ///
+    /// Declared last so its threads are joined before the state they use is
+    /// destroyed.
+    ThreadPool _pool;
+
+};
+
+
+} } // namespace ofx::Twitter
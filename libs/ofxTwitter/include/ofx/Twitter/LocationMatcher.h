@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <vector>
+#include "ofx/Geo/CoordinateBounds.h"
+#include "ofx/Twitter/FilterQuery.h"
+#include "ofx/Twitter/Status.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Determines which `locations` bounding boxes contain a Status.
+///
+/// The Streaming API ORs the `locations` parameter with the `track` and
+/// `follow` parameters, so a filter stream may deliver statuses outside of
+/// every requested box. A LocationMatcher tests a Status against all boxes
+/// at once so that applications can apply AND semantics cheaply.
+///
+/// Boxes are stored as separate arrays of edges and tested several at a time
+/// with SSE2 where available. Boxes that cross the antimeridian are split in
+/// two. Statuses without exact coordinates are located at the center of
+/// their Place bounding box.
+///
+/// \sa https://dev.twitter.com/streaming/overview/request-parameters#locations
+class LocationMatcher
+{
+public:
+    /// \brief Create an empty LocationMatcher.
+    LocationMatcher();
+
+    /// \brief Create a LocationMatcher from a list of bounding boxes.
+    /// \param locations The bounding boxes. The index of each box is its id.
+    LocationMatcher(const std::vector<Geo::CoordinateBounds>& locations);
+
+    /// \brief Create a LocationMatcher from the `locations` parameter of a query.
+    /// \param query The filter query.
+    LocationMatcher(const BaseFilterQuery& query);
+
+    /// \brief Set the bounding boxes, replacing any existing boxes.
+    /// \param locations The bounding boxes. The index of each box is its id.
+    void setLocations(const std::vector<Geo::CoordinateBounds>& locations);
+
+    /// \returns the bounding boxes, indexed by id.
+    const std::vector<Geo::CoordinateBounds>& locations() const;
+
+    /// \returns true if there are no bounding boxes.
+    bool empty() const;
+
+    /// \brief Find the boxes containing a coordinate.
+    /// \param coordinate The coordinate to test.
+    /// \returns the ids of the containing boxes in ascending order.
+    std::vector<std::size_t> match(const Geo::Coordinate& coordinate) const;
+
+    /// \brief Find the boxes containing a Status.
+    /// \param status The status to test.
+    /// \returns the ids of the containing boxes in ascending order.
+    std::vector<std::size_t> match(const Status& status) const;
+
+    /// \brief Match a Status and store the results in the Status.
+    ///
+    /// The results are available from Status::matchedLocations().
+    ///
+    /// \param status The status to annotate.
+    void annotate(Status& status) const;
+
+private:
+    /// \brief Add a box that does not cross the antimeridian.
+    void _add(double south, double west, double north, double east, uint32_t id);
+
+    /// \brief The original bounding boxes.
+    std::vector<Geo::CoordinateBounds> _locations;
+
+    /// \brief The southern edge of each box.
+    std::vector<double> _south;
+
+    /// \brief The western edge of each box.
+    std::vector<double> _west;
+
+    /// \brief The northern edge of each box.
+    std::vector<double> _north;
+
+    /// \brief The eastern edge of each box.
+    std::vector<double> _east;
+
+    /// \brief The original box id of each box.
+    std::vector<uint32_t> _ids;
+
+};
+
+
+} } // namespace ofx::Twitter
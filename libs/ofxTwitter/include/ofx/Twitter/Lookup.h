@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <vector>
+#include "ofx/HTTP/PostRequest.h"
+#include "ofx/Twitter/BaseResponse.h"
+#include "ofx/Twitter/Error.h"
+#include "ofx/Twitter/OAuth10Signer.h"
+#include "ofx/Twitter/Status.h"
+#include "ofx/Twitter/User.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A Twitter users/lookup request.
+///
+/// The request is sent as a POST so that long id lists fit.
+///
+/// \sa https://developer.twitter.com/en/docs/accounts-and-users/follow-search-get-users/api-reference/get-users-lookup
+class UserLookupRequest: public HTTP::PostRequest
+{
+public:
+    /// \brief Create a UserLookupRequest.
+    /// \param userIds The ids of the users, up to MAX_IDS.
+    UserLookupRequest(const std::vector<int64_t>& userIds);
+
+    /// \brief Destroy the UserLookupRequest.
+    virtual ~UserLookupRequest();
+
+    /// \param includeEntities True to include entities.
+    void setIncludeEntities(bool includeEntities);
+
+    /// \returns the form fields, encoded to sign the request with.
+    OAuth10Signer::EncodedParameters formParameters() const;
+
+    /// \brief The resource URL.
+    static const std::string RESOURCE_URL;
+
+    /// \brief The maximum number of ids per request.
+    static const std::size_t MAX_IDS;
+
+};
+
+
+/// \brief A Twitter statuses/lookup request.
+///
+/// The request is sent as a POST so that long id lists fit.
+///
+/// \sa https://developer.twitter.com/en/docs/tweets/post-and-engage/api-reference/get-statuses-lookup
+class StatusLookupRequest: public HTTP::PostRequest
+{
+public:
+    /// \brief Create a StatusLookupRequest.
+    /// \param statusIds The ids of the statuses, up to MAX_IDS.
+    StatusLookupRequest(const std::vector<int64_t>& statusIds);
+
+    /// \brief Destroy the StatusLookupRequest.
+    virtual ~StatusLookupRequest();
+
+    /// \param includeEntities True to include entities.
+    void setIncludeEntities(bool includeEntities);
+
+    /// \param trimUser True to return only the user id with each status.
+    void setTrimUser(bool trimUser);
+
+    /// \returns the form fields, encoded to sign the request with.
+    OAuth10Signer::EncodedParameters formParameters() const;
+
+    /// \brief The resource URL.
+    static const std::string RESOURCE_URL;
+
+    /// \brief The maximum number of ids per request.
+    static const std::size_t MAX_IDS;
+
+};
+
+
+/// \brief A Twitter users/lookup response.
+///
+/// Users that are suspended, deleted or unknown are omitted.
+class UserLookupResponse: public BaseResponse
+{
+public:
+    /// \brief Destroy the UserLookupResponse.
+    virtual ~UserLookupResponse();
+
+    /// \returns the users found.
+    const std::vector<User>& users() const;
+
+    /// \brief Deserialize a UserLookupResponse from JSON.
+    /// \param json A JSON array of users or a JSON error object.
+    /// \returns a deserialized UserLookupResponse.
+    static UserLookupResponse fromJSON(const ofJson& json);
+
+private:
+    std::vector<User> _users;
+
+};
+
+
+/// \brief A Twitter statuses/lookup response.
+///
+/// Statuses that are deleted, protected or unknown are omitted.
+class StatusLookupResponse: public BaseResponse
+{
+public:
+    /// \brief Destroy the StatusLookupResponse.
+    virtual ~StatusLookupResponse();
+
+    /// \returns the statuses found.
+    const std::vector<Status>& statuses() const;
+
+    /// \brief Deserialize a StatusLookupResponse from JSON.
+    /// \param json A JSON array of statuses or a JSON error object.
+    /// \returns a deserialized StatusLookupResponse.
+    static StatusLookupResponse fromJSON(const ofJson& json);
+
+private:
+    std::vector<Status> _statuses;
+
+};
+
+
+} } // namespace ofx::Twitter
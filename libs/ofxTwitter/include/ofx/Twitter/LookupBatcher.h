@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ofx/Twitter/Lookup.h"
+#include "ofx/Twitter/RESTClient.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Coalesces individual user and status lookups into batches.
+///
+/// Ids requested within a short window are collected and sent as a single
+/// users/lookup or statuses/lookup request of up to 100 ids. Batches run
+/// concurrently on the RESTClient and each result is passed back to the
+/// futures waiting for it. Ids that are requested again while pending share
+/// the same future.
+///
+/// When an endpoint's rate limit is exhausted, its ids are held until the
+/// limit resets and are then sent in full batches.
+///
+///     ofxTwitter::RESTClient client(credentials);
+///     ofxTwitter::LookupBatcher batcher(client);
+///
+///     auto author = batcher.user(notice.userId());
+///
+///     ...
+///
+///     std::cout << author.get().screenName() << std::endl;
+///
+/// A future throws Poco::NotFoundException if the user or status does not
+/// exist or is not visible, and Poco::IOException if the request failed.
+class LookupBatcher
+{
+public:
+    /// \brief Create a LookupBatcher.
+    /// \param client The client used to send batches.
+    /// \param window The time to collect ids before sending, in milliseconds.
+    LookupBatcher(RESTClient& client, uint64_t window = DEFAULT_WINDOW);
+
+    /// \brief Destroy the LookupBatcher.
+    ///
+    /// Batches in flight are completed. Ids that have not been sent fail
+    /// with a Poco::IOException.
+    ~LookupBatcher();
+
+    /// \brief Look up a user.
+    /// \param userId The user id.
+    /// \returns a future user.
+    std::shared_future<User> user(int64_t userId);
+
+    /// \brief Look up several users.
+    /// \param userIds The user ids.
+    /// \returns a future user for each id, in the same order.
+    std::vector<std::shared_future<User>> users(const std::vector<int64_t>& userIds);
+
+    /// \brief Look up a status.
+    /// \param statusId The status id.
+    /// \returns a future status.
+    std::shared_future<Status> status(int64_t statusId);
+
+    /// \brief Look up several statuses.
+    /// \param statusIds The status ids.
+    /// \returns a future status for each id, in the same order.
+    std::vector<std::shared_future<Status>> statuses(const std::vector<int64_t>& statusIds);
+
+    /// \brief Send all collected ids without waiting for the window to end.
+    ///
+    /// Ids held by a rate limit are not sent until the limit resets.
+    void flush();
+
+    /// \returns the number of ids that are collected or in flight.
+    std::size_t pending() const;
+
+    /// \brief The default collection window in milliseconds.
+    static const uint64_t DEFAULT_WINDOW;
+
+private:
+    /// \brief A pending lookup.
+    template <typename T>
+    struct Waiter
+    {
+        std::shared_ptr<std::promise<T>> promise;
+        std::shared_future<T> future;
+    };
+
+    /// \brief The lookups for one endpoint.
+    template <typename T>
+    struct Queue
+    {
+        /// \brief The pending lookups by id, collected or in flight.
+        std::map<int64_t, Waiter<T>> waiters;
+
+        /// \brief The collected ids that have not been sent.
+        std::vector<int64_t> queued;
+
+        /// \brief The time the collected ids are sent, in milliseconds.
+        uint64_t deadline = 0;
+
+        /// \brief No batches are sent before this time, in milliseconds.
+        uint64_t holdUntil = 0;
+    };
+
+    /// \brief Add a lookup to a queue.
+    /// \param queue The queue.
+    /// \param id The id to look up.
+    /// \returns the future result.
+    template <typename T>
+    std::shared_future<T> _lookup(Queue<T>& queue, int64_t id);
+
+    /// \brief Send the batches of a queue that are ready. Requires _mutex.
+    /// \param queue The queue.
+    /// \param now The current time in milliseconds.
+    /// \returns the time the next batch is ready, or 0 if none is collected.
+    template <typename RequestType, typename ResponseType, typename T>
+    uint64_t _dispatch(Queue<T>& queue, uint64_t now);
+
+    /// \brief Send batches until stopped.
+    void _run();
+
+    /// \returns the current steady time in milliseconds.
+    static uint64_t _now();
+
+    /// \brief The client used to send batches.
+    RESTClient& _client;
+
+    /// \brief The collection window in milliseconds.
+    uint64_t _window = DEFAULT_WINDOW;
+
+    Queue<User> _users;
+    Queue<Status> _statuses;
+
+    /// \brief The number of batches in flight.
+    std::size_t _inFlight = 0;
+
+    /// \brief True if collected ids should be sent immediately.
+    bool _flushRequested = false;
+
+    /// \brief True once the batcher is being destroyed.
+    bool _stopping = false;
+
+    /// \brief Guards the queues.
+    mutable std::mutex _mutex;
+
+    /// \brief Signalled when the queues change.
+    std::condition_variable _condition;
+
+    /// \brief The dispatch thread.
+    std::thread _thread;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,154 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "ofFileUtils.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A content-addressed disk cache with a total size limit.
+///
+/// Files are stored under the SHA-1 digest of their contents, so identical
+/// media referenced by different keys (e.g. a retweeted photo) is stored
+/// once. Keys, typically URLs, map to a digest.
+///
+/// When the total size exceeds the limit, the least recently used files are
+/// removed. Files larger than the limit are not cached. The index is kept in
+/// `index.json` in the cache directory and is saved when the cache is
+/// destroyed, so the cache persists across runs. On load the directory is
+/// scanned, so files that are missing from the index, e.g. after a crash,
+/// still count towards the limit and are evicted first.
+///
+/// All methods are thread-safe.
+class MediaCache
+{
+public:
+    /// \brief Create a MediaCache.
+    /// \param directory The cache directory. It is created if needed.
+    /// \param maxSize The maximum total size of cached files in bytes.
+    MediaCache(const std::filesystem::path& directory,
+               uint64_t maxSize = DEFAULT_MAX_SIZE);
+
+    /// \brief Destroy the MediaCache, saving its index.
+    ~MediaCache();
+
+    /// \brief Look up a cached file.
+    ///
+    /// A successful lookup marks the file as recently used.
+    ///
+    /// \param key The key to look up.
+    /// \param path The path of the cached file.
+    /// \returns true if the key is cached.
+    bool get(const std::string& key, std::filesystem::path& path);
+
+    /// \brief Add a file to the cache.
+    /// \param key The key to store the file under.
+    /// \param buffer The file contents.
+    /// \param extension The file extension including the dot, e.g. ".jpg".
+    /// \returns the path of the cached file, or an empty path if the file
+    /// could not be written or is larger than the maximum size.
+    std::filesystem::path put(const std::string& key,
+                              const ofBuffer& buffer,
+                              const std::string& extension = "");
+
+    /// \brief Remove all cached files.
+    void clear();
+
+    /// \brief Write the index to disk.
+    /// \returns true if the index was written successfully.
+    bool save() const;
+
+    /// \brief Set the maximum total size, evicting files if needed.
+    /// \param maxSize The maximum total size in bytes.
+    void setMaxSize(uint64_t maxSize);
+
+    /// \returns the maximum total size in bytes.
+    uint64_t maxSize() const;
+
+    /// \returns the total size of cached files in bytes.
+    uint64_t size() const;
+
+    /// \returns the number of cached files.
+    std::size_t count() const;
+
+    /// \returns the cache directory.
+    const std::filesystem::path& directory() const;
+
+    /// \brief The default maximum total size, 1 GB.
+    static const uint64_t DEFAULT_MAX_SIZE;
+
+private:
+    /// \brief A cached file.
+    struct Object
+    {
+        /// \brief The file name relative to the cache directory.
+        std::string filename;
+
+        /// \brief The file size in bytes.
+        uint64_t size = 0;
+
+        /// \brief The access sequence number of the last use.
+        uint64_t access = 0;
+
+        /// \brief The keys that refer to this object.
+        std::set<std::string> keys;
+    };
+
+    /// \brief Load the index from disk and reconcile it with the directory.
+    void _load();
+
+    /// \brief Point a key at an object.
+    void _assign(const std::string& key, const std::string& digest);
+
+    /// \brief Mark an object as used.
+    void _touch(const std::string& digest, Object& object);
+
+    /// \brief Remove least recently used objects until within the limit.
+    void _evict();
+
+    /// \brief Remove an object and the keys that refer to it.
+    void _remove(const std::string& digest);
+
+    /// \brief The cache directory.
+    std::filesystem::path _directory;
+
+    /// \brief The maximum total size in bytes.
+    uint64_t _maxSize = DEFAULT_MAX_SIZE;
+
+    /// \brief The total size in bytes.
+    uint64_t _size = 0;
+
+    /// \brief The next access sequence number.
+    uint64_t _nextAccess = 1;
+
+    /// \brief The cached objects by digest.
+    std::unordered_map<std::string, Object> _objects;
+
+    /// \brief The digests of cached objects by key.
+    std::unordered_map<std::string, std::string> _keys;
+
+    /// \brief The digests of cached objects by access sequence number.
+    std::map<uint64_t, std::string> _lru;
+
+    /// \brief Guards all members.
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::Twitter
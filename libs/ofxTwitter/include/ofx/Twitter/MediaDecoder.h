@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "ofFileUtils.h"
+#include "ofImage.h"
+#include "ofx/Twitter/Entities.h"
+#include "ofx/Twitter/MediaFetcher.h"
+#include "ofx/Twitter/PixelPool.h"
+#include "ofx/Twitter/ThreadPool.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Decodes media into pixels on worker threads.
+///
+/// Decoded pixels are taken from a PixelPool and queued until received,
+/// typically once per frame on the main thread, which only has to upload
+/// them to a texture. The queue is bounded: when it is full, workers wait for
+/// frames to be received, so a burst of media cannot exhaust memory.
+///
+/// Media can optionally be downscaled to a target size variant, using the
+/// dimensions reported by the media entity or the Twitter defaults.
+///
+/// Usage:
+///
+///     ofxTwitter::MediaDecoder decoder;
+///     decoder.setTargetSize(ofxTwitter::MediaEntitySize::Type::SMALL);
+///     decoder.decode(fetchResult);
+///     ...
+///     ofxTwitter::MediaDecoder::Frame frame;
+///     while (decoder.tryReceive(frame)) texture.loadData(*frame.pixels);
+class MediaDecoder
+{
+public:
+    /// \brief Decoded media.
+    struct Frame
+    {
+        /// \brief The media id, or -1 if unknown.
+        int64_t mediaId = -1;
+
+        /// \brief The decoded file, if decoded from a file.
+        std::filesystem::path path;
+
+        /// \brief The pooled pixels if successful.
+        std::shared_ptr<ofPixels> pixels;
+
+        /// \brief The error message if unsuccessful.
+        std::string error;
+
+        /// \returns true if the media was decoded.
+        bool isSuccess() const
+        {
+            return pixels != nullptr;
+        }
+    };
+
+    /// \brief Create a MediaDecoder.
+    /// \param threadCount The number of decoding threads, or 0 to use the
+    /// hardware concurrency.
+    /// \param capacity The maximum number of frames waiting to be received.
+    MediaDecoder(std::size_t threadCount = 0,
+                 std::size_t capacity = DEFAULT_CAPACITY);
+
+    /// \brief Destroy the MediaDecoder.
+    ///
+    /// Media that has not been decoded yet is discarded.
+    ~MediaDecoder();
+
+    /// \brief Decode fetched media.
+    ///
+    /// Unsuccessful results are passed through as unsuccessful frames.
+    ///
+    /// \param result The fetch result.
+    void decode(const MediaFetcher::Result& result);
+
+    /// \brief Decode a media file.
+    /// \param entity The media entity, used for its id and sizes.
+    /// \param path The path of the file.
+    void decode(const MediaEntity& entity, const std::filesystem::path& path);
+
+    /// \brief Decode media from memory.
+    /// \param entity The media entity, used for its id and sizes.
+    /// \param buffer The encoded media.
+    void decode(const MediaEntity& entity, const ofBuffer& buffer);
+
+    /// \brief Receive a decoded frame without waiting.
+    /// \param frame The frame to fill.
+    /// \returns true if a frame was received.
+    bool tryReceive(Frame& frame);
+
+    /// \brief Receive a decoded frame.
+    /// \param frame The frame to fill.
+    /// \param timeout The maximum time to wait in milliseconds.
+    /// \returns true if a frame was received.
+    bool receive(Frame& frame, uint64_t timeout);
+
+    /// \brief Downscale decoded media to a size variant.
+    ///
+    /// Media is never upscaled. The target applies to media queued after the
+    /// call.
+    ///
+    /// \param size The target size.
+    void setTargetSize(MediaEntitySize::Type size);
+
+    /// \brief Keep decoded media at its original size.
+    void clearTargetSize();
+
+    /// \returns true if a target size is set.
+    bool hasTargetSize() const;
+
+    /// \returns the target size, if set.
+    MediaEntitySize::Type targetSize() const;
+
+    /// \returns the maximum number of frames waiting to be received.
+    std::size_t capacity() const;
+
+    /// \returns the number of media queued or being decoded.
+    std::size_t pending() const;
+
+    /// \returns the number of frames waiting to be received.
+    std::size_t ready() const;
+
+    /// \returns the pool that decoded pixels are taken from.
+    PixelPool& pixelPool();
+
+    /// \brief Calculate the size of media scaled to a size variant.
+    /// \param width The width of the media.
+    /// \param height The height of the media.
+    /// \param sizes The sizes reported by the media entity, which may be empty.
+    /// \param target The target size.
+    /// \param resize Set to the resize method.
+    /// \returns the scaled width and height.
+    static std::pair<std::size_t, std::size_t> scaledSize(std::size_t width,
+                                                           std::size_t height,
+                                                           const MediaEntity::Sizes& sizes,
+                                                           MediaEntitySize::Type target,
+                                                           MediaEntitySize::Resize& resize);
+
+    /// \brief The default number of frames waiting to be received.
+    static const std::size_t DEFAULT_CAPACITY;
+
+private:
+    /// \brief Media waiting to be decoded.
+    struct Job
+    {
+        Frame frame;
+        ofBuffer buffer;
+        MediaEntity::Sizes sizes;
+        bool scale = false;
+        MediaEntitySize::Type target = MediaEntitySize::Type::LARGE;
+    };
+
+    /// \brief Queue a job on the decoding threads.
+    void _submit(std::shared_ptr<Job> job);
+
+    /// \brief Decode a job on a worker thread.
+    void _decode(Job& job);
+
+    /// \brief Queue a frame, waiting while the queue is full.
+    void _deliver(Frame&& frame);
+
+    /// \brief The pool of decoded pixels.
+    PixelPool _pixelPool;
+
+    /// \brief The maximum number of frames waiting to be received.
+    std::size_t _capacity;
+
+    /// \brief True if media is downscaled.
+    bool _scale = false;
+
+    /// \brief The target size.
+    MediaEntitySize::Type _target = MediaEntitySize::Type::LARGE;
+
+    /// \brief Frames waiting to be received.
+    std::deque<Frame> _ready;
+
+    /// \brief The number of media queued or being decoded.
+    std::size_t _pending = 0;
+
+    /// \brief True once the decoder is being destroyed.
+    bool _stopping = false;
+
+    /// \brief Guards the queue state.
+    mutable std::mutex _mutex;
+
+    /// \brief Signalled when a frame is queued.
+    std::condition_variable _readyCondition;
+
+    /// \brief Signalled when a frame is received.
+    std::condition_variable _spaceCondition;
+
+    /// \brief The decoding threads.
+    ///
+    /// Declared last so its threads are joined before the state they use is
+    /// destroyed.
+    ThreadPool _pool;
+
+};
+
+
+} } // namespace ofx::Twitter
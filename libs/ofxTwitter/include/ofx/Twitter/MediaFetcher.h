@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "ofFileUtils.h"
+#include "ofx/Twitter/Entities.h"
+#include "ofx/Twitter/MediaCache.h"
+#include "ofx/Twitter/ThreadPool.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Downloads media into a MediaCache with bounded concurrency.
+///
+/// Each fetch picks a size variant of the media, then checks the cache.
+/// Cache misses are queued and downloaded on a fixed number of worker
+/// threads, with at most a fixed number of concurrent downloads per host.
+/// Concurrent fetches of the same media and size share one download.
+///
+/// Usage:
+///
+///     ofxTwitter::MediaFetcher fetcher(ofToDataPath("media"));
+///     auto result = fetcher.fetch(mediaEntity);
+///     ...
+///     if (result.get().isSuccess()) ofLoadImage(pixels, result.get().path);
+class MediaFetcher
+{
+public:
+    /// \brief A function that downloads a URL.
+    ///
+    /// The function is called on worker threads and reports failures by
+    /// throwing. Replacing it allows testing against a local stand-in.
+    typedef std::function<ofBuffer(const std::string& url)> Transport;
+
+    /// \brief The outcome of a fetch.
+    struct Result
+    {
+        /// \brief The media id, or -1 if unknown.
+        int64_t mediaId = -1;
+
+        /// \brief The URL that was fetched.
+        std::string url;
+
+        /// \brief The path of the cached file if successful.
+        std::filesystem::path path;
+
+        /// \brief True if the file was already cached.
+        bool cached = false;
+
+        /// \brief The error message if unsuccessful.
+        std::string error;
+
+        /// \returns true if the media was fetched.
+        bool isSuccess() const
+        {
+            return error.empty();
+        }
+    };
+
+    /// \brief Create a MediaFetcher.
+    /// \param cacheDirectory The directory of the media cache.
+    /// \param maxConcurrency The maximum number of concurrent downloads.
+    /// \param transport The download function, or nullptr for HTTP.
+    MediaFetcher(const std::filesystem::path& cacheDirectory,
+                 std::size_t maxConcurrency = DEFAULT_MAX_CONCURRENCY,
+                 Transport transport = nullptr);
+
+    /// \brief Destroy the MediaFetcher.
+    ///
+    /// Queued fetches fail with an error and running downloads are completed.
+    ~MediaFetcher();
+
+    /// \brief Fetch a media entity in the preferred size.
+    /// \param entity The media to fetch.
+    /// \returns a future for the result.
+    std::shared_future<Result> fetch(const MediaEntity& entity);
+
+    /// \brief Fetch a media URL.
+    ///
+    /// Concurrent fetches with the same media id and size variant share one
+    /// download. The size variant is the `:<size>` suffix of the URL, if any.
+    ///
+    /// \param mediaId The media id used to share concurrent downloads, or -1
+    /// to share by URL.
+    /// \param url The URL to fetch.
+    /// \returns a future for the result.
+    std::shared_future<Result> fetch(int64_t mediaId, const std::string& url);
+
+    /// \brief Set the preferred size variant.
+    ///
+    /// If the media does not have the preferred size, the next smaller
+    /// available size is used, then the next larger one.
+    ///
+    /// \param size The preferred size.
+    void setPreferredSize(MediaEntitySize::Type size);
+
+    /// \returns the preferred size variant.
+    MediaEntitySize::Type preferredSize() const;
+
+    /// \brief Set the maximum number of concurrent downloads per host.
+    /// \param maxConnectionsPerHost The maximum number of downloads.
+    void setMaxConnectionsPerHost(std::size_t maxConnectionsPerHost);
+
+    /// \returns the maximum number of concurrent downloads per host.
+    std::size_t maxConnectionsPerHost() const;
+
+    /// \returns the number of queued downloads.
+    std::size_t pending() const;
+
+    /// \returns the number of running downloads.
+    std::size_t active() const;
+
+    /// \returns the media cache.
+    MediaCache& cache();
+
+    /// \brief Get the URL of a size variant of a media entity.
+    /// \param entity The media entity.
+    /// \param size The preferred size.
+    /// \returns the URL of the closest available size.
+    static std::string url(const MediaEntity& entity, MediaEntitySize::Type size);
+
+    /// \brief Download a URL over HTTP.
+    /// \param url The URL to download.
+    /// \returns the response body.
+    /// \throws Poco::IOException if the response is unsuccessful.
+    static ofBuffer download(const std::string& url);
+
+    /// \brief The default maximum number of concurrent downloads.
+    static const std::size_t DEFAULT_MAX_CONCURRENCY;
+
+    /// \brief The default maximum number of concurrent downloads per host.
+    static const std::size_t DEFAULT_MAX_CONNECTIONS_PER_HOST;
+
+private:
+    /// \brief A queued or running download.
+    struct Job
+    {
+        std::string key;
+        std::string host;
+        std::string extension;
+        Result result;
+        std::promise<Result> promise;
+    };
+
+    /// \brief Start queued jobs while capacity allows. Requires _mutex.
+    void _pump();
+
+    /// \brief Run a job on a worker thread.
+    void _run(std::shared_ptr<Job> job);
+
+    /// \brief The download function.
+    Transport _transport;
+
+    /// \brief The media cache.
+    MediaCache _cache;
+
+    /// \brief The maximum number of concurrent downloads.
+    std::size_t _maxConcurrency;
+
+    /// \brief The maximum number of concurrent downloads per host.
+    std::size_t _maxConnectionsPerHost = DEFAULT_MAX_CONNECTIONS_PER_HOST;
+
+    /// \brief The preferred size.
+    MediaEntitySize::Type _preferredSize = MediaEntitySize::Type::LARGE;
+
+    /// \brief The queued jobs in submission order.
+    std::deque<std::shared_ptr<Job>> _pending;
+
+    /// \brief The futures of queued and running jobs by key.
+    std::map<std::string, std::shared_future<Result>> _inFlight;
+
+    /// \brief The number of running downloads by host.
+    std::map<std::string, std::size_t> _activeByHost;
+
+    /// \brief The number of running downloads.
+    std::size_t _active = 0;
+
+    /// \brief True once the fetcher is being destroyed.
+    bool _stopping = false;
+
+    /// \brief Guards the job state.
+    mutable std::mutex _mutex;
+
+    /// \brief The download threads.
+    ///
+    /// Declared last so it is destroyed, and its threads joined, before the
+    /// state they use.
+    ThreadPool _pool;
+
+};
+
+
+} } // namespace ofx::Twitter
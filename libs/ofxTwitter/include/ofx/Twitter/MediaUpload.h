@@ -8,11 +8,16 @@
 #pragma once
 
 
+#include <memory>
+#include <ostream>
 #include <string>
+#include <vector>
 #include "ofImage.h"
 #include "ofx/Twitter/Status.h"
 #include "ofx/Twitter/BaseResponse.h"
 #include "ofx/Twitter/Error.h"
+#include "ofx/Twitter/ImageEncoder.h"
+#include "ofx/Twitter/OAuth10Signer.h"
 #include "ofx/HTTP/PostRequest.h"
 
 
@@ -36,35 +41,208 @@ public:
     void setFile(const std::string& path);
 
     /// \brief Set the image from an image file.
+    ///
+    /// The pixels are encoded on the calling thread into a buffer from the
+    /// encoder's pool that is written to the request body as raw multipart
+    /// data. Reusing one encoder across requests reuses its buffers.
+    ///
+    /// \param encoder The encoder to encode the pixels with.
     /// \param pixels The image pixels to send.
     /// \param format The image format to encode.
     /// \param quality The compression quality.
-    void setImage(const ofPixels& pixels,
+    void setImage(ImageEncoder& encoder,
+                  const ofPixels& pixels,
                   ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
                   ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
 
+    /// \brief Set encoded media to send.
+    ///
+    /// The media is written to the request body as raw multipart data,
+    /// without copying or Base64 encoding. The request keeps a reference to
+    /// the buffer until it is destroyed. Form fields added with addFormField(),
+    /// e.g. media_category or additional_owners, are sent before the media.
+    ///
+    /// \sa ImageEncoder
+    /// \param media The encoded media.
+    /// \param mediaType The MIME type of the media.
+    void setMedia(std::shared_ptr<const ofBuffer> media,
+                  const std::string& mediaType = DEFAULT_MEDIA_TYPE);
+
+    /// \returns the form fields, encoded to sign the request with, or no
+    /// parameters if they are sent as multipart data.
+    OAuth10Signer::EncodedParameters formParameters() const;
 
     /// \brief The default resource URL.
     static const std::string RESOURCE_URL;
 
+protected:
+    virtual void prepareRequest() override;
+    virtual void writeRequestBody(std::ostream& requestStream) override;
+
+private:
+    /// \brief The encoded media, if set.
+    std::shared_ptr<const ofBuffer> _media;
+
+    /// \brief The MIME type of the encoded media.
+    std::string _mediaType;
+
+    /// \brief The multipart boundary.
+    std::string _boundary;
+
+    /// \brief The form fields and media part headers preceding the media.
+    std::string _header;
+
+    /// \brief The multipart body following the media.
+    std::string _footer;
+
 };
 
 
-/// \brief A Twitter MediaUploadResponse.
-class MediaUploadResponse//: public BaseResponse<MediaUploadRequest>
+/// \brief A chunked media upload APPEND request.
+///
+/// The segment is written to the request body as a raw multipart part
+/// directly from the caller's memory, so it is neither copied nor Base64
+/// encoded. The memory must remain valid until the request is executed.
+///
+/// \sa https://developer.twitter.com/en/docs/media/upload-media/api-reference/post-media-upload-append
+class MediaAppendRequest: public HTTP::Request
 {
 public:
-//    using BaseResponse<MediaUploadRequest>::BaseResponse;
+    /// \brief Create a MediaAppendRequest.
+    /// \param mediaId The media id returned by the INIT command.
+    /// \param segmentIndex The zero-based index of the segment.
+    /// \param data The segment data.
+    /// \param size The segment size in bytes.
+    MediaAppendRequest(int64_t mediaId,
+                       std::size_t segmentIndex,
+                       const char* data,
+                       std::size_t size);
+
+    /// \brief Destroy the MediaAppendRequest.
+    virtual ~MediaAppendRequest();
+
+protected:
+    virtual void prepareRequest() override;
+    virtual void writeRequestBody(std::ostream& requestStream) override;
 
+private:
+    /// \brief The multipart boundary.
+    std::string _boundary;
+
+    /// \brief The multipart body preceding the segment data.
+    std::string _header;
+
+    /// \brief The multipart body following the segment data.
+    std::string _footer;
+
+    /// \brief The segment data.
+    const char* _data = nullptr;
+
+    /// \brief The segment size in bytes.
+    std::size_t _size = 0;
+
+};
+
+
+/// \brief A Twitter MediaUploadResponse.
+///
+/// This is returned by simple uploads and by the INIT, FINALIZE and STATUS
+/// commands of chunked uploads.
+class MediaUploadResponse
+{
+public:
+    /// \brief The state of asynchronous media processing.
+    enum class ProcessingState
+    {
+        /// \brief The media does not require processing.
+        NONE,
+        /// \brief Processing has not started.
+        PENDING,
+        /// \brief Processing is in progress.
+        IN_PROGRESS,
+        /// \brief Processing succeeded.
+        SUCCEEDED,
+        /// \brief Processing failed.
+        FAILED
+    };
+
+    /// \brief Create an empty MediaUploadResponse.
+    MediaUploadResponse();
+
+    /// \brief Destroy the MediaUploadResponse.
     virtual ~MediaUploadResponse();
 
+    /// \returns the media id, or -1 if unknown.
     int64_t mediaId() const;
 
-protected:
-    virtual void parseJSON(const ofJson& json);// override;
+    /// \returns the media key, e.g. "3_1234", or an empty string if unknown.
+    const std::string& mediaKey() const;
+
+    /// \returns the media size in bytes, if reported.
+    uint64_t size() const;
+
+    /// \returns the number of seconds the media id is valid, if reported.
+    uint64_t expiresAfterSecs() const;
+
+    /// \returns the processing state.
+    ProcessingState processingState() const;
+
+    /// \returns the number of seconds to wait before checking the status.
+    uint64_t checkAfterSecs() const;
+
+    /// \returns the processing progress in percent, if reported.
+    int progressPercent() const;
+
+    /// \returns the MIME type of the uploaded image or video, if reported.
+    const std::string& mediaType() const;
+
+    /// \returns the image width in pixels, or -1 if unknown.
+    int width() const;
+
+    /// \returns the image height in pixels, or -1 if unknown.
+    int height() const;
+
+    /// \returns the errors reported by the request or by processing.
+    const std::vector<Error>& errors() const;
+
+    /// \brief Deserialize a MediaUploadResponse from JSON.
+    /// \param json The JSON representing the MediaUploadResponse.
+    /// \returns the MediaUploadResponse.
+    static MediaUploadResponse fromJSON(const ofJson& json);
 
 private:
-    int64_t _mediaId;
+    /// \brief The media id.
+    int64_t _mediaId = -1;
+
+    /// \brief The media key.
+    std::string _mediaKey;
+
+    /// \brief The media size in bytes.
+    uint64_t _size = 0;
+
+    /// \brief The number of seconds the media id is valid.
+    uint64_t _expiresAfterSecs = 0;
+
+    /// \brief The processing state.
+    ProcessingState _processingState = ProcessingState::NONE;
+
+    /// \brief The number of seconds to wait before checking the status.
+    uint64_t _checkAfterSecs = 0;
+
+    /// \brief The processing progress in percent.
+    int _progressPercent = 0;
+
+    /// \brief The MIME type of the image or video.
+    std::string _mediaType;
+
+    /// \brief The image width in pixels.
+    int _width = -1;
+
+    /// \brief The image height in pixels.
+    int _height = -1;
+
+    /// \brief The errors.
+    std::vector<Error> _errors;
 
 };
 
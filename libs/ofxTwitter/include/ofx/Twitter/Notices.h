@@ -37,7 +37,7 @@ public:
     uint64_t timestamp() const;
 
     /// \returns the original json.
-    ofJson json() const;
+    const ofJson& json() const;
 
     static const std::string JSON_KEY;
 
@@ -115,7 +115,7 @@ public:
     uint64_t track() const;
 
     /// \returns the original json.
-    ofJson json() const;
+    const ofJson& json() const;
 
     static const std::string JSON_KEY;
 
@@ -148,10 +148,10 @@ public:
     int64_t statusId() const;
 
     /// \returns the withheld in countries.
-    std::vector<std::string> countries() const;
+    const std::vector<std::string>& countries() const;
 
     /// \returns the original json.
-    ofJson json() const;
+    const ofJson& json() const;
 
     static const std::string JSON_KEY;
 
@@ -186,10 +186,10 @@ public:
     int64_t userId() const;
 
     /// \returns Withheld in countries.
-    std::vector<std::string> countries() const;
+    const std::vector<std::string>& countries() const;
 
     /// \returns the original json.
-    ofJson json() const;
+    const ofJson& json() const;
 
     static const std::string JSON_KEY;
 
@@ -223,13 +223,13 @@ public:
     int64_t code() const;
 
     /// \returns the stream name.
-    std::string streamName() const;
+    const std::string& streamName() const;
 
     /// \returns the disconnect reason.
-    std::string reason() const;
+    const std::string& reason() const;
 
     /// \returns the original json.
-    ofJson json() const;
+    const ofJson& json() const;
 
     static const std::string JSON_KEY;
 
@@ -262,16 +262,16 @@ class StallWarning
 {
 public:
     /// \returns the code.
-    std::string code() const;
+    const std::string& code() const;
 
     /// \returns the message.
-    std::string message() const;
+    const std::string& message() const;
 
     /// \returns the disconnect reason.
     double percentFull() const;
 
     /// \returns the original json.
-    ofJson json() const;
+    const ofJson& json() const;
 
     static const std::string JSON_KEY;
 
@@ -0,0 +1,277 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Poco/Net/NameValueCollection.h"
+#include "ofx/HTTP/OAuth10HTTPClient.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Signs requests with OAuth 1.0a HMAC-SHA1 using precomputed state.
+///
+/// The signer is bound to one set of credentials. The HMAC key does not
+/// change between requests, so the hash state after the inner and outer key
+/// blocks is computed once and each signature only hashes the signature base
+/// string. The percent-encoded consumer key and token are also cached, and
+/// nonces are drawn from a pool that is refilled in batches.
+///
+/// The signature base string is built as specified by OAuth 1.0a section
+/// 3.4.1: the base URI is normalized and the query parameters of the URI are
+/// signed along with the form parameters.
+///
+///     ofxTwitter::OAuth10Signer signer(credentials);
+///
+///     HTTP::GetRequest request(SearchQuery::RESOURCE_URL);
+///     request.addFormFields(query);
+///     signer.sign(request, query);
+///
+///     HTTP::HTTPClient client;
+///     auto response = client.execute(request);
+///
+/// Parameters that are sent repeatedly, e.g. a SearchQuery or FilterQuery,
+/// can be encoded once into EncodedParameters and reused:
+///
+///     ofxTwitter::OAuth10Signer::EncodedParameters parameters(query);
+///     signer.sign(request, parameters);
+///
+/// RESTClient and CredentialPool sign their requests with an OAuth10Signer.
+///
+/// The signer is thread-safe.
+///
+/// \sa https://developer.twitter.com/en/docs/basics/authentication/guides/creating-a-signature
+class OAuth10Signer
+{
+public:
+    /// \brief Request parameters in percent-encoded, sorted form.
+    class EncodedParameters
+    {
+    public:
+        /// \brief Create empty EncodedParameters.
+        EncodedParameters();
+
+        /// \brief Encode a parameter collection.
+        /// \param parameters The query or form parameters.
+        EncodedParameters(const Poco::Net::NameValueCollection& parameters);
+
+        /// \brief Add a parameter.
+        /// \param name The parameter name.
+        /// \param value The parameter value.
+        void add(const std::string& name, const std::string& value);
+
+        /// \brief Replace all values of a parameter.
+        ///
+        /// Only the changed parameter is encoded again, so a query whose
+        /// `since_id` changes between polls keeps its other fragments.
+        ///
+        /// \param name The parameter name.
+        /// \param value The parameter value.
+        void set(const std::string& name, const std::string& value);
+
+        /// \brief Remove all values of a parameter.
+        /// \param name The parameter name.
+        void erase(const std::string& name);
+
+        /// \returns the encoded name and value pairs in signature order.
+        const std::vector<std::pair<std::string, std::string>>& fragments() const;
+
+    private:
+        /// \brief The encoded pairs, sorted by name and then value.
+        std::vector<std::pair<std::string, std::string>> _fragments;
+
+        friend class OAuth10Signer;
+
+    };
+
+    /// \brief Create an OAuth10Signer.
+    /// \param credentials The OAuth 1.0 credentials to sign with.
+    /// \param noncePoolSize The number of nonces generated at a time.
+    OAuth10Signer(const HTTP::OAuth10Credentials& credentials,
+                  std::size_t noncePoolSize = DEFAULT_NONCE_POOL_SIZE);
+
+    /// \brief Destroy the OAuth10Signer.
+    ~OAuth10Signer();
+
+    /// \returns the credentials.
+    const HTTP::OAuth10Credentials& credentials() const;
+
+    /// \brief Sign a request and set its Authorization header.
+    ///
+    /// The query parameters of the request URI are always signed. Form
+    /// fields are not read from the request, so the parameters that are
+    /// sent in the query or a URL-encoded body must be passed, e.g. from
+    /// StatusUpdateRequest::formParameters(). Multipart form fields are not
+    /// signed.
+    ///
+    /// \param request The request to sign.
+    /// \param parameters The query or URL-encoded form parameters that are
+    /// not part of the request URI.
+    void sign(HTTP::Request& request,
+              const EncodedParameters& parameters = EncodedParameters());
+
+    /// \brief Create an Authorization header value.
+    /// \param method The HTTP method, e.g. "GET".
+    /// \param url The request URL. Its query parameters are signed as well.
+    /// \param parameters The query or URL-encoded form parameters that are
+    /// not part of the URL.
+    /// \returns the Authorization header value.
+    std::string authorization(const std::string& method,
+                              const std::string& url,
+                              const EncodedParameters& parameters);
+
+    /// \brief Create an Authorization header value with a given nonce and
+    /// timestamp.
+    ///
+    /// This is mainly useful to reproduce a known signature.
+    ///
+    /// \param method The HTTP method, e.g. "GET".
+    /// \param url The request URL. Its query parameters are signed as well.
+    /// \param parameters The query or URL-encoded form parameters that are
+    /// not part of the URL.
+    /// \param nonce The nonce.
+    /// \param timestamp The Unix time in seconds.
+    /// \returns the Authorization header value.
+    std::string authorization(const std::string& method,
+                              const std::string& url,
+                              const EncodedParameters& parameters,
+                              const std::string& nonce,
+                              uint64_t timestamp) const;
+
+    /// \brief Compute the signature of a request.
+    /// \param method The HTTP method, e.g. "GET".
+    /// \param url The request URL. Its query parameters are signed as well.
+    /// \param parameters The request and oauth_* parameters that are not
+    /// part of the URL.
+    /// \returns the Base64 encoded HMAC-SHA1 signature.
+    std::string signature(const std::string& method,
+                          const std::string& url,
+                          const EncodedParameters& parameters) const;
+
+    /// \returns a nonce from the pool.
+    std::string nonce();
+
+    /// \brief Percent-encode a string as required by OAuth 1.0a.
+    /// \param value The string to encode.
+    /// \returns the encoded string.
+    static std::string percentEncode(const std::string& value);
+
+    /// \brief Get the base string URI of a URL.
+    ///
+    /// The scheme and host are lowercase, default ports are removed and the
+    /// query and fragment are dropped, as specified by OAuth 1.0a section
+    /// 3.4.1.2.
+    ///
+    /// \param url The request URL.
+    /// \returns the base string URI.
+    static std::string baseURI(const std::string& url);
+
+    /// \brief Compute an SHA-1 digest.
+    /// \param data The data to hash.
+    /// \returns the digest.
+    static std::array<uint8_t, 20> sha1(const std::string& data);
+
+    /// \brief Compute an HMAC-SHA1 digest.
+    /// \param key The key.
+    /// \param data The data to authenticate.
+    /// \returns the digest.
+    static std::array<uint8_t, 20> hmacSHA1(const std::string& key,
+                                            const std::string& data);
+
+    /// \brief The default number of nonces generated at a time.
+    static const std::size_t DEFAULT_NONCE_POOL_SIZE;
+
+private:
+    /// \brief An SHA-1 hash state that can be copied.
+    struct SHA1
+    {
+        std::array<uint32_t, 5> state;
+        std::array<uint8_t, 64> block;
+        std::size_t blockSize = 0;
+        uint64_t length = 0;
+
+        SHA1();
+        void update(const void* data, std::size_t size);
+        std::array<uint8_t, 20> finish();
+        void transform(const uint8_t* data);
+    };
+
+    /// \brief Compute the HMAC hash states after the key blocks.
+    /// \param key The key.
+    /// \param inner The hash state to update with the inner key block.
+    /// \param outer The hash state to update with the outer key block.
+    static void _initializeHMAC(const std::string& key, SHA1& inner, SHA1& outer);
+
+    /// \brief Finish an HMAC from the hash states after the key blocks.
+    /// \param inner The hash state after the inner key block.
+    /// \param outer The hash state after the outer key block.
+    /// \param data The data to authenticate.
+    /// \returns the digest.
+    static std::array<uint8_t, 20> _finishHMAC(SHA1 inner,
+                                               SHA1 outer,
+                                               const std::string& data);
+
+    /// \brief Create the oauth_* parameters.
+    /// \param nonce The nonce.
+    /// \param timestamp The Unix time in seconds.
+    /// \returns the oauth_* parameters without the signature.
+    EncodedParameters _oauthParameters(const std::string& nonce,
+                                       uint64_t timestamp) const;
+
+    /// \brief Compute the signature of merged parameters.
+    /// \param method The HTTP method.
+    /// \param url The request URL.
+    /// \param parameters The request parameters that are not part of the
+    /// URL.
+    /// \param oauthParameters The oauth_* parameters.
+    /// \returns the Base64 encoded HMAC-SHA1 signature.
+    std::string _signature(const std::string& method,
+                           const std::string& url,
+                           const EncodedParameters& parameters,
+                           const EncodedParameters& oauthParameters) const;
+
+    /// \brief The credentials.
+    HTTP::OAuth10Credentials _credentials;
+
+    /// \brief The percent-encoded consumer key.
+    std::string _encodedConsumerKey;
+
+    /// \brief The percent-encoded access token.
+    std::string _encodedToken;
+
+    /// \brief The hash state after the inner key block.
+    SHA1 _inner;
+
+    /// \brief The hash state after the outer key block.
+    SHA1 _outer;
+
+    /// \brief The number of nonces generated at a time.
+    std::size_t _noncePoolSize = DEFAULT_NONCE_POOL_SIZE;
+
+    /// \brief The unused nonces.
+    std::vector<std::string> _nonces;
+
+    /// \brief The nonce source.
+    std::mt19937_64 _random;
+
+    /// \brief Guards the nonces.
+    std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "ofImage.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A pool of reusable pixel buffers bucketed by size.
+///
+/// Pixels are handed out as shared pointers and return to the pool when the
+/// last reference is released, so a steady stream of images with recurring
+/// dimensions, e.g. media thumbnails, decodes without allocating.
+///
+/// Buckets are keyed by exact width, height and channel count, because
+/// ofPixels only reuses its storage when reallocated to identical
+/// dimensions. Idle pixels beyond the byte limit are freed.
+///
+/// The pool is thread safe and pixels may outlive the pool.
+class PixelPool
+{
+public:
+    /// \brief Create a PixelPool.
+    /// \param maxBytes The maximum number of idle bytes to keep.
+    PixelPool(std::size_t maxBytes = DEFAULT_MAX_BYTES);
+
+    /// \brief Destroy the PixelPool.
+    ~PixelPool();
+
+    /// \brief Get allocated pixels of the given size.
+    ///
+    /// The contents of reused pixels are undefined.
+    ///
+    /// \param width The width in pixels.
+    /// \param height The height in pixels.
+    /// \param channels The number of channels.
+    /// \returns the pixels, which return to the pool when released.
+    std::shared_ptr<ofPixels> acquire(std::size_t width,
+                                      std::size_t height,
+                                      std::size_t channels);
+
+    /// \brief Set the maximum number of idle bytes to keep.
+    /// \param maxBytes The maximum number of bytes.
+    void setMaxBytes(std::size_t maxBytes);
+
+    /// \returns the maximum number of idle bytes to keep.
+    std::size_t maxBytes() const;
+
+    /// \returns the number of idle bytes in the pool.
+    std::size_t bytes() const;
+
+    /// \returns the number of idle pixels in the pool.
+    std::size_t count() const;
+
+    /// \brief Free all idle pixels.
+    void clear();
+
+    /// \brief The default maximum number of idle bytes, 64 MB.
+    static const std::size_t DEFAULT_MAX_BYTES;
+
+private:
+    /// \brief A bucket key of width, height and channels.
+    typedef std::tuple<std::size_t, std::size_t, std::size_t> Key;
+
+    /// \brief The pool state, shared with outstanding pixels.
+    struct State
+    {
+        /// \brief Idle pixels by size.
+        std::map<Key, std::vector<std::unique_ptr<ofPixels>>> buckets;
+
+        /// \brief The number of idle bytes.
+        std::size_t bytes = 0;
+
+        /// \brief The number of idle pixels.
+        std::size_t count = 0;
+
+        /// \brief The maximum number of idle bytes.
+        std::size_t maxBytes = 0;
+
+        /// \brief Guards the state.
+        mutable std::mutex mutex;
+
+        /// \brief Free idle pixels until within the byte limit.
+        ///
+        /// Requires mutex.
+        void trim();
+    };
+
+    /// \brief Return pixels to the pool or free them.
+    /// \param state The pool state, if the pool still exists.
+    /// \param pixels The pixels to return.
+    static void _release(std::weak_ptr<State> state, ofPixels* pixels);
+
+    /// \brief The pool state.
+    std::shared_ptr<State> _state;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -53,36 +53,36 @@ public:
     /// database.
     ///
     /// \returns the place attributes, if available or an empty map.
-    Attributes attributes() const;
+    const Attributes& attributes() const;
 
     /// \brief The bounding box that encloses this Place.
     /// \returns a bounding box.
-    Geo::CoordinateBounds boundingBox() const;
+    const Geo::CoordinateBounds& boundingBox() const;
 
     /// \returns the name of the country containing this Place.
-    std::string country() const;
+    const std::string& country() const;
 
     /// \returns the shortened country code representing the country containing this Place.
-    std::string countryCode() const;
+    const std::string& countryCode() const;
 
     /// \returns the full human-readable representation of the Place's name.
-    std::string fullName() const;
+    const std::string& fullName() const;
 
     /// \returns the ID representing this place.
     /// \note This is represented as a string, not an integer.
-    std::string id() const;
+    const std::string& id() const;
 
     /// \returns the ID of the place that this place is contained within.
-    std::vector<std::string> containedWithinId() const;
+    const std::vector<std::string>& containedWithinId() const;
 
     /// \returns a short human-readable representation of the Place's name.
-    std::string name() const;
+    const std::string& name() const;
 
     /// \returns The type of location represented by this place
-    std::string placeType() const;
+    const std::string& placeType() const;
 
     /// \returns URL representing the location of additional place metadata for this place.
-    std::string url() const;
+    const std::string& url() const;
 
     /// \brief Extract the Place from JSON.
     /// \param json The source JSON.
@@ -122,6 +122,8 @@ private:
     /// \brief URL representing the location of additional place metadata for this place.
     std::string _url;
 
+    friend class BinaryCodec;
+
 };
 
 
@@ -0,0 +1,332 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ofEvents.h"
+#include "ofx/IO/ThreadChannel.h"
+#include "ofx/Twitter/BaseResponse.h"
+#include "ofx/Twitter/ChunkedMediaUpload.h"
+#include "ofx/Twitter/StatusUpdate.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief An asynchronous, persistent queue of status updates.
+///
+/// Posts are sent one at a time, in order, on a background thread, so
+/// replies and threads keep their order. Their media is uploaded first with
+/// a ChunkedMediaUpload.
+///
+/// The queue follows the rate limit headers of the statuses/update endpoint
+/// and holds posts while the limit is exhausted. Transient failures, i.e.
+/// network errors, timeouts, rate limiting and server errors, are retried
+/// with exponential backoff and full jitter. Other failures, e.g. missing
+/// media files or media rejected by Twitter, are not retried.
+///
+/// Uploaded media ids are kept with their upload time, so a retry does not
+/// upload the media again unless the ids are about to expire or Twitter no
+/// longer accepts them.
+///
+/// If a queue path is set, pending posts are saved after every change and
+/// restored when the queue is created again, so posts are not lost when the
+/// application exits.
+///
+/// Results are delivered through the onPosted and onFailed events, which are
+/// triggered from the openFrameworks update loop unless auto event sync is
+/// disabled.
+class PostingQueue
+{
+public:
+    /// \brief The HTTP response to a status update.
+    struct Response
+    {
+        /// \brief The HTTP status code.
+        int status = 0;
+
+        /// \brief The response JSON.
+        ofJson json;
+
+        /// \brief The rate limit reported by the response headers.
+        RateLimit rateLimit;
+    };
+
+    /// \brief A function that executes a status update.
+    ///
+    /// The function reports network failures by throwing.
+    typedef std::function<Response(StatusUpdateRequest& request)> Transport;
+
+    /// \brief The outcome of a post.
+    struct Result
+    {
+        /// \brief The id returned when the post was queued.
+        uint64_t id = 0;
+
+        /// \brief The response if successful.
+        StatusUpdateResponse response;
+
+        /// \brief The error message if unsuccessful.
+        std::string error;
+
+        /// \brief The number of attempts made.
+        std::size_t attempts = 0;
+
+        /// \returns true if the status was posted.
+        bool isSuccess() const
+        {
+            return error.empty();
+        }
+    };
+
+    /// \brief Create a PostingQueue with the given credentials.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param queuePath The file used to persist pending posts, or empty.
+    /// \param autoEventSync True to trigger events from the update loop.
+    PostingQueue(const HTTP::OAuth10Credentials& credentials,
+                 const std::filesystem::path& queuePath = "",
+                 bool autoEventSync = true);
+
+    /// \brief Create a PostingQueue with custom transports.
+    /// \param transport The function that executes status updates.
+    /// \param uploadTransport The function that executes upload commands.
+    /// \param queuePath The file used to persist pending posts, or empty.
+    /// \param autoEventSync True to trigger events from the update loop.
+    PostingQueue(Transport transport,
+                 ChunkedMediaUpload::Transport uploadTransport,
+                 const std::filesystem::path& queuePath = "",
+                 bool autoEventSync = true);
+
+    /// \brief Destroy the PostingQueue.
+    ///
+    /// The post in progress is completed. Pending posts remain in the queue
+    /// file.
+    ~PostingQueue();
+
+    /// \brief Queue a status.
+    /// \param status The status text.
+    /// \param media The paths of media files to attach.
+    /// \returns the id of the queued post.
+    uint64_t post(const std::string& status,
+                  const std::vector<std::filesystem::path>& media = {});
+
+    /// \brief Queue a status update with parameters.
+    ///
+    /// The parameters are the statuses/update form fields, e.g.
+    /// `{ "status": "@user Hi!", "in_reply_to_status_id": "123" }`. Values
+    /// that are not strings are sent as JSON, e.g. `true`.
+    ///
+    /// \param parameters The status update parameters.
+    /// \param media The paths of media files to attach.
+    /// \returns the id of the queued post.
+    uint64_t postParameters(const ofJson& parameters,
+                            const std::vector<std::filesystem::path>& media = {});
+
+    /// \brief Remove a pending post from the queue.
+    ///
+    /// A post that is being sent cannot be cancelled, but one that is
+    /// waiting to be retried can.
+    ///
+    /// \param id The id of the post.
+    /// \returns true if the post was removed.
+    bool cancel(uint64_t id);
+
+    /// \returns the number of pending posts, including the one being sent.
+    std::size_t pending() const;
+
+    /// \returns the last rate limit reported by the endpoint.
+    RateLimit rateLimit() const;
+
+    /// \brief Set the number of attempts before a post fails.
+    /// \param maxAttempts The maximum number of attempts.
+    void setMaxAttempts(std::size_t maxAttempts);
+
+    /// \returns the number of attempts before a post fails.
+    std::size_t maxAttempts() const;
+
+    /// \brief Determine sync If true, events will be triggered from the ofEvents updated loop.
+    /// If false, the events will be triggered when eventSync is called.
+    /// \param value True to enable auto-sync.
+    void setAutoEventSync(bool value);
+
+    /// \brief Trigger an event sync.
+    void syncEvents();
+
+    /// \brief Register all event listeners.
+    ///
+    /// The listener class must implement onPosted(...) and onFailed(...).
+    ///
+    /// \tparam ListenerClass The lister class to register.
+    /// \param listener A pointer to the listener class.
+    /// \param priority The listener priority.
+    template <class ListenerClass>
+    void registerPostingEvents(ListenerClass* listener,
+                               int priority = OF_EVENT_ORDER_AFTER_APP);
+
+    /// \brief Unregister all event listeners.
+    /// \tparam ListenerClass The lister class to uregister.
+    /// \param listener A pointer to the listener class.
+    /// \param priority The listener priority.
+    template <class ListenerClass>
+    void unregisterPostingEvents(ListenerClass* listener,
+                                 int priority = OF_EVENT_ORDER_AFTER_APP);
+
+    /// \brief Execute a status update over HTTP.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param request The status update.
+    /// \returns the response.
+    /// \throws Poco::Exception on network failure.
+    static Response execute(const HTTP::OAuth10Credentials& credentials,
+                            StatusUpdateRequest& request);
+
+    ofEvent<const Result> onPosted;
+    ofEvent<const Result> onFailed;
+
+    /// \brief The default number of attempts before a post fails.
+    static const std::size_t DEFAULT_MAX_ATTEMPTS;
+
+    /// \brief The backoff after the first failure in milliseconds.
+    static const uint64_t INITIAL_BACKOFF;
+
+    /// \brief The maximum backoff in milliseconds.
+    static const uint64_t MAX_BACKOFF;
+
+    /// \brief The age in milliseconds after which uploaded media is uploaded
+    /// again, an hour less than the 24 hours Twitter keeps it.
+    static const uint64_t MEDIA_EXPIRY;
+
+private:
+    /// \brief A queued post.
+    struct Item
+    {
+        uint64_t id = 0;
+        ofJson parameters;
+        std::vector<std::string> media;
+        std::vector<int64_t> mediaIds;
+
+        /// \brief The time the first media id was uploaded, in Unix
+        /// milliseconds.
+        uint64_t mediaUploadedAt = 0;
+
+        std::size_t attempts = 0;
+
+        /// \brief The earliest time to send, in Unix milliseconds.
+        uint64_t notBefore = 0;
+    };
+
+    /// \brief The outcome of one attempt.
+    enum class Outcome
+    {
+        SUCCESS,
+        RETRY,
+        FAILURE
+    };
+
+    /// \brief Send posts until stopped.
+    void _run();
+
+    /// \brief Send one post.
+    /// \param item The post, updated with uploaded media ids.
+    /// \param result The result to fill.
+    /// \returns the outcome.
+    Outcome _send(Item& item, Result& result);
+
+    /// \brief Save the queue. Requires _mutex.
+    void _save() const;
+
+    /// \brief Load the queue.
+    void _load();
+
+    /// \brief Get the backoff before the next attempt.
+    /// \param attempts The number of attempts made.
+    /// \returns the backoff in milliseconds.
+    uint64_t _backoff(std::size_t attempts);
+
+    /// \returns the current time in Unix milliseconds.
+    static uint64_t _now();
+
+    void _update(ofEventArgs& args);
+    void _exit(ofEventArgs& args);
+
+    /// \brief The function that executes status updates.
+    Transport _transport;
+
+    /// \brief The media uploader.
+    ChunkedMediaUpload _uploader;
+
+    /// \brief The file used to persist pending posts.
+    std::filesystem::path _queuePath;
+
+    /// \brief The pending posts in order.
+    std::deque<Item> _items;
+
+    /// \brief The id of the next post.
+    uint64_t _nextId = 1;
+
+    /// \brief The number of attempts before a post fails.
+    std::size_t _maxAttempts = DEFAULT_MAX_ATTEMPTS;
+
+    /// \brief The last reported rate limit.
+    RateLimit _rateLimit;
+
+    /// \brief No posts are sent before this time, in Unix milliseconds.
+    uint64_t _holdUntil = 0;
+
+    /// \brief The id of the post being sent, or 0.
+    uint64_t _sendingId = 0;
+
+    /// \brief The jitter source.
+    std::mt19937_64 _random;
+
+    /// \brief True once the queue is being destroyed.
+    bool _stopping = false;
+
+    /// \brief Guards the queue state.
+    mutable std::mutex _mutex;
+
+    /// \brief Signalled when the queue changes.
+    std::condition_variable _condition;
+
+    IO::ThreadChannel<Result> _postedChannel;
+    IO::ThreadChannel<Result> _failedChannel;
+
+    ofEventListener _updateListener;
+    ofEventListener _exitListener;
+
+    /// \brief The posting thread.
+    std::thread _thread;
+
+};
+
+
+template <class ListenerClass>
+void PostingQueue::registerPostingEvents(ListenerClass* listener, int priority)
+{
+    onPosted.add(listener, &ListenerClass::onPosted, priority);
+    onFailed.add(listener, &ListenerClass::onFailed, priority);
+}
+
+
+template <class ListenerClass>
+void PostingQueue::unregisterPostingEvents(ListenerClass* listener, int priority)
+{
+    onPosted.remove(listener, &ListenerClass::onPosted, priority);
+    onFailed.remove(listener, &ListenerClass::onFailed, priority);
+}
+
+
+} } // namespace ofx::Twitter
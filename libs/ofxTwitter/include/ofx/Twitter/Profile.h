@@ -37,19 +37,19 @@ public:
 
     // TODO: finish setters
 
-    std::string getBackgroundColorHex() const;
+    const std::string& getBackgroundColorHex() const;
 
-    std::string getLinkColorHex() const;
+    const std::string& getLinkColorHex() const;
 
     bool useBackgroundImage() const;
 
-    std::string getBackgroundImageUrl() const;
+    const std::string& getBackgroundImageUrl() const;
 
-    std::string getBackgroundImageUrlHttps() const;
+    const std::string& getBackgroundImageUrlHttps() const;
 
     bool getBackgroundTile() const;
 
-    std::string getBannerUrl() const;
+    const std::string& getBannerUrl() const;
 
 private:
     // colors
@@ -70,6 +70,8 @@ private:
     std::string _sidebarFillColorHex;
     std::string _sidebarTextColorHex;
 
+    friend class BinaryCodec;
+
 };
 
 
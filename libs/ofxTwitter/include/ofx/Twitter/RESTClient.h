@@ -8,129 +8,318 @@
 #pragma once
 
 
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ofImage.h"
+#include "ofx/HTTP/HTTPClient.h"
 #include "ofx/HTTP/OAuth10HTTPClient.h"
+#include "ofx/Twitter/BaseResponse.h"
+#include "ofx/Twitter/CredentialPool.h"
+#include "ofx/Twitter/ImageEncoder.h"
+#include "ofx/Twitter/Lookup.h"
+#include "ofx/Twitter/MediaUpload.h"
+#include "ofx/Twitter/OAuth10Signer.h"
 #include "ofx/Twitter/Search.h"
+#include "ofx/Twitter/StatusUpdate.h"
+#include "ofx/Twitter/ThreadPool.h"
 
 
 namespace ofx {
 namespace Twitter {
 
 
-class SearchResponse;
-class MediaUploadResponse;
-class StatusUpdateResponse;
+/// \brief An asynchronous client for the Twitter REST API.
+///
+/// Requests are executed on an internal pool with a bounded number of
+/// concurrent connections. Each connection is an HTTP client that is reused
+/// by later requests, so keep-alive sessions are shared instead of being
+/// opened for every request. Requests are signed with an OAuth10Signer,
+/// so the signing key is derived once per set of credentials rather than
+/// for every request.
+///
+/// Any request can be submitted with the type of its response, e.g.
+///
+///     ofxTwitter::RESTClient client(credentials);
+///
+///     auto request = std::make_unique<ofxHTTP::GetRequest>(url);
+///     auto future = client.submit<ofxTwitter::SearchResponse>(std::move(request));
+///
+///     auto result = future.get();
+///
+///     if (result.isSuccess())
+///     {
+///         for (const auto& status: result.response.statuses()) ...
+///     }
+///
+/// Responses are parsed from JSON with the static `fromJSON` method of the
+/// response type.
+class RESTClient
+{
+public:
+    /// \brief The HTTP response to a request.
+    struct Response
+    {
+        /// \brief The HTTP status code, or 0 if no response was received.
+        int status = 0;
 
+        /// \brief The HTTP reason phrase.
+        std::string reason;
 
-///// \brief A RESTClient for the Twitter API.
-///// \sa
-//class RESTClient: public HTTP::OAuth10HTTPClient
-//{
-//public:
-//    /// \brief Create a default RESTClient.
-//    ///
-//    /// The user must set the appropriate credentials using the setCredentials()
-//    /// method before the client will connnect to the Twitter API.
-//    RESTClient();
-//
-//    /// \brief Create a RESTClient with the given Credentials.
-//    /// \param credentials The Twitter Credentials.
-//    RESTClient(const HTTP::OAuth10Credentials& credentials);
-//
-//    /// \brief Destroys the REST client.
-//    virtual ~RESTClient();
-//
-//    /// \brief Execute a basic Twitter Search query.
-//    /// \param query The search string to send.
-//    /// \returns The SearchResponse.
-//    SearchResponse search(const std::string& query);
-//
-//    /// \brief Execute a basic Twitter Search query.
-//    /// \param query The search query to send.
-//    /// \returns The SearchResponse.
-//    SearchResponse search(const SearchQuery& query);
-//
+        /// \brief The response JSON, or null if the body was not JSON.
+        ofJson json;
 
-//    SearchResponse RESTClient::search(const SearchQuery& query)
-//    {
-//
-//
-//
-//    }
+        /// \brief The rate limit reported by the response headers.
+        RateLimit rateLimit;
 
+        /// \brief The error message if the request could not be completed.
+        std::string error;
 
+        /// \returns true if the request succeeded.
+        bool isSuccess() const
+        {
+            return error.empty() && status >= 200 && status < 300;
+        }
+    };
 
-//    /// \brief Execute a basic Twitter Search query.
-//    /// \param query The query string to send.
-//    /// \returns The SearchResponse.
-//    std::unique_ptr<SearchResponse> search(const std::string& query);
+    /// \brief A response parsed into a response type.
+    /// \tparam ResponseType The response type, e.g. SearchResponse.
+    template <typename ResponseType>
+    struct Result: public Response
+    {
+        /// \brief The parsed response.
+        ResponseType response;
+    };
 
-//    /// \brief Execute a Media Upload Request with a path to a file.
-//    ///
-//    /// This method does not post a status update but completes a media upload.
-//    /// The MediaUploadResponse contains the media id that can be referenced in
-//    /// a subsequent updateStatus() request.
-//    ///
-//    /// \param path The path the media that should be uploaded.
-//    /// \returns a unique pointer to a MediaUploadResponse.
-//    std::unique_ptr<MediaUploadResponse> uploadMedia(const std::string& path);
-//
-//
-//    /// \brief Execute a Media Upload Request with uncompressed pixels.
-//    ///
-//    /// The uncompressed pixels will be compressed and base64-encoded according
-//    /// to the \p format and \p quality parameters.
-//    ///
-//    /// This method does not post a status update but completes a media upload.
-//    /// The MediaUploadResponse contains the media id that can be referenced in
-//    /// a subsequent updateStatus() request.
-//    ///
-//    /// \param pixels The image pixels to send.
-//    /// \param format The image format to encode.
-//    /// \param quality The compression quality.
-//    /// \returns a unique pointer to a MediaUploadResponse.
-//    std::unique_ptr<MediaUploadResponse> uploadMedia(const ofPixels& pixels,
-//                                                     ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
-//                                                     ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
-//
-//    /// \brief Update a Twitter Status.
-//    ///
-//    /// This is a simple status update with no additional parameters set.
-//    ///
-//    /// \param status The status update to send.
-//    /// \returns a unique pointer to a StatusUpdateResponse.
-//    std::unique_ptr<StatusUpdateResponse> updateStatus(const std::string& status);
-//
-//
-//    /// \brief Update a Twitter Status and include a image or other media.
-//    ///
-//    /// This combines MediaUploadRequest and a StatusUpdateRequest allowing the
-//    /// user to upload a file and set a Twitter status with one function. This
-//    /// method does not require and additional call to uploadMedia.
-//    ///
-//    /// \param status The status update to send.
-//    /// \param path The path the media that should be uploaded.
-//    /// \returns a unique pointer to a StatusUpdateResponse.
-//    std::unique_ptr<StatusUpdateResponse> updateStatus(const std::string& status,
-//                                                       const std::string& path);
-//
-//    /// \brief Update a Twitter Status and include a image or other media.
-//    ///
-//    /// This combines MediaUploadRequest and a StatusUpdateRequest allowing the
-//    /// user to compress and encode raw pixels and upload and reference them
-//    /// and set Twitter status with one function. This method does not require
-//    /// and additional call to uploadMedia.
-//    ///
-//    /// \param status The status update to send.
-//    /// \param pixels The image pixels to send.
-//    /// \param format The image format to encode.
-//    /// \param quality The compression quality.
-//    /// \returns a unique pointer to a StatusUpdateResponse.
-//    std::unique_ptr<StatusUpdateResponse> updateStatus(const std::string& status,
-//                                                       const ofPixels& pixels,
-//                                                       ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
-//                                                       ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
-
-//};
+    /// \brief A function that executes a request.
+    ///
+    /// The function may be called concurrently from several threads. It
+    /// reports network failures by throwing. The parameters are the query
+    /// or URL-encoded form parameters to sign the request with.
+    typedef std::function<Response(HTTP::Request& request,
+                                   const OAuth10Signer::EncodedParameters& parameters)> Transport;
+
+    /// \brief Create a RESTClient with the given credentials.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param maxConnections The maximum number of concurrent connections.
+    RESTClient(const HTTP::OAuth10Credentials& credentials,
+               std::size_t maxConnections = DEFAULT_MAX_CONNECTIONS);
+
+    /// \brief Create a RESTClient that routes requests through a pool.
+    ///
+    /// Each request is sent with the pooled credentials that have the most
+    /// budget left for its endpoint. If all of them are exhausted the
+    /// request fails with status 429 without being sent.
+    ///
+    /// \param credentialPool The credentials to use.
+    /// \param maxConnections The maximum number of concurrent connections.
+    RESTClient(std::shared_ptr<CredentialPool> credentialPool,
+               std::size_t maxConnections = DEFAULT_MAX_CONNECTIONS);
+
+    /// \brief Create a RESTClient with a custom transport.
+    /// \param transport The function that executes requests.
+    /// \param maxConnections The maximum number of concurrent requests.
+    RESTClient(Transport transport,
+               std::size_t maxConnections = DEFAULT_MAX_CONNECTIONS);
+
+    /// \brief Destroy the RESTClient.
+    ///
+    /// Requests that have already been submitted are completed first.
+    ~RESTClient();
+
+    /// \brief Submit a request.
+    ///
+    /// Form fields are not read from the request, so the parameters sent in
+    /// its query or URL-encoded body must be passed to be signed, e.g. from
+    /// StatusUpdateRequest::formParameters().
+    ///
+    /// \tparam ResponseType The type to parse the response into.
+    /// \param request The request to execute.
+    /// \param parameters The parameters to sign that are not part of the
+    /// request URI.
+    /// \returns a future result.
+    template <typename ResponseType>
+    std::future<Result<ResponseType>> submit(std::unique_ptr<HTTP::Request> request,
+                                             const OAuth10Signer::EncodedParameters& parameters = OAuth10Signer::EncodedParameters());
+
+    /// \brief Submit a request with a completion callback.
+    ///
+    /// The callback is invoked on a pool thread.
+    ///
+    /// \tparam ResponseType The type to parse the response into.
+    /// \param request The request to execute.
+    /// \param callback The function to call with the result.
+    /// \param parameters The parameters to sign that are not part of the
+    /// request URI.
+    template <typename ResponseType>
+    void submit(std::unique_ptr<HTTP::Request> request,
+                std::function<void(const Result<ResponseType>&)> callback,
+                const OAuth10Signer::EncodedParameters& parameters = OAuth10Signer::EncodedParameters());
+
+    /// \brief Execute a basic Twitter Search query.
+    /// \param query The search string to send.
+    /// \returns a future search result.
+    std::future<Result<SearchResponse>> search(const std::string& query);
+
+    /// \brief Execute a Twitter Search query.
+    /// \param query The search query to send.
+    /// \returns a future search result.
+    std::future<Result<SearchResponse>> search(const SearchQuery& query);
+
+    /// \brief Update a Twitter status.
+    /// \param status The status text.
+    /// \returns a future status update result.
+    std::future<Result<StatusUpdateResponse>> updateStatus(const std::string& status);
+
+    /// \brief Update a Twitter status.
+    /// \param request The status update request.
+    /// \returns a future status update result.
+    std::future<Result<StatusUpdateResponse>> updateStatus(std::unique_ptr<StatusUpdateRequest> request);
+
+    /// \brief Upload a media file.
+    ///
+    /// The MediaUploadResponse contains the media id that can be referenced
+    /// in a subsequent updateStatus() request.
+    ///
+    /// \param path The path the media that should be uploaded.
+    /// \returns a future media upload result.
+    std::future<Result<MediaUploadResponse>> uploadMedia(const std::string& path);
+
+    /// \brief Upload uncompressed pixels.
+    ///
+    /// The pixels are encoded on the calling thread into buffers that are
+    /// reused across uploads.
+    ///
+    /// \param pixels The image pixels to send.
+    /// \param format The image format to encode.
+    /// \param quality The compression quality.
+    /// \returns a future media upload result.
+    std::future<Result<MediaUploadResponse>> uploadMedia(const ofPixels& pixels,
+                                                         ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
+                                                         ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
+
+    /// \brief Look up up to 100 users by id.
+    /// \sa LookupBatcher
+    /// \param userIds The user ids.
+    /// \returns a future user lookup result.
+    std::future<Result<UserLookupResponse>> lookupUsers(const std::vector<int64_t>& userIds);
+
+    /// \brief Look up up to 100 statuses by id.
+    /// \sa LookupBatcher
+    /// \param statusIds The status ids.
+    /// \returns a future status lookup result.
+    std::future<Result<StatusLookupResponse>> lookupStatuses(const std::vector<int64_t>& statusIds);
+
+    /// \returns the last rate limit reported by any endpoint.
+    RateLimit rateLimit() const;
+
+    /// \returns the maximum number of concurrent connections.
+    std::size_t maxConnections() const;
+
+    /// \brief Execute a request with an HTTP client.
+    /// \param client The client to execute the request with. The request is
+    /// sent as is, so it must be signed already unless the client signs it.
+    /// \param request The request to execute.
+    /// \returns the response.
+    /// \throws Poco::Exception on network failure.
+    static Response execute(HTTP::HTTPClient& client,
+                            HTTP::Request& request);
+
+    /// \brief The default maximum number of concurrent connections.
+    static const std::size_t DEFAULT_MAX_CONNECTIONS;
+
+private:
+    /// \brief Execute a request with the transport.
+    ///
+    /// Exceptions are reported in the response error.
+    ///
+    /// \param request The request to execute.
+    /// \param parameters The parameters to sign the request with.
+    /// \param response The response to fill.
+    void _execute(HTTP::Request& request,
+                  const OAuth10Signer::EncodedParameters& parameters,
+                  Response& response);
+
+    /// \brief Take an idle client from the pool or create a new one.
+    /// \returns the client.
+    std::unique_ptr<HTTP::HTTPClient> _acquireClient();
+
+    /// \brief Return a client to the pool.
+    /// \param client The client.
+    void _releaseClient(std::unique_ptr<HTTP::HTTPClient> client);
+
+    /// \brief The function that executes requests.
+    Transport _transport;
+
+    /// \brief The idle clients.
+    std::vector<std::unique_ptr<HTTP::HTTPClient>> _clients;
+
+    /// \brief The last reported rate limit.
+    RateLimit _rateLimit;
+
+    /// \brief Guards the clients and rate limit.
+    mutable std::mutex _mutex;
+
+    /// \brief The encoder of uploaded pixels.
+    ImageEncoder _encoder;
+
+    /// \brief The request executor.
+    ///
+    /// Declared last so that pending tasks complete before the members they
+    /// use are destroyed.
+    ThreadPool _pool;
+
+};
+
+
+template <typename ResponseType>
+std::future<RESTClient::Result<ResponseType>> RESTClient::submit(std::unique_ptr<HTTP::Request> request,
+                                                                 const OAuth10Signer::EncodedParameters& parameters)
+{
+    auto promise = std::make_shared<std::promise<Result<ResponseType>>>();
+    auto future = promise->get_future();
+
+    submit<ResponseType>(std::move(request), [promise](const Result<ResponseType>& result)
+    {
+        promise->set_value(result);
+    }, parameters);
+
+    return future;
+}
+
+
+template <typename ResponseType>
+void RESTClient::submit(std::unique_ptr<HTTP::Request> request,
+                        std::function<void(const Result<ResponseType>&)> callback,
+                        const OAuth10Signer::EncodedParameters& parameters)
+{
+    // Tasks must be copyable, so the request is shared with the task.
+    std::shared_ptr<HTTP::Request> sharedRequest(std::move(request));
+
+    _pool.execute([this, sharedRequest, callback, parameters]()
+    {
+        Result<ResponseType> result;
+
+        _execute(*sharedRequest, parameters, result);
+
+        // Some endpoints, e.g. users/lookup, respond with a JSON array.
+        if (!result.json.is_null())
+        {
+            try
+            {
+                result.response = ResponseType::fromJSON(result.json);
+            }
+            catch (const std::exception& exc)
+            {
+                result.error = exc.what();
+            }
+        }
+
+        if (callback) callback(result);
+    });
+}
 
 
 } } // namespace ofx::Twitter
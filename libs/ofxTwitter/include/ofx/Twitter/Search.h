@@ -13,6 +13,7 @@
 #include "ofx/Twitter/Error.h"
 #include "ofx/Twitter/BaseResponse.h"
 #include "ofx/Twitter/Status.h"
+#include "ofx/Twitter/StatusBatch.h"
 
 
 namespace ofx {
@@ -86,7 +87,7 @@ public:
 
     std::size_t count() const;
 
-    std::string query() const;
+    const std::string& query() const;
 
     int64_t maxId() const;
 
@@ -122,19 +123,33 @@ public:
     virtual ~SearchResponse();
 
     /// \returns any resulting statuses.
-    std::vector<Status> statuses() const;
+    const std::vector<Status>& statuses() const;
 
     /// \returns the metadata associated with the response.
-    SearchMetadata metadata() const;
+    const SearchMetadata& metadata() const;
 
     /// \returns any errors associated with the response.
-    std::vector<Error> errors() const;
+    const std::vector<Error>& errors() const;
 
     /// \brief Deserialize a SearchResponse from JSON.
     /// \param json JSON representing a search result.
     /// \returns a deserialized SearchResponse.
     static SearchResponse fromJSON(const ofJson& json);
 
+    /// \brief Deserialize a SearchResponse, decoding statuses into a batch.
+    ///
+    /// Each status is moved into the batch as it is decoded, so the response
+    /// itself holds no statuses.
+    ///
+    /// \param json JSON representing a search result.
+    /// \param batch The batch to append the statuses to.
+    /// \param sinceId Statuses with an id less than or equal to this are
+    /// skipped.
+    /// \returns a deserialized SearchResponse without statuses.
+    static SearchResponse fromJSON(const ofJson& json,
+                                   StatusBatch& batch,
+                                   int64_t sinceId = -1);
+
 private:
     std::vector<Status> _statuses;
     SearchMetadata _metadata;
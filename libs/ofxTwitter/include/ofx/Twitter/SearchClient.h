@@ -11,6 +11,8 @@
 #include "ofx/HTTP/OAuth10HTTPClient.h"
 #include "ofx/IO/PollingThread.h"
 #include "ofx/IO/ThreadChannel.h"
+#include "ofx/Twitter/ClientMetrics.h"
+#include "ofx/Twitter/CredentialPool.h"
 #include "ofx/Twitter/Error.h"
 #include "ofx/Twitter/Search.h"
 #include "ofx/Twitter/Status.h"
@@ -24,6 +26,9 @@ namespace Twitter {
 class BaseSearchClient: public IO::PollingThread
 {
 public:
+    /// \brief A function that receives the statuses of a search as a batch.
+    typedef std::function<void(StatusBatch&&)> BatchSink;
+
     /// \brief Create a default BaseSearchClient.
     BaseSearchClient();
 
@@ -51,6 +56,29 @@ public:
     /// \returns the current credentials.
     HTTP::OAuth10Credentials getCredentials() const;
 
+    /// \brief Route searches through a CredentialPool.
+    ///
+    /// Each search is sent with the pooled credentials that have the most
+    /// search budget left instead of the client's own credentials. While all
+    /// of them are exhausted, searches are skipped and reported as an Error
+    /// with code 88, "Rate limit exceeded".
+    ///
+    /// \param credentialPool The pool, or nullptr to use the client's
+    /// credentials.
+    void setCredentialPool(std::shared_ptr<CredentialPool> credentialPool);
+
+    /// \returns the credential pool, or nullptr if none is set.
+    std::shared_ptr<CredentialPool> credentialPool() const;
+
+    /// \brief Collect the statuses of each search into a StatusBatch.
+    ///
+    /// When a sink is set, the statuses of each search response are decoded
+    /// directly into a StatusBatch instead of being delivered to the status
+    /// callback, and the batch is passed to the sink on the search thread.
+    ///
+    /// \param sink The batch sink, or nullptr to deliver statuses one by one.
+    void setBatchSink(BatchSink sink);
+
     /// \brief Execute a basic Twitter Search query.
     ///
     /// Results are returned via callback functions.
@@ -74,6 +102,14 @@ public:
     /// \returns the last rate limit information if available.
     RateLimit rateLimit() const;
 
+    /// \brief Get the runtime metrics for this client.
+    ///
+    /// The metrics are updated lock-free from the search thread and may be
+    /// read from any thread.
+    ///
+    /// \returns the client metrics.
+    const ClientMetrics& metrics() const;
+
     /// \brief The BaseSearchClient user agent.
     ///
     /// Both the `User-Agent` and `X-User-Agent` are set to this value.
@@ -91,6 +127,9 @@ protected:
 
     uint64_t _lastMessageTime = 0;
 
+    /// \brief The runtime metrics.
+    ClientMetrics _metrics;
+
 private:
     void _run();
 
@@ -102,6 +141,12 @@ private:
     HTTP::OAuth10Credentials _credentials;
     HTTP::OAuth10HTTPClient _client;
 
+    /// \brief The optional credential pool.
+    std::shared_ptr<CredentialPool> _credentialPool;
+
+    /// \brief The batch sink, or nullptr to deliver statuses one by one.
+    BatchSink _batchSink;
+
 };
 
 
@@ -160,6 +205,14 @@ private:
     void _update(ofEventArgs& args);
     void _exit(ofEventArgs& args);
 
+    /// \brief Receive all queued values and update the queue depth metrics.
+    /// \param channel The channel to receive from.
+    /// \param event The metrics event type carried by the channel.
+    /// \returns the received values.
+    template <typename T>
+    std::vector<T> _receiveAll(IO::ThreadChannel<T>& channel,
+                               ClientMetrics::Event event);
+
     virtual void _onStatus(const Status& status) override;
     virtual void _onError(const Error& error) override;
     virtual void _onException(const std::exception& exc) override;
@@ -178,6 +231,16 @@ private:
 };
 
 
+template <typename T>
+std::vector<T> SearchClient::_receiveAll(IO::ThreadChannel<T>& channel,
+                                         ClientMetrics::Event event)
+{
+    std::vector<T> values = channel.tryReceiveAll();
+    _metrics.removeQueued(event, values.size());
+    return values;
+}
+
+
 template <class ListenerClass>
 void SearchClient::registerSearchEvents(ListenerClass* listener,
                                         int priority)
@@ -0,0 +1,308 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "ofx/Twitter/FilterRuleManager.h"
+#include "ofx/Twitter/TrackMatcher.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A filter stream whose rules are spread across several connections.
+///
+/// A single filter connection allows at most MAX_TRACKS track phrases,
+/// MAX_FOLLOWS follows and MAX_LOCATIONS locations. The sharded client
+/// partitions a larger rule set across one connection per set of credentials,
+/// each managed by a FilterRuleManager so that rule edits do not open gaps.
+///
+/// The events of all shards are merged into one stream. Statuses are held for
+/// a short ordering delay and delivered in status id order, which follows
+/// creation time, and statuses delivered by more than one shard are passed to
+/// the sink only once. All sink callbacks are invoked on a single delivery
+/// thread.
+///
+/// Track phrases are assigned to shards by their observed volume, heaviest
+/// first, to the least loaded shard. The volume of each phrase is counted
+/// from the statuses it matches. When a shard reports undelivered statuses
+/// in a LimitNotice, the volume of its phrases is scaled up by the undelivered
+/// share and, at the next rebalance interval, the phrases of the limited
+/// shards are moved to the least loaded shards. Shards that were not limited
+/// keep their phrases, and a move is only made if it lowers the load of the
+/// heaviest shard by at least MIN_REBALANCE_IMPROVEMENT, since every move
+/// reconnects the shards involved.
+class ShardedStreamingClient
+{
+public:
+    /// \brief Create a ShardedStreamingClient.
+    /// \param credentials The credentials, one for each shard.
+    /// \param sink The sink to deliver events to.
+    /// \param orderingDelay The time statuses are held for ordering, in
+    /// milliseconds.
+    ShardedStreamingClient(const std::vector<HTTP::OAuth10Credentials>& credentials,
+                           StreamingSink* sink,
+                           uint64_t orderingDelay = DEFAULT_ORDERING_DELAY);
+
+    /// \brief Destroy the ShardedStreamingClient.
+    ///
+    /// All shards are stopped and their final events, such as their
+    /// disconnects, are delivered on the calling thread. Statuses still held
+    /// for ordering are dropped.
+    ~ShardedStreamingClient();
+
+    /// \brief Replace all rules.
+    ///
+    /// Rules beyond the combined capacity of the shards are dropped with an
+    /// error.
+    ///
+    /// \param tracks The track phrases.
+    /// \param follows The user ids to follow.
+    /// \param locations The locations to filter.
+    void setRules(const std::vector<std::string>& tracks,
+                  const std::vector<std::string>& follows = {},
+                  const std::vector<Geo::CoordinateBounds>& locations = {});
+
+    /// \brief Add a track phrase to the least loaded shard.
+    /// \param track The phrase to track.
+    void addTrack(const std::string& track);
+
+    /// \brief Remove a track phrase.
+    /// \param track The phrase to remove.
+    void removeTrack(const std::string& track);
+
+    /// \brief Move the track phrases of limited shards by their observed
+    /// volume now.
+    void rebalance();
+
+    /// \brief Set how often track phrases are rebalanced.
+    ///
+    /// Phrases are only rebalanced if a shard reported undelivered statuses
+    /// since the last rebalance.
+    ///
+    /// \param interval The interval in milliseconds, or 0 to disable.
+    void setRebalanceInterval(uint64_t interval);
+
+    /// \brief Open the shards' streams with a transport instead of the HTTP
+    /// client.
+    ///
+    /// The transport applies to streams opened after the call.
+    ///
+    /// \param transport The transport, or nullptr to use the HTTP client.
+    void setTransport(BaseStreamingClient::Transport transport);
+
+    /// \returns the number of shards.
+    std::size_t shardCount() const;
+
+    /// \param shard The shard index.
+    /// \returns the rules assigned to the shard.
+    FilterQuery shardQuery(std::size_t shard) const;
+
+    /// \returns the number of statuses matched by each track phrase since
+    /// the last rebalance.
+    std::map<std::string, uint64_t> trackVolumes() const;
+
+    /// \brief The maximum number of track phrases per connection.
+    static const std::size_t MAX_TRACKS;
+
+    /// \brief The maximum number of follows per connection.
+    static const std::size_t MAX_FOLLOWS;
+
+    /// \brief The maximum number of locations per connection.
+    static const std::size_t MAX_LOCATIONS;
+
+    /// \brief The default ordering delay in milliseconds.
+    static const uint64_t DEFAULT_ORDERING_DELAY;
+
+    /// \brief The default rebalance interval in milliseconds.
+    static const uint64_t DEFAULT_REBALANCE_INTERVAL;
+
+    /// \brief The minimum share by which a rebalance must lower the load of
+    /// the heaviest shard to be applied.
+    static const double MIN_REBALANCE_IMPROVEMENT;
+
+    /// \brief The number of recent status ids kept to remove duplicates.
+    static const std::size_t DEDUPLICATION_WINDOW;
+
+private:
+    /// \brief A connection and the sink that queues its events.
+    class Shard: public StreamingSink
+    {
+    public:
+        Shard(ShardedStreamingClient& client,
+              const HTTP::OAuth10Credentials& credentials);
+
+        virtual ~Shard();
+
+        virtual void onConnect() override;
+        virtual void onDisconnect() override;
+        virtual void onStatus(const Status& status) override;
+        virtual void onStatusDeletedNotice(const StatusDeletedNotice& notice) override;
+        virtual void onLocationDeletedNotice(const LocationDeletedNotice& notice) override;
+        virtual void onLimitNotice(const LimitNotice& notice) override;
+        virtual void onStatusWithheldNotice(const StatusWithheldNotice& notice) override;
+        virtual void onUserWitheldNotice(const UserWithheldNotice& notice) override;
+        virtual void onDisconnectNotice(const DisconnectNotice& notice) override;
+        virtual void onStallWarning(const StallWarning& notice) override;
+        virtual void onException(const std::exception& exc) override;
+        virtual void onMessage(const ofJson& message) override;
+        virtual bool wantsMessages() const override;
+
+    private:
+        ShardedStreamingClient& _client;
+
+    public:
+        /// \brief The assigned track phrases.
+        std::set<std::string> tracks;
+
+        /// \brief The assigned follows.
+        std::set<std::string> follows;
+
+        /// \brief The assigned locations.
+        std::vector<Geo::CoordinateBounds> locations;
+
+        /// \brief The estimated volume of the assigned track phrases.
+        double load = 0;
+
+        /// \brief The statuses delivered since the last rebalance.
+        uint64_t delivered = 0;
+
+        /// \brief The statuses undelivered since the last rebalance.
+        uint64_t undelivered = 0;
+
+        /// \brief The last cumulative LimitNotice count.
+        uint64_t lastLimit = 0;
+
+        /// \brief The rule manager, declared last so it stops first.
+        FilterRuleManager manager;
+
+    };
+
+    /// \brief A status waiting to be delivered in order.
+    struct PendingStatus
+    {
+        int64_t id = 0;
+        uint64_t releaseAt = 0;
+        std::shared_ptr<const Status> status;
+
+        bool operator > (const PendingStatus& other) const
+        {
+            return id > other.id;
+        }
+    };
+
+    /// \brief Assign track phrases to shards. Requires _mutex.
+    /// \param tracks The phrases.
+    /// \param weights The weight of each phrase.
+    void _assignTracks(const std::vector<std::string>& tracks,
+                       const std::map<std::string, double>& weights);
+
+    /// \brief Place track phrases on the least loaded shards, heaviest first.
+    /// \param tracks The phrases to place.
+    /// \param weights The weight of each phrase.
+    /// \param assignment The phrases of each shard, added to.
+    /// \param loads The load of each shard, added to.
+    /// \returns the number of phrases that did not fit.
+    static std::size_t _place(const std::vector<std::string>& tracks,
+                              const std::map<std::string, double>& weights,
+                              std::vector<std::set<std::string>>& assignment,
+                              std::vector<double>& loads);
+
+    /// \brief Send the assigned rules to the shards. Requires _mutex.
+    void _apply();
+
+    /// \brief Send the assigned rules to one shard. Requires _mutex.
+    /// \param shard The shard.
+    void _apply(Shard& shard);
+
+    /// \brief Rebalance track phrases. Requires _mutex.
+    void _rebalance();
+
+    /// \brief Queue a status for ordered delivery.
+    /// \param shard The shard that received the status.
+    /// \param status The status.
+    void _onStatus(Shard& shard, const Status& status);
+
+    /// \brief Record a LimitNotice.
+    /// \param shard The shard that received the notice.
+    /// \param notice The notice.
+    void _onLimitNotice(Shard& shard, const LimitNotice& notice);
+
+    /// \brief Queue an event for delivery.
+    /// \param event The event.
+    void _post(std::function<void(StreamingSink&)> event);
+
+    /// \brief Deliver events and rebalance until stopped.
+    void _run();
+
+    /// \returns the current steady time in milliseconds.
+    static uint64_t _now();
+
+    /// \brief The sink to deliver events to.
+    StreamingSink* _sink = nullptr;
+
+    /// \brief The ordering delay in milliseconds.
+    uint64_t _orderingDelay = DEFAULT_ORDERING_DELAY;
+
+    /// \brief The rebalance interval in milliseconds, or 0.
+    uint64_t _rebalanceInterval = DEFAULT_REBALANCE_INTERVAL;
+
+    /// \brief The time of the last rebalance.
+    uint64_t _rebalancedAt = 0;
+
+    /// \brief Matches statuses against all track phrases.
+    TrackMatcher _matcher;
+
+    /// \brief The statuses matched by each phrase since the last rebalance.
+    std::map<std::string, uint64_t> _volumes;
+
+    /// \brief Guards the rules, shard state and volumes.
+    mutable std::mutex _mutex;
+
+    /// \brief The statuses held for ordering.
+    std::priority_queue<PendingStatus, std::vector<PendingStatus>, std::greater<PendingStatus>> _statuses;
+
+    /// \brief The other events in arrival order.
+    std::deque<std::function<void(StreamingSink&)>> _events;
+
+    /// \brief The recently queued status ids.
+    std::unordered_set<int64_t> _seen;
+
+    /// \brief The recently queued status ids in order.
+    std::deque<int64_t> _seenOrder;
+
+    bool _stopping = false;
+
+    /// \brief Guards the delivery queues.
+    std::mutex _queueMutex;
+
+    /// \brief Signalled when events are queued.
+    std::condition_variable _condition;
+
+    /// \brief The shards, declared after the queues they post to.
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    /// \brief The delivery thread.
+    std::thread _thread;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -62,10 +62,10 @@ public:
     {
     public:
         /// returns the ISO language code.
-        std::string isoLanguageCode() const;
+        const std::string& isoLanguageCode() const;
 
         /// \todo Would be nice to return SearchRequest::RESULT_TYPE.
-        std::string resultType() const;
+        const std::string& resultType() const;
 
         /// \brief Parse a Metadata from the given JSON.
         /// \param json The JSON to parse.
@@ -79,6 +79,8 @@ public:
         /// \brief The result type.
         std::string _resultType;
 
+        friend class BinaryCodec;
+
     };
 
     /// \brief Create a default empty Status.
@@ -107,10 +109,10 @@ public:
     /// be detected.
     ///
     /// \returns the machine-detected language of the Tweet.
-    std::string language() const;
+    const std::string& language() const;
 
     /// \return the Tweet annotations.
-    Annotations annotations() const;
+    const Annotations& annotations() const;
 
     /// \brief Get a list of the controbutors.
     ///
@@ -121,7 +123,7 @@ public:
     /// \deprecated
     ///
     /// \returns the list of contributors.
-    std::vector<BaseNamedUser> contributors() const;
+    const std::vector<BaseNamedUser>& contributors() const;
 
     /// \returns the Tweet coordinates, or nullptr if none.
     const Geo::Coordinate* coordinates() const;
@@ -141,10 +143,10 @@ public:
     int64_t currentUserRetweet() const;
 
     /// \returns Entities which have been parsed out of the text of the Tweet.
-    Entities entities() const;
+    const Entities& entities() const;
 
     /// \returns Entities which have been parsed out of the text of the Tweet.
-    Entities extendedEntities() const;
+    const Entities& extendedEntities() const;
 
     /// \returns the extended Tweet or nullptr if none.
     const Status* extendedTweet() const;
@@ -183,7 +185,7 @@ public:
     FilterLevel filterLevel() const;
 
     /// \returns the screen name of the original Tweet's author, or empty.
-    std::string inReplyToScreenName() const;
+    const std::string& inReplyToScreenName() const;
 
     /// \returns the status id of the original Tweet's if retweeted, or -1.
     int64_t inReplyToStatusId() const;
@@ -206,7 +208,7 @@ public:
     /// the containing Tweet. Currently used by Twitter's Promoted Products.
     ///
     /// \returns the scopes of this Tweet.
-    std::map<std::string, bool> scopes() const;
+    const std::map<std::string, bool>& scopes() const;
 
     /// \returns the number of times this Tweet has been retweeted.
     int64_t retweetCount() const;
@@ -227,13 +229,13 @@ public:
     /// Tweets from the Twitter website have a source value of web.
     ///
     /// \returns the Tweet source.
-    std::string source() const;
+    const std::string& source() const;
 
     /// \returns the actual UTF-8 text of the status update.
-    std::string text() const;
+    const std::string& text() const;
 
     /// \returns the full text if this is an extended tweet.
-    std::string fullText() const;
+    const std::string& fullText() const;
 
     /// \returns the start index of the display text.
     std::string::size_type displayTextStart() const;
@@ -268,22 +270,39 @@ public:
     /// - "XY" - Content is withheld due to a DMCA request
     ///
     /// \returns the withheld in contries.
-    std::vector<std::string> withheldInCountries() const;
+    const std::vector<std::string>& withheldInCountries() const;
 
     /// \returns whether the witheld content is the "status" or a "user".
-    std::string withheldScope() const;
+    const std::string& withheldScope() const;
 
     /// \returns the optional Place data.
     const Place* place() const;
 
     /// \returns the Status metadata.
-    Metadata metadata() const;
+    const Metadata& metadata() const;
 
     /// \returns the streaming timestamp in milliseconds.
     uint64_t timestamp() const;
 
     /// \returns the original json.
-    ofJson json() const;
+    const ofJson& json() const;
+
+    /// \brief Get the track rules matched by this Status.
+    ///
+    /// This is only populated when the Status was annotated by a
+    /// TrackMatcher, e.g. by a streaming client with track matching enabled.
+    ///
+    /// \returns the ids of the matched rules in ascending order.
+    const std::vector<std::size_t>& matchedTrackRules() const;
+
+    /// \brief Get the location bounding boxes that contain this Status.
+    ///
+    /// This is only populated when the Status was annotated by a
+    /// LocationMatcher, e.g. by a streaming client with location matching
+    /// enabled.
+    ///
+    /// \returns the ids of the containing boxes in ascending order.
+    const std::vector<std::size_t>& matchedLocations() const;
 
     /// \brief Parse a Status from the given JSON.
     /// \param json The JSON to parse.
@@ -469,6 +488,17 @@ protected:
     /// \brief The original json.
     ofJson _json;
 
+    /// \brief The track rules matched by this Status.
+    std::vector<std::size_t> _matchedTrackRules;
+
+    /// \brief The location bounding boxes that contain this Status.
+    std::vector<std::size_t> _matchedLocations;
+
+    friend class TrackMatcher;
+    friend class LocationMatcher;
+    friend class BinaryCodec;
+    friend class StatusBatch;
+
 };
 
 
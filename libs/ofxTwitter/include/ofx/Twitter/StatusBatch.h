@@ -0,0 +1,230 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ofJson.h"
+#include "ofx/Twitter/Entities.h"
+#include "ofx/Twitter/Place.h"
+#include "ofx/Twitter/Status.h"
+#include "ofx/Twitter/User.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A structure-of-arrays container of statuses.
+///
+/// The scalar fields used for sorting and ranking are stored in contiguous
+/// arrays, one per field, so scanning a field across many statuses only
+/// touches that field's memory. The remaining data (text, user, entities,
+/// place and JSON) is kept in a side table indexed by the same row.
+///
+/// Appending an rvalue Status moves its cold data into the batch, so
+/// deserializers can fill a batch without copying, e.g.
+///
+///     ofxTwitter::StatusBatch batch;
+///     batch.append(ofxTwitter::Status::fromJSON(json));
+///
+/// The streaming and search clients can fill batches directly, see
+/// BaseStreamingClient::setBatchSink() and BaseSearchClient::setBatchSink().
+///
+/// Counts that are unknown (-1 in Status) are stored as -1.
+class StatusBatch
+{
+public:
+    /// \brief The fields that rows can be ordered by.
+    enum class Key
+    {
+        /// \brief The status id.
+        ID,
+        /// \brief The creation time.
+        CREATED_AT,
+        /// \brief The stream timestamp.
+        TIMESTAMP,
+        /// \brief The favorite count.
+        FAVORITE_COUNT,
+        /// \brief The retweet count.
+        RETWEET_COUNT,
+        /// \brief The quote count.
+        QUOTE_COUNT,
+        /// \brief The reply count.
+        REPLY_COUNT,
+        /// \brief The sum of the known favorite, retweet, quote and reply
+        /// counts.
+        ENGAGEMENT
+    };
+
+    /// \brief Boolean properties stored in the flags column.
+    enum Flag: uint8_t
+    {
+        /// \brief The status is a retweet.
+        RETWEET = 1 << 0,
+        /// \brief The status is a quote tweet.
+        QUOTE = 1 << 1,
+        /// \brief The status is a reply.
+        REPLY = 1 << 2,
+        /// \brief The status has exact coordinates.
+        COORDINATES = 1 << 3,
+        /// \brief The status may link to sensitive content.
+        POSSIBLY_SENSITIVE = 1 << 4,
+        /// \brief The status has an extended tweet.
+        EXTENDED = 1 << 5
+    };
+
+    /// \brief Append a status.
+    /// \param status The status to copy.
+    /// \returns the row of the status.
+    std::size_t append(const Status& status);
+
+    /// \brief Append a status, moving its cold data into the batch.
+    /// \param status The status to consume.
+    /// \returns the row of the status.
+    std::size_t append(Status&& status);
+
+    /// \brief Append all rows of another batch.
+    /// \param batch The batch to consume.
+    void append(StatusBatch&& batch);
+
+    /// \brief Reserve space for a number of rows.
+    /// \param rows The expected number of rows.
+    void reserve(std::size_t rows);
+
+    /// \returns the number of rows.
+    std::size_t size() const;
+
+    /// \returns true if the batch has no rows.
+    bool empty() const;
+
+    /// \brief Remove all rows.
+    void clear();
+
+    /// \returns the status ids.
+    const std::vector<int64_t>& ids() const;
+
+    /// \returns the creation times in milliseconds since the Unix epoch.
+    const std::vector<int64_t>& createdAt() const;
+
+    /// \returns the stream timestamps in milliseconds since the Unix epoch.
+    const std::vector<uint64_t>& timestamps() const;
+
+    /// \returns the favorite counts.
+    const std::vector<int64_t>& favoriteCounts() const;
+
+    /// \returns the retweet counts.
+    const std::vector<int64_t>& retweetCounts() const;
+
+    /// \returns the quote counts.
+    const std::vector<int64_t>& quoteCounts() const;
+
+    /// \returns the reply counts.
+    const std::vector<int64_t>& replyCounts() const;
+
+    /// \returns the author ids, or -1 where the user is missing.
+    const std::vector<int64_t>& userIds() const;
+
+    /// \returns the Flag bits of each row.
+    const std::vector<uint8_t>& flags() const;
+
+    /// \returns true if the row has all of the given flags.
+    bool has(std::size_t row, uint8_t flags) const;
+
+    /// \returns the full text of the row's status.
+    const std::string& text(std::size_t row) const;
+
+    /// \returns the author of the row's status, or nullptr.
+    const User* user(std::size_t row) const;
+
+    /// \returns the entities of the row's status, taken from the extended
+    /// tweet when present.
+    const Entities& entities(std::size_t row) const;
+
+    /// \returns the place of the row's status, or nullptr.
+    const Place* place(std::size_t row) const;
+
+    /// \returns the original JSON of the row's status.
+    const ofJson& json(std::size_t row) const;
+
+    /// \brief Get the rows ordered by a key.
+    ///
+    /// Rows with equal keys keep their relative order.
+    ///
+    /// \param key The key to order by.
+    /// \param descending True to order from largest to smallest.
+    /// \returns the ordered row indices.
+    std::vector<std::size_t> sortedRows(Key key, bool descending = true) const;
+
+    /// \brief Get the rows with the largest keys.
+    /// \param key The key to rank by.
+    /// \param count The maximum number of rows to return.
+    /// \returns the row indices, from largest to smallest key.
+    std::vector<std::size_t> top(Key key, std::size_t count) const;
+
+    /// \brief Reorder the rows of the batch by a key.
+    /// \param key The key to order by.
+    /// \param descending True to order from largest to smallest.
+    void sort(Key key, bool descending = true);
+
+    /// \brief Remove rows with a stream timestamp older than a cutoff.
+    ///
+    /// The remaining rows keep their relative order.
+    ///
+    /// \param timestamp The cutoff in milliseconds since the Unix epoch.
+    /// \returns the number of rows removed.
+    std::size_t evictBefore(uint64_t timestamp);
+
+private:
+    /// \brief The cold data of a row.
+    struct Cold
+    {
+        std::string text;
+        std::shared_ptr<User> user;
+        Entities entities;
+        std::shared_ptr<Place> place;
+        ofJson json;
+    };
+
+    /// \brief Append the hot fields of a status.
+    void _appendHot(const Status& status);
+
+    /// \brief Call a function with the column of a key.
+    ///
+    /// Stored columns are passed by reference. Only the derived ENGAGEMENT
+    /// key is computed into a temporary column.
+    ///
+    /// \param key The key.
+    /// \param function The function to call with the column.
+    /// \returns the rows returned by the function.
+    template <typename Function>
+    std::vector<std::size_t> _withKeys(Key key, Function function) const;
+
+    /// \brief Keep only the given rows, in the given order.
+    void _select(const std::vector<std::size_t>& rows);
+
+    std::vector<int64_t> _ids;
+    std::vector<int64_t> _createdAt;
+    std::vector<uint64_t> _timestamps;
+    std::vector<int64_t> _favoriteCounts;
+    std::vector<int64_t> _retweetCounts;
+    std::vector<int64_t> _quoteCounts;
+    std::vector<int64_t> _replyCounts;
+    std::vector<int64_t> _userIds;
+    std::vector<uint8_t> _flags;
+
+    /// \brief The cold data, indexed by row.
+    std::vector<Cold> _cold;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ofImage.h"
+#include "ofx/Twitter/ChunkedMediaUpload.h"
+#include "ofx/Twitter/ImageEncoder.h"
+#include "ofx/Twitter/StatusUpdate.h"
+#include "ofx/Twitter/ThreadPool.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Posts statuses with media in one call.
+///
+/// The media of a post is encoded and uploaded concurrently on a worker
+/// pool. When the last upload finishes, the same worker posts the status
+/// with the collected media ids in their original order. No thread waits on
+/// another, so the post takes roughly as long as the slowest upload plus the
+/// status update.
+///
+/// Usage:
+///
+///     ofxTwitter::StatusPoster poster(credentials);
+///     std::future<ofxTwitter::Status> result = poster.postImages("Hello!", images);
+///     ...
+///     ofxTwitter::Status status = result.get(); // Throws if posting failed.
+class StatusPoster
+{
+public:
+    /// \brief A function that executes a status update.
+    ///
+    /// The function returns the response JSON and reports failures by
+    /// throwing. It may be called from several threads at once.
+    typedef std::function<ofJson(StatusUpdateRequest& request)> PostTransport;
+
+    /// \brief Create a StatusPoster with the given credentials.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param maxConcurrency The maximum number of concurrent uploads.
+    StatusPoster(const HTTP::OAuth10Credentials& credentials,
+                 std::size_t maxConcurrency = DEFAULT_MAX_CONCURRENCY);
+
+    /// \brief Create a StatusPoster with custom transports.
+    /// \param uploadTransport The function that executes upload commands.
+    /// \param postTransport The function that executes status updates.
+    /// \param maxConcurrency The maximum number of concurrent uploads.
+    StatusPoster(ChunkedMediaUpload::Transport uploadTransport,
+                 PostTransport postTransport,
+                 std::size_t maxConcurrency = DEFAULT_MAX_CONCURRENCY);
+
+    /// \brief Destroy the StatusPoster.
+    ///
+    /// Posts in progress are completed first.
+    ~StatusPoster();
+
+    /// \brief Post a status with media files.
+    /// \param status The status text.
+    /// \param media The paths of the media files, up to 4 photos or 1 GIF or
+    /// 1 video.
+    /// \returns a future for the posted status.
+    std::future<Status> post(const std::string& status,
+                             const std::vector<std::filesystem::path>& media = {});
+
+    /// \brief Post a status update with media files.
+    /// \param request The status update. Media ids are set when posting.
+    /// \param media The paths of the media files.
+    /// \returns a future for the posted status.
+    std::future<Status> post(std::unique_ptr<StatusUpdateRequest> request,
+                             const std::vector<std::filesystem::path>& media);
+
+    /// \brief Post a status with images.
+    ///
+    /// The images are encoded on the worker pool.
+    ///
+    /// \param status The status text.
+    /// \param images The images to encode and upload.
+    /// \param format The image format to encode.
+    /// \param quality The compression quality.
+    /// \returns a future for the posted status.
+    std::future<Status> postImages(const std::string& status,
+                                   std::vector<ofPixels> images,
+                                   ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
+                                   ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
+
+    /// \brief Post a status update with images.
+    /// \param request The status update. Media ids are set when posting.
+    /// \param images The images to encode and upload.
+    /// \param format The image format to encode.
+    /// \param quality The compression quality.
+    /// \returns a future for the posted status.
+    std::future<Status> postImages(std::unique_ptr<StatusUpdateRequest> request,
+                                   std::vector<ofPixels> images,
+                                   ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
+                                   ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
+
+    /// \returns the media uploader, e.g. to adjust its chunk size.
+    ChunkedMediaUpload& uploader();
+
+    /// \brief Execute a status update over HTTP.
+    /// \param credentials The OAuth 1.0 credentials to use.
+    /// \param request The status update.
+    /// \returns the response JSON.
+    /// \throws Poco::Exception if the request fails.
+    static ofJson execute(const HTTP::OAuth10Credentials& credentials,
+                          StatusUpdateRequest& request);
+
+    /// \brief The default maximum number of concurrent uploads.
+    static const std::size_t DEFAULT_MAX_CONCURRENCY;
+
+private:
+    /// \brief A post waiting for its uploads.
+    struct Post
+    {
+        std::unique_ptr<StatusUpdateRequest> request;
+        std::vector<int64_t> mediaIds;
+        std::size_t remaining = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::promise<Status> promise;
+    };
+
+    /// \brief A function that uploads one media item and returns its id.
+    typedef std::function<int64_t()> Upload;
+
+    /// \brief Run the uploads of a post, then post it.
+    std::future<Status> _post(std::unique_ptr<StatusUpdateRequest> request,
+                              std::vector<Upload> uploads);
+
+    /// \brief Post the status once all uploads have finished.
+    void _finish(std::shared_ptr<Post> post);
+
+    /// \brief The media uploader.
+    ChunkedMediaUpload _uploader;
+
+    /// \brief The encoder of image posts.
+    ImageEncoder _encoder;
+
+    /// \brief The function that executes status updates.
+    PostTransport _postTransport;
+
+    /// \brief The upload threads.
+    ///
+    /// Declared last so its threads are joined before the state they use is
+    /// destroyed.
+    ThreadPool _pool;
+
+};
+
+
+} } // namespace ofx::Twitter
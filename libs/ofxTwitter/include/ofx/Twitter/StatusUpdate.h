@@ -12,6 +12,7 @@
 #include "ofx/HTTP/PostRequest.h"
 #include "ofx/Twitter/BaseResponse.h"
 #include "ofx/Twitter/Error.h"
+#include "ofx/Twitter/OAuth10Signer.h"
 #include "ofx/Twitter/Status.h"
 
 
@@ -126,30 +127,43 @@ public:
     /// \param id The media id to reference.
     void setMediaId(int64_t id);
 
+    /// \returns the form fields, encoded to sign the request with.
+    OAuth10Signer::EncodedParameters formParameters() const;
+
     /// \brief The endpoint URL.
     static const std::string RESOURCE_URL;
 };
 
 
-class StatusUpdateResponse//: public BaseResponse<StatusUpdateRequest>
+/// \brief A Twitter StatusUpdateResponse.
+class StatusUpdateResponse
 {
 public:
-//    using BaseResponse<StatusUpdateRequest>::BaseResponse;
+    /// \brief Create an empty StatusUpdateResponse.
+    StatusUpdateResponse();
 
+    /// \brief Destroy the StatusUpdateResponse.
     virtual ~StatusUpdateResponse();
 
     /// \returns the posted status if successful.
-    Status status() const;
+    const Status& status() const;
+
+    /// \returns the errors reported by the request.
+    const std::vector<Error>& errors() const;
 
-protected:
-    virtual void parseJSON(const ofJson& json);// override;
+    /// \brief Deserialize a StatusUpdateResponse from JSON.
+    /// \param json The JSON representing the StatusUpdateResponse.
+    /// \returns the StatusUpdateResponse.
+    static StatusUpdateResponse fromJSON(const ofJson& json);
 
 private:
+    /// \brief The posted status.
     Status _status;
 
-};
-
+    /// \brief The errors.
+    std::vector<Error> _errors;
 
+};
 
 
 } } // namespace ofx::Twitter
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <string>
+#include "ofJson.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Identifies the type of a raw Streaming API message.
+///
+/// Every streaming message is a single JSON object. Notices wrap their
+/// payload in an object under a single well-known key (e.g. `limit` or
+/// `delete`) and statuses begin with `created_at`, so the type can almost
+/// always be determined from the first key without building a DOM. Since
+/// other objects may also begin with `created_at`, a STATUS is only a hint
+/// that must be confirmed once the message is parsed.
+///
+/// \sa https://dev.twitter.com/streaming/overview/messages-types
+class StreamMessage
+{
+public:
+    /// \brief The known message types.
+    enum class Type
+    {
+        /// \brief A blank keep-alive line.
+        KEEP_ALIVE,
+        /// \brief A Status.
+        STATUS,
+        /// \brief A StatusDeletedNotice.
+        STATUS_DELETED_NOTICE,
+        /// \brief A LocationDeletedNotice.
+        LOCATION_DELETED_NOTICE,
+        /// \brief A LimitNotice.
+        LIMIT_NOTICE,
+        /// \brief A StatusWithheldNotice.
+        STATUS_WITHHELD_NOTICE,
+        /// \brief A UserWithheldNotice.
+        USER_WITHHELD_NOTICE,
+        /// \brief A DisconnectNotice.
+        DISCONNECT_NOTICE,
+        /// \brief A StallWarning.
+        STALL_WARNING,
+        /// \brief A message that could not be identified from its first key.
+        UNKNOWN
+    };
+
+    /// \brief Classify a raw message by its first object key.
+    ///
+    /// This only scans the leading bytes of the message and never parses
+    /// the full JSON. A return value of UNKNOWN means that the message must
+    /// be parsed and passed to classify(const ofJson&).
+    ///
+    /// \param message The raw message line.
+    /// \returns the message type.
+    static Type classify(const std::string& message);
+
+    /// \brief Locate the value of a notice without parsing it.
+    ///
+    /// Notices wrap their payload in an object under a single key. This
+    /// finds the bounds of that object so that it can be parsed on its own.
+    ///
+    /// \param message The raw message line.
+    /// \param begin Set to the offset of the first byte of the value.
+    /// \param end Set to the offset one past the last byte of the value.
+    /// \returns true if the message is an object with a single key whose
+    /// value is an object.
+    static bool payload(const std::string& message,
+                        std::size_t& begin,
+                        std::size_t& end);
+
+    /// \brief Classify a parsed message by probing for known keys.
+    ///
+    /// This is the fallback for messages that classify(const std::string&)
+    /// could not identify.
+    ///
+    /// \param json The parsed message.
+    /// \returns the message type, or UNKNOWN if the message is not recognized.
+    static Type classify(const ofJson& json);
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -14,10 +14,14 @@
 #include "ofx/HTTP/OAuth10HTTPClient.h"
 #include "ofx/IO/Thread.h"
 #include "ofx/IO/ThreadChannel.h"
+#include "ofx/Twitter/ClientMetrics.h"
 #include "ofx/Twitter/Notices.h"
 #include "ofx/Twitter/Status.h"
+#include "ofx/Twitter/StatusBatch.h"
 #include "ofx/Twitter/SampleQuery.h"
 #include "ofx/Twitter/FilterQuery.h"
+#include "ofx/Twitter/LocationMatcher.h"
+#include "ofx/Twitter/TrackMatcher.h"
 
 
 namespace ofx {
@@ -44,6 +48,15 @@ public:
         // SITE
     };
 
+    /// \brief A function that receives a batch of decoded statuses.
+    typedef std::function<void(StatusBatch&&)> BatchSink;
+
+    /// \brief A function that opens a stream.
+    ///
+    /// It returns the body of a successful response, or throws if the stream
+    /// could not be opened.
+    typedef std::function<std::unique_ptr<std::istream>(HTTP::Request& request)> Transport;
+
     /// \brief Create a default BaseStreamingClient.
     BaseStreamingClient();
 
@@ -118,6 +131,78 @@ public:
     /// \returns the current stream parameters.
     Poco::Net::NameValueCollection parameters() const;
 
+    /// \brief Enable or disable track rule matching.
+    ///
+    /// When enabled, each filter or user stream compiles its `track`
+    /// parameter into a TrackMatcher and every received Status is annotated
+    /// with the ids of the track phrases it matched. See
+    /// Status::matchedTrackRules(). The setting takes effect on the next call
+    /// to filter() or user().
+    ///
+    /// \param value True to enable track matching.
+    void setTrackMatchingEnabled(bool value);
+
+    /// \returns true if track rule matching is enabled.
+    bool isTrackMatchingEnabled() const;
+
+    /// \returns the TrackMatcher for the current stream, or nullptr if track
+    /// matching is disabled or the stream has no track parameter.
+    std::shared_ptr<const TrackMatcher> trackMatcher() const;
+
+    /// \brief Enable or disable location matching.
+    ///
+    /// When enabled, each filter or user stream compiles its `locations`
+    /// parameter into a LocationMatcher and every received Status is
+    /// annotated with the ids of the bounding boxes that contain it. See
+    /// Status::matchedLocations(). The setting takes effect on the next call
+    /// to filter() or user().
+    ///
+    /// \param value True to enable location matching.
+    void setLocationMatchingEnabled(bool value);
+
+    /// \returns true if location matching is enabled.
+    bool isLocationMatchingEnabled() const;
+
+    /// \returns the LocationMatcher for the current stream, or nullptr if
+    /// location matching is disabled or the stream has no locations parameter.
+    std::shared_ptr<const LocationMatcher> locationMatcher() const;
+
+    /// \brief Collect statuses into StatusBatches.
+    ///
+    /// When a sink is set, each decoded status is moved into a StatusBatch
+    /// instead of being delivered to the status callback. The batch is passed
+    /// to the sink on the streaming thread once it holds batchSize rows, once
+    /// its first row is batchInterval milliseconds old, or when the stream
+    /// disconnects. Since keep-alives arrive every 30 seconds, a quiet stream
+    /// may hold a partial batch for up to that long after batchInterval.
+    ///
+    /// The sink may only be changed while the client is stopped.
+    ///
+    /// \param sink The batch sink, or nullptr to deliver statuses one by one.
+    /// \param batchSize The maximum number of rows in a batch.
+    /// \param batchInterval The maximum age of a batch in milliseconds.
+    void setBatchSink(BatchSink sink,
+                      std::size_t batchSize = DEFAULT_BATCH_SIZE,
+                      uint64_t batchInterval = DEFAULT_BATCH_INTERVAL);
+
+    /// \brief Open streams with a transport instead of the HTTP client.
+    ///
+    /// The request is not signed. The stream returned by the transport must
+    /// end on its own, since stopping the client cannot abort it.
+    ///
+    /// The transport may only be changed while the client is stopped.
+    ///
+    /// \param transport The transport, or nullptr to use the HTTP client.
+    void setTransport(Transport transport);
+
+    /// \brief Get the runtime metrics for this client.
+    ///
+    /// The metrics are updated lock-free from the streaming thread and may be
+    /// read from any thread.
+    ///
+    /// \returns the client metrics.
+    const ClientMetrics& metrics() const;
+
     /// \brief The BaseStreamingClient timeout.
     ///
     /// This value is set to 90000 milliseconds, as recommended by the
@@ -126,6 +211,12 @@ public:
     /// \sa https://dev.twitter.com/streaming/overview/connecting
     static const uint64_t TIMEOUT;
 
+    /// \brief The default maximum number of rows in a batch.
+    static const std::size_t DEFAULT_BATCH_SIZE;
+
+    /// \brief The default maximum age of a batch in milliseconds.
+    static const uint64_t DEFAULT_BATCH_INTERVAL;
+
     /// \brief The BaseStreamingClient user agent.
     ///
     /// Both the `User-Agent` and `X-User-Agent` are set to this value.
@@ -149,16 +240,62 @@ protected:
     virtual void _onException(const std::exception& exc) = 0;
     virtual void _onMessage(const ofJson& message) = 0;
 
+    /// \returns true if _onMessage() should receive raw messages.
+    ///
+    /// Notices are decoded without building the raw message when this
+    /// returns false.
+    virtual bool _wantsMessages() const;
+
     uint64_t _lastMessageTime = 0;
 
+    /// \brief The runtime metrics.
+    ClientMetrics _metrics;
+
 private:
     void _run();
 
+    /// \brief Compile the track and location matchers for a new stream.
+    /// \param query The stream query, or nullptr for unfiltered streams.
+    void _setMatchers(const BaseFilterQuery* query);
+
+    /// \brief Pass the current batch to the batch sink.
+    void _flushBatch();
+
     /// \brief The OAuth 1.0 client.
     HTTP::OAuth10HTTPClient _client;
 
     HTTP::OAuth10Credentials _credentials;
 
+    /// \brief True if track rule matching is enabled.
+    bool _trackMatchingEnabled = false;
+
+    /// \brief The track matcher for the current stream, if any.
+    std::shared_ptr<const TrackMatcher> _trackMatcher;
+
+    /// \brief True if location matching is enabled.
+    bool _locationMatchingEnabled = false;
+
+    /// \brief The location matcher for the current stream, if any.
+    std::shared_ptr<const LocationMatcher> _locationMatcher;
+
+    /// \brief The transport, or nullptr to use the HTTP client.
+    Transport _transport;
+
+    /// \brief The batch sink, or nullptr to deliver statuses one by one.
+    BatchSink _batchSink;
+
+    /// \brief The maximum number of rows in a batch.
+    std::size_t _batchSize = DEFAULT_BATCH_SIZE;
+
+    /// \brief The maximum age of a batch in milliseconds.
+    uint64_t _batchInterval = DEFAULT_BATCH_INTERVAL;
+
+    /// \brief The statuses collected since the last flush.
+    StatusBatch _batch;
+
+    /// \brief The time the first row of the current batch was collected.
+    uint64_t _batchStart = 0;
+
     StreamType _streamType = StreamType::NONE;
     std::string _url;
     std::string _httpMethod;
@@ -234,6 +371,14 @@ private:
     void _update(ofEventArgs& args);
     void _exit(ofEventArgs& args);
 
+    /// \brief Receive all queued values and update the queue depth metrics.
+    /// \param channel The channel to receive from.
+    /// \param event The metrics event type carried by the channel.
+    /// \returns the received values.
+    template <typename T>
+    std::vector<T> _receiveAll(IO::ThreadChannel<T>& channel,
+                               ClientMetrics::Event event);
+
     virtual void _onConnect() override;
     virtual void _onDisconnect() override;
     virtual void _onStatus(const Status& status) override;
@@ -246,6 +391,7 @@ private:
     virtual void _onStallWarning(const StallWarning& notice) override;
     virtual void _onException(const std::exception& exc) override;
     virtual void _onMessage(const ofJson& message) override;
+    virtual bool _wantsMessages() const override;
 
     bool _autoEventSync = true;
 
@@ -268,6 +414,16 @@ private:
 };
 
 
+template <typename T>
+std::vector<T> StreamingClient::_receiveAll(IO::ThreadChannel<T>& channel,
+                                            ClientMetrics::Event event)
+{
+    std::vector<T> values = channel.tryReceiveAll();
+    _metrics.removeQueued(event, values.size());
+    return values;
+}
+
+
 template <class ListenerClass>
 void StreamingClient::registerStreamingEvents(ListenerClass* listener,
                                               int priority)
@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A fixed size pool of worker threads.
+///
+/// Tasks are run in submission order by the first idle worker. For data
+/// parallel work, parallelFor() splits a range into small chunks that idle
+/// workers claim with an atomic counter, so faster workers automatically
+/// take more chunks and the load stays balanced without per-thread queues.
+class ThreadPool
+{
+public:
+    /// \brief Create a ThreadPool.
+    /// \param threadCount The number of worker threads, or 0 to use the
+    /// number of hardware threads.
+    ThreadPool(std::size_t threadCount = 0);
+
+    /// \brief Destroy the ThreadPool.
+    ///
+    /// Queued tasks are run before the workers are joined.
+    ~ThreadPool();
+
+    /// \brief Queue a task.
+    ///
+    /// This signature matches DirectStreamingClient::Executor, so a pool can
+    /// be used directly as an executor.
+    ///
+    /// \param task The task to run.
+    void execute(std::function<void()> task);
+
+    /// \brief Queue a task and get a future for its result.
+    /// \param function The function to run.
+    /// \returns a future for the result of the function.
+    template <typename Function>
+    auto submit(Function&& function) -> std::future<decltype(function())>;
+
+    /// \brief Call a function for every index in [0, count) in parallel.
+    ///
+    /// The calling thread also processes chunks and returns once every index
+    /// has been processed. The first exception thrown by the function is
+    /// rethrown on the calling thread after all chunks are complete.
+    ///
+    /// \param count The number of indices.
+    /// \param function The function to call with each index.
+    /// \param chunkSize The number of indices claimed at a time, or 0 to
+    /// choose automatically.
+    void parallelFor(std::size_t count,
+                     const std::function<void(std::size_t)>& function,
+                     std::size_t chunkSize = 0);
+
+    /// \returns the number of worker threads.
+    std::size_t size() const;
+
+    /// \returns a shared pool with one worker per hardware thread.
+    static ThreadPool& instance();
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    /// \brief The worker thread loop.
+    void _work();
+
+    /// \brief The worker threads.
+    std::vector<std::thread> _threads;
+
+    /// \brief The queued tasks.
+    std::deque<std::function<void()>> _tasks;
+
+    /// \brief True when the workers should exit.
+    bool _stopping = false;
+
+    /// \brief Guards _tasks and _stopping.
+    std::mutex _mutex;
+
+    /// \brief Signals queued tasks or stopping.
+    std::condition_variable _condition;
+
+};
+
+
+template <typename Function>
+auto ThreadPool::submit(Function&& function) -> std::future<decltype(function())>
+{
+    typedef decltype(function()) Result;
+
+    // std::function requires copyable callables, so the packaged task is
+    // held by a shared pointer.
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+    std::future<Result> result = task->get_future();
+    execute([task]() { (*task)(); });
+    return result;
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ofFileUtils.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief A collector for hot-path trace spans.
+///
+/// Spans are recorded into per-thread buffers and written out in the Chrome
+/// trace-event format, which can be loaded in `chrome://tracing` or
+/// https://ui.perfetto.dev.
+///
+/// The trace macros below are compiled out unless OFX_TWITTER_ENABLE_TRACING
+/// is defined, e.g. by adding `ADDON_CFLAGS += -DOFX_TWITTER_ENABLE_TRACING`
+/// to the project's addon_config.mk or config.make. When compiled in, spans
+/// are only recorded while the Tracer is started.
+///
+/// Usage:
+///
+///     ofxTwitter::Tracer::instance().start();
+///     ...
+///     ofxTwitter::Tracer::instance().stop();
+///     ofxTwitter::Tracer::instance().save("trace.json");
+class Tracer
+{
+public:
+    /// \returns the shared Tracer instance.
+    static Tracer& instance();
+
+    /// \brief Begin recording spans.
+    void start();
+
+    /// \brief Stop recording spans.
+    ///
+    /// Recorded spans are kept until clear() is called.
+    void stop();
+
+    /// \returns true if spans are currently being recorded.
+    bool isEnabled() const;
+
+    /// \brief Discard all recorded spans.
+    ///
+    /// The buffers of threads that have exited are released.
+    void clear();
+
+    /// \brief Write all recorded spans as Chrome trace-event JSON.
+    /// \param path The output file path.
+    /// \returns true if the file was written successfully.
+    bool save(const std::filesystem::path& path) const;
+
+    /// \brief Record a complete span.
+    /// \param name The span name. Must have static storage duration.
+    /// \param start The span start time returned by now().
+    /// \param end The span end time returned by now().
+    void record(const char* name, uint64_t start, uint64_t end);
+
+    /// \returns a monotonic timestamp in microseconds.
+    ///
+    /// This uses the same clock as ClientMetrics::now(), so timestamps from
+    /// either may be mixed.
+    static uint64_t now();
+
+    /// \brief The maximum number of spans kept per thread.
+    ///
+    /// Additional spans are dropped to keep memory bounded.
+    static const std::size_t MAX_EVENTS_PER_THREAD;
+
+private:
+    Tracer();
+    ~Tracer();
+
+    /// \brief A single complete span.
+    struct Event
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t duration;
+    };
+
+    /// \brief The spans recorded by a single thread.
+    struct ThreadBuffer
+    {
+        uint64_t threadId = 0;
+        std::mutex mutex;
+        std::vector<Event> events;
+
+        /// \brief True once the thread has exited.
+        bool retired = false;
+    };
+
+    /// \returns the calling thread's buffer, registering it if needed.
+    ThreadBuffer& _threadBuffer();
+
+    /// \brief Unregister the buffer of an exiting thread.
+    ///
+    /// A buffer with spans is kept until they are saved and cleared.
+    ///
+    /// \param buffer The thread's buffer.
+    void _retire(const std::shared_ptr<ThreadBuffer>& buffer);
+
+    /// \brief True while spans are being recorded.
+    std::atomic<bool> _enabled;
+
+    /// \brief The next thread id to assign.
+    std::atomic<uint64_t> _nextThreadId;
+
+    /// \brief Guards _buffers.
+    mutable std::mutex _mutex;
+
+    /// \brief All registered thread buffers.
+    std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+
+};
+
+
+/// \brief Records a span covering the lifetime of this object.
+class TraceScope
+{
+public:
+    /// \brief Begin a span.
+    /// \param name The span name. Must have static storage duration.
+    TraceScope(const char* name);
+
+    /// \brief End the span.
+    ~TraceScope();
+
+private:
+    /// \brief The span name, or nullptr if tracing was disabled at start.
+    const char* _name = nullptr;
+
+    /// \brief The start time.
+    uint64_t _start = 0;
+
+};
+
+
+} } // namespace ofx::Twitter
+
+
+#if defined(OFX_TWITTER_ENABLE_TRACING)
+    #define OFX_TWITTER_TRACE_CONCAT_INNER(a, b) a##b
+    #define OFX_TWITTER_TRACE_CONCAT(a, b) OFX_TWITTER_TRACE_CONCAT_INNER(a, b)
+    /// \brief Trace the enclosing scope.
+    #define OFX_TWITTER_TRACE_SCOPE(name) \
+        ofx::Twitter::TraceScope OFX_TWITTER_TRACE_CONCAT(_traceScope, __LINE__)(name)
+    /// \brief Trace a span with explicit start and end timestamps.
+    #define OFX_TWITTER_TRACE_SPAN(name, start, end) \
+        ofx::Twitter::Tracer::instance().record(name, start, end)
+#else
+    #define OFX_TWITTER_TRACE_SCOPE(name)
+    #define OFX_TWITTER_TRACE_SPAN(name, start, end)
+#endif
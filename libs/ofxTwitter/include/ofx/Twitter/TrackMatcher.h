@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ofx/Twitter/FilterQuery.h"
+#include "ofx/Twitter/Status.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Determines which `track` phrases a Status matched.
+///
+/// The Streaming API does not report which track phrase caused a Status to
+/// be delivered. A TrackMatcher compiles a list of track phrases into a
+/// single Aho-Corasick automaton and finds every matching phrase in one pass
+/// over the Status text.
+///
+/// Matching follows the streaming track semantics: each comma separated
+/// phrase is a rule, the space separated terms in a rule must all be present
+/// in any order, terms match whole tokens ignoring case, and punctuation
+/// delimits tokens (so `twitter` matches `#twitter`, `@twitter` and
+/// `twitter's`, but not `twitters`). The text, the expanded and display URLs
+/// and the text of any retweeted or quoted Status are considered.
+///
+/// Case folding is limited to ASCII.
+///
+/// \sa https://dev.twitter.com/streaming/overview/request-parameters#track
+class TrackMatcher
+{
+public:
+    /// \brief Create an empty TrackMatcher.
+    TrackMatcher();
+
+    /// \brief Create a TrackMatcher from a list of track phrases.
+    /// \param tracks The track phrases. The index of each phrase is its rule id.
+    TrackMatcher(const std::vector<std::string>& tracks);
+
+    /// \brief Create a TrackMatcher from the `track` parameter of a query.
+    /// \param query The filter query.
+    TrackMatcher(const BaseFilterQuery& query);
+
+    /// \brief Compile a list of track phrases, replacing any existing rules.
+    /// \param tracks The track phrases. The index of each phrase is its rule id.
+    void setTracks(const std::vector<std::string>& tracks);
+
+    /// \returns the track phrases, indexed by rule id.
+    const std::vector<std::string>& tracks() const;
+
+    /// \returns true if there are no rules.
+    bool empty() const;
+
+    /// \brief Find the rules matched by a string.
+    /// \param text The text to search.
+    /// \returns the ids of the matched rules in ascending order.
+    std::vector<std::size_t> match(const std::string& text) const;
+
+    /// \brief Find the rules matched by a Status.
+    /// \param status The status to search.
+    /// \returns the ids of the matched rules in ascending order.
+    std::vector<std::size_t> match(const Status& status) const;
+
+    /// \brief Match a Status and store the results in the Status.
+    ///
+    /// The results are available from Status::matchedTrackRules().
+    ///
+    /// \param status The status to annotate.
+    void annotate(Status& status) const;
+
+private:
+    /// \brief Append the case folded searchable text of a Status.
+    /// \param status The status.
+    /// \param buffer The buffer to append to.
+    /// \param depth The current retweet / quote nesting depth.
+    static void _appendText(const Status& status,
+                            std::string& buffer,
+                            std::size_t depth);
+
+    /// \brief Search a case folded buffer.
+    /// \param buffer The case folded text.
+    /// \returns the ids of the matched rules in ascending order.
+    std::vector<std::size_t> _search(const std::string& buffer) const;
+
+    /// \brief A search term and the rules that require it.
+    struct Term
+    {
+        /// \brief The term length in bytes.
+        std::size_t length = 0;
+
+        /// \brief True if the term must start on a token boundary.
+        bool checkStart = false;
+
+        /// \brief True if the term must end on a token boundary.
+        bool checkEnd = false;
+
+        /// \brief The ids of the rules that contain this term.
+        std::vector<uint32_t> rules;
+    };
+
+    /// \brief The original phrases.
+    std::vector<std::string> _tracks;
+
+    /// \brief The number of distinct terms in each rule.
+    std::vector<uint32_t> _ruleTermCounts;
+
+    /// \brief The distinct terms.
+    std::vector<Term> _terms;
+
+    /// \brief Maps each byte to a symbol in the automaton's reduced alphabet.
+    ///
+    /// Symbol 0 represents every byte that does not occur in any term.
+    uint8_t _symbols[256];
+
+    /// \brief The number of symbols in the reduced alphabet.
+    std::size_t _symbolCount = 1;
+
+    /// \brief The automaton transitions, indexed by state * _symbolCount + symbol.
+    std::vector<uint32_t> _transitions;
+
+    /// \brief The offset of each state's outputs in _outputs.
+    ///
+    /// State s emits _outputs[_outputOffsets[s]] to _outputs[_outputOffsets[s + 1]].
+    std::vector<uint32_t> _outputOffsets;
+
+    /// \brief The term ids emitted by each state, including those reached by
+    /// failure links.
+    std::vector<uint32_t> _outputs;
+
+};
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,265 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ofx/Twitter/Status.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+/// \brief Counts hashtags, mentions, symbols and URL domains over sliding
+/// time windows.
+///
+/// Time is divided into fixed length buckets. Each bucket keeps a
+/// count-min sketch of every term seen during the bucket. Each window keeps
+/// the running sum of the sketches of the buckets it covers, so a count
+/// estimate for any window costs a few array lookups. Each window also keeps
+/// a running summary of its most frequent terms of each type, updated as
+/// terms are counted and as buckets expire, so finding the top terms only
+/// ranks the summary.
+///
+/// Memory use is fixed by the sketch dimensions, the summary capacity and
+/// the number of buckets in the longest window, regardless of the number of
+/// distinct terms. Counts are estimates that may only be too high. The
+/// expected error is bounded by the total count in the window divided by the
+/// sketch width.
+///
+/// Time follows the statuses rather than the wall clock. Call advance() to
+/// expire old buckets while no statuses arrive.
+///
+/// All methods are thread-safe.
+class TrendAggregator
+{
+public:
+    /// \brief The kinds of counted terms.
+    enum class TermType
+    {
+        /// \brief A hashtag, without the leading `#`.
+        HASHTAG,
+        /// \brief A mentioned screen name, without the leading `@`.
+        MENTION,
+        /// \brief A cashtag symbol, without the leading `$`.
+        SYMBOL,
+        /// \brief The host name of a linked URL.
+        DOMAIN
+    };
+
+    /// \brief A counted term.
+    struct Trend
+    {
+        /// \brief The term type.
+        TermType type = TermType::HASHTAG;
+
+        /// \brief The normalized term.
+        std::string term;
+
+        /// \brief The estimated number of occurrences in the window.
+        uint64_t count = 0;
+    };
+
+    /// \brief Create a TrendAggregator.
+    /// \param windows The window durations in milliseconds.
+    /// \param bucketDuration The bucket duration in milliseconds. Window
+    /// boundaries are rounded to whole buckets.
+    /// \param sketchWidth The number of counters in each sketch row.
+    /// \param sketchDepth The number of sketch rows.
+    /// \param topCapacity The number of terms of each type tracked by each
+    /// window's top term summary.
+    TrendAggregator(const std::vector<uint64_t>& windows = DEFAULT_WINDOWS,
+                    uint64_t bucketDuration = DEFAULT_BUCKET_DURATION,
+                    std::size_t sketchWidth = DEFAULT_SKETCH_WIDTH,
+                    std::size_t sketchDepth = DEFAULT_SKETCH_DEPTH,
+                    std::size_t topCapacity = DEFAULT_TOP_CAPACITY);
+
+    /// \brief Count the entities of a Status.
+    ///
+    /// The time is taken from Utils::timestamp().
+    ///
+    /// \param status The status to count.
+    void add(const Status& status);
+
+    /// \brief Count a term.
+    /// \param type The term type.
+    /// \param term The term. It is normalized before counting.
+    /// \param timestamp The time in milliseconds since the Unix epoch.
+    /// \param count The number of occurrences.
+    void add(TermType type,
+             const std::string& term,
+             uint64_t timestamp,
+             uint64_t count = 1);
+
+    /// \brief Expire buckets that are older than the given time.
+    /// \param timestamp The current time in milliseconds since the Unix epoch.
+    void advance(uint64_t timestamp);
+
+    /// \brief Estimate the count of a term in a window.
+    /// \param type The term type.
+    /// \param term The term.
+    /// \param window The window duration.
+    /// \returns the estimated count, or 0 if the window is not one of
+    /// windows().
+    uint64_t count(TermType type, const std::string& term, uint64_t window) const;
+
+    /// \brief Find the most frequent terms in a window.
+    /// \param window The window duration.
+    /// \param size The maximum number of terms to return.
+    /// \returns the terms in descending order of count, or no terms if the
+    /// window is not one of windows().
+    std::vector<Trend> top(uint64_t window, std::size_t size) const;
+
+    /// \brief Find the most frequent terms of one type in a window.
+    /// \param window The window duration.
+    /// \param size The maximum number of terms to return.
+    /// \param type The term type.
+    /// \returns the terms in descending order of count, or no terms if the
+    /// window is not one of windows().
+    std::vector<Trend> top(uint64_t window, std::size_t size, TermType type) const;
+
+    /// \returns the window durations in milliseconds.
+    const std::vector<uint64_t>& windows() const;
+
+    /// \brief Remove all counts.
+    void clear();
+
+    /// \brief Normalize a term.
+    ///
+    /// Terms are case folded. Leading `#`, `@` and `$` characters are
+    /// removed, and a leading `www.` is removed from domains.
+    ///
+    /// \param type The term type.
+    /// \param term The term.
+    /// \returns the normalized term.
+    static std::string normalize(TermType type, const std::string& term);
+
+    /// \brief Get the host name of a URL.
+    /// \param url The URL.
+    /// \returns the host name, or an empty string if there is none.
+    static std::string domain(const std::string& url);
+
+    /// \brief The default windows of 1 minute, 15 minutes and 1 hour.
+    static const std::vector<uint64_t> DEFAULT_WINDOWS;
+
+    /// \brief The default bucket duration of 15 seconds.
+    static const uint64_t DEFAULT_BUCKET_DURATION;
+
+    /// \brief The default sketch width.
+    static const std::size_t DEFAULT_SKETCH_WIDTH;
+
+    /// \brief The default sketch depth.
+    static const std::size_t DEFAULT_SKETCH_DEPTH;
+
+    /// \brief The default top term summary capacity.
+    static const std::size_t DEFAULT_TOP_CAPACITY;
+
+private:
+    /// \brief The counts for one time bucket.
+    struct Bucket
+    {
+        /// \brief The absolute bucket index, or -1 if unused.
+        int64_t index = -1;
+
+        /// \brief The count-min sketch counters.
+        std::vector<uint32_t> sketch;
+    };
+
+    /// \brief A sliding window.
+    struct Window
+    {
+        /// \brief The window duration in milliseconds.
+        uint64_t duration = 0;
+
+        /// \brief The number of buckets covered by the window.
+        int64_t bucketCount = 0;
+
+        /// \brief The index of the oldest bucket included in the sum.
+        int64_t oldest = 0;
+
+        /// \brief The sum of the sketches of the covered buckets.
+        std::vector<uint64_t> sketch;
+
+        /// \brief The most frequent keys of each TermType and their last
+        /// count estimates.
+        std::vector<std::unordered_map<std::string, uint64_t>> top;
+    };
+
+    /// \returns the counter offsets for a key, one per sketch row.
+    void _hash(const std::string& key, std::vector<std::size_t>& offsets) const;
+
+    /// \returns the internal key for a term, or an empty string if the
+    /// normalized term is empty.
+    static std::string _key(TermType type, const std::string& term);
+
+    /// \brief Count an internal key without locking.
+    void _add(const std::string& key, uint64_t timestamp, uint64_t count);
+
+    /// \brief Move the current bucket forward, expiring old buckets.
+    void _advance(int64_t index);
+
+    /// \returns the window with the given duration, or nullptr.
+    const Window* _window(uint64_t duration) const;
+
+    /// \brief Estimate the count of an internal key in a window.
+    uint64_t _estimate(const Window& window, const std::string& key) const;
+
+    /// \brief Estimate the count of a key in a window from its offsets.
+    static uint64_t _estimate(const Window& window, const std::vector<std::size_t>& offsets);
+
+    /// \brief Offer a key to a window's top term summary.
+    ///
+    /// When the summary is full, the key replaces the least frequent key if
+    /// its estimate is higher.
+    void _offer(Window& window, const std::string& key, uint64_t estimate);
+
+    /// \brief Update the estimates of a window's top terms after buckets
+    /// expire, removing terms that are no longer counted.
+    void _refresh(Window& window);
+
+    /// \brief Rank the candidate keys of a window.
+    std::vector<Trend> _top(uint64_t duration,
+                            std::size_t size,
+                            const TermType* type) const;
+
+    /// \brief The window durations.
+    std::vector<uint64_t> _durations;
+
+    /// \brief The bucket duration in milliseconds.
+    uint64_t _bucketDuration = 0;
+
+    /// \brief The sketch width.
+    std::size_t _width = 0;
+
+    /// \brief The sketch depth.
+    std::size_t _depth = 0;
+
+    /// \brief The top term summary capacity.
+    std::size_t _capacity = 0;
+
+    /// \brief The bucket ring, indexed by absolute bucket index.
+    std::vector<Bucket> _buckets;
+
+    /// \brief The windows.
+    std::vector<Window> _windows;
+
+    /// \brief The index of the newest bucket, or -1 if empty.
+    int64_t _current = -1;
+
+    /// \brief Guards all members.
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::Twitter
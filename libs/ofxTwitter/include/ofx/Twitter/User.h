@@ -51,18 +51,18 @@ public:
     Poco::DateTime createdAt() const;
     bool defaultProfile() const;
     bool defaultProfileImage() const;
-    std::string description() const;
-    Entities entities() const;
+    const std::string& description() const;
+    const Entities& entities() const;
     int64_t favouritesCount() const;
     bool wasFollowRequestSent() const;
     int64_t followersCount() const;
     int64_t friendsCount() const;
     bool isGeoEnabled() const;
     bool isTranslator() const;
-    std::string language() const;
+    const std::string& language() const;
     int64_t listedCount() const;
-    std::string location() const;
-    Profile profile() const;
+    const std::string& location() const;
+    const Profile& profile() const;
     bool isProtected() const;
     bool showsAllInlineMedia();
 
@@ -73,10 +73,10 @@ public:
     const std::string* url() const;
     const int64_t* utcOffset() const;
     bool verified() const;
-    std::vector<std::string> withheldInCountries() const;
+    const std::vector<std::string>& withheldInCountries() const;
     WithheldScope withheldScope() const;
 
-    std::string translatorType() const;
+    const std::string& translatorType() const;
 
     static User fromJSON(const ofJson& json);
 
@@ -137,7 +137,7 @@ private:
     /// the hassle of std::unique_ptr and copies.
     std::shared_ptr<Status> _status;
 
-    int64_t _statusesCount;
+    int64_t _statusesCount = -1;
 
     std::shared_ptr<std::string> _timeZone;
 
@@ -147,9 +147,11 @@ private:
 
     std::vector<std::string> _withheldInCountries;
 
-    WithheldScope _withheldScope;
+    WithheldScope _withheldScope = WithheldScope::USER;
 
     std::string _translatorType;
+
+    friend class BinaryCodec;
 };
 
 
@@ -8,14 +8,19 @@
 #pragma once
 
 
+#include <cstdint>
 #include <string>
 #include "Poco/DateTime.h"
+#include "ofx/Geo/CoordinateBounds.h"
 
 
 namespace ofx {
 namespace Twitter {
 
 
+class Status;
+
+
 /// \brief A collection of Twitter utilities.
 class Utils
 {
@@ -26,12 +31,46 @@ public:
     /// \returns true if str ends with suffix.
     static bool endsWith(const std::string& str, const std::string &suffix);
 
+    /// \brief Determine if one string starts with a given prefix.
+    /// \param str The string to check.
+    /// \param prefix The prefix to match.
+    /// \returns true if str starts with prefix.
+    static bool startsWith(const std::string& str, const std::string& prefix);
+
     /// \brief Parse a Twitter date string.
     /// \param dateString The raw date string to parse.
     /// \param date The destination date.
     /// \returns true if parsing was successful.
     static bool parse(const std::string& dateString, Poco::DateTime& date);
 
+    /// \brief Get the best available location of a Status.
+    ///
+    /// The exact Status coordinates are used if present, otherwise the center
+    /// of the Place bounding box is used.
+    ///
+    /// \param status The status to locate.
+    /// \param coordinate The destination coordinate.
+    /// \returns true if the status has a location.
+    static bool location(const Status& status, Geo::Coordinate& coordinate);
+
+    /// \brief Get the center of a bounding box.
+    ///
+    /// Boxes that cross the antimeridian (i.e. the western longitude is
+    /// greater than the eastern longitude) are handled.
+    ///
+    /// \param bounds The bounding box.
+    /// \returns the center of the bounding box.
+    static Geo::Coordinate center(const Geo::CoordinateBounds& bounds);
+
+    /// \brief Get the time a Status was created.
+    ///
+    /// The streaming `timestamp_ms` is used if present, otherwise the
+    /// `created_at` date is used.
+    ///
+    /// \param status The status.
+    /// \returns the creation time in milliseconds since the Unix epoch.
+    static uint64_t timestamp(const Status& status);
+
     /// \brief The default Twitter date format.
     static const std::string TWITTER_DATE_FORMAT;
 
@@ -41,7 +41,7 @@ int64_t BaseUser::id() const
 }
 
 
-std::string BaseUser::screenName() const
+const std::string& BaseUser::screenName() const
 {
     return _screenName;
 }
@@ -78,7 +78,7 @@ BaseNamedUser::~BaseNamedUser()
 }
 
 
-std::string BaseNamedUser::name() const
+const std::string& BaseNamedUser::name() const
 {
     return _name;
 }
@@ -0,0 +1,1017 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/BinaryCodec.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+/// \brief Identifies the class of an encoded value.
+enum Kind: uint8_t
+{
+    KIND_STATUS = 1,
+    KIND_USER = 2,
+    KIND_PLACE = 3,
+    KIND_ENTITIES = 4
+};
+
+
+/// \brief The maximum object nesting accepted when decoding.
+///
+/// This bounds recursion on malformed input. Real statuses nest at most a few
+/// levels (e.g. a retweet of a quote tweet).
+const int MAX_DEPTH = 32;
+
+
+} // namespace
+
+
+/// \brief Writes the body of an encoded value and collects its strings.
+class BinaryCodec::Encoder
+{
+public:
+    /// \brief Writes one object's presence bitmap followed by its fields.
+    ///
+    /// Fields are buffered until the object is complete, since the bitmap
+    /// precedes them.
+    class Object
+    {
+    public:
+        Object(Encoder& encoder): _encoder(encoder), _parent(encoder.out)
+        {
+            _encoder.out = &_buffer;
+        }
+
+        ~Object()
+        {
+            _encoder.out = _parent;
+            _encoder.varint(_mask);
+            _parent->append(_buffer);
+        }
+
+        /// \brief Write the next field if it is present.
+        template <typename Function>
+        void field(bool present, Function write)
+        {
+            if (present)
+            {
+                _mask |= uint64_t(1) << _bit;
+                write();
+            }
+
+            ++_bit;
+        }
+
+        /// \brief Write the next field as a boolean stored in the bitmap.
+        void flag(bool value)
+        {
+            field(value, [](){});
+        }
+
+    private:
+        Encoder& _encoder;
+        std::string* _parent;
+        std::string _buffer;
+        uint64_t _mask = 0;
+        int _bit = 0;
+
+    };
+
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out->push_back(char(value | 0x80));
+            value >>= 7;
+        }
+
+        out->push_back(char(value));
+    }
+
+    void integer(int64_t value)
+    {
+        varint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+    }
+
+    void real(double value)
+    {
+        char bytes[sizeof(double)];
+        std::memcpy(bytes, &value, sizeof(double));
+        out->append(bytes, sizeof(double));
+    }
+
+    void string(const std::string& value)
+    {
+        if (value.empty())
+        {
+            varint(0);
+            return;
+        }
+
+        auto result = indices.insert(std::make_pair(value, table.size() + 1));
+
+        if (result.second)
+        {
+            table.push_back(&result.first->first);
+        }
+
+        varint(result.first->second);
+    }
+
+    void stringList(const std::vector<std::string>& values)
+    {
+        varint(values.size());
+        for (const auto& value: values) string(value);
+    }
+
+    template <typename Value>
+    void map(const std::map<std::string, Value>& values)
+    {
+        varint(values.size());
+
+        for (const auto& entry: values)
+        {
+            string(entry.first);
+            value(entry.second);
+        }
+    }
+
+    void value(const std::string& v)
+    {
+        string(v);
+    }
+
+    void value(bool v)
+    {
+        varint(v ? 1 : 0);
+    }
+
+    /// \brief The buffer currently being written.
+    std::string* out = nullptr;
+
+    /// \brief The string table indices, starting at 1.
+    std::unordered_map<std::string, uint64_t> indices;
+
+    /// \brief The string table in index order.
+    std::vector<const std::string*> table;
+
+};
+
+
+/// \brief Reads an encoded value.
+class BinaryCodec::Decoder
+{
+public:
+    /// \brief Reads one object's presence bitmap.
+    class Object
+    {
+    public:
+        Object(Decoder& decoder): _decoder(decoder)
+        {
+            if (_decoder.depth >= MAX_DEPTH)
+            {
+                throw std::runtime_error("Maximum nesting depth exceeded.");
+            }
+
+            _mask = _decoder.varint();
+            ++_decoder.depth;
+        }
+
+        ~Object()
+        {
+            --_decoder.depth;
+        }
+
+        /// \returns true if the next field is present.
+        bool has()
+        {
+            return (_mask >> _bit++) & 1;
+        }
+
+    private:
+        Decoder& _decoder;
+        uint64_t _mask = 0;
+        int _bit = 0;
+
+    };
+
+    Decoder(const char* data, std::size_t size):
+        position(reinterpret_cast<const uint8_t*>(data)),
+        end(position + size)
+    {
+    }
+
+    uint8_t byte()
+    {
+        if (position >= end)
+        {
+            throw std::runtime_error("Unexpected end of data.");
+        }
+
+        return *position++;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t b = byte();
+            value |= uint64_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return value;
+        }
+
+        throw std::runtime_error("Invalid varint.");
+    }
+
+    int64_t integer()
+    {
+        uint64_t value = varint();
+        return int64_t(value >> 1) ^ -int64_t(value & 1);
+    }
+
+    double real()
+    {
+        if (std::size_t(end - position) < sizeof(double))
+        {
+            throw std::runtime_error("Unexpected end of data.");
+        }
+
+        double value;
+        std::memcpy(&value, position, sizeof(double));
+        position += sizeof(double);
+        return value;
+    }
+
+    const std::string& string()
+    {
+        static const std::string empty;
+
+        uint64_t index = varint();
+
+        if (index == 0)
+        {
+            return empty;
+        }
+        else if (index > table.size())
+        {
+            throw std::runtime_error("Invalid string index.");
+        }
+
+        return table[index - 1];
+    }
+
+    /// \returns a collection size, checked against the remaining data so that
+    /// malformed input cannot cause large allocations.
+    std::size_t count()
+    {
+        uint64_t value = varint();
+
+        if (value > uint64_t(end - position))
+        {
+            throw std::runtime_error("Invalid count.");
+        }
+
+        return std::size_t(value);
+    }
+
+    template <typename Enum>
+    Enum enumeration(uint64_t count)
+    {
+        uint64_t value = varint();
+
+        if (value >= count)
+        {
+            throw std::runtime_error("Invalid enumeration value.");
+        }
+
+        return static_cast<Enum>(value);
+    }
+
+    std::vector<std::string> stringList()
+    {
+        std::vector<std::string> values(count());
+        for (auto& value: values) value = string();
+        return values;
+    }
+
+    template <typename Value>
+    std::map<std::string, Value> map()
+    {
+        std::map<std::string, Value> values;
+        std::size_t n = count();
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const std::string& key = string();
+            value(values[key]);
+        }
+
+        return values;
+    }
+
+    void value(std::string& v)
+    {
+        v = string();
+    }
+
+    void value(bool& v)
+    {
+        v = varint() != 0;
+    }
+
+    /// \brief The current read position.
+    const uint8_t* position = nullptr;
+
+    /// \brief The end of the data.
+    const uint8_t* end = nullptr;
+
+    /// \brief The string table.
+    std::vector<std::string> table;
+
+    /// \brief The current object nesting depth.
+    int depth = 0;
+
+};
+
+
+const uint64_t BinaryCodec::VERSION = 1;
+const std::string BinaryCodec::MAGIC = "OFXT";
+
+
+std::string BinaryCodec::serialize(const Status& status)
+{
+    return _serialize(KIND_STATUS, status);
+}
+
+
+std::string BinaryCodec::serialize(const User& user)
+{
+    return _serialize(KIND_USER, user);
+}
+
+
+std::string BinaryCodec::serialize(const Place& place)
+{
+    return _serialize(KIND_PLACE, place);
+}
+
+
+std::string BinaryCodec::serialize(const Entities& entities)
+{
+    return _serialize(KIND_ENTITIES, entities);
+}
+
+
+bool BinaryCodec::deserialize(const char* data, std::size_t size, Status& status)
+{
+    return _deserialize(KIND_STATUS, data, size, status);
+}
+
+
+bool BinaryCodec::deserialize(const char* data, std::size_t size, User& user)
+{
+    return _deserialize(KIND_USER, data, size, user);
+}
+
+
+bool BinaryCodec::deserialize(const char* data, std::size_t size, Place& place)
+{
+    return _deserialize(KIND_PLACE, data, size, place);
+}
+
+
+bool BinaryCodec::deserialize(const char* data, std::size_t size, Entities& entities)
+{
+    return _deserialize(KIND_ENTITIES, data, size, entities);
+}
+
+
+template <typename T>
+std::string BinaryCodec::_serialize(uint8_t kind, const T& value)
+{
+    Encoder encoder;
+
+    std::string body;
+    encoder.out = &body;
+    _write(encoder, value);
+
+    std::string result = MAGIC;
+    encoder.out = &result;
+    encoder.varint(VERSION);
+    result.push_back(char(kind));
+    encoder.varint(encoder.table.size());
+
+    for (const std::string* str: encoder.table)
+    {
+        encoder.varint(str->size());
+        result.append(*str);
+    }
+
+    result.append(body);
+    return result;
+}
+
+
+template <typename T>
+bool BinaryCodec::_deserialize(uint8_t kind,
+                               const char* data,
+                               std::size_t size,
+                               T& value)
+{
+    if (size < MAGIC.size() || MAGIC.compare(0, MAGIC.size(), data, MAGIC.size()) != 0)
+    {
+        ofLogError("BinaryCodec::deserialize") << "Invalid magic.";
+        return false;
+    }
+
+    try
+    {
+        Decoder decoder(data + MAGIC.size(), size - MAGIC.size());
+
+        uint64_t version = decoder.varint();
+
+        if (version != VERSION)
+        {
+            ofLogError("BinaryCodec::deserialize") << "Unsupported version: " << version;
+            return false;
+        }
+
+        uint8_t encodedKind = decoder.byte();
+
+        if (encodedKind != kind)
+        {
+            ofLogError("BinaryCodec::deserialize") << "Unexpected kind: " << int(encodedKind) << " != " << int(kind);
+            return false;
+        }
+
+        decoder.table.resize(decoder.count());
+
+        for (auto& str: decoder.table)
+        {
+            std::size_t length = decoder.count();
+            str.assign(reinterpret_cast<const char*>(decoder.position), length);
+            decoder.position += length;
+        }
+
+        T result;
+        _read(decoder, result);
+        value = std::move(result);
+        return true;
+    }
+    catch (const std::exception& exc)
+    {
+        ofLogError("BinaryCodec::deserialize") << exc.what();
+        return false;
+    }
+}
+
+
+void BinaryCodec::_write(Encoder& e, const Status& s)
+{
+    Encoder::Object o(e);
+    o.field(s._id != -1, [&]() { e.integer(s._id); });
+    o.field(s._user != nullptr, [&]() { _write(e, *s._user); });
+    o.field(!s._annotations.empty(), [&]() { e.map(s._annotations); });
+    o.field(!s._contributors.empty(), [&]()
+    {
+        e.varint(s._contributors.size());
+
+        for (const auto& contributor: s._contributors)
+        {
+            e.integer(contributor.id());
+            e.string(contributor.screenName());
+            e.string(contributor.name());
+        }
+    });
+    o.field(s._coordinates != nullptr, [&]()
+    {
+        e.real(s._coordinates->getLatitude());
+        e.real(s._coordinates->getLongitude());
+    });
+    o.field(true, [&]() { e.integer(s._createdAt.timestamp().epochMicroseconds()); });
+    o.field(s._utcOffset != 0, [&]() { e.integer(s._utcOffset); });
+    o.field(s._currentUserRetweet != -1, [&]() { e.integer(s._currentUserRetweet); });
+    o.field(true, [&]() { _write(e, s._entities); });
+    o.field(true, [&]() { _write(e, s._extendedEntities); });
+    o.field(s._extendedTweet != nullptr, [&]() { _write(e, *s._extendedTweet); });
+    o.field(s._favoriteCount != -1, [&]() { e.integer(s._favoriteCount); });
+    o.field(s._quoteCount != -1, [&]() { e.integer(s._quoteCount); });
+    o.field(s._replyCount != -1, [&]() { e.integer(s._replyCount); });
+    o.flag(s._isQuoteStatus);
+    o.field(s._quotedStatusId != -1, [&]() { e.integer(s._quotedStatusId); });
+    o.field(s._quotedStatus != nullptr, [&]() { _write(e, *s._quotedStatus); });
+    o.field(s._quotedStatusPermalink != nullptr, [&]()
+    {
+        e.string(s._quotedStatusPermalink->url());
+        e.string(s._quotedStatusPermalink->displayURL());
+        e.string(s._quotedStatusPermalink->expandedURL());
+    });
+    o.flag(s._favorited);
+    o.field(s._filterLevel != Status::FilterLevel::NONE, [&]() { e.varint(uint64_t(s._filterLevel)); });
+    o.field(!s._inReplyToScreenName.empty(), [&]() { e.string(s._inReplyToScreenName); });
+    o.field(s._inReplyToStatusId != -1, [&]() { e.integer(s._inReplyToStatusId); });
+    o.field(s._inReplyToUserId != -1, [&]() { e.integer(s._inReplyToUserId); });
+    o.field(!s._language.empty(), [&]() { e.string(s._language); });
+    o.flag(s._possiblySensitive);
+    o.field(!s._scopes.empty(), [&]() { e.map(s._scopes); });
+    o.field(s._retweetCount != -1, [&]() { e.integer(s._retweetCount); });
+    o.flag(s._retweeted);
+    o.field(s._retweetedStatus != nullptr, [&]() { _write(e, *s._retweetedStatus); });
+    o.field(!s._source.empty(), [&]() { e.string(s._source); });
+    o.field(!s._text.empty(), [&]() { e.string(s._text); });
+    o.field(!s._fullText.empty(), [&]() { e.string(s._fullText); });
+    o.field(s._displayTextStart != 0, [&]() { e.varint(s._displayTextStart); });
+    o.field(s._displayTextEnd != 0, [&]() { e.varint(s._displayTextEnd); });
+    o.flag(s._truncated);
+    o.flag(s._withheldCopyright);
+    o.field(!s._withheldInCountries.empty(), [&]() { e.stringList(s._withheldInCountries); });
+    o.field(!s._withheldScope.empty(), [&]() { e.string(s._withheldScope); });
+    o.field(s._place != nullptr, [&]() { _write(e, *s._place); });
+    o.field(!s._metadata._isoLanguageCode.empty(), [&]() { e.string(s._metadata._isoLanguageCode); });
+    o.field(!s._metadata._resultType.empty(), [&]() { e.string(s._metadata._resultType); });
+    o.field(s._timestamp != 0, [&]() { e.varint(s._timestamp); });
+}
+
+
+void BinaryCodec::_read(Decoder& d, Status& s)
+{
+    Decoder::Object o(d);
+    if (o.has()) s._id = d.integer();
+    if (o.has()) { s._user = std::make_shared<User>(); _read(d, *s._user); }
+    if (o.has()) s._annotations = d.map<std::string>();
+    if (o.has())
+    {
+        std::size_t n = d.count();
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            int64_t id = d.integer();
+            const std::string& screenName = d.string();
+            s._contributors.push_back(BaseNamedUser(id, screenName, d.string()));
+        }
+    }
+    if (o.has())
+    {
+        double latitude = d.real();
+        s._coordinates = std::make_shared<Geo::Coordinate>(latitude, d.real());
+    }
+    if (o.has()) s._createdAt = Poco::DateTime(Poco::Timestamp(d.integer()));
+    if (o.has()) s._utcOffset = d.integer();
+    if (o.has()) s._currentUserRetweet = d.integer();
+    if (o.has()) _read(d, s._entities);
+    if (o.has()) _read(d, s._extendedEntities);
+    if (o.has()) { s._extendedTweet = std::make_shared<Status>(); _read(d, *s._extendedTweet); }
+    if (o.has()) s._favoriteCount = d.integer();
+    if (o.has()) s._quoteCount = d.integer();
+    if (o.has()) s._replyCount = d.integer();
+    s._isQuoteStatus = o.has();
+    if (o.has()) s._quotedStatusId = d.integer();
+    if (o.has()) { s._quotedStatus = std::make_shared<Status>(); _read(d, *s._quotedStatus); }
+    if (o.has())
+    {
+        const std::string& url = d.string();
+        const std::string& displayURL = d.string();
+        s._quotedStatusPermalink = std::make_shared<QuotedStatusPermalink>(url, displayURL, d.string());
+    }
+    s._favorited = o.has();
+    if (o.has()) s._filterLevel = d.enumeration<Status::FilterLevel>(3);
+    if (o.has()) s._inReplyToScreenName = d.string();
+    if (o.has()) s._inReplyToStatusId = d.integer();
+    if (o.has()) s._inReplyToUserId = d.integer();
+    if (o.has()) s._language = d.string();
+    s._possiblySensitive = o.has();
+    if (o.has()) s._scopes = d.map<bool>();
+    if (o.has()) s._retweetCount = d.integer();
+    s._retweeted = o.has();
+    if (o.has()) { s._retweetedStatus = std::make_shared<Status>(); _read(d, *s._retweetedStatus); }
+    if (o.has()) s._source = d.string();
+    if (o.has()) s._text = d.string();
+    if (o.has()) s._fullText = d.string();
+    if (o.has()) s._displayTextStart = d.varint();
+    if (o.has()) s._displayTextEnd = d.varint();
+    s._truncated = o.has();
+    s._withheldCopyright = o.has();
+    if (o.has()) s._withheldInCountries = d.stringList();
+    if (o.has()) s._withheldScope = d.string();
+    if (o.has()) { s._place = std::make_shared<Place>(); _read(d, *s._place); }
+    if (o.has()) s._metadata._isoLanguageCode = d.string();
+    if (o.has()) s._metadata._resultType = d.string();
+    if (o.has()) s._timestamp = d.varint();
+}
+
+
+void BinaryCodec::_write(Encoder& e, const User& u)
+{
+    Encoder::Object o(e);
+    o.field(u._id != -1, [&]() { e.integer(u._id); });
+    o.field(!u._screenName.empty(), [&]() { e.string(u._screenName); });
+    o.field(!u._name.empty(), [&]() { e.string(u._name); });
+    o.flag(u._contributorsEnabled);
+    o.field(true, [&]() { e.integer(u._createdAt.timestamp().epochMicroseconds()); });
+    o.flag(u._defaultProfile);
+    o.flag(u._defaultProfileImage);
+    o.flag(u._hasExtendedProfile);
+    o.field(!u._description.empty(), [&]() { e.string(u._description); });
+    o.field(true, [&]() { _write(e, u._entities); });
+    o.flag(u._geoEnabled);
+    o.field(u._favouritesCount != -1, [&]() { e.integer(u._favouritesCount); });
+    o.flag(u._followRequestSent);
+    o.field(u._followersCount != -1, [&]() { e.integer(u._followersCount); });
+    o.field(u._friendsCount != -1, [&]() { e.integer(u._friendsCount); });
+    o.flag(u._following);
+    o.flag(u._isGeoEnabled);
+    o.flag(u._isTranslator);
+    o.flag(u._isTranslationEnabled);
+    o.flag(u._protected);
+    o.flag(u._verified);
+    o.flag(u._notifications);
+    o.field(!u._language.empty(), [&]() { e.string(u._language); });
+    o.field(u._listedCount != -1, [&]() { e.integer(u._listedCount); });
+    o.field(!u._location.empty(), [&]() { e.string(u._location); });
+    o.field(true, [&]() { _write(e, u._profile); });
+    o.flag(u._isProtected);
+    o.flag(u._showsAllInlineMedia);
+    o.field(u._status != nullptr, [&]() { _write(e, *u._status); });
+    o.field(u._statusesCount != -1, [&]() { e.integer(u._statusesCount); });
+    o.field(u._timeZone != nullptr, [&]() { e.string(*u._timeZone); });
+    o.field(u._url != nullptr, [&]() { e.string(*u._url); });
+    o.field(u._UTCOffset != nullptr, [&]() { e.integer(*u._UTCOffset); });
+    o.field(!u._withheldInCountries.empty(), [&]() { e.stringList(u._withheldInCountries); });
+    o.field(u._withheldScope != User::WithheldScope::USER, [&]() { e.varint(uint64_t(u._withheldScope)); });
+    o.field(!u._translatorType.empty(), [&]() { e.string(u._translatorType); });
+}
+
+
+void BinaryCodec::_read(Decoder& d, User& u)
+{
+    Decoder::Object o(d);
+    if (o.has()) u._id = d.integer();
+    if (o.has()) u._screenName = d.string();
+    if (o.has()) u._name = d.string();
+    u._contributorsEnabled = o.has();
+    if (o.has()) u._createdAt = Poco::DateTime(Poco::Timestamp(d.integer()));
+    u._defaultProfile = o.has();
+    u._defaultProfileImage = o.has();
+    u._hasExtendedProfile = o.has();
+    if (o.has()) u._description = d.string();
+    if (o.has()) _read(d, u._entities);
+    u._geoEnabled = o.has();
+    if (o.has()) u._favouritesCount = d.integer();
+    u._followRequestSent = o.has();
+    if (o.has()) u._followersCount = d.integer();
+    if (o.has()) u._friendsCount = d.integer();
+    u._following = o.has();
+    u._isGeoEnabled = o.has();
+    u._isTranslator = o.has();
+    u._isTranslationEnabled = o.has();
+    u._protected = o.has();
+    u._verified = o.has();
+    u._notifications = o.has();
+    if (o.has()) u._language = d.string();
+    if (o.has()) u._listedCount = d.integer();
+    if (o.has()) u._location = d.string();
+    if (o.has()) _read(d, u._profile);
+    u._isProtected = o.has();
+    u._showsAllInlineMedia = o.has();
+    if (o.has()) { u._status = std::make_shared<Status>(); _read(d, *u._status); }
+    if (o.has()) u._statusesCount = d.integer();
+    if (o.has()) u._timeZone = std::make_shared<std::string>(d.string());
+    if (o.has()) u._url = std::make_shared<std::string>(d.string());
+    if (o.has()) u._UTCOffset = std::make_shared<int64_t>(d.integer());
+    if (o.has()) u._withheldInCountries = d.stringList();
+    if (o.has()) u._withheldScope = d.enumeration<User::WithheldScope>(2);
+    if (o.has()) u._translatorType = d.string();
+}
+
+
+void BinaryCodec::_write(Encoder& e, const Profile& p)
+{
+    Encoder::Object o(e);
+    o.field(!p._backgroundColorHex.empty(), [&]() { e.string(p._backgroundColorHex); });
+    o.field(!p._linkColorHex.empty(), [&]() { e.string(p._linkColorHex); });
+    o.flag(p._useBackgroundImage);
+    o.field(!p._backgroundImageUrl.empty(), [&]() { e.string(p._backgroundImageUrl); });
+    o.field(!p._backgroundImageUrlHttps.empty(), [&]() { e.string(p._backgroundImageUrlHttps); });
+    o.flag(p._backgroundTile);
+    o.field(!p._bannerUrl.empty(), [&]() { e.string(p._bannerUrl); });
+    o.field(!p._sidebarBorderColorHex.empty(), [&]() { e.string(p._sidebarBorderColorHex); });
+    o.field(!p._sidebarFillColorHex.empty(), [&]() { e.string(p._sidebarFillColorHex); });
+    o.field(!p._sidebarTextColorHex.empty(), [&]() { e.string(p._sidebarTextColorHex); });
+}
+
+
+void BinaryCodec::_read(Decoder& d, Profile& p)
+{
+    Decoder::Object o(d);
+    if (o.has()) p._backgroundColorHex = d.string();
+    if (o.has()) p._linkColorHex = d.string();
+    p._useBackgroundImage = o.has();
+    if (o.has()) p._backgroundImageUrl = d.string();
+    if (o.has()) p._backgroundImageUrlHttps = d.string();
+    p._backgroundTile = o.has();
+    if (o.has()) p._bannerUrl = d.string();
+    if (o.has()) p._sidebarBorderColorHex = d.string();
+    if (o.has()) p._sidebarFillColorHex = d.string();
+    if (o.has()) p._sidebarTextColorHex = d.string();
+}
+
+
+void BinaryCodec::_write(Encoder& e, const Place& p)
+{
+    Encoder::Object o(e);
+    o.field(!p._attributes.empty(), [&]() { e.map(p._attributes); });
+    o.field(true, [&]()
+    {
+        e.real(p._boundingBox.southwest().getLatitude());
+        e.real(p._boundingBox.southwest().getLongitude());
+        e.real(p._boundingBox.northeast().getLatitude());
+        e.real(p._boundingBox.northeast().getLongitude());
+    });
+    o.field(!p._country.empty(), [&]() { e.string(p._country); });
+    o.field(!p._countryCode.empty(), [&]() { e.string(p._countryCode); });
+    o.field(!p._fullName.empty(), [&]() { e.string(p._fullName); });
+    o.field(!p._id.empty(), [&]() { e.string(p._id); });
+    o.field(!p._containedWithinIds.empty(), [&]() { e.stringList(p._containedWithinIds); });
+    o.field(!p._name.empty(), [&]() { e.string(p._name); });
+    o.field(!p._placeType.empty(), [&]() { e.string(p._placeType); });
+    o.field(!p._url.empty(), [&]() { e.string(p._url); });
+}
+
+
+void BinaryCodec::_read(Decoder& d, Place& p)
+{
+    Decoder::Object o(d);
+    if (o.has()) p._attributes = d.map<std::string>();
+    if (o.has())
+    {
+        double south = d.real();
+        double west = d.real();
+        double north = d.real();
+        double east = d.real();
+        p._boundingBox = Geo::CoordinateBounds(Geo::Coordinate(south, west),
+                                               Geo::Coordinate(north, east));
+    }
+    if (o.has()) p._country = d.string();
+    if (o.has()) p._countryCode = d.string();
+    if (o.has()) p._fullName = d.string();
+    if (o.has()) p._id = d.string();
+    if (o.has()) p._containedWithinIds = d.stringList();
+    if (o.has()) p._name = d.string();
+    if (o.has()) p._placeType = d.string();
+    if (o.has()) p._url = d.string();
+}
+
+
+void BinaryCodec::_write(Encoder& e, const Entities& entities)
+{
+    Encoder::Object o(e);
+    o.field(!entities._hashTagEntities.empty(), [&]()
+    {
+        e.varint(entities._hashTagEntities.size());
+
+        for (const auto& entity: entities._hashTagEntities)
+        {
+            e.varint(entity.startIndex());
+            e.varint(entity.endIndex());
+            e.string(entity.hashTag());
+        }
+    });
+    o.field(!entities._symbolEntities.empty(), [&]()
+    {
+        e.varint(entities._symbolEntities.size());
+
+        for (const auto& entity: entities._symbolEntities)
+        {
+            e.varint(entity.startIndex());
+            e.varint(entity.endIndex());
+            e.string(entity.symbol());
+        }
+    });
+    o.field(!entities._mediaEntities.empty(), [&]()
+    {
+        e.varint(entities._mediaEntities.size());
+        for (const auto& entity: entities._mediaEntities) _write(e, entity);
+    });
+    o.field(!entities._URLEntities.empty(), [&]()
+    {
+        e.varint(entities._URLEntities.size());
+
+        for (const auto& entity: entities._URLEntities)
+        {
+            e.varint(entity.startIndex());
+            e.varint(entity.endIndex());
+            e.string(entity.url());
+            e.string(entity.displayURL());
+            e.string(entity.expandedURL());
+        }
+    });
+    o.field(!entities._userMentionEntities.empty(), [&]()
+    {
+        e.varint(entities._userMentionEntities.size());
+
+        for (const auto& entity: entities._userMentionEntities)
+        {
+            e.varint(entity.startIndex());
+            e.varint(entity.endIndex());
+            e.integer(entity.id());
+            e.string(entity.screenName());
+            e.string(entity.name());
+        }
+    });
+}
+
+
+void BinaryCodec::_read(Decoder& d, Entities& entities)
+{
+    Decoder::Object o(d);
+    if (o.has())
+    {
+        std::size_t n = d.count();
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t start = d.varint();
+            std::size_t end = d.varint();
+            entities._hashTagEntities.push_back(HashTagEntity(start, end, d.string()));
+        }
+    }
+    if (o.has())
+    {
+        std::size_t n = d.count();
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t start = d.varint();
+            std::size_t end = d.varint();
+            entities._symbolEntities.push_back(SymbolEntity(start, end, d.string()));
+        }
+    }
+    if (o.has())
+    {
+        entities._mediaEntities.resize(d.count());
+        for (auto& entity: entities._mediaEntities) _read(d, entity);
+    }
+    if (o.has())
+    {
+        std::size_t n = d.count();
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t start = d.varint();
+            std::size_t end = d.varint();
+            const std::string& url = d.string();
+            const std::string& displayURL = d.string();
+            entities._URLEntities.push_back(URLEntity(start, end, url, displayURL, d.string()));
+        }
+    }
+    if (o.has())
+    {
+        std::size_t n = d.count();
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t start = d.varint();
+            std::size_t end = d.varint();
+            int64_t id = d.integer();
+            const std::string& screenName = d.string();
+            entities._userMentionEntities.push_back(UserMentionEntity(start, end, id, screenName, d.string()));
+        }
+    }
+}
+
+
+void BinaryCodec::_write(Encoder& e, const MediaEntity& m)
+{
+    Encoder::Object o(e);
+    o.field(m._startIndex != 0, [&]() { e.varint(m._startIndex); });
+    o.field(m._endIndex != 0, [&]() { e.varint(m._endIndex); });
+    o.field(!m._url.empty(), [&]() { e.string(m._url); });
+    o.field(!m._displayURL.empty(), [&]() { e.string(m._displayURL); });
+    o.field(!m._expandedURL.empty(), [&]() { e.string(m._expandedURL); });
+    o.field(!m._mediaURL.empty(), [&]() { e.string(m._mediaURL); });
+    o.field(!m._secureMediaURL.empty(), [&]() { e.string(m._secureMediaURL); });
+    o.field(m._mediaID != -1, [&]() { e.integer(m._mediaID); });
+    o.field(m._type != MediaEntity::Type::PHOTO, [&]() { e.varint(uint64_t(m._type)); });
+    o.field(!m._sizes.empty(), [&]()
+    {
+        e.varint(m._sizes.size());
+
+        for (const auto& size: m._sizes)
+        {
+            e.varint(uint64_t(size.first));
+            e.varint(uint64_t(size.second.resize()));
+            e.varint(size.second.width());
+            e.varint(size.second.height());
+        }
+    });
+    o.field(m._sourceStatusID != -1, [&]() { e.integer(m._sourceStatusID); });
+    o.field(m._sourceUserID != -1, [&]() { e.integer(m._sourceUserID); });
+
+    VideoInfo::AspectRatio aspectRatio = m._videoInfo.aspectRatio();
+    const std::vector<VideoInfo::Variant>& variants = m._videoInfo.variants();
+
+    o.field(aspectRatio.x != 0 || aspectRatio.y != 0 || m._videoInfo.duration() != 0 || !variants.empty(), [&]()
+    {
+        e.varint(aspectRatio.x);
+        e.varint(aspectRatio.y);
+        e.varint(m._videoInfo.duration());
+        e.varint(variants.size());
+
+        for (const auto& variant: variants)
+        {
+            e.varint(variant.bitrate);
+            e.string(variant.contentType);
+            e.string(variant.url);
+        }
+    });
+    o.field(true, [&]() { _write(e, m._additionalMediaInfo); });
+}
+
+
+void BinaryCodec::_read(Decoder& d, MediaEntity& m)
+{
+    Decoder::Object o(d);
+    if (o.has()) m._startIndex = d.varint();
+    if (o.has()) m._endIndex = d.varint();
+    if (o.has()) m._url = d.string();
+    if (o.has()) m._displayURL = d.string();
+    if (o.has()) m._expandedURL = d.string();
+    if (o.has()) m._mediaURL = d.string();
+    if (o.has()) m._secureMediaURL = d.string();
+    if (o.has()) m._mediaID = d.integer();
+    if (o.has()) m._type = d.enumeration<MediaEntity::Type>(uint64_t(MediaEntity::Type::VIDEO) + 1);
+    if (o.has())
+    {
+        std::size_t n = d.count();
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            MediaEntitySize::Type type = d.enumeration<MediaEntitySize::Type>(4);
+            MediaEntitySize::Resize resize = d.enumeration<MediaEntitySize::Resize>(2);
+            std::size_t width = d.varint();
+            std::size_t height = d.varint();
+            m._sizes.insert(std::make_pair(type, MediaEntitySize(resize, width, height)));
+        }
+    }
+    if (o.has()) m._sourceStatusID = d.integer();
+    if (o.has()) m._sourceUserID = d.integer();
+    if (o.has())
+    {
+        VideoInfo::AspectRatio aspectRatio;
+        aspectRatio.x = d.varint();
+        aspectRatio.y = d.varint();
+        uint64_t duration = d.varint();
+
+        std::vector<VideoInfo::Variant> variants(d.count());
+
+        for (auto& variant: variants)
+        {
+            variant.bitrate = d.varint();
+            variant.contentType = d.string();
+            variant.url = d.string();
+        }
+
+        m._videoInfo = VideoInfo(aspectRatio, duration, variants);
+    }
+    if (o.has()) _read(d, m._additionalMediaInfo);
+}
+
+
+void BinaryCodec::_write(Encoder& e, const AdditionalMediaInfo& info)
+{
+    Encoder::Object o(e);
+    o.flag(info._montetizable);
+    o.field(!info._description.empty(), [&]() { e.string(info._description); });
+    o.flag(info._embeddable);
+    o.field(!info._title.empty(), [&]() { e.string(info._title); });
+    o.field(info._sourceUser != nullptr, [&]() { _write(e, *info._sourceUser); });
+}
+
+
+void BinaryCodec::_read(Decoder& d, AdditionalMediaInfo& info)
+{
+    Decoder::Object o(d);
+    info._montetizable = o.has();
+    if (o.has()) info._description = d.string();
+    info._embeddable = o.has();
+    if (o.has()) info._title = d.string();
+    if (o.has()) { info._sourceUser = std::make_shared<User>(); _read(d, *info._sourceUser); }
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,333 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/BulkDecoder.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "ofx/Twitter/StreamMessage.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t BulkDecoder::DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+
+BulkDecoder::BulkDecoder(ThreadPool& pool): _pool(pool), _errorCount(0)
+{
+}
+
+
+std::vector<Status> BulkDecoder::decode(const char* data, std::size_t size)
+{
+    std::vector<Chunk> chunks = _split(data, size);
+    std::vector<std::vector<Status>> results(chunks.size());
+
+    _errorCount = 0;
+
+    _pool.parallelFor(chunks.size(), [&](std::size_t i)
+    {
+        _errorCount += _decode(chunks[i], [&](Status&& status)
+        {
+            results[i].push_back(std::move(status));
+        });
+    }, 1);
+
+    std::size_t total = 0;
+
+    for (const auto& result: results)
+    {
+        total += result.size();
+    }
+
+    std::vector<Status> statuses;
+    statuses.reserve(total);
+
+    for (auto& result: results)
+    {
+        std::move(result.begin(), result.end(), std::back_inserter(statuses));
+    }
+
+    if (_errorCount > 0)
+    {
+        ofLogWarning("BulkDecoder::decode") << "Skipped " << _errorCount << " lines that failed to decode.";
+    }
+
+    return statuses;
+}
+
+
+std::vector<Status> BulkDecoder::decode(const std::string& data)
+{
+    return decode(data.data(), data.size());
+}
+
+
+std::vector<Status> BulkDecoder::decode(const ofBuffer& buffer)
+{
+    return decode(buffer.getData(), buffer.size());
+}
+
+
+std::vector<Status> BulkDecoder::decodeFile(const std::filesystem::path& path)
+{
+    std::vector<Status> statuses;
+
+    _readFile(path, [&](const char* data, std::size_t size)
+    {
+        std::vector<Status> block = decode(data, size);
+        std::move(block.begin(), block.end(), std::back_inserter(statuses));
+    });
+
+    return statuses;
+}
+
+
+std::size_t BulkDecoder::decodeFile(const std::filesystem::path& path,
+                                    const Sink& sink)
+{
+    std::size_t count = 0;
+
+    _readFile(path, [&](const char* data, std::size_t size)
+    {
+        count += decode(data, size, sink);
+    });
+
+    return count;
+}
+
+
+std::size_t BulkDecoder::decode(const char* data, std::size_t size, const Sink& sink)
+{
+    std::vector<Chunk> chunks = _split(data, size);
+    std::atomic<std::size_t> count(0);
+
+    _errorCount = 0;
+
+    _pool.parallelFor(chunks.size(), [&](std::size_t i)
+    {
+        _errorCount += _decode(chunks[i], [&](Status&& status)
+        {
+            sink(status);
+            ++count;
+        });
+    }, 1);
+
+    if (_errorCount > 0)
+    {
+        ofLogWarning("BulkDecoder::decode") << "Skipped " << _errorCount << " lines that failed to decode.";
+    }
+
+    return count;
+}
+
+
+std::size_t BulkDecoder::decode(const char* data, std::size_t size, StatusBatch& batch)
+{
+    std::vector<Chunk> chunks = _split(data, size);
+    std::vector<StatusBatch> results(chunks.size());
+
+    _errorCount = 0;
+
+    _pool.parallelFor(chunks.size(), [&](std::size_t i)
+    {
+        _errorCount += _decode(chunks[i], [&](Status&& status)
+        {
+            results[i].append(std::move(status));
+        });
+    }, 1);
+
+    std::size_t count = 0;
+
+    for (auto& result: results)
+    {
+        count += result.size();
+        batch.append(std::move(result));
+    }
+
+    if (_errorCount > 0)
+    {
+        ofLogWarning("BulkDecoder::decode") << "Skipped " << _errorCount << " lines that failed to decode.";
+    }
+
+    return count;
+}
+
+
+void BulkDecoder::setChunkSize(std::size_t chunkSize)
+{
+    _chunkSize = std::max(std::size_t(1), chunkSize);
+}
+
+
+std::size_t BulkDecoder::getChunkSize() const
+{
+    return _chunkSize;
+}
+
+
+std::size_t BulkDecoder::errorCount() const
+{
+    return _errorCount;
+}
+
+
+void BulkDecoder::_readFile(const std::filesystem::path& path,
+                            const std::function<void(const char*, std::size_t)>& block)
+{
+    std::ifstream stream(ofToDataPath(path, true), std::ios::binary);
+
+    if (!stream)
+    {
+        ofLogError("BulkDecoder::decodeFile") << "Unable to open " << path << ".";
+        _errorCount = 0;
+        return;
+    }
+
+    const std::size_t blockSize = _chunkSize * (_pool.size() + 1) * 4;
+
+    std::vector<char> buffer;
+    std::size_t carry = 0;
+    std::size_t errors = 0;
+
+    while (true)
+    {
+        buffer.resize(carry + blockSize);
+        stream.read(buffer.data() + carry, blockSize);
+
+        std::size_t size = carry + static_cast<std::size_t>(stream.gcount());
+        std::size_t end = size;
+        bool done = !stream;
+
+        if (!done)
+        {
+            // Only decode through the last complete line. The remainder can
+            // not contain a newline, so only the new data is searched.
+            auto last = std::find(std::make_reverse_iterator(buffer.begin() + size),
+                                  std::make_reverse_iterator(buffer.begin() + carry),
+                                  '\n');
+
+            if (last == std::make_reverse_iterator(buffer.begin() + carry))
+            {
+                // The line is longer than a block, so keep reading.
+                carry = size;
+                continue;
+            }
+
+            end = static_cast<std::size_t>(last.base() - buffer.begin());
+        }
+
+        if (end > 0)
+        {
+            block(buffer.data(), end);
+            errors += _errorCount;
+        }
+
+        if (done)
+        {
+            break;
+        }
+
+        carry = size - end;
+        std::memmove(buffer.data(), buffer.data() + end, carry);
+    }
+
+    _errorCount = errors;
+}
+
+
+std::vector<BulkDecoder::Chunk> BulkDecoder::_split(const char* data, std::size_t size) const
+{
+    std::vector<Chunk> chunks;
+
+    const char* begin = data;
+    const char* end = data + size;
+
+    while (begin < end)
+    {
+        const char* split = end;
+
+        if (std::size_t(end - begin) > _chunkSize)
+        {
+            // Extend the chunk to the end of the line it ends in.
+            const void* newline = std::memchr(begin + _chunkSize, '\n', end - (begin + _chunkSize));
+            split = newline ? static_cast<const char*>(newline) + 1 : end;
+        }
+
+        chunks.push_back({ begin, split });
+        begin = split;
+    }
+
+    return chunks;
+}
+
+
+std::size_t BulkDecoder::_decode(const Chunk& chunk,
+                                 const std::function<void(Status&&)>& callback)
+{
+    std::size_t errors = 0;
+    std::string line;
+
+    const char* begin = chunk.begin;
+
+    while (begin < chunk.end)
+    {
+        const void* newline = std::memchr(begin, '\n', chunk.end - begin);
+        const char* end = newline ? static_cast<const char*>(newline) : chunk.end;
+
+        line.assign(begin, end);
+        begin = end + 1;
+
+        Status status;
+
+        try
+        {
+            StreamMessage::Type type = StreamMessage::classify(line);
+
+            if (type == StreamMessage::Type::KEEP_ALIVE
+            || (type != StreamMessage::Type::STATUS && type != StreamMessage::Type::UNKNOWN))
+            {
+                continue;
+            }
+
+            ofJson json = ofJson::parse(line);
+
+            if (json.is_null() || json.empty())
+            {
+                continue;
+            }
+
+            // A leading `created_at` is only a hint, so the status is
+            // confirmed by its `text`.
+            if ((type == StreamMessage::Type::UNKNOWN || json.find("text") == json.end())
+            && StreamMessage::classify(json) != StreamMessage::Type::STATUS)
+            {
+                continue;
+            }
+
+            status = Status::fromJSON(json);
+        }
+        catch (const std::exception&)
+        {
+            ++errors;
+            continue;
+        }
+
+        // The callback is outside of the try block, so that its exceptions
+        // are not counted as decode errors.
+        callback(std::move(status));
+    }
+
+    return errors;
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,566 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/ChunkedMediaUpload.h"
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "Poco/Exception.h"
+#include "ofx/HTTP/GetRequest.h"
+#include "ofx/Twitter/ThreadPool.h"
+#include "ofx/Twitter/Utils.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t ChunkedMediaUpload::DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+const std::size_t ChunkedMediaUpload::DEFAULT_MAX_IN_FLIGHT = 3;
+const std::size_t ChunkedMediaUpload::DEFAULT_MAX_RETRIES = 3;
+const uint64_t ChunkedMediaUpload::MAX_PROCESSING_SECS = 600;
+
+
+ChunkedMediaUpload::ChunkedMediaUpload(const HTTP::OAuth10Credentials& credentials):
+    _transport([credentials](const Poco::Net::NameValueCollection& fields,
+                             const char* data,
+                             std::size_t size)
+    {
+        return execute(credentials, fields, data, size);
+    })
+{
+}
+
+
+ChunkedMediaUpload::ChunkedMediaUpload(Transport transport):
+    _transport(transport)
+{
+}
+
+
+ChunkedMediaUpload::~ChunkedMediaUpload()
+{
+}
+
+
+MediaUploadResponse ChunkedMediaUpload::upload(const std::filesystem::path& path,
+                                               const std::string& mediaType,
+                                               const std::string& mediaCategory)
+{
+    if (!std::filesystem::exists(path))
+    {
+        throw Poco::FileNotFoundException(path.string());
+    }
+
+    std::ifstream istr(path.string(), std::ios::binary);
+
+    Reader read = [&](uint64_t offset, std::size_t size, std::vector<char>& buffer)
+    {
+        buffer.resize(size);
+        istr.seekg(offset);
+        return istr.read(buffer.data(), size) ? buffer.data() : nullptr;
+    };
+
+    return _upload(std::filesystem::file_size(path),
+                   read,
+                   mediaType.empty() ? mediaTypeForPath(path) : mediaType,
+                   mediaCategory,
+                   path);
+}
+
+
+MediaUploadResponse ChunkedMediaUpload::upload(const ofBuffer& buffer,
+                                               const std::string& mediaType,
+                                               const std::string& mediaCategory)
+{
+    // Segments are sent straight from the buffer.
+    Reader read = [&](uint64_t offset, std::size_t, std::vector<char>&)
+    {
+        return buffer.getData() + offset;
+    };
+
+    return _upload(buffer.size(), read, mediaType, mediaCategory, "");
+}
+
+
+MediaUploadResponse ChunkedMediaUpload::_upload(uint64_t totalBytes,
+                                                Reader read,
+                                                const std::string& mediaType,
+                                                const std::string& mediaCategory,
+                                                const std::filesystem::path& path)
+{
+    if (totalBytes == 0)
+    {
+        throw Poco::InvalidArgumentException("Empty media.");
+    }
+
+    bool resumable = _resumable && !path.empty();
+    int64_t modified = resumable ? std::filesystem::last_write_time(path).time_since_epoch().count() : 0;
+    std::filesystem::path stateFile = resumable ? statePath(path) : std::filesystem::path();
+
+    int64_t mediaId = -1;
+    int64_t expiresAt = 0;
+    std::set<std::size_t> acknowledged;
+
+    // Resume if the saved state belongs to this version of the file and the
+    // media id is valid for a while longer.
+    if (resumable && std::filesystem::exists(stateFile))
+    {
+        try
+        {
+            std::ifstream istr(stateFile.string(), std::ios::binary);
+            ofJson state = ofJson::parse(istr);
+
+            if (state.value("size", uint64_t(0)) == totalBytes
+            &&  state.value("modified", int64_t(0)) == modified
+            &&  state.value("chunk_size", std::size_t(0)) == _chunkSize
+            &&  state.value("expires_at", int64_t(0)) > std::time(nullptr) + 60)
+            {
+                mediaId = state.value("media_id", int64_t(-1));
+                expiresAt = state["expires_at"];
+                acknowledged = state.value("segments", std::set<std::size_t>());
+            }
+        }
+        catch (const std::exception& exc)
+        {
+            ofLogWarning("ChunkedMediaUpload::_upload") << "Ignoring invalid state " << stateFile.string() << ": " << exc.what();
+        }
+    }
+
+    if (mediaId < 0)
+    {
+        std::string category = mediaCategory;
+
+        if (category.empty())
+        {
+            if (mediaType == "image/gif") category = "tweet_gif";
+            else if (Utils::startsWith(mediaType, "video/")) category = "tweet_video";
+            else category = "tweet_image";
+        }
+
+        Poco::Net::NameValueCollection fields;
+        fields.set("command", "INIT");
+        fields.set("total_bytes", std::to_string(totalBytes));
+        fields.set("media_type", mediaType);
+        fields.set("media_category", category);
+
+        MediaUploadResponse response = _command(fields);
+
+        mediaId = response.mediaId();
+        expiresAt = std::time(nullptr) + (response.expiresAfterSecs() > 0 ? response.expiresAfterSecs() : 86400);
+        acknowledged.clear();
+    }
+    else
+    {
+        ofLogVerbose("ChunkedMediaUpload::_upload") << "Resuming media " << mediaId << " with " << acknowledged.size() << " segments uploaded.";
+    }
+
+    std::size_t segmentCount = (totalBytes + _chunkSize - 1) / _chunkSize;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::string error;
+    bool rejected = false;
+
+    // Requires mutex.
+    auto saveState = [&]()
+    {
+        if (!resumable)
+        {
+            return;
+        }
+
+        ofJson state;
+        state["media_id"] = mediaId;
+        state["size"] = totalBytes;
+        state["modified"] = modified;
+        state["chunk_size"] = _chunkSize;
+        state["expires_at"] = expiresAt;
+        state["segments"] = acknowledged;
+
+        std::filesystem::path tmp = stateFile;
+        tmp += ".tmp";
+
+        std::error_code ec;
+
+        if (!_stateDirectory.empty())
+        {
+            std::filesystem::create_directories(_stateDirectory, ec);
+        }
+
+        {
+            std::ofstream ostr(tmp.string(), std::ios::binary | std::ios::trunc);
+            ostr << state.dump();
+        }
+
+        std::filesystem::rename(tmp, stateFile, ec);
+    };
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        saveState();
+    }
+
+    // Each slot is a segment buffer that is reused for the whole upload.
+    std::size_t slotCount = std::max(std::size_t(1), std::min(_maxInFlight, segmentCount));
+    std::vector<std::vector<char>> buffers(slotCount);
+    std::vector<std::size_t> freeSlots;
+
+    for (std::size_t i = 0; i < slotCount; ++i)
+    {
+        freeSlots.push_back(i);
+    }
+
+    // Segments are read into the slot buffers by the caller while up to
+    // slotCount segments are sent by the pool.
+    std::vector<const char*> segmentData(slotCount, nullptr);
+
+    {
+        ThreadPool pool(slotCount);
+
+        for (std::size_t segment = 0; segment < segmentCount; ++segment)
+        {
+            if (acknowledged.count(segment) > 0)
+            {
+                continue;
+            }
+
+            std::size_t slot = 0;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return !freeSlots.empty() || !error.empty(); });
+
+                if (!error.empty())
+                {
+                    break;
+                }
+
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+
+            uint64_t offset = uint64_t(segment) * _chunkSize;
+            std::size_t size = std::size_t(std::min<uint64_t>(_chunkSize, totalBytes - offset));
+
+            segmentData[slot] = read(offset, size, buffers[slot]);
+
+            if (segmentData[slot] == nullptr)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                error = "Unable to read segment " + std::to_string(segment);
+                freeSlots.push_back(slot);
+                break;
+            }
+
+            pool.execute([&, slot, segment, size]()
+            {
+                Poco::Net::NameValueCollection fields;
+                fields.set("command", "APPEND");
+                fields.set("media_id", std::to_string(mediaId));
+                fields.set("segment_index", std::to_string(segment));
+
+                std::string failure;
+                bool segmentRejected = false;
+
+                for (std::size_t attempt = 0; attempt <= _maxRetries; ++attempt)
+                {
+                    if (attempt > 0)
+                    {
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            if (!error.empty()) break;
+                        }
+
+                        uint64_t delay = std::min(uint64_t(250) << (attempt - 1), uint64_t(8000));
+                        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+                    }
+
+                    try
+                    {
+                        _transport(fields, segmentData[slot], size);
+                        failure.clear();
+                        break;
+                    }
+                    catch (const Poco::DataException& exc)
+                    {
+                        // Rejected segments fail the same way when retried.
+                        failure = exc.displayText();
+                        segmentRejected = true;
+                        break;
+                    }
+                    catch (const Poco::Exception& exc)
+                    {
+                        failure = exc.displayText();
+                    }
+                    catch (const std::exception& exc)
+                    {
+                        failure = exc.what();
+                    }
+
+                    ofLogWarning("ChunkedMediaUpload::_upload") << "Segment " << segment << " failed: " << failure;
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+
+                if (failure.empty())
+                {
+                    acknowledged.insert(segment);
+                    saveState();
+                }
+                else if (error.empty())
+                {
+                    error = "Unable to upload segment " + std::to_string(segment) + ": " + failure;
+                    rejected = segmentRejected;
+                }
+
+                freeSlots.push_back(slot);
+                condition.notify_all();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return freeSlots.size() == slotCount; });
+    }
+
+    if (rejected)
+    {
+        throw Poco::DataException(error);
+    }
+    else if (!error.empty())
+    {
+        throw Poco::IOException(error);
+    }
+
+    Poco::Net::NameValueCollection fields;
+    fields.set("media_id", std::to_string(mediaId));
+
+    MediaUploadResponse response;
+
+    try
+    {
+        fields.set("command", "FINALIZE");
+        response = _command(fields);
+
+        fields.set("command", "STATUS");
+        uint64_t waited = 0;
+
+        while (response.processingState() == MediaUploadResponse::ProcessingState::PENDING
+            || response.processingState() == MediaUploadResponse::ProcessingState::IN_PROGRESS)
+        {
+            uint64_t delay = std::max(uint64_t(1), response.checkAfterSecs());
+
+            if (waited + delay > MAX_PROCESSING_SECS)
+            {
+                throw Poco::TimeoutException("Media processing did not finish: " + std::to_string(mediaId));
+            }
+
+            std::this_thread::sleep_for(std::chrono::seconds(delay));
+            waited += delay;
+
+            response = _command(fields);
+        }
+    }
+    catch (const Poco::DataException&)
+    {
+        // The media was rejected, so resuming it would fail again.
+        if (resumable) std::filesystem::remove(stateFile);
+        throw;
+    }
+
+    if (resumable) std::filesystem::remove(stateFile);
+
+    return response;
+}
+
+
+void ChunkedMediaUpload::setChunkSize(std::size_t chunkSize)
+{
+    _chunkSize = std::max(std::size_t(1), chunkSize);
+}
+
+
+std::size_t ChunkedMediaUpload::chunkSize() const
+{
+    return _chunkSize;
+}
+
+
+void ChunkedMediaUpload::setMaxInFlight(std::size_t maxInFlight)
+{
+    _maxInFlight = std::max(std::size_t(1), maxInFlight);
+}
+
+
+std::size_t ChunkedMediaUpload::maxInFlight() const
+{
+    return _maxInFlight;
+}
+
+
+void ChunkedMediaUpload::setMaxRetries(std::size_t maxRetries)
+{
+    _maxRetries = maxRetries;
+}
+
+
+std::size_t ChunkedMediaUpload::maxRetries() const
+{
+    return _maxRetries;
+}
+
+
+void ChunkedMediaUpload::setResumable(bool resumable)
+{
+    _resumable = resumable;
+}
+
+
+bool ChunkedMediaUpload::isResumable() const
+{
+    return _resumable;
+}
+
+
+void ChunkedMediaUpload::setStateDirectory(const std::filesystem::path& stateDirectory)
+{
+    _stateDirectory = stateDirectory;
+}
+
+
+std::filesystem::path ChunkedMediaUpload::stateDirectory() const
+{
+    return _stateDirectory;
+}
+
+
+std::filesystem::path ChunkedMediaUpload::statePath(const std::filesystem::path& path) const
+{
+    if (_stateDirectory.empty())
+    {
+        std::filesystem::path result = path;
+        result += ".upload.json";
+        return result;
+    }
+
+    // Files with the same name in different directories get different states.
+    std::ostringstream name;
+    name << path.filename().string() << "."
+         << std::hex << std::hash<std::string>()(std::filesystem::absolute(path).string())
+         << ".upload.json";
+    return _stateDirectory / name.str();
+}
+
+
+std::string ChunkedMediaUpload::mediaTypeForPath(const std::filesystem::path& path)
+{
+    std::string extension = ofToLower(path.extension().string());
+
+    if (extension == ".jpg" || extension == ".jpeg") return "image/jpeg";
+    else if (extension == ".png") return "image/png";
+    else if (extension == ".gif") return "image/gif";
+    else if (extension == ".webp") return "image/webp";
+    else if (extension == ".mp4") return "video/mp4";
+    else if (extension == ".mov") return "video/quicktime";
+
+    return "application/octet-stream";
+}
+
+
+ofJson ChunkedMediaUpload::execute(const HTTP::OAuth10Credentials& credentials,
+                                   const Poco::Net::NameValueCollection& fields,
+                                   const char* data,
+                                   std::size_t size)
+{
+    // Clients are not shared, since APPEND commands run concurrently.
+    HTTP::OAuth10HTTPClient client(credentials);
+
+    std::unique_ptr<HTTP::ClientResponse> response;
+
+    if (data != nullptr)
+    {
+        MediaAppendRequest request(std::stoll(fields.get("media_id")),
+                                   std::stoul(fields.get("segment_index")),
+                                   data,
+                                   size);
+        response = client.execute(request);
+    }
+    else if (fields.get("command", "") == "STATUS")
+    {
+        HTTP::GetRequest request(MediaUploadRequest::RESOURCE_URL);
+        request.addFormFields(fields);
+        response = client.execute(request);
+    }
+    else
+    {
+        MediaUploadRequest request;
+        request.addFormFields(fields);
+        response = client.execute(request);
+    }
+
+    if (response == nullptr)
+    {
+        throw Poco::IOException("No response.");
+    }
+
+    ofBuffer buffer = response->buffer();
+    ofJson json = ofJson::object();
+
+    if (buffer.size() > 0)
+    {
+        json = ofJson::parse(buffer.begin(), buffer.end(), nullptr, false);
+    }
+
+    if (!response->isSuccess())
+    {
+        std::string message = std::to_string(response->getStatus()) + " " + response->getReason();
+
+        if (json.is_object() && json.find("errors") != json.end() && !json["errors"].empty())
+        {
+            message += ": " + Error::fromJSON(json["errors"][0]).message();
+        }
+
+        // Client errors other than rate limiting mean the media or the
+        // request was rejected.
+        if (response->getStatus() >= 400 && response->getStatus() < 500 && response->getStatus() != 429)
+        {
+            throw Poco::DataException(message);
+        }
+
+        throw Poco::IOException(message);
+    }
+
+    return json.is_discarded() ? ofJson::object() : json;
+}
+
+
+MediaUploadResponse ChunkedMediaUpload::_command(const Poco::Net::NameValueCollection& fields)
+{
+    MediaUploadResponse response = MediaUploadResponse::fromJSON(_transport(fields, nullptr, 0));
+
+    if (!response.errors().empty())
+    {
+        throw Poco::DataException(fields.get("command", "") + ": " + response.errors()[0].message());
+    }
+
+    if (response.processingState() == MediaUploadResponse::ProcessingState::FAILED)
+    {
+        throw Poco::DataException("Media processing failed: " + std::to_string(response.mediaId()));
+    }
+
+    return response;
+}
+
+
+} } // namespace ofx::Twitter
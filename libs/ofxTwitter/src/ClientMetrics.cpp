@@ -0,0 +1,351 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/ClientMetrics.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+
+namespace ofx {
+namespace Twitter {
+
+
+constexpr std::size_t LatencyHistogram::SUB_BUCKET_BITS;
+constexpr std::size_t LatencyHistogram::SUB_BUCKET_COUNT;
+constexpr std::size_t LatencyHistogram::BUCKET_COUNT;
+
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+
+void LatencyHistogram::record(uint64_t micros)
+{
+    _buckets[_bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t current = _min.load(std::memory_order_relaxed);
+    while (micros < current && !_min.compare_exchange_weak(current, micros, std::memory_order_relaxed))
+    {
+    }
+
+    current = _max.load(std::memory_order_relaxed);
+    while (micros > current && !_max.compare_exchange_weak(current, micros, std::memory_order_relaxed))
+    {
+    }
+}
+
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket: _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::sum() const
+{
+    return _sum.load(std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::min() const
+{
+    return count() > 0 ? _min.load(std::memory_order_relaxed) : 0;
+}
+
+
+uint64_t LatencyHistogram::max() const
+{
+    return _max.load(std::memory_order_relaxed);
+}
+
+
+double LatencyHistogram::mean() const
+{
+    uint64_t n = count();
+    return n > 0 ? static_cast<double>(sum()) / n : 0;
+}
+
+
+uint64_t LatencyHistogram::percentile(double percentile) const
+{
+    uint64_t total = 0;
+
+    for (const auto& bucket: _buckets)
+    {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    percentile = std::max(0.0, std::min(100.0, percentile));
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * total + 0.5);
+    target = std::max(target, uint64_t(1));
+
+    uint64_t seen = 0;
+
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+
+        if (seen >= target)
+        {
+            // The bucket bound may overshoot the true maximum.
+            return std::min(_bucketUpperBound(i), max());
+        }
+    }
+
+    return max();
+}
+
+
+ofJson LatencyHistogram::toJSON() const
+{
+    ofJson json;
+    json["count"] = count();
+    json["sum_us"] = sum();
+    json["min_us"] = min();
+    json["max_us"] = max();
+    json["mean_us"] = mean();
+    json["p50_us"] = percentile(50);
+    json["p90_us"] = percentile(90);
+    json["p99_us"] = percentile(99);
+    json["p999_us"] = percentile(99.9);
+    return json;
+}
+
+
+std::size_t LatencyHistogram::_bucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKET_COUNT)
+    {
+        return static_cast<std::size_t>(value);
+    }
+
+    // Position of the most significant bit.
+    std::size_t exponent = 63;
+    while ((value >> exponent) == 0)
+    {
+        --exponent;
+    }
+
+    std::size_t shift = exponent - SUB_BUCKET_BITS;
+    std::size_t subBucket = static_cast<std::size_t>(value >> shift) - SUB_BUCKET_COUNT;
+    return (shift + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+
+uint64_t LatencyHistogram::_bucketUpperBound(std::size_t index)
+{
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+
+    std::size_t shift = index / SUB_BUCKET_COUNT - 1;
+    uint64_t subBucket = index % SUB_BUCKET_COUNT;
+    uint64_t lower = (SUB_BUCKET_COUNT + subBucket) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+
+constexpr std::size_t ClientMetrics::EVENT_COUNT;
+constexpr std::size_t ClientMetrics::STAGE_COUNT;
+
+
+ClientMetrics::ClientMetrics()
+{
+    reset();
+}
+
+
+void ClientMetrics::increment(Event event, uint64_t count)
+{
+    if (event == Event::CONNECT)
+    {
+        _limitTrackPrevious.fetch_add(_limitTrackCurrent.exchange(0, std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
+    }
+
+    _counts[static_cast<std::size_t>(event)].fetch_add(count, std::memory_order_relaxed);
+}
+
+
+uint64_t ClientMetrics::count(Event event) const
+{
+    return _counts[static_cast<std::size_t>(event)].load(std::memory_order_relaxed);
+}
+
+
+void ClientMetrics::addBytesReceived(uint64_t bytes)
+{
+    _bytesReceived.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+
+uint64_t ClientMetrics::bytesReceived() const
+{
+    return _bytesReceived.load(std::memory_order_relaxed);
+}
+
+
+void ClientMetrics::setLimitTrack(uint64_t track)
+{
+    _limitTrackCurrent.store(track, std::memory_order_relaxed);
+}
+
+
+uint64_t ClientMetrics::limitTrackTotal() const
+{
+    return _limitTrackPrevious.load(std::memory_order_relaxed)
+         + _limitTrackCurrent.load(std::memory_order_relaxed);
+}
+
+
+void ClientMetrics::addQueued(Event event, uint64_t count)
+{
+    _queueDepths[static_cast<std::size_t>(event)].fetch_add(count, std::memory_order_relaxed);
+}
+
+
+void ClientMetrics::removeQueued(Event event, uint64_t count)
+{
+    _queueDepths[static_cast<std::size_t>(event)].fetch_sub(count, std::memory_order_relaxed);
+}
+
+
+uint64_t ClientMetrics::queueDepth(Event event) const
+{
+    // The gauge may briefly go negative if a receive is counted before the
+    // matching send on another thread.
+    int64_t depth = _queueDepths[static_cast<std::size_t>(event)].load(std::memory_order_relaxed);
+    return depth > 0 ? static_cast<uint64_t>(depth) : 0;
+}
+
+
+uint64_t ClientMetrics::record(Stage stage, uint64_t start)
+{
+    uint64_t end = now();
+    _histograms[static_cast<std::size_t>(stage)].record(end > start ? end - start : 0);
+    return end;
+}
+
+
+const LatencyHistogram& ClientMetrics::histogram(Stage stage) const
+{
+    return _histograms[static_cast<std::size_t>(stage)];
+}
+
+
+void ClientMetrics::reset()
+{
+    for (auto& count: _counts) count.store(0, std::memory_order_relaxed);
+    for (auto& depth: _queueDepths) depth.store(0, std::memory_order_relaxed);
+    for (auto& histogram: _histograms) histogram.reset();
+
+    _bytesReceived.store(0, std::memory_order_relaxed);
+    _limitTrackCurrent.store(0, std::memory_order_relaxed);
+    _limitTrackPrevious.store(0, std::memory_order_relaxed);
+}
+
+
+ofJson ClientMetrics::toJSON() const
+{
+    ofJson json;
+
+    for (std::size_t i = 0; i < EVENT_COUNT; ++i)
+    {
+        Event event = static_cast<Event>(i);
+        json["counts"][to_string(event)] = count(event);
+        json["queue_depths"][to_string(event)] = queueDepth(event);
+    }
+
+    for (std::size_t i = 0; i < STAGE_COUNT; ++i)
+    {
+        Stage stage = static_cast<Stage>(i);
+        json["latency"][to_string(stage)] = histogram(stage).toJSON();
+    }
+
+    json["bytes_received"] = bytesReceived();
+    json["limit_track_total"] = limitTrackTotal();
+
+    // The fraction of processing time not spent waiting on the network.
+    // Values approaching 1 indicate the client is CPU-bound.
+    uint64_t read = histogram(Stage::READ).sum();
+    uint64_t busy = histogram(Stage::PARSE).sum() + histogram(Stage::DELIVER).sum();
+    json["cpu_fraction"] = (read + busy) > 0 ? static_cast<double>(busy) / (read + busy) : 0.0;
+
+    return json;
+}
+
+
+uint64_t ClientMetrics::now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+std::string ClientMetrics::to_string(Event event)
+{
+    switch (event)
+    {
+        case Event::CONNECT: return "connect";
+        case Event::DISCONNECT: return "disconnect";
+        case Event::MESSAGE: return "message";
+        case Event::STATUS: return "status";
+        case Event::STATUS_DELETED_NOTICE: return "status_deleted_notice";
+        case Event::LOCATION_DELETED_NOTICE: return "location_deleted_notice";
+        case Event::LIMIT_NOTICE: return "limit_notice";
+        case Event::STATUS_WITHHELD_NOTICE: return "status_withheld_notice";
+        case Event::USER_WITHHELD_NOTICE: return "user_withheld_notice";
+        case Event::DISCONNECT_NOTICE: return "disconnect_notice";
+        case Event::STALL_WARNING: return "stall_warning";
+        case Event::API_ERROR: return "api_error";
+        case Event::EXCEPTION: return "exception";
+    }
+
+    return "unknown";
+}
+
+
+std::string ClientMetrics::to_string(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::READ: return "read";
+        case Stage::PARSE: return "parse";
+        case Stage::DELIVER: return "deliver";
+    }
+
+    return "unknown";
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,298 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/ColumnarBatch.h"
+#include <fstream>
+#include "ofx/Twitter/User.h"
+#include "ofx/Twitter/Utils.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+/// \brief Writes the columnar file layout and tracks buffer alignment.
+class ColumnWriter
+{
+public:
+    ColumnWriter(std::ostream& ostr): _ostr(ostr)
+    {
+    }
+
+    template <typename T>
+    void value(T v)
+    {
+        bytes(&v, sizeof(T));
+    }
+
+    void bytes(const void* data, std::size_t size)
+    {
+        _ostr.write(static_cast<const char*>(data), std::streamsize(size));
+        _offset += size;
+    }
+
+    template <typename T>
+    void buffer(const std::vector<T>& values)
+    {
+        value(uint64_t(values.size() * sizeof(T)));
+
+        static const char padding[8] = { 0 };
+        bytes(padding, (8 - _offset % 8) % 8);
+
+        if (!values.empty())
+        {
+            bytes(values.data(), values.size() * sizeof(T));
+        }
+    }
+
+    void header(const std::string& name,
+                ColumnarBatch::ColumnType type,
+                uint8_t buffers)
+    {
+        value(uint16_t(name.size()));
+        bytes(name.data(), name.size());
+        value(uint8_t(type));
+        value(buffers);
+    }
+
+    template <typename T>
+    void column(const std::string& name,
+                ColumnarBatch::ColumnType type,
+                const FixedColumn<T>& column)
+    {
+        header(name, type, 2);
+        buffer(column.validity);
+        buffer(column.values);
+    }
+
+    void column(const std::string& name, const StringColumn& column)
+    {
+        header(name, ColumnarBatch::ColumnType::STRING, 3);
+        strings(column);
+    }
+
+    void column(const std::string& name, const ListColumn<StringColumn>& column)
+    {
+        header(name, ColumnarBatch::ColumnType::STRING_LIST, 4);
+        buffer(column.offsets);
+        strings(column.values);
+    }
+
+    void column(const std::string& name, const ListColumn<std::vector<int64_t>>& column)
+    {
+        header(name, ColumnarBatch::ColumnType::INT64_LIST, 2);
+        buffer(column.offsets);
+        buffer(column.values);
+    }
+
+private:
+    void strings(const StringColumn& column)
+    {
+        buffer(column.validity);
+        buffer(column.offsets);
+        buffer(column.data);
+    }
+
+    std::ostream& _ostr;
+    std::size_t _offset = 0;
+
+};
+
+
+} // namespace
+
+
+const std::string ColumnarBatch::MAGIC = "OFXTCOL1";
+
+
+StringColumn::StringColumn(): offsets(1, 0)
+{
+}
+
+
+void StringColumn::append(const std::string& value, bool valid)
+{
+    std::size_t row = size();
+
+    if (row % 8 == 0)
+    {
+        validity.push_back(0);
+    }
+
+    if (valid)
+    {
+        validity.back() |= uint8_t(1 << (row % 8));
+        data.insert(data.end(), value.begin(), value.end());
+    }
+
+    offsets.push_back(uint32_t(data.size()));
+}
+
+
+std::string StringColumn::get(std::size_t row) const
+{
+    return std::string(data.data() + offsets[row], data.data() + offsets[row + 1]);
+}
+
+
+bool StringColumn::isValid(std::size_t row) const
+{
+    return (validity[row / 8] >> (row % 8)) & 1;
+}
+
+
+std::size_t StringColumn::size() const
+{
+    return offsets.size() - 1;
+}
+
+
+void ColumnarBatch::append(const Status& status)
+{
+    id.append(status.id());
+    createdAt.append(status.createdAt().timestamp().epochMicroseconds() / 1000);
+    timestamp.append(Utils::timestamp(status));
+    const std::string& lang = status.language();
+    language.append(lang, !lang.empty());
+
+    const User* user = status.user();
+    userId.append(user ? user->id() : 0, user != nullptr);
+    userScreenName.append(user ? user->screenName() : "", user != nullptr);
+
+    // Absent ids and counts default to -1 in Status, so they are exported as
+    // null values.
+    int64_t inReplyTo = status.inReplyToStatusId();
+    inReplyToStatusId.append(inReplyTo > 0 ? inReplyTo : 0, inReplyTo > 0);
+
+    const Status* retweeted = status.retweetedStatus();
+    retweetedStatusId.append(retweeted ? retweeted->id() : 0, retweeted != nullptr);
+
+    quotedStatusId.append(status.quotedStatusId(), status.isQuoteStatus());
+
+    auto appendCount = [](FixedColumn<int64_t>& column, int64_t count)
+    {
+        column.append(count >= 0 ? count : 0, count >= 0);
+    };
+
+    appendCount(retweetCount, status.retweetCount());
+    appendCount(favoriteCount, status.favoriteCount());
+    appendCount(quoteCount, status.quoteCount());
+    appendCount(replyCount, status.replyCount());
+
+    const Geo::Coordinate* coordinates = status.coordinates();
+    latitude.append(coordinates ? coordinates->getLatitude() : 0, coordinates != nullptr);
+    longitude.append(coordinates ? coordinates->getLongitude() : 0, coordinates != nullptr);
+
+    const Status* extended = status.extendedTweet();
+    const Entities& entities = extended ? extended->entities() : status.entities();
+
+    for (const auto& entity: entities.hashTagEntities()) hashtags.values.append(entity.hashTag());
+    hashtags.endRow();
+
+    for (const auto& entity: entities.symbolEntities()) symbols.values.append(entity.symbol());
+    symbols.endRow();
+
+    for (const auto& entity: entities.userMentionEntities()) mentionIds.values.push_back(entity.id());
+    mentionIds.endRow();
+
+    for (const auto& entity: entities.urlEntities()) urls.values.append(entity.expandedURL());
+    urls.endRow();
+
+    for (const auto& entity: entities.mediaEntities()) mediaIds.values.push_back(entity.mediaID());
+    mediaIds.endRow();
+}
+
+
+void ColumnarBatch::reserve(std::size_t rows)
+{
+    id.values.reserve(rows);
+    createdAt.values.reserve(rows);
+    timestamp.values.reserve(rows);
+    language.offsets.reserve(rows + 1);
+    userId.values.reserve(rows);
+    userScreenName.offsets.reserve(rows + 1);
+    inReplyToStatusId.values.reserve(rows);
+    retweetedStatusId.values.reserve(rows);
+    quotedStatusId.values.reserve(rows);
+    retweetCount.values.reserve(rows);
+    favoriteCount.values.reserve(rows);
+    quoteCount.values.reserve(rows);
+    replyCount.values.reserve(rows);
+    latitude.values.reserve(rows);
+    longitude.values.reserve(rows);
+    hashtags.offsets.reserve(rows + 1);
+    symbols.offsets.reserve(rows + 1);
+    mentionIds.offsets.reserve(rows + 1);
+    urls.offsets.reserve(rows + 1);
+    mediaIds.offsets.reserve(rows + 1);
+}
+
+
+std::size_t ColumnarBatch::size() const
+{
+    return id.values.size();
+}
+
+
+void ColumnarBatch::clear()
+{
+    *this = ColumnarBatch();
+}
+
+
+bool ColumnarBatch::write(std::ostream& ostr) const
+{
+    ColumnWriter writer(ostr);
+
+    writer.bytes(MAGIC.data(), MAGIC.size());
+    writer.value(uint64_t(size()));
+    writer.value(uint32_t(20));
+
+    writer.column("id", ColumnType::INT64, id);
+    writer.column("created_at", ColumnType::INT64, createdAt);
+    writer.column("timestamp_ms", ColumnType::UINT64, timestamp);
+    writer.column("lang", language);
+    writer.column("user_id", ColumnType::INT64, userId);
+    writer.column("user_screen_name", userScreenName);
+    writer.column("in_reply_to_status_id", ColumnType::INT64, inReplyToStatusId);
+    writer.column("retweeted_status_id", ColumnType::INT64, retweetedStatusId);
+    writer.column("quoted_status_id", ColumnType::INT64, quotedStatusId);
+    writer.column("retweet_count", ColumnType::INT64, retweetCount);
+    writer.column("favorite_count", ColumnType::INT64, favoriteCount);
+    writer.column("quote_count", ColumnType::INT64, quoteCount);
+    writer.column("reply_count", ColumnType::INT64, replyCount);
+    writer.column("latitude", ColumnType::FLOAT64, latitude);
+    writer.column("longitude", ColumnType::FLOAT64, longitude);
+    writer.column("hashtags", hashtags);
+    writer.column("symbols", symbols);
+    writer.column("mention_ids", mentionIds);
+    writer.column("urls", urls);
+    writer.column("media_ids", mediaIds);
+
+    return ostr.good();
+}
+
+
+bool ColumnarBatch::save(const std::filesystem::path& path) const
+{
+    std::ofstream ostr(path.string(), std::ios::binary);
+
+    if (!ostr)
+    {
+        ofLogError("ColumnarBatch::save") << "Unable to open " << path.string();
+        return false;
+    }
+
+    return write(ostr);
+}
+
+
+} } // namespace ofx::Twitter
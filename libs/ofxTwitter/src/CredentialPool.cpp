@@ -0,0 +1,250 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/CredentialPool.h"
+#include <chrono>
+#include <limits>
+#include "ofJson.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+CredentialPool::CredentialPool()
+{
+}
+
+
+CredentialPool::CredentialPool(const std::vector<HTTP::OAuth10Credentials>& credentials)
+{
+    for (const auto& c: credentials)
+    {
+        add(c);
+    }
+}
+
+
+CredentialPool::~CredentialPool()
+{
+}
+
+
+std::size_t CredentialPool::add(const HTTP::OAuth10Credentials& credentials)
+{
+    Entry entry;
+    entry.credentials = credentials;
+    entry.signer = std::make_shared<OAuth10Signer>(credentials);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _entries.push_back(entry);
+    return _entries.size() - 1;
+}
+
+
+std::size_t CredentialPool::addFromFile(const std::filesystem::path& path)
+{
+    ofJson json = ofLoadJson(path);
+
+    if (json.is_object())
+    {
+        add(HTTP::OAuth10Credentials::fromJSON(json));
+        return 1;
+    }
+    else if (json.is_array())
+    {
+        for (const auto& credentials: json)
+        {
+            add(HTTP::OAuth10Credentials::fromJSON(credentials));
+        }
+
+        return json.size();
+    }
+
+    ofLogError("CredentialPool::addFromFile") << "No credentials in " << path.string();
+    return 0;
+}
+
+
+std::size_t CredentialPool::size() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+
+HTTP::OAuth10Credentials CredentialPool::credentials(std::size_t index) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _entries.at(index).credentials;
+}
+
+
+std::shared_ptr<OAuth10Signer> CredentialPool::signer(std::size_t index) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _entries.at(index).signer;
+}
+
+
+bool CredentialPool::tryAcquire(const std::string& endpoint, std::size_t& index)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    uint64_t now = _now();
+    uint64_t best = 0;
+    Budget* bestBudget = nullptr;
+
+    for (std::size_t i = 0; i < _entries.size(); ++i)
+    {
+        Budget& budget = _entries[i].budgets[endpoint];
+        uint64_t estimate = _estimate(budget, now);
+
+        if (estimate > best)
+        {
+            best = estimate;
+            bestBudget = &budget;
+            index = i;
+        }
+    }
+
+    if (bestBudget == nullptr)
+    {
+        return false;
+    }
+
+    bestBudget->acquired++;
+    return true;
+}
+
+
+void CredentialPool::release(std::size_t index,
+                             const std::string& endpoint,
+                             const RateLimit& rateLimit)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (index >= _entries.size())
+    {
+        ofLogError("CredentialPool::release") << "Invalid index " << index;
+        return;
+    }
+
+    Budget& budget = _entries[index].budgets[endpoint];
+
+    if (budget.acquired > 0)
+    {
+        budget.acquired--;
+    }
+
+    // Responses can arrive out of order, so an older window does not
+    // replace a newer one.
+    if (rateLimit.limit() > 0 && rateLimit.reset() >= budget.rateLimit.reset())
+    {
+        if (rateLimit.reset() > budget.rateLimit.reset()
+         || rateLimit.remaining() < budget.rateLimit.remaining()
+         || budget.rateLimit.limit() == 0)
+        {
+            budget.rateLimit = rateLimit;
+        }
+    }
+}
+
+
+RateLimit CredentialPool::rateLimit(std::size_t index, const std::string& endpoint) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (index < _entries.size())
+    {
+        auto iter = _entries[index].budgets.find(endpoint);
+
+        if (iter != _entries[index].budgets.end())
+        {
+            return iter->second.rateLimit;
+        }
+    }
+
+    return RateLimit();
+}
+
+
+uint64_t CredentialPool::remaining(const std::string& endpoint) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    uint64_t now = _now();
+    uint64_t total = 0;
+
+    for (const auto& entry: _entries)
+    {
+        auto iter = entry.budgets.find(endpoint);
+
+        if (iter != entry.budgets.end()
+         && iter->second.rateLimit.limit() > 0
+         && iter->second.rateLimit.reset() > now)
+        {
+            total += _estimate(iter->second, now);
+        }
+    }
+
+    return total;
+}
+
+
+uint64_t CredentialPool::nextReset(const std::string& endpoint) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    uint64_t now = _now();
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+
+    for (const auto& entry: _entries)
+    {
+        auto iter = entry.budgets.find(endpoint);
+
+        if (iter == entry.budgets.end() || _estimate(iter->second, now) > 0)
+        {
+            return 0;
+        }
+
+        next = std::min(next, iter->second.rateLimit.reset());
+    }
+
+    return _entries.empty() ? 0 : next;
+}
+
+
+std::string CredentialPool::endpoint(const HTTP::Request& request)
+{
+    std::string uri = request.getURI();
+    return uri.substr(0, uri.find('?'));
+}
+
+
+uint64_t CredentialPool::_estimate(const Budget& budget, uint64_t now)
+{
+    const RateLimit& rateLimit = budget.rateLimit;
+
+    if (rateLimit.limit() == 0 || rateLimit.reset() <= now)
+    {
+        return std::numeric_limits<uint64_t>::max() - budget.acquired;
+    }
+
+    return rateLimit.remaining() > budget.acquired ? rateLimit.remaining() - budget.acquired : 0;
+}
+
+
+uint64_t CredentialPool::_now()
+{
+    using namespace std::chrono;
+    return duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+}
+
+
+} } // namespace ofx::Twitter
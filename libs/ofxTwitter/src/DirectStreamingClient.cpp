@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/DirectStreamingClient.h"
+#include "ofx/Twitter/Trace.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+DirectStreamingClient::DirectStreamingClient(StreamingSink* sink,
+                                             Executor executor):
+    DirectStreamingClient(HTTP::OAuth10Credentials(), sink, executor)
+{
+}
+
+
+DirectStreamingClient::DirectStreamingClient(const HTTP::OAuth10Credentials& credentials,
+                                             StreamingSink* sink,
+                                             Executor executor):
+    BaseStreamingClient(credentials),
+    _sink(sink),
+    _executor(executor)
+{
+}
+
+
+DirectStreamingClient::~DirectStreamingClient()
+{
+    // The streaming thread calls back into this object, so it must be
+    // stopped before the members are destroyed.
+    stopAndJoin();
+}
+
+
+void DirectStreamingClient::setSink(StreamingSink* sink)
+{
+    _sink.store(sink, std::memory_order_release);
+}
+
+
+StreamingSink* DirectStreamingClient::sink() const
+{
+    return _sink.load(std::memory_order_acquire);
+}
+
+
+void DirectStreamingClient::setExecutor(Executor executor)
+{
+    if (isRunning())
+    {
+        ofLogWarning("DirectStreamingClient::setExecutor") << "The executor cannot be changed while the client is running.";
+        return;
+    }
+
+    _executor = executor;
+}
+
+
+void DirectStreamingClient::_deliver(void (StreamingSink::*callback)())
+{
+    if (_executor)
+    {
+        _executor([this, callback]()
+        {
+            StreamingSink* sink = _sink.load(std::memory_order_acquire);
+            if (sink) (sink->*callback)();
+        });
+    }
+    else
+    {
+        StreamingSink* sink = _sink.load(std::memory_order_acquire);
+        if (sink) (sink->*callback)();
+    }
+}
+
+
+void DirectStreamingClient::_onConnect()
+{
+    _deliver(&StreamingSink::onConnect);
+}
+
+
+void DirectStreamingClient::_onDisconnect()
+{
+    _deliver(&StreamingSink::onDisconnect);
+}
+
+
+void DirectStreamingClient::_onStatus(const Status& status)
+{
+    OFX_TWITTER_TRACE_SCOPE("DirectStreamingClient::onStatus");
+    _deliver(&StreamingSink::onStatus, status);
+}
+
+
+void DirectStreamingClient::_onStatusDeletedNotice(const StatusDeletedNotice& notice)
+{
+    _deliver(&StreamingSink::onStatusDeletedNotice, notice);
+}
+
+
+void DirectStreamingClient::_onLocationDeletedNotice(const LocationDeletedNotice& notice)
+{
+    _deliver(&StreamingSink::onLocationDeletedNotice, notice);
+}
+
+
+void DirectStreamingClient::_onLimitNotice(const LimitNotice& notice)
+{
+    _deliver(&StreamingSink::onLimitNotice, notice);
+}
+
+
+void DirectStreamingClient::_onStatusWithheldNotice(const StatusWithheldNotice& notice)
+{
+    _deliver(&StreamingSink::onStatusWithheldNotice, notice);
+}
+
+
+void DirectStreamingClient::_onUserWitheldNotice(const UserWithheldNotice& notice)
+{
+    _deliver(&StreamingSink::onUserWitheldNotice, notice);
+}
+
+
+void DirectStreamingClient::_onDisconnectNotice(const DisconnectNotice& notice)
+{
+    _deliver(&StreamingSink::onDisconnectNotice, notice);
+}
+
+
+void DirectStreamingClient::_onStallWarning(const StallWarning& notice)
+{
+    _deliver(&StreamingSink::onStallWarning, notice);
+}
+
+
+void DirectStreamingClient::_onException(const std::exception& exc)
+{
+    _deliver(&StreamingSink::onException, exc);
+}
+
+
+void DirectStreamingClient::_onMessage(const ofJson& message)
+{
+    _deliver(&StreamingSink::onMessage, message);
+}
+
+
+bool DirectStreamingClient::_wantsMessages() const
+{
+    StreamingSink* sink = _sink.load(std::memory_order_acquire);
+    return sink && sink->wantsMessages();
+}
+
+
+} } // namespace ofx::Twitter
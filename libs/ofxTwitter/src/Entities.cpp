@@ -7,6 +7,7 @@
 
 #include "ofx/Twitter/Entities.h"
 #include "ofx/Twitter/User.h"
+#include "ofx/Twitter/Trace.h"
 #include "ofx/Twitter/Utils.h"
 #include "ofLog.h"
 #include "Poco/Exception.h"
@@ -66,7 +67,7 @@ SymbolEntity::~SymbolEntity()
 }
 
 
-std::string SymbolEntity::symbol() const
+const std::string& SymbolEntity::symbol() const
 {
     return _symbol;
 }
@@ -131,7 +132,7 @@ HashTagEntity::~HashTagEntity()
 }
 
 
-std::string HashTagEntity::hashTag() const
+const std::string& HashTagEntity::hashTag() const
 {
     return _hashTag;
 }
@@ -204,19 +205,19 @@ URLEntity::~URLEntity()
 }
 
 
-std::string URLEntity::url() const
+const std::string& URLEntity::url() const
 {
     return _url;
 }
 
 
-std::string URLEntity::displayURL() const
+const std::string& URLEntity::displayURL() const
 {
     return _displayURL;
 }
 
 
-std::string URLEntity::expandedURL() const
+const std::string& URLEntity::expandedURL() const
 {
     return _expandedURL;
 }
@@ -293,19 +294,19 @@ QuotedStatusPermalink::~QuotedStatusPermalink()
 }
 
 
-std::string QuotedStatusPermalink::url() const
+const std::string& QuotedStatusPermalink::url() const
 {
     return _url;
 }
 
 
-std::string QuotedStatusPermalink::displayURL() const
+const std::string& QuotedStatusPermalink::displayURL() const
 {
     return _displayURL;
 }
 
 
-std::string QuotedStatusPermalink::expandedURL() const
+const std::string& QuotedStatusPermalink::expandedURL() const
 {
     return _expandedURL;
 }
@@ -437,7 +438,7 @@ uint64_t VideoInfo::duration() const
 }
 
 
-std::vector<VideoInfo::Variant> VideoInfo::variants() const
+const std::vector<VideoInfo::Variant>& VideoInfo::variants() const
 {
     return _variants;
 }
@@ -507,7 +508,7 @@ bool AdditionalMediaInfo::monetizable() const
 }
 
 
-std::string AdditionalMediaInfo::description() const
+const std::string& AdditionalMediaInfo::description() const
 {
     return _description;
 }
@@ -519,7 +520,7 @@ bool AdditionalMediaInfo::embeddable() const
 }
 
 
-std::string AdditionalMediaInfo::title() const
+const std::string& AdditionalMediaInfo::title() const
 {
     return _title;
 }
@@ -608,13 +609,13 @@ MediaEntity::~MediaEntity()
 }
 
 
-std::string MediaEntity::mediaURL() const
+const std::string& MediaEntity::mediaURL() const
 {
     return _mediaURL;
 }
 
 
-std::string MediaEntity::secureMediaURL() const
+const std::string& MediaEntity::secureMediaURL() const
 {
     return _secureMediaURL;
 }
@@ -648,7 +649,7 @@ std::string MediaEntity::mediaFileExtension() const
 }
 
 
-MediaEntity::Sizes MediaEntity::sizes() const
+const MediaEntity::Sizes& MediaEntity::sizes() const
 {
     return _sizes;
 }
@@ -672,13 +673,13 @@ int64_t MediaEntity::sourceUserID() const
 }
 
 
-VideoInfo MediaEntity::videoInfo() const
+const VideoInfo& MediaEntity::videoInfo() const
 {
     return _videoInfo;
 }
 
 
-AdditionalMediaInfo MediaEntity::additionalMediaEntity() const
+const AdditionalMediaInfo& MediaEntity::additionalMediaEntity() const
 {
     return _additionalMediaInfo;
 }
@@ -855,31 +856,31 @@ Entities::~Entities()
 }
 
 
-Entities::HashTagEntities Entities::hashTagEntities() const
+const Entities::HashTagEntities& Entities::hashTagEntities() const
 {
     return _hashTagEntities;
 }
 
 
-Entities::SymbolEntities Entities::symbolEntities() const
+const Entities::SymbolEntities& Entities::symbolEntities() const
 {
     return _symbolEntities;
 }
 
 
-Entities::MediaEntities Entities::mediaEntities() const
+const Entities::MediaEntities& Entities::mediaEntities() const
 {
     return _mediaEntities;
 }
 
 
-Entities::URLEntities Entities::urlEntities() const
+const Entities::URLEntities& Entities::urlEntities() const
 {
     return _URLEntities;
 }
 
 
-Entities::UserMentionEntities Entities::userMentionEntities() const
+const Entities::UserMentionEntities& Entities::userMentionEntities() const
 {
     return _userMentionEntities;
 }
@@ -887,6 +888,8 @@ Entities::UserMentionEntities Entities::userMentionEntities() const
 
 Entities Entities::fromJSON(const ofJson& json)
 {
+    OFX_TWITTER_TRACE_SCOPE("Entities::fromJSON");
+
     Entities entities;
 
     auto iter = json.cbegin();
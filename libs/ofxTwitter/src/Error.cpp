@@ -36,7 +36,7 @@ int64_t Error::code() const
 }
 
 
-std::string Error::message() const
+const std::string& Error::message() const
 {
     return _message;
 }
@@ -63,6 +63,7 @@ Error Error::fromJSON(const ofJson& json)
 
         if (key == "code") error._code = value;
         else if (key == "message") error._message = value;
+        else if (key == "name") { /* media processing errors, skip */ }
         else ofLogWarning("Error::fromJSON") << "Unknown key: " << key;
 
         ++iter;
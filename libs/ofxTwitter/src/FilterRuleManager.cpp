@@ -0,0 +1,528 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/FilterRuleManager.h"
+#include <chrono>
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+bool isEqual(const Geo::CoordinateBounds& a, const Geo::CoordinateBounds& b)
+{
+    return a.southwest().getLatitude() == b.southwest().getLatitude()
+        && a.southwest().getLongitude() == b.southwest().getLongitude()
+        && a.northeast().getLatitude() == b.northeast().getLatitude()
+        && a.northeast().getLongitude() == b.northeast().getLongitude();
+}
+
+
+} // namespace
+
+
+const uint64_t FilterRuleManager::DEFAULT_DEBOUNCE = 1000;
+const uint64_t FilterRuleManager::SWITCH_TIMEOUT = BaseStreamingClient::TIMEOUT;
+const std::size_t FilterRuleManager::DEDUPLICATION_WINDOW = 1 << 16;
+
+
+FilterRuleManager::Connection::Connection(FilterRuleManager& manager,
+                                          std::size_t credentialIndex_,
+                                          const FilterQuery& query_):
+    credentialIndex(credentialIndex_),
+    query(query_),
+    _manager(manager),
+    _client(manager._credentials[credentialIndex_], this)
+{
+    _client.setTransport(manager._transport);
+    _client.filter(query);
+}
+
+
+FilterRuleManager::Connection::~Connection()
+{
+}
+
+
+void FilterRuleManager::Connection::onConnect()
+{
+    // A new stream proves itself by connecting, since a quiet stream may
+    // only send keep-alives for a long time. Its connect is not forwarded,
+    // since the sink is already connected.
+    if (_manager._promote(this)) return;
+    if (_manager._isActive(this) && _manager._sink) _manager._sink->onConnect();
+}
+
+
+void FilterRuleManager::Connection::onDisconnect()
+{
+    if (_manager._isActive(this) && _manager._sink) _manager._sink->onDisconnect();
+}
+
+
+void FilterRuleManager::Connection::onStatus(const Status& status)
+{
+    // Statuses are delivered from every stream, including one that is being
+    // replaced, so that the overlap has no gaps.
+    _manager._onStatus(status);
+}
+
+
+void FilterRuleManager::Connection::onStatusDeletedNotice(const StatusDeletedNotice& notice)
+{
+    _forward(&StreamingSink::onStatusDeletedNotice, notice);
+}
+
+
+void FilterRuleManager::Connection::onLocationDeletedNotice(const LocationDeletedNotice& notice)
+{
+    _forward(&StreamingSink::onLocationDeletedNotice, notice);
+}
+
+
+void FilterRuleManager::Connection::onLimitNotice(const LimitNotice& notice)
+{
+    _forward(&StreamingSink::onLimitNotice, notice);
+}
+
+
+void FilterRuleManager::Connection::onStatusWithheldNotice(const StatusWithheldNotice& notice)
+{
+    _forward(&StreamingSink::onStatusWithheldNotice, notice);
+}
+
+
+void FilterRuleManager::Connection::onUserWitheldNotice(const UserWithheldNotice& notice)
+{
+    _forward(&StreamingSink::onUserWitheldNotice, notice);
+}
+
+
+void FilterRuleManager::Connection::onDisconnectNotice(const DisconnectNotice& notice)
+{
+    _forward(&StreamingSink::onDisconnectNotice, notice);
+}
+
+
+void FilterRuleManager::Connection::onStallWarning(const StallWarning& notice)
+{
+    _forward(&StreamingSink::onStallWarning, notice);
+}
+
+
+void FilterRuleManager::Connection::onException(const std::exception& exc)
+{
+    if (_manager._isActive(this) && _manager._sink) _manager._sink->onException(exc);
+}
+
+
+void FilterRuleManager::Connection::onMessage(const ofJson& message)
+{
+    _forward(&StreamingSink::onMessage, message);
+}
+
+
+bool FilterRuleManager::Connection::wantsMessages() const
+{
+    return _manager._sink && _manager._sink->wantsMessages();
+}
+
+
+template <typename T>
+void FilterRuleManager::Connection::_forward(void (StreamingSink::*callback)(const T&),
+                                             const T& value)
+{
+    if (_manager._isActive(this) && _manager._sink) (_manager._sink->*callback)(value);
+}
+
+
+FilterRuleManager::FilterRuleManager(const HTTP::OAuth10Credentials& credentials,
+                                     StreamingSink* sink,
+                                     uint64_t debounce):
+    _credentials({ credentials }),
+    _sink(sink),
+    _debounce(debounce)
+{
+    _thread = std::thread(&FilterRuleManager::_run, this);
+}
+
+
+FilterRuleManager::FilterRuleManager(const HTTP::OAuth10Credentials& credentials,
+                                     const HTTP::OAuth10Credentials& standbyCredentials,
+                                     StreamingSink* sink,
+                                     uint64_t debounce):
+    _credentials({ credentials, standbyCredentials }),
+    _sink(sink),
+    _debounce(debounce)
+{
+    _thread = std::thread(&FilterRuleManager::_run, this);
+}
+
+
+FilterRuleManager::~FilterRuleManager()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    // Streams call back into the manager, so they are stopped without the
+    // lock held and before the members are destroyed.
+    std::vector<std::unique_ptr<Connection>> connections;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        connections = std::move(_retired);
+        connections.push_back(std::move(_standby));
+        connections.push_back(std::move(_active));
+    }
+
+    connections.clear();
+}
+
+
+void FilterRuleManager::addTrack(const std::string& track)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_tracks.insert(track).second) _changed();
+}
+
+
+void FilterRuleManager::removeTrack(const std::string& track)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_tracks.erase(track) > 0) _changed();
+}
+
+
+void FilterRuleManager::addFollow(const std::string& userId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_follows.insert(userId).second) _changed();
+}
+
+
+void FilterRuleManager::removeFollow(const std::string& userId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_follows.erase(userId) > 0) _changed();
+}
+
+
+void FilterRuleManager::addLocation(const Geo::CoordinateBounds& location)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& l: _locations)
+    {
+        if (isEqual(l, location)) return;
+    }
+
+    _locations.push_back(location);
+    _changed();
+}
+
+
+void FilterRuleManager::removeLocation(const Geo::CoordinateBounds& location)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (auto iter = _locations.begin(); iter != _locations.end(); ++iter)
+    {
+        if (isEqual(*iter, location))
+        {
+            _locations.erase(iter);
+            _changed();
+            return;
+        }
+    }
+}
+
+
+void FilterRuleManager::setRules(const std::vector<std::string>& tracks,
+                                 const std::vector<std::string>& follows,
+                                 const std::vector<Geo::CoordinateBounds>& locations)
+{
+    std::set<std::string> trackSet(tracks.begin(), tracks.end());
+    std::set<std::string> followSet(follows.begin(), follows.end());
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    bool changed = trackSet != _tracks
+                || followSet != _follows
+                || locations.size() != _locations.size();
+
+    for (std::size_t i = 0; !changed && i < locations.size(); ++i)
+    {
+        changed = !isEqual(locations[i], _locations[i]);
+    }
+
+    if (changed)
+    {
+        _tracks = std::move(trackSet);
+        _follows = std::move(followSet);
+        _locations = locations;
+        _changed();
+    }
+}
+
+
+void FilterRuleManager::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_tracks.empty() || !_follows.empty() || !_locations.empty())
+    {
+        _tracks.clear();
+        _follows.clear();
+        _locations.clear();
+        _changed();
+    }
+}
+
+
+FilterQuery FilterRuleManager::query() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _query();
+}
+
+
+FilterQuery FilterRuleManager::activeQuery() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _active ? _active->query : FilterQuery();
+}
+
+
+bool FilterRuleManager::isSwitching() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _standby != nullptr;
+}
+
+
+uint64_t FilterRuleManager::switchCount() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _switchCount;
+}
+
+
+void FilterRuleManager::setTransport(BaseStreamingClient::Transport transport)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _transport = transport;
+}
+
+
+void FilterRuleManager::_changed()
+{
+    _version++;
+    _changedAt = _now();
+    _condition.notify_all();
+}
+
+
+FilterQuery FilterRuleManager::_query() const
+{
+    FilterQuery query;
+
+    if (!_tracks.empty())
+    {
+        query.setTracks(std::vector<std::string>(_tracks.begin(), _tracks.end()));
+    }
+
+    if (!_follows.empty())
+    {
+        query.setFollows(std::vector<std::string>(_follows.begin(), _follows.end()));
+    }
+
+    if (!_locations.empty())
+    {
+        query.setLocations(_locations);
+    }
+
+    return query;
+}
+
+
+bool FilterRuleManager::_promote(Connection* connection)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (connection != _standby.get())
+    {
+        return false;
+    }
+
+    if (_active)
+    {
+        _retired.push_back(std::move(_active));
+    }
+
+    _active = std::move(_standby);
+    _activeVersion = _standbyVersion;
+    _switchCount++;
+
+    // The old stream is stopped by the worker, since stopping it blocks and
+    // this is the new stream's thread.
+    _condition.notify_all();
+    return true;
+}
+
+
+void FilterRuleManager::_onStatus(const Status& status)
+{
+    {
+        std::unique_lock<std::mutex> lock(_seenMutex);
+
+        if (!_seen.insert(status.id()).second)
+        {
+            return;
+        }
+
+        _seenOrder.push_back(status.id());
+
+        if (_seenOrder.size() > DEDUPLICATION_WINDOW)
+        {
+            _seen.erase(_seenOrder.front());
+            _seenOrder.pop_front();
+        }
+    }
+
+    if (_sink) _sink->onStatus(status);
+}
+
+
+bool FilterRuleManager::_isActive(const Connection* connection) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return connection == _active.get();
+}
+
+
+void FilterRuleManager::_run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stopping)
+    {
+        if (!_retired.empty())
+        {
+            auto retired = std::move(_retired);
+            _retired.clear();
+
+            lock.unlock();
+            retired.clear();
+            lock.lock();
+            continue;
+        }
+
+        uint64_t now = _now();
+        uint64_t wakeAt = 0;
+
+        uint64_t targetVersion = _standby ? _standbyVersion : _activeVersion;
+
+        if (_version != targetVersion)
+        {
+            uint64_t applyAt = _changedAt + _debounce;
+
+            if (now >= applyAt)
+            {
+                FilterQuery query = _query();
+
+                if (_standby)
+                {
+                    // The rules changed again before the switch completed.
+                    _retired.push_back(std::move(_standby));
+                }
+
+                if (query.empty())
+                {
+                    if (_active) _retired.push_back(std::move(_active));
+                    _activeVersion = _version;
+                }
+                else if (_active == nullptr)
+                {
+                    // Nothing is running, so there is no gap to avoid.
+                    _active = std::make_unique<Connection>(*this, 0, query);
+                    _activeVersion = _version;
+                }
+                else if (_credentials.size() < 2)
+                {
+                    // A second connection on the same account would close
+                    // the first, so the old stream is stopped before the new
+                    // one is opened.
+                    _retired.push_back(std::move(_active));
+                    _switchCount++;
+                }
+                else
+                {
+                    // The streams alternate between the credentials, so the
+                    // new one does not close the old one.
+                    std::size_t credentialIndex = (_active->credentialIndex + 1) % _credentials.size();
+                    _standby = std::make_unique<Connection>(*this, credentialIndex, query);
+                    _standbyVersion = _version;
+                    _standbyStartedAt = now;
+                }
+
+                continue;
+            }
+
+            wakeAt = applyAt;
+        }
+
+        if (_standby)
+        {
+            uint64_t timeoutAt = _standbyStartedAt + SWITCH_TIMEOUT;
+
+            if (now >= timeoutAt)
+            {
+                ofLogWarning("FilterRuleManager::_run") << "The new stream did not connect, retrying.";
+
+                _retired.push_back(std::move(_standby));
+
+                // Keep the old stream and apply the rules again.
+                _changedAt = now;
+                continue;
+            }
+
+            wakeAt = wakeAt == 0 ? timeoutAt : std::min(wakeAt, timeoutAt);
+        }
+
+        if (wakeAt == 0)
+        {
+            _condition.wait(lock);
+        }
+        else
+        {
+            _condition.wait_for(lock, std::chrono::milliseconds(wakeAt - now));
+        }
+    }
+}
+
+
+uint64_t FilterRuleManager::_now()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,338 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/GeoIndex.h"
+#include <algorithm>
+#include <cmath>
+#include "ofx/Twitter/Utils.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+const double RADIANS_PER_DEGREE = 0.017453292519943295;
+
+inline double toRadians(double degrees)
+{
+    return degrees * RADIANS_PER_DEGREE;
+}
+
+inline double toDegrees(double radians)
+{
+    return radians / RADIANS_PER_DEGREE;
+}
+
+/// \returns the great-circle distance between two points in meters.
+double haversine(double latitude0, double longitude0, double latitude1, double longitude1)
+{
+    double dLatitude = toRadians(latitude1 - latitude0);
+    double dLongitude = toRadians(longitude1 - longitude0);
+    double a = std::sin(dLatitude / 2) * std::sin(dLatitude / 2)
+             + std::cos(toRadians(latitude0)) * std::cos(toRadians(latitude1))
+             * std::sin(dLongitude / 2) * std::sin(dLongitude / 2);
+    return 2 * GeoIndex::EARTH_RADIUS * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+}
+
+
+const double GeoIndex::DEFAULT_CELL_SIZE = 0.25;
+const double GeoIndex::EARTH_RADIUS = 6371008.8;
+
+
+GeoIndex::GeoIndex(double cellSize, uint64_t maxAge):
+    _cellSize(cellSize > 0 ? cellSize : DEFAULT_CELL_SIZE),
+    _maxAge(maxAge)
+{
+    _rows = static_cast<int64_t>(std::ceil(180.0 / _cellSize));
+    _columns = static_cast<int64_t>(std::ceil(360.0 / _cellSize));
+}
+
+
+bool GeoIndex::insert(const Status& status)
+{
+    Geo::Coordinate coordinate;
+
+    if (!Utils::location(status, coordinate))
+    {
+        return false;
+    }
+
+    insert(status.id(), coordinate, Utils::timestamp(status));
+    return true;
+}
+
+
+void GeoIndex::insert(int64_t id, const Geo::Coordinate& coordinate, uint64_t timestamp)
+{
+    Entry entry;
+    entry.id = id;
+    entry.coordinate = coordinate;
+    entry.timestamp = timestamp;
+
+    uint64_t key = _key(_row(coordinate.getLatitude()),
+                        _column(coordinate.getLongitude()));
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _cells[key].push_back(entry);
+    _order.push_back(key);
+    _newest = std::max(_newest, timestamp);
+
+    if (_maxAge > 0 && _newest > _maxAge)
+    {
+        _evict(_newest - _maxAge);
+    }
+}
+
+
+void GeoIndex::evict(uint64_t olderThan)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _evict(olderThan);
+}
+
+
+std::vector<GeoIndex::Entry> GeoIndex::query(const Geo::CoordinateBounds& bounds,
+                                             uint64_t since) const
+{
+    double south = bounds.southwest().getLatitude();
+    double west = bounds.southwest().getLongitude();
+    double north = bounds.northeast().getLatitude();
+    double east = bounds.northeast().getLongitude();
+
+    std::vector<Entry> results;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (west > east)
+    {
+        _query(south, west, north, 180, since, results);
+        _query(south, -180, north, east, since, results);
+    }
+    else
+    {
+        _query(south, west, north, east, since, results);
+    }
+
+    return results;
+}
+
+
+std::vector<GeoIndex::Entry> GeoIndex::query(const Geo::Coordinate& center,
+                                             double radius,
+                                             uint64_t since) const
+{
+    double latitude = center.getLatitude();
+    double longitude = center.getLongitude();
+    double angle = radius / EARTH_RADIUS;
+    double latitudeDelta = toDegrees(angle);
+
+    double south = std::max(-90.0, latitude - latitudeDelta);
+    double north = std::min(90.0, latitude + latitudeDelta);
+    double west = -180;
+    double east = 180;
+
+    // Near the poles, or for very large radii, every longitude may be in
+    // range.
+    double sinLongitudeDelta = std::sin(angle) / std::cos(toRadians(latitude));
+
+    if (north < 90 && south > -90 && sinLongitudeDelta < 1)
+    {
+        double longitudeDelta = toDegrees(std::asin(sinLongitudeDelta));
+        west = std::remainder(longitude - longitudeDelta, 360.0);
+        east = std::remainder(longitude + longitudeDelta, 360.0);
+    }
+
+    std::vector<Entry> candidates;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (west > east)
+        {
+            _query(south, west, north, 180, since, candidates);
+            _query(south, -180, north, east, since, candidates);
+        }
+        else
+        {
+            _query(south, west, north, east, since, candidates);
+        }
+    }
+
+    std::vector<Entry> results;
+
+    for (const auto& entry: candidates)
+    {
+        if (haversine(latitude,
+                      longitude,
+                      entry.coordinate.getLatitude(),
+                      entry.coordinate.getLongitude()) <= radius)
+        {
+            results.push_back(entry);
+        }
+    }
+
+    return results;
+}
+
+
+void GeoIndex::setMaxAge(uint64_t maxAge)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _maxAge = maxAge;
+
+    if (_maxAge > 0 && _newest > _maxAge)
+    {
+        _evict(_newest - _maxAge);
+    }
+}
+
+
+uint64_t GeoIndex::maxAge() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _maxAge;
+}
+
+
+std::size_t GeoIndex::size() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _order.size();
+}
+
+
+void GeoIndex::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cells.clear();
+    _order.clear();
+    _newest = 0;
+}
+
+
+int64_t GeoIndex::_row(double latitude) const
+{
+    int64_t row = static_cast<int64_t>(std::floor((latitude + 90.0) / _cellSize));
+    return std::max(int64_t(0), std::min(_rows - 1, row));
+}
+
+
+int64_t GeoIndex::_column(double longitude) const
+{
+    int64_t column = static_cast<int64_t>(std::floor((longitude + 180.0) / _cellSize));
+    return std::max(int64_t(0), std::min(_columns - 1, column));
+}
+
+
+uint64_t GeoIndex::_key(int64_t row, int64_t column) const
+{
+    return static_cast<uint64_t>(row * _columns + column);
+}
+
+
+void GeoIndex::_query(double south,
+                      double west,
+                      double north,
+                      double east,
+                      uint64_t since,
+                      std::vector<Entry>& results) const
+{
+    int64_t row0 = _row(south);
+    int64_t row1 = _row(north);
+    int64_t column0 = _column(west);
+    int64_t column1 = _column(east);
+
+    auto append = [&](int64_t row, int64_t column, const std::deque<Entry>& entries)
+    {
+        // Cells entirely inside the box only need the time test.
+        bool inside = row > row0 && row < row1 && column > column0 && column < column1;
+
+        for (const auto& entry: entries)
+        {
+            if (entry.timestamp < since)
+            {
+                continue;
+            }
+
+            if (!inside)
+            {
+                double latitude = entry.coordinate.getLatitude();
+                double longitude = entry.coordinate.getLongitude();
+
+                if (latitude < south || latitude > north || longitude < west || longitude > east)
+                {
+                    continue;
+                }
+            }
+
+            results.push_back(entry);
+        }
+    };
+
+    uint64_t cellCount = static_cast<uint64_t>(row1 - row0 + 1) * (column1 - column0 + 1);
+
+    if (cellCount > _cells.size())
+    {
+        // Large boxes visit the occupied cells rather than every cell.
+        for (const auto& cell: _cells)
+        {
+            int64_t row = static_cast<int64_t>(cell.first) / _columns;
+            int64_t column = static_cast<int64_t>(cell.first) % _columns;
+
+            if (row >= row0 && row <= row1 && column >= column0 && column <= column1)
+            {
+                append(row, column, cell.second);
+            }
+        }
+    }
+    else
+    {
+        for (int64_t row = row0; row <= row1; ++row)
+        {
+            for (int64_t column = column0; column <= column1; ++column)
+            {
+                auto iter = _cells.find(_key(row, column));
+
+                if (iter != _cells.end())
+                {
+                    append(row, column, iter->second);
+                }
+            }
+        }
+    }
+}
+
+
+void GeoIndex::_evict(uint64_t olderThan)
+{
+    while (!_order.empty())
+    {
+        auto iter = _cells.find(_order.front());
+        std::deque<Entry>& entries = iter->second;
+
+        if (entries.front().timestamp >= olderThan)
+        {
+            break;
+        }
+
+        entries.pop_front();
+        _order.pop_front();
+
+        if (entries.empty())
+        {
+            _cells.erase(iter);
+        }
+    }
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/ImageEncoder.h"
+#include "Poco/Exception.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t ImageEncoder::DEFAULT_MAX_POOLED_BUFFERS = 8;
+
+
+ImageEncoder::ImageEncoder(std::size_t threadCount, std::size_t maxPooledBuffers):
+    _state(std::make_shared<State>()),
+    _pool(threadCount)
+{
+    _state->maxBuffers = maxPooledBuffers;
+}
+
+
+ImageEncoder::~ImageEncoder()
+{
+}
+
+
+std::shared_ptr<const ofBuffer> ImageEncoder::encode(const ofPixels& pixels,
+                                                     ofImageFormat format,
+                                                     ofImageQualityType quality)
+{
+    std::unique_ptr<ofBuffer> buffer;
+
+    {
+        std::unique_lock<std::mutex> lock(_state->mutex);
+
+        if (!_state->buffers.empty())
+        {
+            buffer = std::move(_state->buffers.back());
+            _state->buffers.pop_back();
+        }
+    }
+
+    if (buffer == nullptr)
+    {
+        buffer = std::make_unique<ofBuffer>();
+    }
+
+    std::weak_ptr<State> state = _state;
+
+    std::shared_ptr<ofBuffer> result(buffer.release(), [state](ofBuffer* buffer)
+    {
+        _release(state, buffer);
+    });
+
+#if OF_VERSION_MINOR < 10
+    ofPixels _pixels = pixels;
+    bool success = ofSaveImage(_pixels, *result, format, quality);
+#else
+    bool success = ofSaveImage(pixels, *result, format, quality);
+#endif
+
+    if (!success || result->size() == 0)
+    {
+        throw Poco::IOException("Unable to encode image.");
+    }
+
+    return result;
+}
+
+
+std::future<std::shared_ptr<const ofBuffer>> ImageEncoder::encodeAsync(ofPixels pixels,
+                                                                        ofImageFormat format,
+                                                                        ofImageQualityType quality)
+{
+    auto source = std::make_shared<ofPixels>(std::move(pixels));
+
+    return _pool.submit([this, source, format, quality]()
+    {
+        return encode(*source, format, quality);
+    });
+}
+
+
+std::size_t ImageEncoder::pooled() const
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    return _state->buffers.size();
+}
+
+
+std::string ImageEncoder::mediaType(ofImageFormat format)
+{
+    switch (format)
+    {
+        case OF_IMAGE_FORMAT_PNG: return "image/png";
+        case OF_IMAGE_FORMAT_GIF: return "image/gif";
+        case OF_IMAGE_FORMAT_BMP: return "image/bmp";
+        default: return "image/jpeg";
+    }
+}
+
+
+void ImageEncoder::_release(std::weak_ptr<State> state, ofBuffer* buffer)
+{
+    std::unique_ptr<ofBuffer> owned(buffer);
+
+    std::shared_ptr<State> shared = state.lock();
+
+    if (shared == nullptr)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+
+    if (shared->buffers.size() < shared->maxBuffers)
+    {
+        shared->buffers.push_back(std::move(owned));
+    }
+}
+
+
+} } // namespace ofx::Twitter
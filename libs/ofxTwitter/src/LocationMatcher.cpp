@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/LocationMatcher.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include "ofx/Twitter/Utils.h"
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OFX_TWITTER_LOCATION_MATCHER_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace ofx {
+namespace Twitter {
+
+
+LocationMatcher::LocationMatcher()
+{
+}
+
+
+LocationMatcher::LocationMatcher(const std::vector<Geo::CoordinateBounds>& locations)
+{
+    setLocations(locations);
+}
+
+
+LocationMatcher::LocationMatcher(const BaseFilterQuery& query)
+{
+    std::vector<Geo::CoordinateBounds> locations;
+
+    if (query.has("locations"))
+    {
+        // The parameter is a comma separated list of south-west longitude,
+        // south-west latitude, north-east longitude, north-east latitude.
+        std::istringstream istr(query.get("locations"));
+        std::string value;
+        std::vector<double> values;
+
+        while (std::getline(istr, value, ','))
+        {
+            try
+            {
+                values.push_back(std::stod(value));
+            }
+            catch (const std::exception&)
+            {
+                ofLogWarning("LocationMatcher::LocationMatcher") << "Invalid location value: " << value;
+                values.clear();
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i + 3 < values.size(); i += 4)
+        {
+            locations.push_back(Geo::CoordinateBounds(Geo::Coordinate(values[i + 1], values[i]),
+                                                      Geo::Coordinate(values[i + 3], values[i + 2])));
+        }
+    }
+
+    setLocations(locations);
+}
+
+
+void LocationMatcher::setLocations(const std::vector<Geo::CoordinateBounds>& locations)
+{
+    _locations = locations;
+    _south.clear();
+    _west.clear();
+    _north.clear();
+    _east.clear();
+    _ids.clear();
+
+    for (std::size_t i = 0; i < locations.size(); ++i)
+    {
+        double south = locations[i].southwest().getLatitude();
+        double west = locations[i].southwest().getLongitude();
+        double north = locations[i].northeast().getLatitude();
+        double east = locations[i].northeast().getLongitude();
+
+        if (west > east)
+        {
+            _add(south, west, north, 180, uint32_t(i));
+            _add(south, -180, north, east, uint32_t(i));
+        }
+        else
+        {
+            _add(south, west, north, east, uint32_t(i));
+        }
+    }
+
+    // Pad to an even count with boxes that contain nothing, so the vector
+    // loop needs no remainder handling.
+    if (_ids.size() % 2 != 0)
+    {
+        double inf = std::numeric_limits<double>::infinity();
+        _add(inf, inf, -inf, -inf, 0);
+    }
+}
+
+
+const std::vector<Geo::CoordinateBounds>& LocationMatcher::locations() const
+{
+    return _locations;
+}
+
+
+bool LocationMatcher::empty() const
+{
+    return _locations.empty();
+}
+
+
+std::vector<std::size_t> LocationMatcher::match(const Geo::Coordinate& coordinate) const
+{
+    std::vector<std::size_t> matches;
+
+    double latitude = coordinate.getLatitude();
+    double longitude = coordinate.getLongitude();
+    std::size_t count = _ids.size();
+
+#if defined(OFX_TWITTER_LOCATION_MATCHER_SSE2)
+    __m128d lat = _mm_set1_pd(latitude);
+    __m128d lon = _mm_set1_pd(longitude);
+
+    for (std::size_t i = 0; i < count; i += 2)
+    {
+        __m128d inside = _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(lat, _mm_loadu_pd(&_south[i])),
+                                               _mm_cmple_pd(lat, _mm_loadu_pd(&_north[i]))),
+                                    _mm_and_pd(_mm_cmpge_pd(lon, _mm_loadu_pd(&_west[i])),
+                                               _mm_cmple_pd(lon, _mm_loadu_pd(&_east[i]))));
+
+        int mask = _mm_movemask_pd(inside);
+
+        if (mask & 1) matches.push_back(_ids[i]);
+        if (mask & 2) matches.push_back(_ids[i + 1]);
+    }
+#else
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (latitude >= _south[i] && latitude <= _north[i]
+         && longitude >= _west[i] && longitude <= _east[i])
+        {
+            matches.push_back(_ids[i]);
+        }
+    }
+#endif
+
+    // A point on the antimeridian may match both halves of a split box.
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+    return matches;
+}
+
+
+std::vector<std::size_t> LocationMatcher::match(const Status& status) const
+{
+    Geo::Coordinate coordinate;
+
+    if (_ids.empty() || !Utils::location(status, coordinate))
+    {
+        return {};
+    }
+
+    return match(coordinate);
+}
+
+
+void LocationMatcher::annotate(Status& status) const
+{
+    status._matchedLocations = match(status);
+}
+
+
+void LocationMatcher::_add(double south, double west, double north, double east, uint32_t id)
+{
+    _south.push_back(south);
+    _west.push_back(west);
+    _north.push_back(north);
+    _east.push_back(east);
+    _ids.push_back(id);
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/Lookup.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+std::string joinIds(const std::vector<int64_t>& ids)
+{
+    std::string result;
+
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        if (i > 0) result += ",";
+        result += std::to_string(ids[i]);
+    }
+
+    return result;
+}
+
+
+} // namespace
+
+
+const std::string UserLookupRequest::RESOURCE_URL = "https://api.twitter.com/1.1/users/lookup.json";
+const std::size_t UserLookupRequest::MAX_IDS = 100;
+
+
+UserLookupRequest::UserLookupRequest(const std::vector<int64_t>& userIds):
+    HTTP::PostRequest(RESOURCE_URL, HTTP_1_1)
+{
+    if (userIds.size() > MAX_IDS)
+    {
+        ofLogWarning("UserLookupRequest::UserLookupRequest") << "Only " << MAX_IDS << " ids are allowed per request.";
+    }
+
+    setFormField("user_id", joinIds(userIds));
+}
+
+
+UserLookupRequest::~UserLookupRequest()
+{
+}
+
+
+void UserLookupRequest::setIncludeEntities(bool includeEntities)
+{
+    setFormField("include_entities", includeEntities ? "true" : "false");
+}
+
+
+OAuth10Signer::EncodedParameters UserLookupRequest::formParameters() const
+{
+    return OAuth10Signer::EncodedParameters(_form);
+}
+
+
+const std::string StatusLookupRequest::RESOURCE_URL = "https://api.twitter.com/1.1/statuses/lookup.json";
+const std::size_t StatusLookupRequest::MAX_IDS = 100;
+
+
+StatusLookupRequest::StatusLookupRequest(const std::vector<int64_t>& statusIds):
+    HTTP::PostRequest(RESOURCE_URL, HTTP_1_1)
+{
+    if (statusIds.size() > MAX_IDS)
+    {
+        ofLogWarning("StatusLookupRequest::StatusLookupRequest") << "Only " << MAX_IDS << " ids are allowed per request.";
+    }
+
+    setFormField("id", joinIds(statusIds));
+}
+
+
+StatusLookupRequest::~StatusLookupRequest()
+{
+}
+
+
+void StatusLookupRequest::setIncludeEntities(bool includeEntities)
+{
+    setFormField("include_entities", includeEntities ? "true" : "false");
+}
+
+
+void StatusLookupRequest::setTrimUser(bool trimUser)
+{
+    setFormField("trim_user", trimUser ? "true" : "false");
+}
+
+
+OAuth10Signer::EncodedParameters StatusLookupRequest::formParameters() const
+{
+    return OAuth10Signer::EncodedParameters(_form);
+}
+
+
+UserLookupResponse::~UserLookupResponse()
+{
+}
+
+
+const std::vector<User>& UserLookupResponse::users() const
+{
+    return _users;
+}
+
+
+UserLookupResponse UserLookupResponse::fromJSON(const ofJson& json)
+{
+    UserLookupResponse response;
+
+    if (json.is_array())
+    {
+        response._users.reserve(json.size());
+
+        for (const auto& user: json)
+        {
+            response._users.push_back(User::fromJSON(user));
+        }
+    }
+    else if (json.is_object())
+    {
+        // No matching users is reported as an error object.
+        for (const auto& error: json.value("errors", ofJson::array()))
+        {
+            response._errors.push_back(Error::fromJSON(error));
+        }
+    }
+
+    return response;
+}
+
+
+StatusLookupResponse::~StatusLookupResponse()
+{
+}
+
+
+const std::vector<Status>& StatusLookupResponse::statuses() const
+{
+    return _statuses;
+}
+
+
+StatusLookupResponse StatusLookupResponse::fromJSON(const ofJson& json)
+{
+    StatusLookupResponse response;
+
+    if (json.is_array())
+    {
+        response._statuses.reserve(json.size());
+
+        for (const auto& status: json)
+        {
+            response._statuses.push_back(Status::fromJSON(status));
+        }
+    }
+    else if (json.is_object())
+    {
+        for (const auto& error: json.value("errors", ofJson::array()))
+        {
+            response._errors.push_back(Error::fromJSON(error));
+        }
+    }
+
+    return response;
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,310 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/LookupBatcher.h"
+#include <chrono>
+#include "Poco/Exception.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+const std::vector<User>& items(const UserLookupResponse& response)
+{
+    return response.users();
+}
+
+
+const std::vector<Status>& items(const StatusLookupResponse& response)
+{
+    return response.statuses();
+}
+
+
+} // namespace
+
+
+const uint64_t LookupBatcher::DEFAULT_WINDOW = 50;
+
+
+LookupBatcher::LookupBatcher(RESTClient& client, uint64_t window):
+    _client(client),
+    _window(window)
+{
+    _thread = std::thread(&LookupBatcher::_run, this);
+}
+
+
+LookupBatcher::~LookupBatcher()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _stopping = true;
+    _condition.notify_all();
+
+    // Batch callbacks refer to this batcher, so they must all complete.
+    _condition.wait(lock, [this]() { return _inFlight == 0; });
+
+    auto cancel = [](auto& queue)
+    {
+        for (auto id: queue.queued)
+        {
+            auto iter = queue.waiters.find(id);
+
+            if (iter != queue.waiters.end())
+            {
+                iter->second.promise->set_exception(std::make_exception_ptr(Poco::IOException("Lookup cancelled.")));
+                queue.waiters.erase(iter);
+            }
+        }
+
+        queue.queued.clear();
+    };
+
+    cancel(_users);
+    cancel(_statuses);
+
+    lock.unlock();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+
+std::shared_future<User> LookupBatcher::user(int64_t userId)
+{
+    return _lookup(_users, userId);
+}
+
+
+std::vector<std::shared_future<User>> LookupBatcher::users(const std::vector<int64_t>& userIds)
+{
+    std::vector<std::shared_future<User>> results;
+    results.reserve(userIds.size());
+    for (auto id: userIds) results.push_back(_lookup(_users, id));
+    return results;
+}
+
+
+std::shared_future<Status> LookupBatcher::status(int64_t statusId)
+{
+    return _lookup(_statuses, statusId);
+}
+
+
+std::vector<std::shared_future<Status>> LookupBatcher::statuses(const std::vector<int64_t>& statusIds)
+{
+    std::vector<std::shared_future<Status>> results;
+    results.reserve(statusIds.size());
+    for (auto id: statusIds) results.push_back(_lookup(_statuses, id));
+    return results;
+}
+
+
+void LookupBatcher::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _flushRequested = true;
+    }
+
+    _condition.notify_all();
+}
+
+
+std::size_t LookupBatcher::pending() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _users.waiters.size() + _statuses.waiters.size();
+}
+
+
+template <typename T>
+std::shared_future<T> LookupBatcher::_lookup(Queue<T>& queue, int64_t id)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto iter = queue.waiters.find(id);
+
+    if (iter != queue.waiters.end())
+    {
+        return iter->second.future;
+    }
+
+    if (_stopping)
+    {
+        std::promise<T> promise;
+        promise.set_exception(std::make_exception_ptr(Poco::IOException("Lookup cancelled.")));
+        return promise.get_future().share();
+    }
+
+    Waiter<T> waiter;
+    waiter.promise = std::make_shared<std::promise<T>>();
+    waiter.future = waiter.promise->get_future().share();
+
+    queue.waiters[id] = waiter;
+    queue.queued.push_back(id);
+
+    if (queue.queued.size() == 1)
+    {
+        queue.deadline = _now() + _window;
+    }
+
+    // Only wake the dispatcher when there is something new for it to do.
+    if (queue.queued.size() == 1 || queue.queued.size() == UserLookupRequest::MAX_IDS)
+    {
+        _condition.notify_all();
+    }
+
+    return waiter.future;
+}
+
+
+template <typename RequestType, typename ResponseType, typename T>
+uint64_t LookupBatcher::_dispatch(Queue<T>& queue, uint64_t now)
+{
+    while (!queue.queued.empty())
+    {
+        uint64_t readyAt = queue.queued.size() >= RequestType::MAX_IDS || _flushRequested ? now : queue.deadline;
+        readyAt = std::max(readyAt, queue.holdUntil);
+
+        if (readyAt > now)
+        {
+            return readyAt;
+        }
+
+        std::size_t count = std::min(queue.queued.size(), RequestType::MAX_IDS);
+        std::vector<int64_t> ids(queue.queued.begin(), queue.queued.begin() + count);
+        queue.queued.erase(queue.queued.begin(), queue.queued.begin() + count);
+
+        // The remaining ids have already waited a full window.
+        _inFlight++;
+
+        auto request = std::make_unique<RequestType>(ids);
+        OAuth10Signer::EncodedParameters parameters = request->formParameters();
+
+        _client.submit<ResponseType>(std::move(request),
+                                     [this, &queue, ids](const RESTClient::Result<ResponseType>& result)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            const RateLimit& rateLimit = result.rateLimit;
+
+            if ((result.status == 429 || (rateLimit.limit() > 0 && rateLimit.remaining() == 0))
+                && rateLimit.reset() > 0)
+            {
+                using namespace std::chrono;
+                uint64_t wallNow = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+                uint64_t resetAt = rateLimit.reset() * 1000;
+                queue.holdUntil = _now() + (resetAt > wallNow ? resetAt - wallNow : 0);
+            }
+
+            if (result.status == 429 && rateLimit.reset() > 0 && !_stopping)
+            {
+                // Rate limited batches are collected again and sent once the
+                // limit resets.
+                queue.queued.insert(queue.queued.begin(), ids.begin(), ids.end());
+            }
+            else
+            {
+                for (const auto& item: items(result.response))
+                {
+                    auto iter = queue.waiters.find(item.id());
+
+                    if (iter != queue.waiters.end())
+                    {
+                        iter->second.promise->set_value(item);
+                        queue.waiters.erase(iter);
+                    }
+                }
+
+                // The endpoints omit ids that do not exist and report 404
+                // if none of them do.
+                bool found = result.isSuccess() || result.status == 404;
+
+                for (auto id: ids)
+                {
+                    auto iter = queue.waiters.find(id);
+
+                    if (iter != queue.waiters.end())
+                    {
+                        if (found)
+                        {
+                            iter->second.promise->set_exception(std::make_exception_ptr(Poco::NotFoundException(std::to_string(id))));
+                        }
+                        else
+                        {
+                            std::string error = result.error;
+
+                            if (error.empty())
+                            {
+                                error = "HTTP " + std::to_string(result.status);
+                            }
+
+                            iter->second.promise->set_exception(std::make_exception_ptr(Poco::IOException(error)));
+                        }
+
+                        queue.waiters.erase(iter);
+                    }
+                }
+            }
+
+            _inFlight--;
+            _condition.notify_all();
+        }, parameters);
+    }
+
+    return 0;
+}
+
+
+void LookupBatcher::_run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stopping)
+    {
+        uint64_t now = _now();
+
+        uint64_t usersReadyAt = _dispatch<UserLookupRequest, UserLookupResponse>(_users, now);
+        uint64_t statusesReadyAt = _dispatch<StatusLookupRequest, StatusLookupResponse>(_statuses, now);
+
+        _flushRequested = false;
+
+        uint64_t readyAt = 0;
+
+        if (usersReadyAt == 0) readyAt = statusesReadyAt;
+        else if (statusesReadyAt == 0) readyAt = usersReadyAt;
+        else readyAt = std::min(usersReadyAt, statusesReadyAt);
+
+        if (readyAt == 0)
+        {
+            _condition.wait(lock);
+        }
+        else
+        {
+            _condition.wait_for(lock, std::chrono::milliseconds(readyAt - now));
+        }
+    }
+}
+
+
+uint64_t LookupBatcher::_now()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,418 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/MediaCache.h"
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include "Poco/SHA1Engine.h"
+#include "ofJson.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const uint64_t MediaCache::DEFAULT_MAX_SIZE = 1024ull * 1024ull * 1024ull;
+
+
+MediaCache::MediaCache(const std::filesystem::path& directory,
+                       uint64_t maxSize):
+    _directory(directory),
+    _maxSize(maxSize)
+{
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+
+    if (error)
+    {
+        ofLogError("MediaCache::MediaCache") << "Unable to create " << _directory.string() << ": " << error.message();
+    }
+
+    _load();
+}
+
+
+MediaCache::~MediaCache()
+{
+    save();
+}
+
+
+bool MediaCache::get(const std::string& key, std::filesystem::path& path)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto keyIter = _keys.find(key);
+
+    if (keyIter == _keys.end())
+    {
+        return false;
+    }
+
+    auto objectIter = _objects.find(keyIter->second);
+    path = _directory / objectIter->second.filename;
+
+    // The file may have been removed outside of the cache.
+    if (!std::filesystem::exists(path))
+    {
+        std::string digest = keyIter->second;
+        _remove(digest);
+        return false;
+    }
+
+    _touch(objectIter->first, objectIter->second);
+    return true;
+}
+
+
+std::filesystem::path MediaCache::put(const std::string& key,
+                                      const ofBuffer& buffer,
+                                      const std::string& extension)
+{
+    Poco::SHA1Engine sha1;
+    sha1.update(buffer.getData(), buffer.size());
+    std::string digest = Poco::DigestEngine::digestToHex(sha1.digest());
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto objectIter = _objects.find(digest);
+
+    if (objectIter == _objects.end())
+    {
+        // An object larger than the cache would evict everything, itself
+        // included, so it is not cached at all.
+        if (buffer.size() > _maxSize)
+        {
+            ofLogWarning("MediaCache::put") << "Not caching " << key << ": " << buffer.size() << " bytes exceeds the maximum cache size.";
+            return std::filesystem::path();
+        }
+
+        Object object;
+        object.filename = digest + extension;
+        object.size = buffer.size();
+
+        std::filesystem::path path = _directory / object.filename;
+        std::filesystem::path temporaryPath = path;
+        temporaryPath += ".tmp";
+
+        // Write to a temporary file first so that a partially written file
+        // is never visible under its final name.
+        if (!ofBufferToFile(temporaryPath, buffer, true))
+        {
+            ofLogError("MediaCache::put") << "Unable to write " << temporaryPath.string();
+            return std::filesystem::path();
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+
+        if (error)
+        {
+            ofLogError("MediaCache::put") << "Unable to rename " << temporaryPath.string() << ": " << error.message();
+            std::filesystem::remove(temporaryPath, error);
+            return std::filesystem::path();
+        }
+
+        objectIter = _objects.insert(std::make_pair(digest, object)).first;
+        _size += object.size;
+    }
+
+    _assign(key, digest);
+    _touch(objectIter->first, objectIter->second);
+
+    std::filesystem::path path = _directory / objectIter->second.filename;
+
+    _evict();
+
+    if (_objects.find(digest) == _objects.end())
+    {
+        return std::filesystem::path();
+    }
+
+    return path;
+}
+
+
+void MediaCache::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_objects.empty())
+    {
+        _remove(_objects.begin()->first);
+    }
+}
+
+
+bool MediaCache::save() const
+{
+    ofJson objects = ofJson::object();
+    ofJson keys = ofJson::object();
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for (const auto& entry: _objects)
+        {
+            objects[entry.first] = {
+                { "filename", entry.second.filename },
+                { "size", entry.second.size },
+                { "access", entry.second.access }
+            };
+        }
+
+        for (const auto& entry: _keys)
+        {
+            keys[entry.first] = entry.second;
+        }
+    }
+
+    std::filesystem::path path = _directory / "index.json";
+    std::ofstream ostr(path.string(), std::ios::binary);
+
+    if (!ostr)
+    {
+        ofLogError("MediaCache::save") << "Unable to open " << path.string();
+        return false;
+    }
+
+    ostr << ofJson({ { "objects", objects }, { "keys", keys } }).dump();
+
+    return ostr.good();
+}
+
+
+void MediaCache::setMaxSize(uint64_t maxSize)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _maxSize = maxSize;
+    _evict();
+}
+
+
+uint64_t MediaCache::maxSize() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _maxSize;
+}
+
+
+uint64_t MediaCache::size() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _size;
+}
+
+
+std::size_t MediaCache::count() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _objects.size();
+}
+
+
+const std::filesystem::path& MediaCache::directory() const
+{
+    return _directory;
+}
+
+
+void MediaCache::_load()
+{
+    std::filesystem::path path = _directory / "index.json";
+
+    std::unordered_map<std::string, Object> indexed;
+    ofJson keys = ofJson::object();
+
+    if (std::filesystem::exists(path))
+    {
+        try
+        {
+            std::ifstream istr(path.string(), std::ios::binary);
+            ofJson json = ofJson::parse(istr);
+            ofJson objects = json.value("objects", ofJson::object());
+            keys = json.value("keys", ofJson::object());
+
+            for (const auto& entry: objects.items())
+            {
+                Object object;
+                object.filename = entry.value().value("filename", "");
+                object.access = entry.value().value("access", uint64_t(0));
+                indexed[entry.key()] = object;
+            }
+        }
+        catch (const std::exception& exc)
+        {
+            ofLogError("MediaCache::_load") << "Unable to load " << path.string() << ": " << exc.what();
+            indexed.clear();
+            keys = ofJson::object();
+        }
+    }
+
+    // The index is only written when the cache is destroyed, so after a
+    // crash it may be stale or missing. The directory is the source of truth:
+    // indexed files that no longer exist are dropped, and files missing from
+    // the index are added as the least recently used.
+    std::vector<std::pair<uint64_t, std::string>> reindexed;
+    std::vector<std::pair<std::filesystem::file_time_type, std::string>> unindexed;
+
+    std::error_code error;
+
+    for (std::filesystem::directory_iterator iter(_directory, error), end; !error && iter != end; iter.increment(error))
+    {
+        std::filesystem::path file = iter->path();
+        std::string filename = file.filename().string();
+
+        if (!iter->is_regular_file(error) || filename == "index.json")
+        {
+            continue;
+        }
+
+        // Remove files left by an interrupted put().
+        if (file.extension() == ".tmp")
+        {
+            std::filesystem::remove(file, error);
+            continue;
+        }
+
+        std::string digest = filename.substr(0, filename.find('.'));
+
+        if (digest.size() != 40 || digest.find_first_not_of("0123456789abcdef") != std::string::npos)
+        {
+            continue;
+        }
+
+        auto indexIter = indexed.find(digest);
+        uint64_t size = std::filesystem::file_size(file, error);
+
+        if (indexIter != indexed.end() && indexIter->second.filename == filename)
+        {
+            indexIter->second.size = size;
+            _objects[digest] = indexIter->second;
+            reindexed.push_back(std::make_pair(indexIter->second.access, digest));
+        }
+        else if (_objects.find(digest) == _objects.end())
+        {
+            Object object;
+            object.filename = filename;
+            object.size = size;
+            _objects[digest] = object;
+            unindexed.push_back(std::make_pair(std::filesystem::last_write_time(file, error), digest));
+        }
+    }
+
+    // Unindexed files are ordered by age and placed before the indexed ones,
+    // which keep their recorded order.
+    std::sort(unindexed.begin(), unindexed.end());
+    std::sort(reindexed.begin(), reindexed.end());
+
+    for (const auto& entry: unindexed)
+    {
+        _touch(entry.second, _objects[entry.second]);
+    }
+
+    for (const auto& entry: reindexed)
+    {
+        // Clear the recorded access so _touch() does not erase another
+        // object's new sequence number.
+        Object& object = _objects[entry.second];
+        object.access = 0;
+        _touch(entry.second, object);
+    }
+
+    for (const auto& entry: _objects)
+    {
+        _size += entry.second.size;
+    }
+
+    for (const auto& entry: keys.items())
+    {
+        if (!entry.value().is_string())
+        {
+            continue;
+        }
+
+        std::string digest = entry.value();
+
+        if (_objects.find(digest) != _objects.end())
+        {
+            _assign(entry.key(), digest);
+        }
+    }
+
+    _evict();
+}
+
+
+void MediaCache::_assign(const std::string& key, const std::string& digest)
+{
+    auto keyIter = _keys.find(key);
+
+    if (keyIter != _keys.end())
+    {
+        if (keyIter->second == digest)
+        {
+            return;
+        }
+
+        auto previous = _objects.find(keyIter->second);
+        if (previous != _objects.end()) previous->second.keys.erase(key);
+        keyIter->second = digest;
+    }
+    else
+    {
+        _keys.insert(std::make_pair(key, digest));
+    }
+
+    _objects[digest].keys.insert(key);
+}
+
+
+void MediaCache::_touch(const std::string& digest, Object& object)
+{
+    _lru.erase(object.access);
+    object.access = _nextAccess++;
+    _lru[object.access] = digest;
+}
+
+
+void MediaCache::_evict()
+{
+    while (_size > _maxSize && !_lru.empty())
+    {
+        std::string digest = _lru.begin()->second;
+        _remove(digest);
+    }
+}
+
+
+void MediaCache::_remove(const std::string& digest)
+{
+    auto objectIter = _objects.find(digest);
+
+    if (objectIter == _objects.end())
+    {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::remove(_directory / objectIter->second.filename, error);
+
+    for (const auto& key: objectIter->second.keys)
+    {
+        _keys.erase(key);
+    }
+
+    _size -= objectIter->second.size;
+    _lru.erase(objectIter->second.access);
+    _objects.erase(objectIter);
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,338 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/MediaDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t MediaDecoder::DEFAULT_CAPACITY = 16;
+
+
+MediaDecoder::MediaDecoder(std::size_t threadCount, std::size_t capacity):
+    _capacity(std::max(std::size_t(1), capacity)),
+    _pool(threadCount)
+{
+}
+
+
+MediaDecoder::~MediaDecoder()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stopping = true;
+    _spaceCondition.notify_all();
+}
+
+
+void MediaDecoder::decode(const MediaFetcher::Result& result)
+{
+    auto job = std::make_shared<Job>();
+    job->frame.mediaId = result.mediaId;
+    job->frame.path = result.path;
+    job->frame.error = result.error;
+    _submit(job);
+}
+
+
+void MediaDecoder::decode(const MediaEntity& entity,
+                          const std::filesystem::path& path)
+{
+    auto job = std::make_shared<Job>();
+    job->frame.mediaId = entity.mediaID();
+    job->frame.path = path;
+    job->sizes = entity.sizes();
+    _submit(job);
+}
+
+
+void MediaDecoder::decode(const MediaEntity& entity, const ofBuffer& buffer)
+{
+    auto job = std::make_shared<Job>();
+    job->frame.mediaId = entity.mediaID();
+    job->buffer = buffer;
+    job->sizes = entity.sizes();
+    _submit(job);
+}
+
+
+bool MediaDecoder::tryReceive(Frame& frame)
+{
+    return receive(frame, 0);
+}
+
+
+bool MediaDecoder::receive(Frame& frame, uint64_t timeout)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_readyCondition.wait_for(lock,
+                                  std::chrono::milliseconds(timeout),
+                                  [this]() { return !_ready.empty(); }))
+    {
+        return false;
+    }
+
+    frame = std::move(_ready.front());
+    _ready.pop_front();
+    _spaceCondition.notify_one();
+    return true;
+}
+
+
+void MediaDecoder::setTargetSize(MediaEntitySize::Type size)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _scale = true;
+    _target = size;
+}
+
+
+void MediaDecoder::clearTargetSize()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _scale = false;
+}
+
+
+bool MediaDecoder::hasTargetSize() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _scale;
+}
+
+
+MediaEntitySize::Type MediaDecoder::targetSize() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _target;
+}
+
+
+std::size_t MediaDecoder::capacity() const
+{
+    return _capacity;
+}
+
+
+std::size_t MediaDecoder::pending() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _pending;
+}
+
+
+std::size_t MediaDecoder::ready() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _ready.size();
+}
+
+
+PixelPool& MediaDecoder::pixelPool()
+{
+    return _pixelPool;
+}
+
+
+std::pair<std::size_t, std::size_t> MediaDecoder::scaledSize(std::size_t width,
+                                                             std::size_t height,
+                                                             const MediaEntity::Sizes& sizes,
+                                                             MediaEntitySize::Type target,
+                                                             MediaEntitySize::Resize& resize)
+{
+    std::size_t targetWidth = 0;
+    std::size_t targetHeight = 0;
+
+    auto iter = sizes.find(target);
+
+    if (iter != sizes.end() && iter->second.width() > 0 && iter->second.height() > 0)
+    {
+        targetWidth = iter->second.width();
+        targetHeight = iter->second.height();
+        resize = iter->second.resize();
+    }
+    else
+    {
+        // The sizes Twitter produces for photos.
+        switch (target)
+        {
+            case MediaEntitySize::Type::THUMB:
+                targetWidth = targetHeight = 150;
+                resize = MediaEntitySize::Resize::CROP;
+                break;
+            case MediaEntitySize::Type::SMALL:
+                targetWidth = targetHeight = 680;
+                resize = MediaEntitySize::Resize::FIT;
+                break;
+            case MediaEntitySize::Type::MEDIUM:
+                targetWidth = targetHeight = 1200;
+                resize = MediaEntitySize::Resize::FIT;
+                break;
+            case MediaEntitySize::Type::LARGE:
+                targetWidth = targetHeight = 2048;
+                resize = MediaEntitySize::Resize::FIT;
+                break;
+        }
+    }
+
+    if (width == 0 || height == 0)
+    {
+        return { 0, 0 };
+    }
+
+    if (resize == MediaEntitySize::Resize::CROP)
+    {
+        return { std::min(width, targetWidth), std::min(height, targetHeight) };
+    }
+
+    double scale = std::min({ double(targetWidth) / width,
+                              double(targetHeight) / height,
+                              1.0 });
+
+    return { std::max(std::size_t(1), std::size_t(std::lround(width * scale))),
+             std::max(std::size_t(1), std::size_t(std::lround(height * scale))) };
+}
+
+
+void MediaDecoder::_submit(std::shared_ptr<Job> job)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        job->scale = _scale;
+        job->target = _target;
+        _pending++;
+    }
+
+    _pool.execute([this, job]()
+    {
+        _decode(*job);
+    });
+}
+
+
+void MediaDecoder::_decode(Job& job)
+{
+    // Each worker keeps its decoding buffers, so a stream of same sized
+    // images is decoded without allocating.
+    thread_local ofPixels decoded;
+    thread_local ofPixels cropped;
+
+    bool stopping = false;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        stopping = _stopping;
+    }
+
+    if (stopping)
+    {
+        job.frame.error = "Cancelled.";
+    }
+    else if (job.frame.error.empty())
+    {
+        bool loaded = job.buffer.size() > 0 ? ofLoadImage(decoded, job.buffer)
+                                            : ofLoadImage(decoded, job.frame.path);
+
+        if (!loaded || !decoded.isAllocated())
+        {
+            job.frame.error = "Unable to decode media " + std::to_string(job.frame.mediaId);
+        }
+    }
+
+    if (job.frame.error.empty())
+    {
+        std::size_t width = decoded.getWidth();
+        std::size_t height = decoded.getHeight();
+        std::size_t channels = decoded.getNumChannels();
+
+        MediaEntitySize::Resize resize = MediaEntitySize::Resize::FIT;
+        std::pair<std::size_t, std::size_t> size(width, height);
+
+        if (job.scale)
+        {
+            size = scaledSize(width, height, job.sizes, job.target, resize);
+        }
+
+        job.frame.pixels = _pixelPool.acquire(size.first, size.second, channels);
+
+        if (size.first == width && size.second == height)
+        {
+            // Hand the decoded pixels over without copying. The worker keeps
+            // the pooled buffer, which has the same size, for the next image.
+            job.frame.pixels->swap(decoded);
+        }
+        else
+        {
+            const ofPixels* source = &decoded;
+
+            if (resize == MediaEntitySize::Resize::CROP)
+            {
+                // Crop the center to the target aspect ratio before scaling.
+                double aspect = double(size.first) / size.second;
+                std::size_t cropWidth = std::min(width, std::size_t(std::lround(height * aspect)));
+                std::size_t cropHeight = std::min(height, std::size_t(std::lround(width / aspect)));
+
+                if (cropWidth != width || cropHeight != height)
+                {
+                    decoded.cropTo(cropped,
+                                   (width - cropWidth) / 2,
+                                   (height - cropHeight) / 2,
+                                   cropWidth,
+                                   cropHeight);
+                    source = &cropped;
+                }
+            }
+
+            if (source->getWidth() == size.first && source->getHeight() == size.second)
+            {
+                job.frame.pixels->swap(cropped);
+            }
+            else if (!source->resizeTo(*job.frame.pixels, OF_INTERPOLATE_BICUBIC))
+            {
+                job.frame.pixels.reset();
+                job.frame.error = "Unable to resize media " + std::to_string(job.frame.mediaId);
+            }
+        }
+    }
+
+    if (!job.frame.error.empty() && job.frame.error != "Cancelled.")
+    {
+        ofLogWarning("MediaDecoder::_decode") << job.frame.error;
+    }
+
+    job.buffer.clear();
+
+    _deliver(std::move(job.frame));
+}
+
+
+void MediaDecoder::_deliver(Frame&& frame)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _spaceCondition.wait(lock, [this]()
+    {
+        return _stopping || _ready.size() < _capacity;
+    });
+
+    _pending--;
+
+    if (!_stopping)
+    {
+        _ready.push_back(std::move(frame));
+        _readyCondition.notify_one();
+    }
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,339 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/MediaFetcher.h"
+#include "Poco/Exception.h"
+#include "Poco/URI.h"
+#include "ofx/HTTP/GetRequest.h"
+#include "ofx/HTTP/HTTPClient.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+std::string sizeName(MediaEntitySize::Type size)
+{
+    switch (size)
+    {
+        case MediaEntitySize::Type::THUMB: return "thumb";
+        case MediaEntitySize::Type::SMALL: return "small";
+        case MediaEntitySize::Type::MEDIUM: return "medium";
+        case MediaEntitySize::Type::LARGE: return "large";
+    }
+
+    return "large";
+}
+
+
+/// \brief Split a media URL into its base URL and size variant.
+///
+/// Size variants are requested by appending `:<size>` to the media URL, e.g.
+/// `https://pbs.twimg.com/media/abc.jpg:small`.
+void splitVariant(const std::string& url, std::string& base, std::string& variant)
+{
+    std::size_t slash = url.find_last_of('/');
+    std::size_t colon = url.find_last_of(':');
+
+    if (colon != std::string::npos && (slash == std::string::npos || colon > slash))
+    {
+        base = url.substr(0, colon);
+        variant = url.substr(colon + 1);
+    }
+    else
+    {
+        base = url;
+        variant.clear();
+    }
+}
+
+
+} // namespace
+
+
+const std::size_t MediaFetcher::DEFAULT_MAX_CONCURRENCY = 8;
+const std::size_t MediaFetcher::DEFAULT_MAX_CONNECTIONS_PER_HOST = 4;
+
+
+MediaFetcher::MediaFetcher(const std::filesystem::path& cacheDirectory,
+                           std::size_t maxConcurrency,
+                           Transport transport):
+    _transport(transport ? transport : &MediaFetcher::download),
+    _cache(cacheDirectory),
+    _maxConcurrency(std::max(std::size_t(1), maxConcurrency)),
+    _pool(_maxConcurrency)
+{
+}
+
+
+MediaFetcher::~MediaFetcher()
+{
+    std::deque<std::shared_ptr<Job>> cancelled;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+        cancelled.swap(_pending);
+    }
+
+    for (auto& job: cancelled)
+    {
+        job->result.error = "Cancelled.";
+        job->promise.set_value(job->result);
+    }
+}
+
+
+std::shared_future<MediaFetcher::Result> MediaFetcher::fetch(const MediaEntity& entity)
+{
+    MediaEntitySize::Type size = preferredSize();
+    int64_t mediaId = entity.mediaID();
+
+    std::string url = MediaFetcher::url(entity, size);
+
+    return fetch(mediaId, url);
+}
+
+
+std::shared_future<MediaFetcher::Result> MediaFetcher::fetch(int64_t mediaId,
+                                                             const std::string& url)
+{
+    Result result;
+    result.mediaId = mediaId;
+    result.url = url;
+
+    if (_cache.get(url, result.path))
+    {
+        result.cached = true;
+        std::promise<Result> promise;
+        promise.set_value(result);
+        return promise.get_future().share();
+    }
+
+    std::string base;
+    std::string variant;
+    splitVariant(url, base, variant);
+
+    // Fetches of the same media and size share a download, even when the
+    // media is referenced by different URLs, e.g. http and https. Media
+    // without an id is shared by URL.
+    std::string key = mediaId >= 0 ? std::to_string(mediaId) + ":" + variant : url;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto iter = _inFlight.find(key);
+
+    if (iter != _inFlight.end())
+    {
+        return iter->second;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->key = key;
+    job->result = result;
+
+    try
+    {
+        Poco::URI uri(base);
+        job->host = uri.getHost();
+
+        // The extension is taken from the base URL so the size variant does
+        // not end up in the cached file name.
+        job->extension = std::filesystem::path(uri.getPath()).extension().string();
+    }
+    catch (const Poco::SyntaxException& exc)
+    {
+        job->result.error = "Unable to parse URL " + url;
+        job->promise.set_value(job->result);
+        return job->promise.get_future().share();
+    }
+
+    if (_stopping)
+    {
+        job->result.error = "Cancelled.";
+        job->promise.set_value(job->result);
+        return job->promise.get_future().share();
+    }
+
+    std::shared_future<Result> future = job->promise.get_future().share();
+    _inFlight[key] = future;
+    _pending.push_back(job);
+    _pump();
+
+    return future;
+}
+
+
+void MediaFetcher::setPreferredSize(MediaEntitySize::Type size)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _preferredSize = size;
+}
+
+
+MediaEntitySize::Type MediaFetcher::preferredSize() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _preferredSize;
+}
+
+
+void MediaFetcher::setMaxConnectionsPerHost(std::size_t maxConnectionsPerHost)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _maxConnectionsPerHost = std::max(std::size_t(1), maxConnectionsPerHost);
+    _pump();
+}
+
+
+std::size_t MediaFetcher::maxConnectionsPerHost() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _maxConnectionsPerHost;
+}
+
+
+std::size_t MediaFetcher::pending() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _pending.size();
+}
+
+
+std::size_t MediaFetcher::active() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _active;
+}
+
+
+MediaCache& MediaFetcher::cache()
+{
+    return _cache;
+}
+
+
+std::string MediaFetcher::url(const MediaEntity& entity, MediaEntitySize::Type size)
+{
+    std::string base = entity.secureMediaURL().empty() ? entity.mediaURL() : entity.secureMediaURL();
+
+    const MediaEntity::Sizes& sizes = entity.sizes();
+
+    if (sizes.empty())
+    {
+        return base;
+    }
+
+    auto iter = sizes.upper_bound(size);
+
+    // Prefer the requested size, then the next smaller, then the smallest
+    // larger size.
+    if (iter != sizes.begin())
+    {
+        --iter;
+    }
+
+    return base + ":" + sizeName(iter->first);
+}
+
+
+ofBuffer MediaFetcher::download(const std::string& url)
+{
+    HTTP::HTTPClient client;
+    HTTP::GetRequest request(url);
+
+    auto response = client.execute(request);
+
+    if (response == nullptr || !response->isSuccess())
+    {
+        throw Poco::IOException("Unable to download " + url);
+    }
+
+    return response->buffer();
+}
+
+
+void MediaFetcher::_pump()
+{
+    if (_stopping)
+    {
+        return;
+    }
+
+    for (auto iter = _pending.begin(); iter != _pending.end() && _active < _maxConcurrency;)
+    {
+        std::size_t& hostActive = _activeByHost[(*iter)->host];
+
+        if (hostActive < _maxConnectionsPerHost)
+        {
+            std::shared_ptr<Job> job = *iter;
+            iter = _pending.erase(iter);
+
+            ++hostActive;
+            ++_active;
+
+            _pool.execute([this, job]() { _run(job); });
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+
+void MediaFetcher::_run(std::shared_ptr<Job> job)
+{
+    try
+    {
+        ofBuffer buffer = _transport(job->result.url);
+
+        job->result.path = _cache.put(job->result.url, buffer, job->extension);
+
+        if (job->result.path.empty())
+        {
+            job->result.error = "Unable to cache " + job->result.url;
+        }
+    }
+    catch (const std::exception& exc)
+    {
+        job->result.error = exc.what();
+    }
+
+    if (!job->result.isSuccess())
+    {
+        ofLogWarning("MediaFetcher::_run") << job->result.error;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        --_active;
+
+        auto iter = _activeByHost.find(job->host);
+
+        if (iter != _activeByHost.end() && --iter->second == 0)
+        {
+            _activeByHost.erase(iter);
+        }
+
+        // The file is cached before the job leaves _inFlight, so a new fetch
+        // of the same key finds it in the cache.
+        _inFlight.erase(job->key);
+
+        _pump();
+    }
+
+    job->promise.set_value(job->result);
+}
+
+
+} } // namespace ofx::Twitter
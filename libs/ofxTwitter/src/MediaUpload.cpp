@@ -7,10 +7,11 @@
 
 #include "ofx/Twitter/MediaUpload.h"
 #include "ofLog.h"
+#include <random>
 #include <sstream>
+#include "Poco/Exception.h"
+#include "Poco/Net/HTMLForm.h"
 #include "Poco/Net/HTTPRequest.h"
-#include "ofx/IO/ByteBuffer.h"
-#include "ofx/IO/Base64Encoding.h"
 #include "ofx/Twitter/Utils.h"
 
 
@@ -18,6 +19,48 @@ namespace ofx {
 namespace Twitter {
 
 
+namespace {
+
+
+/// \returns a random boundary, vanishingly unlikely to occur in the data.
+std::string multipartBoundary()
+{
+    thread_local std::mt19937_64 engine(std::random_device{}());
+    std::ostringstream boundary;
+    boundary << "ofxTwitter" << std::hex << engine() << engine();
+    return boundary.str();
+}
+
+
+std::string multipartField(const std::string& boundary,
+                           const std::string& name,
+                           const std::string& value)
+{
+    return "--" + boundary + "\r\n"
+         + "Content-Disposition: form-data; name=\"" + name + "\"\r\n\r\n"
+         + value + "\r\n";
+}
+
+
+/// \returns the headers of a media part, which is followed by raw data.
+std::string multipartMedia(const std::string& boundary,
+                           const std::string& mediaType)
+{
+    return "--" + boundary + "\r\n"
+         + "Content-Disposition: form-data; name=\"media\"; filename=\"blob\"\r\n"
+         + "Content-Type: " + mediaType + "\r\n\r\n";
+}
+
+
+std::string multipartFooter(const std::string& boundary)
+{
+    return "\r\n--" + boundary + "--\r\n";
+}
+
+
+} // namespace
+
+
 const std::string MediaUploadRequest::RESOURCE_URL = "https://upload.twitter.com/1.1/media/upload.json";
 
 
@@ -38,19 +81,128 @@ void MediaUploadRequest::setFile(const std::string& path)
 }
 
 
-void MediaUploadRequest::setImage(const ofPixels& pixels,
+void MediaUploadRequest::setImage(ImageEncoder& encoder,
+                                  const ofPixels& pixels,
                                   ofImageFormat format,
                                   ofImageQualityType quality)
 {
-    ofBuffer buffer;
-#if OF_VERSION_MINOR < 10
-    ofPixels _pixels = pixels;
-    ofSaveImage(_pixels, buffer, format, quality);
-#else
-    ofSaveImage(pixels, buffer, format, quality);
-#endif
-    HTTP::PostRequest::addFormField("media_data",
-                                    IO::Base64Encoding::encode(IO::ByteBuffer(buffer)));
+    try
+    {
+        setMedia(encoder.encode(pixels, format, quality),
+                 ImageEncoder::mediaType(format));
+    }
+    catch (const Poco::Exception& exc)
+    {
+        ofLogError("MediaUploadRequest::setImage") << exc.displayText();
+    }
+}
+
+
+void MediaUploadRequest::setMedia(std::shared_ptr<const ofBuffer> media,
+                                  const std::string& mediaType)
+{
+    _media = media;
+    _mediaType = mediaType;
+
+    // The form fields are sent as multipart data, so they are not signed.
+    _form.setEncoding(Poco::Net::HTMLForm::ENCODING_MULTIPART);
+    _boundary = multipartBoundary();
+    _footer = multipartFooter(_boundary);
+}
+
+
+OAuth10Signer::EncodedParameters MediaUploadRequest::formParameters() const
+{
+    // Multipart form fields are not signed.
+    if (_form.getEncoding() != Poco::Net::HTMLForm::ENCODING_URL)
+    {
+        return OAuth10Signer::EncodedParameters();
+    }
+
+    return OAuth10Signer::EncodedParameters(_form);
+}
+
+
+void MediaUploadRequest::prepareRequest()
+{
+    if (_media == nullptr)
+    {
+        HTTP::PostRequest::prepareRequest();
+        return;
+    }
+
+    // Form fields, e.g. media_category or additional_owners, precede the
+    // media part.
+    _header.clear();
+
+    for (const auto& field: _form)
+    {
+        _header += multipartField(_boundary, field.first, field.second);
+    }
+
+    _header += multipartMedia(_boundary, _mediaType);
+
+    setContentType("multipart/form-data; boundary=" + _boundary);
+    setContentLength(_header.size() + _media->size() + _footer.size());
+}
+
+
+void MediaUploadRequest::writeRequestBody(std::ostream& requestStream)
+{
+    if (_media == nullptr)
+    {
+        HTTP::PostRequest::writeRequestBody(requestStream);
+        return;
+    }
+
+    requestStream.write(_header.data(), _header.size());
+    requestStream.write(_media->getData(), _media->size());
+    requestStream.write(_footer.data(), _footer.size());
+}
+
+
+MediaAppendRequest::MediaAppendRequest(int64_t mediaId,
+                                       std::size_t segmentIndex,
+                                       const char* data,
+                                       std::size_t size):
+    HTTP::Request(Poco::Net::HTTPRequest::HTTP_POST,
+                  MediaUploadRequest::RESOURCE_URL,
+                  Poco::Net::HTTPMessage::HTTP_1_1),
+    _boundary(multipartBoundary()),
+    _data(data),
+    _size(size)
+{
+    _header = multipartField(_boundary, "command", "APPEND")
+            + multipartField(_boundary, "media_id", std::to_string(mediaId))
+            + multipartField(_boundary, "segment_index", std::to_string(segmentIndex))
+            + multipartMedia(_boundary, "application/octet-stream");
+
+    _footer = multipartFooter(_boundary);
+}
+
+
+MediaAppendRequest::~MediaAppendRequest()
+{
+}
+
+
+void MediaAppendRequest::prepareRequest()
+{
+    setContentType("multipart/form-data; boundary=" + _boundary);
+    setContentLength(_header.size() + _size + _footer.size());
+}
+
+
+void MediaAppendRequest::writeRequestBody(std::ostream& requestStream)
+{
+    requestStream.write(_header.data(), _header.size());
+    requestStream.write(_data, _size);
+    requestStream.write(_footer.data(), _footer.size());
+}
+
+
+MediaUploadResponse::MediaUploadResponse()
+{
 }
 
 
@@ -65,8 +217,70 @@ int64_t MediaUploadResponse::mediaId() const
 }
 
 
-void MediaUploadResponse::parseJSON(const ofJson& json)
+const std::string& MediaUploadResponse::mediaKey() const
+{
+    return _mediaKey;
+}
+
+
+uint64_t MediaUploadResponse::size() const
+{
+    return _size;
+}
+
+
+uint64_t MediaUploadResponse::expiresAfterSecs() const
+{
+    return _expiresAfterSecs;
+}
+
+
+MediaUploadResponse::ProcessingState MediaUploadResponse::processingState() const
+{
+    return _processingState;
+}
+
+
+uint64_t MediaUploadResponse::checkAfterSecs() const
+{
+    return _checkAfterSecs;
+}
+
+
+int MediaUploadResponse::progressPercent() const
+{
+    return _progressPercent;
+}
+
+
+const std::string& MediaUploadResponse::mediaType() const
+{
+    return _mediaType;
+}
+
+
+int MediaUploadResponse::width() const
+{
+    return _width;
+}
+
+
+int MediaUploadResponse::height() const
+{
+    return _height;
+}
+
+
+const std::vector<Error>& MediaUploadResponse::errors() const
 {
+    return _errors;
+}
+
+
+MediaUploadResponse MediaUploadResponse::fromJSON(const ofJson& json)
+{
+    MediaUploadResponse response;
+
     auto iter = json.cbegin();
     while (iter != json.cend())
     {
@@ -75,14 +289,51 @@ void MediaUploadResponse::parseJSON(const ofJson& json)
 
         if (Utils::endsWith(key, "_str")) { /* skip */ }
         else if (Utils::endsWith(key, "_string")) { /* skip */ }
-        else if (key == "media_id") _mediaId = value;
-        else if (key == "image") { /* TODO */ }
-        else if (key == "size") { /* TODO */ }
-        else if (key == "expires_after_secs") { /* TODO */ }
-        else ofLogWarning("SearchResponse::parseJSON") << "Unknown key: " << key;
+        else if (key == "media_id") response._mediaId = value;
+        else if (key == "size") response._size = value;
+        else if (key == "expires_after_secs") response._expiresAfterSecs = value;
+        else if (key == "processing_info")
+        {
+            std::string state = value.value("state", "");
+
+            if (state == "pending") response._processingState = ProcessingState::PENDING;
+            else if (state == "in_progress") response._processingState = ProcessingState::IN_PROGRESS;
+            else if (state == "succeeded") response._processingState = ProcessingState::SUCCEEDED;
+            else if (state == "failed") response._processingState = ProcessingState::FAILED;
+            else ofLogWarning("MediaUploadResponse::fromJSON") << "Unknown state: " << state;
+
+            response._checkAfterSecs = value.value("check_after_secs", uint64_t(0));
+            response._progressPercent = value.value("progress_percent", 0);
+
+            if (value.find("error") != value.end())
+            {
+                response._errors.push_back(Error::fromJSON(value["error"]));
+            }
+        }
+        else if (key == "errors")
+        {
+            for (const auto& error: value)
+            {
+                response._errors.push_back(Error::fromJSON(error));
+            }
+        }
+        else if (key == "media_key") response._mediaKey = value;
+        else if (key == "image")
+        {
+            response._mediaType = value.value("image_type", "");
+            response._width = value.value("w", -1);
+            response._height = value.value("h", -1);
+        }
+        else if (key == "video")
+        {
+            response._mediaType = value.value("video_type", "");
+        }
+        else ofLogWarning("MediaUploadResponse::fromJSON") << "Unknown key: " << key;
 
         ++iter;
     }
+
+    return response;
 }
 
 
@@ -33,7 +33,7 @@ uint64_t StatusDeletedNotice::timestamp() const
 }
 
 
-ofJson StatusDeletedNotice::json() const
+const ofJson& StatusDeletedNotice::json() const
 {
     return _json;
 }
@@ -84,7 +84,7 @@ uint64_t LimitNotice::track() const
 }
 
 
-ofJson LimitNotice::json() const
+const ofJson& LimitNotice::json() const
 {
     return _json;
 }
@@ -114,13 +114,13 @@ int64_t StatusWithheldNotice::statusId() const
 }
 
 
-std::vector<std::string> StatusWithheldNotice::countries() const
+const std::vector<std::string>& StatusWithheldNotice::countries() const
 {
     return _countries;
 }
 
 
-ofJson StatusWithheldNotice::json() const
+const ofJson& StatusWithheldNotice::json() const
 {
     return _json;
 }
@@ -151,13 +151,13 @@ int64_t UserWithheldNotice::userId() const
 }
 
 
-std::vector<std::string> UserWithheldNotice::countries() const
+const std::vector<std::string>& UserWithheldNotice::countries() const
 {
     return _countries;
 }
 
 
-ofJson UserWithheldNotice::json() const
+const ofJson& UserWithheldNotice::json() const
 {
     return _json;
 }
@@ -186,19 +186,19 @@ int64_t DisconnectNotice::code() const
 }
 
 
-std::string DisconnectNotice::streamName() const
+const std::string& DisconnectNotice::streamName() const
 {
     return _streamName;
 }
 
 
-std::string DisconnectNotice::reason() const
+const std::string& DisconnectNotice::reason() const
 {
     return _reason;
 }
 
 
-ofJson DisconnectNotice::json() const
+const ofJson& DisconnectNotice::json() const
 {
     return _json;
 }
@@ -218,13 +218,13 @@ DisconnectNotice DisconnectNotice::fromJSON(const ofJson& json)
 const std::string StallWarning::JSON_KEY = "warning";
 
 
-std::string StallWarning::code() const
+const std::string& StallWarning::code() const
 {
     return _code;
 }
 
 
-std::string StallWarning::message() const
+const std::string& StallWarning::message() const
 {
     return _message;
 }
@@ -236,7 +236,7 @@ double StallWarning::percentFull() const
 }
 
 
-ofJson StallWarning::json() const
+const ofJson& StallWarning::json() const
 {
     return _json;
 }
@@ -0,0 +1,544 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/OAuth10Signer.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include "Poco/URI.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+inline uint32_t rotateLeft(uint32_t value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+
+std::string base64(const uint8_t* data, std::size_t size)
+{
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string result;
+    result.reserve(((size + 2) / 3) * 4);
+
+    for (std::size_t i = 0; i < size; i += 3)
+    {
+        uint32_t n = uint32_t(data[i]) << 16;
+        if (i + 1 < size) n |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) n |= uint32_t(data[i + 2]);
+
+        result += alphabet[(n >> 18) & 63];
+        result += alphabet[(n >> 12) & 63];
+        result += i + 1 < size ? alphabet[(n >> 6) & 63] : '=';
+        result += i + 2 < size ? alphabet[n & 63] : '=';
+    }
+
+    return result;
+}
+
+
+std::string baseStringURI(const Poco::URI& uri)
+{
+    std::string scheme = uri.getScheme();
+    std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
+
+    std::string host = uri.getHost();
+    std::transform(host.begin(), host.end(), host.begin(), ::tolower);
+
+    std::string result = scheme + "://" + host;
+
+    unsigned short port = uri.getPort();
+
+    if (port != 0
+    && !(scheme == "http" && port == 80)
+    && !(scheme == "https" && port == 443))
+    {
+        result += ":" + std::to_string(port);
+    }
+
+    std::string path;
+    Poco::URI::encode(uri.getPath(), "?#", path);
+    result += path.empty() ? "/" : path;
+
+    return result;
+}
+
+
+} // namespace
+
+
+const std::size_t OAuth10Signer::DEFAULT_NONCE_POOL_SIZE = 256;
+
+
+OAuth10Signer::EncodedParameters::EncodedParameters()
+{
+}
+
+
+OAuth10Signer::EncodedParameters::EncodedParameters(const Poco::Net::NameValueCollection& parameters)
+{
+    for (const auto& parameter: parameters)
+    {
+        _fragments.emplace_back(percentEncode(parameter.first),
+                                percentEncode(parameter.second));
+    }
+
+    std::sort(_fragments.begin(), _fragments.end());
+}
+
+
+void OAuth10Signer::EncodedParameters::add(const std::string& name,
+                                           const std::string& value)
+{
+    auto fragment = std::make_pair(percentEncode(name), percentEncode(value));
+    _fragments.insert(std::upper_bound(_fragments.begin(), _fragments.end(), fragment), fragment);
+}
+
+
+void OAuth10Signer::EncodedParameters::set(const std::string& name,
+                                           const std::string& value)
+{
+    erase(name);
+    add(name, value);
+}
+
+
+void OAuth10Signer::EncodedParameters::erase(const std::string& name)
+{
+    std::string encodedName = percentEncode(name);
+
+    _fragments.erase(std::remove_if(_fragments.begin(),
+                                    _fragments.end(),
+                                    [&](const std::pair<std::string, std::string>& fragment)
+                                    {
+                                        return fragment.first == encodedName;
+                                    }),
+                     _fragments.end());
+}
+
+
+const std::vector<std::pair<std::string, std::string>>& OAuth10Signer::EncodedParameters::fragments() const
+{
+    return _fragments;
+}
+
+
+OAuth10Signer::OAuth10Signer(const HTTP::OAuth10Credentials& credentials,
+                             std::size_t noncePoolSize):
+    _credentials(credentials),
+    _encodedConsumerKey(percentEncode(credentials.consumerKey())),
+    _encodedToken(percentEncode(credentials.accessToken())),
+    _noncePoolSize(std::max(std::size_t(1), noncePoolSize)),
+    _random(std::random_device()())
+{
+    _initializeHMAC(percentEncode(credentials.consumerSecret())
+                  + "&"
+                  + percentEncode(credentials.accessTokenSecret()),
+                    _inner,
+                    _outer);
+}
+
+
+OAuth10Signer::~OAuth10Signer()
+{
+}
+
+
+const HTTP::OAuth10Credentials& OAuth10Signer::credentials() const
+{
+    return _credentials;
+}
+
+
+void OAuth10Signer::sign(HTTP::Request& request, const EncodedParameters& parameters)
+{
+    request.set("Authorization", authorization(request.getMethod(),
+                                               request.getURI(),
+                                               parameters));
+}
+
+
+std::string OAuth10Signer::authorization(const std::string& method,
+                                         const std::string& url,
+                                         const EncodedParameters& parameters)
+{
+    using namespace std::chrono;
+    uint64_t timestamp = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+    return authorization(method, url, parameters, nonce(), timestamp);
+}
+
+
+std::string OAuth10Signer::authorization(const std::string& method,
+                                         const std::string& url,
+                                         const EncodedParameters& parameters,
+                                         const std::string& nonce,
+                                         uint64_t timestamp) const
+{
+    EncodedParameters oauthParameters = _oauthParameters(nonce, timestamp);
+    oauthParameters.add("oauth_signature", _signature(method, url, parameters, oauthParameters));
+
+    std::string header = "OAuth ";
+
+    for (const auto& fragment: oauthParameters.fragments())
+    {
+        if (header.size() > 6) header += ", ";
+        header += fragment.first;
+        header += "=\"";
+        header += fragment.second;
+        header += "\"";
+    }
+
+    return header;
+}
+
+
+std::string OAuth10Signer::signature(const std::string& method,
+                                     const std::string& url,
+                                     const EncodedParameters& parameters) const
+{
+    return _signature(method, url, parameters, EncodedParameters());
+}
+
+
+std::string OAuth10Signer::nonce()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_nonces.empty())
+    {
+        static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+        _nonces.resize(_noncePoolSize);
+
+        for (auto& nonce: _nonces)
+        {
+            nonce.resize(32);
+
+            // Each draw yields ten characters.
+            for (std::size_t i = 0; i < nonce.size(); i += 10)
+            {
+                uint64_t bits = _random();
+
+                for (std::size_t j = i; j < std::min(i + 10, nonce.size()); ++j)
+                {
+                    nonce[j] = alphabet[bits % 62];
+                    bits /= 62;
+                }
+            }
+        }
+    }
+
+    std::string nonce = std::move(_nonces.back());
+    _nonces.pop_back();
+    return nonce;
+}
+
+
+std::string OAuth10Signer::percentEncode(const std::string& value)
+{
+    static const char* hex = "0123456789ABCDEF";
+
+    std::string result;
+    result.reserve(value.size() * 3);
+
+    for (unsigned char c: value)
+    {
+        if ((c >= 'A' && c <= 'Z')
+         || (c >= 'a' && c <= 'z')
+         || (c >= '0' && c <= '9')
+         || c == '-' || c == '.' || c == '_' || c == '~')
+        {
+            result += char(c);
+        }
+        else
+        {
+            result += '%';
+            result += hex[c >> 4];
+            result += hex[c & 15];
+        }
+    }
+
+    return result;
+}
+
+
+std::string OAuth10Signer::baseURI(const std::string& url)
+{
+    return baseStringURI(Poco::URI(url));
+}
+
+
+std::array<uint8_t, 20> OAuth10Signer::sha1(const std::string& data)
+{
+    SHA1 hash;
+    hash.update(data.data(), data.size());
+    return hash.finish();
+}
+
+
+std::array<uint8_t, 20> OAuth10Signer::hmacSHA1(const std::string& key,
+                                                const std::string& data)
+{
+    SHA1 inner;
+    SHA1 outer;
+    _initializeHMAC(key, inner, outer);
+    return _finishHMAC(inner, outer, data);
+}
+
+
+void OAuth10Signer::_initializeHMAC(const std::string& key, SHA1& inner, SHA1& outer)
+{
+    // Keys longer than a block are hashed first, as specified by HMAC.
+    std::array<uint8_t, 64> keyBlock;
+    keyBlock.fill(0);
+
+    if (key.size() > keyBlock.size())
+    {
+        SHA1 hash;
+        hash.update(key.data(), key.size());
+        auto digest = hash.finish();
+        std::copy(digest.begin(), digest.end(), keyBlock.begin());
+    }
+    else
+    {
+        std::copy(key.begin(), key.end(), keyBlock.begin());
+    }
+
+    std::array<uint8_t, 64> pad;
+
+    for (std::size_t i = 0; i < pad.size(); ++i) pad[i] = keyBlock[i] ^ 0x36;
+    inner.update(pad.data(), pad.size());
+
+    for (std::size_t i = 0; i < pad.size(); ++i) pad[i] = keyBlock[i] ^ 0x5c;
+    outer.update(pad.data(), pad.size());
+}
+
+
+std::array<uint8_t, 20> OAuth10Signer::_finishHMAC(SHA1 inner,
+                                                   SHA1 outer,
+                                                   const std::string& data)
+{
+    inner.update(data.data(), data.size());
+    auto innerDigest = inner.finish();
+
+    outer.update(innerDigest.data(), innerDigest.size());
+    return outer.finish();
+}
+
+
+OAuth10Signer::EncodedParameters OAuth10Signer::_oauthParameters(const std::string& nonce,
+                                                                 uint64_t timestamp) const
+{
+    // The cached fragments are already encoded and in order, so they are
+    // added without going through add().
+    EncodedParameters parameters;
+
+    auto& fragments = parameters._fragments;
+    fragments.reserve(7);
+    fragments.emplace_back("oauth_consumer_key", _encodedConsumerKey);
+    fragments.emplace_back("oauth_nonce", percentEncode(nonce));
+    fragments.emplace_back("oauth_signature_method", "HMAC-SHA1");
+    fragments.emplace_back("oauth_timestamp", std::to_string(timestamp));
+
+    if (!_encodedToken.empty())
+    {
+        fragments.emplace_back("oauth_token", _encodedToken);
+    }
+
+    fragments.emplace_back("oauth_version", "1.0");
+
+    return parameters;
+}
+
+
+std::string OAuth10Signer::_signature(const std::string& method,
+                                      const std::string& url,
+                                      const EncodedParameters& parameters,
+                                      const EncodedParameters& oauthParameters) const
+{
+    Poco::URI uri(url);
+
+    // Query parameters are signed with the other request parameters.
+    EncodedParameters merged;
+    const EncodedParameters* requestParameters = &parameters;
+
+    if (!uri.getRawQuery().empty())
+    {
+        merged = parameters;
+
+        for (const auto& parameter: uri.getQueryParameters())
+        {
+            merged.add(parameter.first, parameter.second);
+        }
+
+        requestParameters = &merged;
+    }
+
+    const auto& a = requestParameters->fragments();
+    const auto& b = oauthParameters.fragments();
+
+    std::string parameterString;
+
+    std::size_t size = 0;
+    for (const auto& fragment: a) size += fragment.first.size() + fragment.second.size() + 2;
+    for (const auto& fragment: b) size += fragment.first.size() + fragment.second.size() + 2;
+    parameterString.reserve(size);
+
+    // Both lists are sorted, so they are merged rather than sorted again.
+    auto i = a.begin();
+    auto j = b.begin();
+
+    while (i != a.end() || j != b.end())
+    {
+        const auto& fragment = (j == b.end() || (i != a.end() && *i < *j)) ? *i++ : *j++;
+
+        if (!parameterString.empty()) parameterString += '&';
+        parameterString += fragment.first;
+        parameterString += '=';
+        parameterString += fragment.second;
+    }
+
+    std::string base = method;
+    std::transform(base.begin(), base.end(), base.begin(), ::toupper);
+    base += '&';
+    base += percentEncode(baseStringURI(uri));
+    base += '&';
+    base += percentEncode(parameterString);
+
+    auto digest = _finishHMAC(_inner, _outer, base);
+
+    return base64(digest.data(), digest.size());
+}
+
+
+OAuth10Signer::SHA1::SHA1():
+    state({ 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 })
+{
+}
+
+
+void OAuth10Signer::SHA1::update(const void* data, std::size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    length += size;
+
+    if (blockSize > 0)
+    {
+        std::size_t count = std::min(size, block.size() - blockSize);
+        std::memcpy(block.data() + blockSize, bytes, count);
+        blockSize += count;
+        bytes += count;
+        size -= count;
+
+        if (blockSize < block.size())
+        {
+            return;
+        }
+
+        transform(block.data());
+        blockSize = 0;
+    }
+
+    while (size >= block.size())
+    {
+        transform(bytes);
+        bytes += block.size();
+        size -= block.size();
+    }
+
+    std::memcpy(block.data(), bytes, size);
+    blockSize = size;
+}
+
+
+std::array<uint8_t, 20> OAuth10Signer::SHA1::finish()
+{
+    uint64_t bits = length * 8;
+
+    uint8_t padding[72] = { 0x80 };
+    std::size_t paddingSize = (blockSize < 56 ? 56 : 120) - blockSize;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        padding[paddingSize + i] = uint8_t(bits >> (56 - 8 * i));
+    }
+
+    update(padding, paddingSize + 8);
+
+    std::array<uint8_t, 20> digest;
+
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+        digest[i * 4 + 0] = uint8_t(state[i] >> 24);
+        digest[i * 4 + 1] = uint8_t(state[i] >> 16);
+        digest[i * 4 + 2] = uint8_t(state[i] >> 8);
+        digest[i * 4 + 3] = uint8_t(state[i]);
+    }
+
+    return digest;
+}
+
+
+void OAuth10Signer::SHA1::transform(const uint8_t* data)
+{
+    uint32_t w[80];
+
+    for (int i = 0; i < 16; ++i)
+    {
+        w[i] = (uint32_t(data[i * 4]) << 24)
+             | (uint32_t(data[i * 4 + 1]) << 16)
+             | (uint32_t(data[i * 4 + 2]) << 8)
+             | uint32_t(data[i * 4 + 3]);
+    }
+
+    for (int i = 16; i < 80; ++i)
+    {
+        w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+
+    for (int i = 0; i < 80; ++i)
+    {
+        uint32_t f = 0;
+        uint32_t k = 0;
+
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+        uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rotateLeft(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+
+} } // namespace ofx::Twitter
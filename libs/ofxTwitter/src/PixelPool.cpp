@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/PixelPool.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t PixelPool::DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+
+PixelPool::PixelPool(std::size_t maxBytes): _state(std::make_shared<State>())
+{
+    _state->maxBytes = maxBytes;
+}
+
+
+PixelPool::~PixelPool()
+{
+}
+
+
+std::shared_ptr<ofPixels> PixelPool::acquire(std::size_t width,
+                                             std::size_t height,
+                                             std::size_t channels)
+{
+    std::unique_ptr<ofPixels> pixels;
+
+    {
+        std::unique_lock<std::mutex> lock(_state->mutex);
+
+        auto iter = _state->buckets.find(Key(width, height, channels));
+
+        if (iter != _state->buckets.end())
+        {
+            pixels = std::move(iter->second.back());
+            iter->second.pop_back();
+
+            _state->bytes -= pixels->getTotalBytes();
+            _state->count--;
+
+            if (iter->second.empty())
+            {
+                _state->buckets.erase(iter);
+            }
+        }
+    }
+
+    if (pixels == nullptr)
+    {
+        pixels = std::make_unique<ofPixels>();
+        pixels->allocate(width, height, channels);
+    }
+
+    std::weak_ptr<State> state = _state;
+
+    return std::shared_ptr<ofPixels>(pixels.release(), [state](ofPixels* pixels)
+    {
+        _release(state, pixels);
+    });
+}
+
+
+void PixelPool::setMaxBytes(std::size_t maxBytes)
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->maxBytes = maxBytes;
+    _state->trim();
+}
+
+
+std::size_t PixelPool::maxBytes() const
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    return _state->maxBytes;
+}
+
+
+std::size_t PixelPool::bytes() const
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    return _state->bytes;
+}
+
+
+std::size_t PixelPool::count() const
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    return _state->count;
+}
+
+
+void PixelPool::clear()
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->buckets.clear();
+    _state->bytes = 0;
+    _state->count = 0;
+}
+
+
+void PixelPool::State::trim()
+{
+    // Buckets are freed in key order, which frees the smallest widths first.
+    // Large images are the most expensive to allocate, so they are kept.
+    auto iter = buckets.begin();
+
+    while (bytes > maxBytes && iter != buckets.end())
+    {
+        while (bytes > maxBytes && !iter->second.empty())
+        {
+            bytes -= iter->second.back()->getTotalBytes();
+            count--;
+            iter->second.pop_back();
+        }
+
+        if (iter->second.empty())
+        {
+            iter = buckets.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+
+void PixelPool::_release(std::weak_ptr<State> state, ofPixels* pixels)
+{
+    std::unique_ptr<ofPixels> owned(pixels);
+
+    std::shared_ptr<State> shared = state.lock();
+
+    if (shared == nullptr || !owned->isAllocated())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+
+    std::size_t size = owned->getTotalBytes();
+
+    if (shared->bytes + size > shared->maxBytes)
+    {
+        return;
+    }
+
+    Key key(owned->getWidth(), owned->getHeight(), owned->getNumChannels());
+
+    shared->buckets[key].push_back(std::move(owned));
+    shared->bytes += size;
+    shared->count++;
+}
+
+
+} } // namespace ofx::Twitter
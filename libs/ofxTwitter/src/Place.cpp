@@ -22,61 +22,61 @@ Place::~Place()
 }
 
 
-Place::Attributes Place::attributes() const
+const Place::Attributes& Place::attributes() const
 {
     return _attributes;
 }
 
 
-Geo::CoordinateBounds Place::boundingBox() const
+const Geo::CoordinateBounds& Place::boundingBox() const
 {
     return _boundingBox;
 }
 
 
-std::string Place::country() const
+const std::string& Place::country() const
 {
     return _country;
 }
 
 
-std::string Place::countryCode() const
+const std::string& Place::countryCode() const
 {
     return _countryCode;
 }
 
 
-std::string Place::fullName() const
+const std::string& Place::fullName() const
 {
     return _fullName;
 }
 
 
-std::string Place::id() const
+const std::string& Place::id() const
 {
     return _id;
 }
 
 
-std::vector<std::string> Place::containedWithinId() const
+const std::vector<std::string>& Place::containedWithinId() const
 {
     return _containedWithinIds;
 }
 
 
-std::string Place::name() const
+const std::string& Place::name() const
 {
     return _name;
 }
 
 
-std::string Place::placeType() const
+const std::string& Place::placeType() const
 {
     return _placeType;
 }
 
 
-std::string Place::url() const
+const std::string& Place::url() const
 {
     return _url;
 }
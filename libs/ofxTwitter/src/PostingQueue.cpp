@@ -0,0 +1,539 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/PostingQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include "Poco/Exception.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t PostingQueue::DEFAULT_MAX_ATTEMPTS = 8;
+const uint64_t PostingQueue::INITIAL_BACKOFF = 1000;
+const uint64_t PostingQueue::MAX_BACKOFF = 15 * 60 * 1000;
+const uint64_t PostingQueue::MEDIA_EXPIRY = 23 * 60 * 60 * 1000;
+
+
+PostingQueue::PostingQueue(const HTTP::OAuth10Credentials& credentials,
+                           const std::filesystem::path& queuePath,
+                           bool autoEventSync):
+    PostingQueue([credentials](StatusUpdateRequest& request)
+                 {
+                     return execute(credentials, request);
+                 },
+                 [credentials](const Poco::Net::NameValueCollection& fields,
+                               const char* data,
+                               std::size_t size)
+                 {
+                     return ChunkedMediaUpload::execute(credentials, fields, data, size);
+                 },
+                 queuePath,
+                 autoEventSync)
+{
+}
+
+
+PostingQueue::PostingQueue(Transport transport,
+                           ChunkedMediaUpload::Transport uploadTransport,
+                           const std::filesystem::path& queuePath,
+                           bool autoEventSync):
+    _transport(transport),
+    _uploader(uploadTransport),
+    _queuePath(queuePath),
+    _random(std::random_device()())
+{
+    _load();
+    setAutoEventSync(autoEventSync);
+    _thread = std::thread(&PostingQueue::_run, this);
+}
+
+
+PostingQueue::~PostingQueue()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+
+uint64_t PostingQueue::post(const std::string& status,
+                            const std::vector<std::filesystem::path>& media)
+{
+    return postParameters({ { "status", status } }, media);
+}
+
+
+uint64_t PostingQueue::postParameters(const ofJson& parameters,
+                                      const std::vector<std::filesystem::path>& media)
+{
+    if (!parameters.is_object())
+    {
+        throw Poco::InvalidArgumentException("Parameters must be a JSON object.");
+    }
+
+    Item item;
+    item.parameters = parameters;
+
+    for (const auto& path: media)
+    {
+        item.media.push_back(path.string());
+    }
+
+    uint64_t id = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        id = _nextId++;
+        item.id = id;
+        _items.push_back(std::move(item));
+        _save();
+    }
+
+    _condition.notify_all();
+
+    return id;
+}
+
+
+bool PostingQueue::cancel(uint64_t id)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (id == _sendingId)
+        {
+            return false;
+        }
+
+        auto iter = std::find_if(_items.begin(), _items.end(), [id](const Item& item)
+        {
+            return item.id == id;
+        });
+
+        if (iter == _items.end())
+        {
+            return false;
+        }
+
+        _items.erase(iter);
+        _save();
+    }
+
+    // The next post may be due sooner than the cancelled one.
+    _condition.notify_all();
+
+    return true;
+}
+
+
+std::size_t PostingQueue::pending() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _items.size();
+}
+
+
+RateLimit PostingQueue::rateLimit() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _rateLimit;
+}
+
+
+void PostingQueue::setMaxAttempts(std::size_t maxAttempts)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _maxAttempts = std::max(std::size_t(1), maxAttempts);
+}
+
+
+std::size_t PostingQueue::maxAttempts() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _maxAttempts;
+}
+
+
+void PostingQueue::setAutoEventSync(bool value)
+{
+    if (value)
+    {
+        _updateListener = ofEvents().update.newListener(this, &PostingQueue::_update);
+        _exitListener = ofEvents().exit.newListener(this, &PostingQueue::_exit);
+    }
+    else
+    {
+        _updateListener.unsubscribe();
+        _exitListener.unsubscribe();
+    }
+}
+
+
+void PostingQueue::syncEvents()
+{
+    Result result;
+    while (_postedChannel.tryReceive(result)) onPosted.notify(this, result);
+    while (_failedChannel.tryReceive(result)) onFailed.notify(this, result);
+}
+
+
+PostingQueue::Response PostingQueue::execute(const HTTP::OAuth10Credentials& credentials,
+                                             StatusUpdateRequest& request)
+{
+    HTTP::OAuth10HTTPClient client(credentials);
+
+    auto response = client.execute(request);
+
+    if (response == nullptr)
+    {
+        throw Poco::IOException("No response.");
+    }
+
+    Response result;
+    result.status = response->getStatus();
+    result.rateLimit = RateLimit::fromHeaders(*response);
+
+    ofBuffer buffer = response->buffer();
+    result.json = ofJson::parse(buffer.begin(), buffer.end(), nullptr, false);
+
+    if (result.json.is_discarded())
+    {
+        result.json = ofJson();
+    }
+
+    return result;
+}
+
+
+void PostingQueue::_run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stopping)
+    {
+        if (_items.empty())
+        {
+            _condition.wait(lock);
+            continue;
+        }
+
+        uint64_t wakeAt = std::max(_items.front().notBefore, _holdUntil);
+        uint64_t now = _now();
+
+        if (wakeAt > now)
+        {
+            _condition.wait_for(lock, std::chrono::milliseconds(wakeAt - now));
+            continue;
+        }
+
+        // The head stays in the queue while it is sent so that it is still
+        // persisted if the application exits mid-request.
+        Item item = _items.front();
+        item.attempts++;
+        _sendingId = item.id;
+
+        lock.unlock();
+
+        Result result;
+        result.id = item.id;
+        result.attempts = item.attempts;
+
+        Outcome outcome = _send(item, result);
+
+        lock.lock();
+
+        _sendingId = 0;
+
+        if (outcome == Outcome::RETRY && item.attempts < _maxAttempts)
+        {
+            item.notBefore = _now() + _backoff(item.attempts);
+            ofLogWarning("PostingQueue::_run") << "Post " << item.id << " failed, retrying: " << result.error;
+            _items.front() = item;
+            _save();
+            continue;
+        }
+
+        _items.pop_front();
+        _save();
+
+        if (outcome == Outcome::SUCCESS)
+        {
+            _postedChannel.send(result);
+        }
+        else
+        {
+            ofLogError("PostingQueue::_run") << "Post " << item.id << " failed: " << result.error;
+            _failedChannel.send(result);
+        }
+    }
+}
+
+
+PostingQueue::Outcome PostingQueue::_send(Item& item, Result& result)
+{
+    try
+    {
+        // Media ids are kept so that a retry does not upload the media again,
+        // unless they are about to expire.
+        if (!item.mediaIds.empty() && _now() > item.mediaUploadedAt + MEDIA_EXPIRY)
+        {
+            item.mediaIds.clear();
+        }
+
+        for (std::size_t i = item.mediaIds.size(); i < item.media.size(); ++i)
+        {
+            if (item.mediaIds.empty())
+            {
+                item.mediaUploadedAt = _now();
+            }
+
+            item.mediaIds.push_back(_uploader.upload(item.media[i]).mediaId());
+        }
+
+        StatusUpdateRequest request;
+
+        for (const auto& parameter: item.parameters.items())
+        {
+            if (parameter.value().is_string())
+            {
+                request.setFormField(parameter.key(), parameter.value().get<std::string>());
+            }
+            else
+            {
+                request.setFormField(parameter.key(), parameter.value().dump());
+            }
+        }
+
+        if (!item.mediaIds.empty())
+        {
+            request.setMediaIds(item.mediaIds);
+        }
+
+        Response response = _transport(request);
+
+        bool limited = response.status == 429;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            if (response.rateLimit.limit() > 0 || response.rateLimit.reset() > 0)
+            {
+                _rateLimit = response.rateLimit;
+            }
+
+            // Hold the whole queue until the window resets.
+            if ((limited || (_rateLimit.limit() > 0 && _rateLimit.remaining() == 0))
+                && response.rateLimit.reset() > 0)
+            {
+                _holdUntil = std::max(_holdUntil, response.rateLimit.reset() * 1000);
+            }
+        }
+
+        result.response = StatusUpdateResponse::fromJSON(response.json);
+
+        const auto& errors = result.response.errors();
+
+        if (response.status >= 200 && response.status < 300 && errors.empty())
+        {
+            return Outcome::SUCCESS;
+        }
+
+        bool transient = limited || response.status >= 500 || response.status == 0;
+
+        for (const auto& error: errors)
+        {
+            // 88: rate limit exceeded, 130: over capacity,
+            // 131: internal error, 185: over the daily status limit,
+            // 324 and 325: the media ids are invalid or have expired, so
+            // the media is uploaded again.
+            switch (error.code())
+            {
+                case 324:
+                case 325:
+                    item.mediaIds.clear();
+                    transient = true;
+                    break;
+                case 88:
+                case 130:
+                case 131:
+                case 185:
+                    transient = true;
+                    break;
+            }
+        }
+
+        result.error = errors.empty() ? "HTTP " + std::to_string(response.status)
+                                      : errors.front().message();
+
+        return transient ? Outcome::RETRY : Outcome::FAILURE;
+    }
+    catch (const Poco::FileException& exc)
+    {
+        // Missing or unreadable media, which a retry will not fix.
+        result.error = exc.displayText();
+        return Outcome::FAILURE;
+    }
+    catch (const Poco::IOException& exc)
+    {
+        // Network errors.
+        result.error = exc.displayText();
+        return Outcome::RETRY;
+    }
+    catch (const Poco::TimeoutException& exc)
+    {
+        result.error = exc.displayText();
+        return Outcome::RETRY;
+    }
+    catch (const Poco::Exception& exc)
+    {
+        // Data errors, e.g. media rejected by Twitter.
+        result.error = exc.displayText();
+    }
+    catch (const std::exception& exc)
+    {
+        result.error = exc.what();
+    }
+
+    return Outcome::FAILURE;
+}
+
+
+void PostingQueue::_save() const
+{
+    if (_queuePath.empty())
+    {
+        return;
+    }
+
+    ofJson json;
+    json["next_id"] = _nextId;
+    json["posts"] = ofJson::array();
+
+    for (const auto& item: _items)
+    {
+        ofJson post;
+        post["id"] = item.id;
+        post["parameters"] = item.parameters;
+        post["media"] = item.media;
+        post["media_ids"] = item.mediaIds;
+        post["media_uploaded_at"] = item.mediaUploadedAt;
+        post["attempts"] = item.attempts;
+        post["not_before"] = item.notBefore;
+        json["posts"].push_back(post);
+    }
+
+    std::filesystem::path tmp = _queuePath;
+    tmp += ".tmp";
+
+    {
+        std::ofstream ostr(tmp.string(), std::ios::binary | std::ios::trunc);
+
+        if (!ostr)
+        {
+            ofLogError("PostingQueue::_save") << "Unable to write " << tmp.string();
+            return;
+        }
+
+        ostr << json.dump();
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, _queuePath, ec);
+
+    if (ec)
+    {
+        ofLogError("PostingQueue::_save") << "Unable to rename " << tmp.string() << ": " << ec.message();
+    }
+}
+
+
+void PostingQueue::_load()
+{
+    if (_queuePath.empty() || !std::filesystem::exists(_queuePath))
+    {
+        return;
+    }
+
+    try
+    {
+        std::ifstream istr(_queuePath.string(), std::ios::binary);
+        ofJson json = ofJson::parse(istr);
+
+        _nextId = json.value("next_id", uint64_t(1));
+
+        const ofJson posts = json.value("posts", ofJson::array());
+
+        for (const auto& post: posts)
+        {
+            Item item;
+            item.id = post.value("id", uint64_t(0));
+            item.parameters = post.value("parameters", ofJson::object());
+            item.media = post.value("media", std::vector<std::string>());
+            item.mediaIds = post.value("media_ids", std::vector<int64_t>());
+            item.mediaUploadedAt = post.value("media_uploaded_at", uint64_t(0));
+            item.attempts = post.value("attempts", std::size_t(0));
+            item.notBefore = post.value("not_before", uint64_t(0));
+            _nextId = std::max(_nextId, item.id + 1);
+            _items.push_back(std::move(item));
+        }
+    }
+    catch (const std::exception& exc)
+    {
+        ofLogError("PostingQueue::_load") << "Unable to load " << _queuePath.string() << ": " << exc.what();
+    }
+}
+
+
+uint64_t PostingQueue::_backoff(std::size_t attempts)
+{
+    // Full jitter: a uniform delay up to the exponential backoff, which
+    // spreads retries from many clients across the window.
+    uint64_t ceiling = MAX_BACKOFF;
+
+    if (attempts < 32)
+    {
+        ceiling = std::min(MAX_BACKOFF, INITIAL_BACKOFF << (attempts - 1));
+    }
+
+    std::uniform_int_distribution<uint64_t> distribution(1, ceiling);
+    return distribution(_random);
+}
+
+
+uint64_t PostingQueue::_now()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+
+void PostingQueue::_update(ofEventArgs& args)
+{
+    syncEvents();
+}
+
+
+void PostingQueue::_exit(ofEventArgs& args)
+{
+    syncEvents();
+}
+
+
+} } // namespace ofx::Twitter
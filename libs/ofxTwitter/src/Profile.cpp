@@ -63,13 +63,13 @@ void Profile::setBackgroundColorHex(const std::string& backgroundColorHex)
 
 // TODO: finish setters
 
-std::string Profile::getBackgroundColorHex() const
+const std::string& Profile::getBackgroundColorHex() const
 {
     return _backgroundColorHex;
 }
 
 
-std::string Profile::getLinkColorHex() const
+const std::string& Profile::getLinkColorHex() const
 {
     return _linkColorHex;
 }
@@ -81,13 +81,13 @@ bool Profile::useBackgroundImage() const
 }
 
 
-std::string Profile::getBackgroundImageUrl() const
+const std::string& Profile::getBackgroundImageUrl() const
 {
     return _backgroundImageUrl;
 }
 
 
-std::string Profile::getBackgroundImageUrlHttps() const
+const std::string& Profile::getBackgroundImageUrlHttps() const
 {
     return _backgroundImageUrlHttps;
 }
@@ -99,7 +99,7 @@ bool Profile::getBackgroundTile() const
 }
 
 
-std::string Profile::getBannerUrl() const
+const std::string& Profile::getBannerUrl() const
 {
     return _bannerUrl;
 }
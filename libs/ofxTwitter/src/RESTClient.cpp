@@ -7,128 +7,248 @@
 
 #include "ofx/Twitter/RESTClient.h"
 #include "ofx/HTTP/GetRequest.h"
-#include "ofx/Twitter/MediaUpload.h"
-#include "ofx/Twitter/Search.h"
-#include "ofx/Twitter/StatusUpdate.h"
+#include "Poco/Exception.h"
+#include "ofLog.h"
 
 
 namespace ofx {
 namespace Twitter {
 
 
-//RESTClient::RESTClient()
-//{
-//}
-//
-//
-//RESTClient::RESTClient(const HTTP::OAuth10Credentials& credentials):
-//    HTTP::OAuth10HTTPClient(credentials)
-//{
-//}
-//
-//
-//RESTClient::~RESTClient()
-//{
-//}
-//
-//SearchResponse RESTClient::search(const std::string& query)
-//{
-//    return search(SearchQuery(query));
-//}
-//
-//
-//SearchResponse RESTClient::search(const SearchQuery& query)
-//{
-//    HTTP::GetRequest request(SearchQuery::RESOURCE_URL);
-//    request.addFormFields(query);
-//    return SearchResponse::fromHTTPResponse(*execute(request));
-//}
-//
+const std::size_t RESTClient::DEFAULT_MAX_CONNECTIONS = 4;
 
 
+RESTClient::RESTClient(const HTTP::OAuth10Credentials& credentials,
+                       std::size_t maxConnections):
+    _transport([this, signer = std::make_shared<OAuth10Signer>(credentials)](HTTP::Request& request,
+                                                                              const OAuth10Signer::EncodedParameters& parameters)
+    {
+        auto client = _acquireClient();
+        signer->sign(request, parameters);
 
-//std::unique_ptr<SearchResponse> RESTClient::search(const std::string& query)
-//{
-//    auto request = std::make_unique<SearchRequest>(query);
-//
-//    return executeBuffered<SearchRequest, SearchResponse>(std::move(request));
-//}
-//
-//
-//std::unique_ptr<MediaUploadResponse> RESTClient::uploadMedia(const std::string& path)
-//{
-//    auto request = std::make_unique<MediaUploadRequest>();
-//    request->setFile(path);
-//    return executeBuffered<MediaUploadRequest, MediaUploadResponse>(std::move(request));
-//}
-//
-//
-//std::unique_ptr<MediaUploadResponse> RESTClient::uploadMedia(const ofPixels& pixels,
-//                                                             ofImageFormat format,
-//                                                             ofImageQualityType quality)
-//{
-//    auto request = std::make_unique<MediaUploadRequest>();
-//    request->setImage(pixels, format, quality);
-//    return executeBuffered<MediaUploadRequest, MediaUploadResponse>(std::move(request));
-//}
-//
-//
-//std::unique_ptr<StatusUpdateResponse> RESTClient::updateStatus(const std::string& status)
-//{
-//    auto updateRequest = std::make_unique<StatusUpdateRequest>(status);
-//    return executeBuffered<StatusUpdateRequest, StatusUpdateResponse>(std::move(updateRequest));
-//}
-//
-//
-//std::unique_ptr<StatusUpdateResponse> RESTClient::updateStatus(const std::string& status,
-//                                                               const std::string& path)
-//{
-//    auto response = uploadMedia(path);
-//
-//    auto updateRequest = std::make_unique<StatusUpdateRequest>(status);
-//
-//    if (response->isSuccess())
-//    {
-//        ofLogVerbose("RESTClient::updateStatus") << "Media id " << response->mediaId();
-//        updateRequest->setMediaId(response->mediaId());
-//    }
-//    else
-//    {
-//        ofLogError("RESTClient::updateStatus") << "Unable to upload media: " << path;
-//        for (auto& error: response->errors())
-//        {
-//            ofLogError("RESTClient::updateStatus") << "\t" << error.code() << " : " << error.message();
-//        }
-//    }
-//
-//    return executeBuffered<StatusUpdateRequest, StatusUpdateResponse>(std::move(updateRequest));
-//}
-//
-//
-//std::unique_ptr<StatusUpdateResponse> RESTClient::updateStatus(const std::string& status,
-//                                                               const ofPixels& pixels,
-//                                                               ofImageFormat format,
-//                                                               ofImageQualityType quality)
-//{
-//    auto response = uploadMedia(pixels, format, quality);
-//
-//    auto updateRequest = std::make_unique<StatusUpdateRequest>(status);
-//
-//    if (response->isSuccess())
-//    {
-//        updateRequest->setMediaId(response->mediaId());
-//    }
-//    else
-//    {
-//        ofLogError("RESTClient::updateStatus") << "Unable to upload pixel media.";
-//        for (auto& error: response->errors())
-//        {
-//            ofLogError("RESTClient::updateStatus") << "\t" << error.code() << " : " << error.message();
-//        }
-//    }
-//
-//    return executeBuffered<StatusUpdateRequest, StatusUpdateResponse>(std::move(updateRequest));
-//}
+        // A client whose request failed is dropped with its session rather
+        // than returned to the pool in an unknown state.
+        Response response = execute(*client, request);
+        _releaseClient(std::move(client));
+        return response;
+    }),
+    _pool(std::max(std::size_t(1), maxConnections))
+{
+}
+
+
+RESTClient::RESTClient(std::shared_ptr<CredentialPool> credentialPool,
+                       std::size_t maxConnections):
+    _transport([this, credentialPool](HTTP::Request& request,
+                                      const OAuth10Signer::EncodedParameters& parameters)
+    {
+        std::string endpoint = CredentialPool::endpoint(request);
+        std::size_t index = 0;
+
+        if (!credentialPool->tryAcquire(endpoint, index))
+        {
+            Response response;
+            response.status = 429;
+            response.error = "All credentials are rate limited until " + std::to_string(credentialPool->nextReset(endpoint)) + ".";
+            return response;
+        }
+
+        auto client = _acquireClient();
+        credentialPool->signer(index)->sign(request, parameters);
+
+        Response response;
+
+        try
+        {
+            response = execute(*client, request);
+        }
+        catch (...)
+        {
+            credentialPool->release(index, endpoint);
+            throw;
+        }
+
+        credentialPool->release(index, endpoint, response.rateLimit);
+        _releaseClient(std::move(client));
+        return response;
+    }),
+    _pool(std::max(std::size_t(1), maxConnections))
+{
+}
+
+
+RESTClient::RESTClient(Transport transport, std::size_t maxConnections):
+    _transport(transport),
+    _pool(std::max(std::size_t(1), maxConnections))
+{
+}
+
+
+RESTClient::~RESTClient()
+{
+}
+
+
+std::future<RESTClient::Result<SearchResponse>> RESTClient::search(const std::string& query)
+{
+    return search(SearchQuery(query));
+}
+
+
+std::future<RESTClient::Result<SearchResponse>> RESTClient::search(const SearchQuery& query)
+{
+    auto request = std::make_unique<HTTP::GetRequest>(SearchQuery::RESOURCE_URL);
+    request->addFormFields(query);
+    return submit<SearchResponse>(std::move(request), query);
+}
+
+
+std::future<RESTClient::Result<StatusUpdateResponse>> RESTClient::updateStatus(const std::string& status)
+{
+    return updateStatus(std::make_unique<StatusUpdateRequest>(status));
+}
+
+
+std::future<RESTClient::Result<StatusUpdateResponse>> RESTClient::updateStatus(std::unique_ptr<StatusUpdateRequest> request)
+{
+    OAuth10Signer::EncodedParameters parameters = request->formParameters();
+    return submit<StatusUpdateResponse>(std::move(request), parameters);
+}
+
+
+std::future<RESTClient::Result<MediaUploadResponse>> RESTClient::uploadMedia(const std::string& path)
+{
+    auto request = std::make_unique<MediaUploadRequest>();
+    request->setFile(path);
+    return submit<MediaUploadResponse>(std::move(request));
+}
+
+
+std::future<RESTClient::Result<MediaUploadResponse>> RESTClient::uploadMedia(const ofPixels& pixels,
+                                                                             ofImageFormat format,
+                                                                             ofImageQualityType quality)
+{
+    auto request = std::make_unique<MediaUploadRequest>();
+    request->setImage(_encoder, pixels, format, quality);
+    return submit<MediaUploadResponse>(std::move(request));
+}
+
+
+std::future<RESTClient::Result<UserLookupResponse>> RESTClient::lookupUsers(const std::vector<int64_t>& userIds)
+{
+    auto request = std::make_unique<UserLookupRequest>(userIds);
+    OAuth10Signer::EncodedParameters parameters = request->formParameters();
+    return submit<UserLookupResponse>(std::move(request), parameters);
+}
+
+
+std::future<RESTClient::Result<StatusLookupResponse>> RESTClient::lookupStatuses(const std::vector<int64_t>& statusIds)
+{
+    auto request = std::make_unique<StatusLookupRequest>(statusIds);
+    OAuth10Signer::EncodedParameters parameters = request->formParameters();
+    return submit<StatusLookupResponse>(std::move(request), parameters);
+}
+
+
+RateLimit RESTClient::rateLimit() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _rateLimit;
+}
+
+
+std::size_t RESTClient::maxConnections() const
+{
+    return _pool.size();
+}
+
+
+RESTClient::Response RESTClient::execute(HTTP::HTTPClient& client,
+                                         HTTP::Request& request)
+{
+    auto response = client.execute(request);
+
+    if (response == nullptr)
+    {
+        throw Poco::IOException("No response.");
+    }
+
+    Response result;
+    result.status = response->getStatus();
+    result.reason = response->getReason();
+    result.rateLimit = RateLimit::fromHeaders(*response);
+
+    ofBuffer buffer = response->buffer();
+    result.json = ofJson::parse(buffer.begin(), buffer.end(), nullptr, false);
+
+    if (result.json.is_discarded())
+    {
+        result.json = ofJson();
+    }
+
+    return result;
+}
+
+
+void RESTClient::_execute(HTTP::Request& request,
+                          const OAuth10Signer::EncodedParameters& parameters,
+                          Response& response)
+{
+    try
+    {
+        static_cast<Response&>(response) = _transport(request, parameters);
+    }
+    catch (const Poco::Exception& exc)
+    {
+        response.error = exc.displayText();
+    }
+    catch (const std::exception& exc)
+    {
+        response.error = exc.what();
+    }
+
+    if (!response.error.empty())
+    {
+        ofLogError("RESTClient::_execute") << response.error;
+        return;
+    }
+
+    if (response.json.is_null() && !response.isSuccess())
+    {
+        response.error = std::to_string(response.status) + " " + response.reason;
+    }
+
+    if (response.rateLimit.limit() > 0)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _rateLimit = response.rateLimit;
+    }
+}
+
+
+std::unique_ptr<HTTP::HTTPClient> RESTClient::_acquireClient()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (!_clients.empty())
+        {
+            auto client = std::move(_clients.back());
+            _clients.pop_back();
+            return client;
+        }
+    }
+
+    // At most one client is created per pool thread.
+    return std::make_unique<HTTP::HTTPClient>();
+}
+
+
+void RESTClient::_releaseClient(std::unique_ptr<HTTP::HTTPClient> client)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _clients.push_back(std::move(client));
+}
 
 
 } } // namespace ofx::Twitter
@@ -143,7 +143,7 @@ std::size_t SearchMetadata::count() const
 }
 
 
-std::string SearchMetadata::query() const
+const std::string& SearchMetadata::query() const
 {
     return _query;
 }
@@ -211,19 +211,19 @@ SearchResponse::~SearchResponse()
 }
 
 
-std::vector<Status> SearchResponse::statuses() const
+const std::vector<Status>& SearchResponse::statuses() const
 {
     return _statuses;
 }
 
 
-SearchMetadata SearchResponse::metadata() const
+const SearchMetadata& SearchResponse::metadata() const
 {
     return _metadata;
 }
 
 
-std::vector<Error> SearchResponse::errors() const
+const std::vector<Error>& SearchResponse::errors() const
 {
     return _errors;
 }
@@ -266,4 +266,50 @@ SearchResponse SearchResponse::fromJSON(const ofJson& json)
 }
 
 
+SearchResponse SearchResponse::fromJSON(const ofJson& json,
+                                        StatusBatch& batch,
+                                        int64_t sinceId)
+{
+    SearchResponse response;
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        if (key == "search_metadata")
+        {
+            response._metadata = SearchMetadata::fromJSON(value);
+        }
+        else if (key == "statuses")
+        {
+            batch.reserve(batch.size() + value.size());
+
+            for (const auto& status: value)
+            {
+                Status decoded = Status::fromJSON(status);
+
+                if (decoded.id() > sinceId)
+                {
+                    batch.append(std::move(decoded));
+                }
+            }
+        }
+        else if (key == "errors")
+        {
+            for (const auto& error: value)
+            {
+                response._errors.push_back(Error::fromJSON(error));
+            }
+        }
+        else ofLogWarning("SearchResponse::parseJSON") << "Unknown key: " << key;
+
+        ++iter;
+    }
+
+    return response;
+}
+
+
 } } // namespace ofx::Twitter
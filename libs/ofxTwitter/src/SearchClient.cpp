@@ -94,6 +94,27 @@ void BaseSearchClient::search(const SearchQuery& query)
 }
 
 
+void BaseSearchClient::setCredentialPool(std::shared_ptr<CredentialPool> credentialPool)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    _credentialPool = credentialPool;
+}
+
+
+std::shared_ptr<CredentialPool> BaseSearchClient::credentialPool() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return _credentialPool;
+}
+
+
+void BaseSearchClient::setBatchSink(BatchSink sink)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    _batchSink = sink;
+}
+
+
 RateLimit BaseSearchClient::rateLimit() const
 {
     std::unique_lock<std::mutex> lock(mutex);
@@ -101,6 +122,12 @@ RateLimit BaseSearchClient::rateLimit() const
 }
 
 
+const ClientMetrics& BaseSearchClient::metrics() const
+{
+    return _metrics;
+}
+
+
 void BaseSearchClient::_run()
 {
     HTTP::ClientSessionSettings sessionSettings;
@@ -109,10 +136,36 @@ void BaseSearchClient::_run()
     _client.context().setClientSessionSettings(sessionSettings);
     _client.setCredentials(_credentials);
 
+    std::shared_ptr<CredentialPool> credentialPool = this->credentialPool();
+    std::size_t credentialIndex = 0;
+    bool credentialAcquired = false;
+
+    if (credentialPool)
+    {
+        if (!credentialPool->tryAcquire(SearchQuery::RESOURCE_URL, credentialIndex))
+        {
+            // Reported as the rate limit error a search would receive.
+            Error error(88, "Rate limit exceeded. All credentials are rate limited until " + std::to_string(credentialPool->nextReset(SearchQuery::RESOURCE_URL)) + ".");
+            ofLogWarning("BaseSearchClient::_run") << error.message();
+            _metrics.increment(ClientMetrics::Event::API_ERROR);
+            _onError(error);
+            return;
+        }
+
+        credentialAcquired = true;
+        _client.setCredentials(credentialPool->credentials(credentialIndex));
+    }
+
     int64_t sinceId = _searchQuery->getSinceId();
 
+    mutex.lock();
+    BatchSink batchSink = _batchSink;
+    mutex.unlock();
+
     try
     {
+        uint64_t readStart = ClientMetrics::now();
+
         HTTP::GetRequest request(SearchQuery::RESOURCE_URL);
 
         request.addFormFields(*_searchQuery);
@@ -123,13 +176,30 @@ void BaseSearchClient::_run()
         _rateLimit = RateLimit::fromHeaders(*httpResponse);
         mutex.unlock();
 
-        ofJson responseJson = httpResponse->json();
+        if (credentialAcquired)
+        {
+            credentialPool->release(credentialIndex, SearchQuery::RESOURCE_URL, _rateLimit);
+            credentialAcquired = false;
+        }
+
+        ofBuffer buffer = httpResponse->buffer();
+
+        uint64_t parseStart = _metrics.record(ClientMetrics::Stage::READ, readStart);
+        _metrics.addBytesReceived(buffer.size());
+
+        ofJson responseJson = ofJson::parse(buffer.begin(), buffer.end());
 
-        SearchResponse response = SearchResponse::fromJSON(responseJson);
+        int64_t requestedSinceId = _searchQuery->getSinceId();
+        StatusBatch batch;
+
+        SearchResponse response = batchSink
+                                ? SearchResponse::fromJSON(responseJson, batch, requestedSinceId)
+                                : SearchResponse::fromJSON(responseJson);
+
+        uint64_t deliverStart = _metrics.record(ClientMetrics::Stage::PARSE, parseStart);
 
         if (response.errors().empty())
         {
-            int64_t requestedSinceId = _searchQuery->getSinceId();
             int64_t sinceId = requestedSinceId;
 
             for (auto& status: response.statuses())
@@ -143,10 +213,20 @@ void BaseSearchClient::_run()
                 // max-count and all are returned.
                 if (status.id() > requestedSinceId)
                 {
+                    _metrics.increment(ClientMetrics::Event::STATUS);
                     _onStatus(status);
                 }
             }
 
+            if (!batch.empty())
+            {
+                sinceId = std::max(sinceId, *std::max_element(batch.ids().begin(), batch.ids().end()));
+
+                _metrics.increment(ClientMetrics::Event::STATUS, batch.size());
+
+                batchSink(std::move(batch));
+            }
+
             // Here we increment the sinceId
             _searchQuery->setSinceId(sinceId);
         }
@@ -154,29 +234,42 @@ void BaseSearchClient::_run()
         {
             for (auto& error: response.errors())
             {
+                _metrics.increment(ClientMetrics::Event::API_ERROR);
                 _onError(error);
             }
         }
 
+        _metrics.increment(ClientMetrics::Event::MESSAGE);
         _onMessage(responseJson);
+
+        _metrics.record(ClientMetrics::Stage::DELIVER, deliverStart);
     }
     catch (const Poco::Exception& exc)
     {
         ofLogError("BaseSearchClient::_run: Poco::Exception: ") << exc.displayText();
+        _metrics.increment(ClientMetrics::Event::EXCEPTION);
         _onException(exc);
     }
     catch (const std::exception& exc)
     {
         Poco::Exception ex(exc.what());
         ofLogError("BaseSearchClient::_run: std::exception: ") << ex.displayText();
+        _metrics.increment(ClientMetrics::Event::EXCEPTION);
         _onException(exc);
     }
     catch (...)
     {
         Poco::Exception exc("Unknown exception.");
         ofLogError("BaseSearchClient::_run") << exc.displayText();
+        _metrics.increment(ClientMetrics::Event::EXCEPTION);
         _onException(exc);
     }
+
+    // Release without a rate limit if the request failed.
+    if (credentialAcquired)
+    {
+        credentialPool->release(credentialIndex, SearchQuery::RESOURCE_URL);
+    }
 }
 
 
@@ -218,10 +311,10 @@ void SearchClient::setAutoEventSync(bool value)
 
 void SearchClient::syncEvents()
 {
-    for (const auto& v: _statusChannel.tryReceiveAll()) onStatus.notify(this, v);
-    for (const auto& v: _errorChannel.tryReceiveAll()) onError.notify(this, v);
-    for (const auto& v: _exceptionChannel.tryReceiveAll()) onException.notify(this, v);
-    for (const auto& v: _messageChannel.tryReceiveAll()) onMessage.notify(this, v);
+    for (const auto& v: _receiveAll(_statusChannel, ClientMetrics::Event::STATUS)) onStatus.notify(this, v);
+    for (const auto& v: _receiveAll(_errorChannel, ClientMetrics::Event::API_ERROR)) onError.notify(this, v);
+    for (const auto& v: _receiveAll(_exceptionChannel, ClientMetrics::Event::EXCEPTION)) onException.notify(this, v);
+    for (const auto& v: _receiveAll(_messageChannel, ClientMetrics::Event::MESSAGE)) onMessage.notify(this, v);
 }
 
 
@@ -239,24 +332,28 @@ void SearchClient::_exit(ofEventArgs& args)
 
 void SearchClient::_onStatus(const Status& status)
 {
+    _metrics.addQueued(ClientMetrics::Event::STATUS);
     _statusChannel.send(status);
 }
 
 
 void SearchClient::_onError(const Error& error)
 {
+    _metrics.addQueued(ClientMetrics::Event::API_ERROR);
     _errorChannel.send(error);
 }
 
 
 void SearchClient::_onException(const std::exception& exc)
 {
+    _metrics.addQueued(ClientMetrics::Event::EXCEPTION);
     _exceptionChannel.send(std::exception(exc));
 }
 
 
 void SearchClient::_onMessage(const ofJson& message)
 {
+    _metrics.addQueued(ClientMetrics::Event::MESSAGE);
     _messageChannel.send(message);
 }
 
@@ -0,0 +1,643 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/ShardedStreamingClient.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t ShardedStreamingClient::MAX_TRACKS = 400;
+const std::size_t ShardedStreamingClient::MAX_FOLLOWS = 5000;
+const std::size_t ShardedStreamingClient::MAX_LOCATIONS = 25;
+const uint64_t ShardedStreamingClient::DEFAULT_ORDERING_DELAY = 1000;
+const uint64_t ShardedStreamingClient::DEFAULT_REBALANCE_INTERVAL = 5 * 60 * 1000;
+const double ShardedStreamingClient::MIN_REBALANCE_IMPROVEMENT = 0.1;
+const std::size_t ShardedStreamingClient::DEDUPLICATION_WINDOW = 1 << 16;
+
+
+ShardedStreamingClient::Shard::Shard(ShardedStreamingClient& client,
+                                     const HTTP::OAuth10Credentials& credentials):
+    _client(client),
+    manager(credentials, this)
+{
+}
+
+
+ShardedStreamingClient::Shard::~Shard()
+{
+}
+
+
+void ShardedStreamingClient::Shard::onConnect()
+{
+    {
+        // The LimitNotice count of the new connection starts at 0.
+        std::unique_lock<std::mutex> lock(_client._mutex);
+        lastLimit = 0;
+    }
+
+    _client._post([](StreamingSink& sink) { sink.onConnect(); });
+}
+
+
+void ShardedStreamingClient::Shard::onDisconnect()
+{
+    _client._post([](StreamingSink& sink) { sink.onDisconnect(); });
+}
+
+
+void ShardedStreamingClient::Shard::onStatus(const Status& status)
+{
+    _client._onStatus(*this, status);
+}
+
+
+void ShardedStreamingClient::Shard::onStatusDeletedNotice(const StatusDeletedNotice& notice)
+{
+    _client._post([notice](StreamingSink& sink) { sink.onStatusDeletedNotice(notice); });
+}
+
+
+void ShardedStreamingClient::Shard::onLocationDeletedNotice(const LocationDeletedNotice& notice)
+{
+    _client._post([notice](StreamingSink& sink) { sink.onLocationDeletedNotice(notice); });
+}
+
+
+void ShardedStreamingClient::Shard::onLimitNotice(const LimitNotice& notice)
+{
+    _client._onLimitNotice(*this, notice);
+    _client._post([notice](StreamingSink& sink) { sink.onLimitNotice(notice); });
+}
+
+
+void ShardedStreamingClient::Shard::onStatusWithheldNotice(const StatusWithheldNotice& notice)
+{
+    _client._post([notice](StreamingSink& sink) { sink.onStatusWithheldNotice(notice); });
+}
+
+
+void ShardedStreamingClient::Shard::onUserWitheldNotice(const UserWithheldNotice& notice)
+{
+    _client._post([notice](StreamingSink& sink) { sink.onUserWitheldNotice(notice); });
+}
+
+
+void ShardedStreamingClient::Shard::onDisconnectNotice(const DisconnectNotice& notice)
+{
+    _client._post([notice](StreamingSink& sink) { sink.onDisconnectNotice(notice); });
+}
+
+
+void ShardedStreamingClient::Shard::onStallWarning(const StallWarning& notice)
+{
+    _client._post([notice](StreamingSink& sink) { sink.onStallWarning(notice); });
+}
+
+
+void ShardedStreamingClient::Shard::onException(const std::exception& exc)
+{
+    // The exception may not outlive the call, so its message is delivered.
+    std::runtime_error error(exc.what());
+    _client._post([error](StreamingSink& sink) { sink.onException(error); });
+}
+
+
+void ShardedStreamingClient::Shard::onMessage(const ofJson& message)
+{
+    _client._post([message](StreamingSink& sink) { sink.onMessage(message); });
+}
+
+
+bool ShardedStreamingClient::Shard::wantsMessages() const
+{
+    return _client._sink && _client._sink->wantsMessages();
+}
+
+
+ShardedStreamingClient::ShardedStreamingClient(const std::vector<HTTP::OAuth10Credentials>& credentials,
+                                               StreamingSink* sink,
+                                               uint64_t orderingDelay):
+    _sink(sink),
+    _orderingDelay(orderingDelay),
+    _rebalancedAt(_now())
+{
+    if (credentials.empty())
+    {
+        ofLogError("ShardedStreamingClient::ShardedStreamingClient") << "No credentials, no shards will be created.";
+    }
+
+    for (std::size_t i = 0; i < credentials.size(); ++i)
+    {
+        _shards.push_back(std::make_unique<Shard>(*this, credentials[i]));
+    }
+
+    _thread = std::thread(&ShardedStreamingClient::_run, this);
+}
+
+
+ShardedStreamingClient::~ShardedStreamingClient()
+{
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        _stopping = true;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    // The shards post to the queues while they stop, so they are destroyed
+    // before the queues.
+    _shards.clear();
+
+    // The delivery thread has stopped, so the events posted by the stopping
+    // shards are delivered here.
+    if (_sink)
+    {
+        for (const auto& event: _events) event(*_sink);
+    }
+}
+
+
+void ShardedStreamingClient::setRules(const std::vector<std::string>& tracks,
+                                      const std::vector<std::string>& follows,
+                                      const std::vector<Geo::CoordinateBounds>& locations)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::size_t shardCount = _shards.size();
+
+    std::vector<std::string> uniqueTracks(tracks);
+    std::sort(uniqueTracks.begin(), uniqueTracks.end());
+    uniqueTracks.erase(std::unique(uniqueTracks.begin(), uniqueTracks.end()), uniqueTracks.end());
+
+    _matcher.setTracks(uniqueTracks);
+
+    std::map<std::string, double> weights;
+
+    for (const auto& track: uniqueTracks)
+    {
+        auto iter = _volumes.find(track);
+        weights[track] = iter != _volumes.end() ? std::max(1.0, double(iter->second)) : 1.0;
+    }
+
+    _assignTracks(uniqueTracks, weights);
+
+    // Follows and locations carry no volume information, so they are
+    // spread evenly.
+    for (auto& shard: _shards)
+    {
+        shard->follows.clear();
+        shard->locations.clear();
+    }
+
+    if (follows.size() > shardCount * MAX_FOLLOWS)
+    {
+        ofLogError("ShardedStreamingClient::setRules") << "Dropping " << follows.size() - shardCount * MAX_FOLLOWS << " follows over capacity.";
+    }
+
+    for (std::size_t i = 0; i < follows.size() && i < shardCount * MAX_FOLLOWS; ++i)
+    {
+        _shards[i % shardCount]->follows.insert(follows[i]);
+    }
+
+    if (locations.size() > shardCount * MAX_LOCATIONS)
+    {
+        ofLogError("ShardedStreamingClient::setRules") << "Dropping " << locations.size() - shardCount * MAX_LOCATIONS << " locations over capacity.";
+    }
+
+    for (std::size_t i = 0; i < locations.size() && i < shardCount * MAX_LOCATIONS; ++i)
+    {
+        _shards[i % shardCount]->locations.push_back(locations[i]);
+    }
+
+    _apply();
+}
+
+
+void ShardedStreamingClient::addTrack(const std::string& track)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    Shard* target = nullptr;
+
+    for (auto& shard: _shards)
+    {
+        if (shard->tracks.count(track) > 0)
+        {
+            return;
+        }
+
+        if (shard->tracks.size() < MAX_TRACKS && (target == nullptr || shard->load < target->load))
+        {
+            target = shard.get();
+        }
+    }
+
+    if (target == nullptr)
+    {
+        ofLogError("ShardedStreamingClient::addTrack") << "All shards are full, dropping " << track;
+        return;
+    }
+
+    target->tracks.insert(track);
+    target->load += 1;
+
+    std::vector<std::string> tracks = _matcher.tracks();
+    tracks.push_back(track);
+    _matcher.setTracks(tracks);
+
+    _apply();
+}
+
+
+void ShardedStreamingClient::removeTrack(const std::string& track)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (auto& shard: _shards)
+    {
+        if (shard->tracks.erase(track) > 0)
+        {
+            std::vector<std::string> tracks = _matcher.tracks();
+            tracks.erase(std::remove(tracks.begin(), tracks.end(), track), tracks.end());
+            _matcher.setTracks(tracks);
+
+            _apply();
+            return;
+        }
+    }
+}
+
+
+void ShardedStreamingClient::rebalance()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _rebalance();
+}
+
+
+void ShardedStreamingClient::setRebalanceInterval(uint64_t interval)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _rebalanceInterval = interval;
+    }
+
+    _condition.notify_all();
+}
+
+
+void ShardedStreamingClient::setTransport(BaseStreamingClient::Transport transport)
+{
+    for (auto& shard: _shards)
+    {
+        shard->manager.setTransport(transport);
+    }
+}
+
+
+std::size_t ShardedStreamingClient::shardCount() const
+{
+    return _shards.size();
+}
+
+
+FilterQuery ShardedStreamingClient::shardQuery(std::size_t shard) const
+{
+    return _shards.at(shard)->manager.query();
+}
+
+
+std::map<std::string, uint64_t> ShardedStreamingClient::trackVolumes() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _volumes;
+}
+
+
+void ShardedStreamingClient::_assignTracks(const std::vector<std::string>& tracks,
+                                           const std::map<std::string, double>& weights)
+{
+    std::vector<std::set<std::string>> assignment(_shards.size());
+    std::vector<double> loads(_shards.size(), 0);
+
+    std::size_t dropped = _place(tracks, weights, assignment, loads);
+
+    for (std::size_t i = 0; i < _shards.size(); ++i)
+    {
+        _shards[i]->tracks = std::move(assignment[i]);
+        _shards[i]->load = loads[i];
+    }
+
+    if (dropped > 0)
+    {
+        ofLogError("ShardedStreamingClient::_assignTracks") << "Dropping " << dropped << " tracks over capacity.";
+    }
+}
+
+
+std::size_t ShardedStreamingClient::_place(const std::vector<std::string>& tracks,
+                                           const std::map<std::string, double>& weights,
+                                           std::vector<std::set<std::string>>& assignment,
+                                           std::vector<double>& loads)
+{
+    std::vector<std::pair<double, std::string>> ordered;
+    ordered.reserve(tracks.size());
+
+    for (const auto& track: tracks)
+    {
+        auto iter = weights.find(track);
+        ordered.emplace_back(iter != weights.end() ? iter->second : 1.0, track);
+    }
+
+    // Longest processing time first: the heaviest phrases are placed first,
+    // each on the least loaded shard that has room.
+    std::sort(ordered.begin(), ordered.end(), [](const std::pair<double, std::string>& a,
+                                                 const std::pair<double, std::string>& b)
+    {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    std::size_t dropped = 0;
+
+    for (const auto& item: ordered)
+    {
+        std::size_t target = assignment.size();
+
+        for (std::size_t i = 0; i < assignment.size(); ++i)
+        {
+            if (assignment[i].size() < MAX_TRACKS && (target == assignment.size() || loads[i] < loads[target]))
+            {
+                target = i;
+            }
+        }
+
+        if (target == assignment.size())
+        {
+            dropped++;
+            continue;
+        }
+
+        assignment[target].insert(item.second);
+        loads[target] += item.first;
+    }
+
+    return dropped;
+}
+
+
+void ShardedStreamingClient::_apply()
+{
+    for (auto& shard: _shards)
+    {
+        _apply(*shard);
+    }
+}
+
+
+void ShardedStreamingClient::_apply(Shard& shard)
+{
+    shard.manager.setRules(std::vector<std::string>(shard.tracks.begin(), shard.tracks.end()),
+                           std::vector<std::string>(shard.follows.begin(), shard.follows.end()),
+                           shard.locations);
+}
+
+
+void ShardedStreamingClient::_rebalance()
+{
+    std::map<std::string, double> weights;
+    std::vector<std::string> moving;
+    std::vector<std::set<std::string>> assignment(_shards.size());
+    std::vector<double> loads(_shards.size(), 0);
+    std::vector<double> currentLoads(_shards.size(), 0);
+    double heaviest = 0;
+
+    for (std::size_t i = 0; i < _shards.size(); ++i)
+    {
+        const Shard& shard = *_shards[i];
+
+        // Statuses the shard could not deliver were matched by its phrases
+        // in the same proportions as the delivered ones.
+        double scale = double(shard.delivered + shard.undelivered) / double(std::max(uint64_t(1), shard.delivered));
+
+        for (const auto& track: shard.tracks)
+        {
+            auto iter = _volumes.find(track);
+            double volume = iter != _volumes.end() ? double(iter->second) : 0.0;
+            weights[track] = std::max(1.0, volume) * scale;
+            currentLoads[i] += weights[track];
+        }
+
+        heaviest = std::max(heaviest, currentLoads[i]);
+
+        // Only the phrases of limited shards are moved. The other shards
+        // keep theirs and may take on more.
+        if (shard.undelivered > 0)
+        {
+            moving.insert(moving.end(), shard.tracks.begin(), shard.tracks.end());
+        }
+        else
+        {
+            assignment[i] = shard.tracks;
+            loads[i] = currentLoads[i];
+        }
+    }
+
+    _place(moving, weights, assignment, loads);
+
+    double placed = 0;
+    for (double load: loads) placed = std::max(placed, load);
+
+    bool apply = !moving.empty() && placed <= heaviest * (1 - MIN_REBALANCE_IMPROVEMENT);
+
+    for (std::size_t i = 0; i < _shards.size(); ++i)
+    {
+        Shard& shard = *_shards[i];
+
+        if (apply && shard.tracks != assignment[i])
+        {
+            shard.tracks = std::move(assignment[i]);
+            shard.load = loads[i];
+            _apply(shard);
+        }
+        else
+        {
+            shard.load = currentLoads[i];
+        }
+    }
+
+    _volumes.clear();
+
+    for (auto& shard: _shards)
+    {
+        shard->delivered = 0;
+        shard->undelivered = 0;
+    }
+
+    _rebalancedAt = _now();
+}
+
+
+void ShardedStreamingClient::_onStatus(Shard& shard, const Status& status)
+{
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+
+        if (!_seen.insert(status.id()).second)
+        {
+            return;
+        }
+
+        _seenOrder.push_back(status.id());
+
+        if (_seenOrder.size() > DEDUPLICATION_WINDOW)
+        {
+            _seen.erase(_seenOrder.front());
+            _seenOrder.pop_front();
+        }
+
+        PendingStatus pending;
+        pending.id = status.id();
+        pending.releaseAt = _now() + _orderingDelay;
+        pending.status = std::make_shared<const Status>(status);
+        _statuses.push(std::move(pending));
+    }
+
+    _condition.notify_all();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    shard.delivered++;
+
+    for (auto rule: _matcher.match(status))
+    {
+        _volumes[_matcher.tracks()[rule]]++;
+    }
+}
+
+
+void ShardedStreamingClient::_onLimitNotice(Shard& shard, const LimitNotice& notice)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // The count is cumulative for a connection and starts again when the
+    // shard reconnects or switches rules.
+    shard.undelivered += notice.track() >= shard.lastLimit ? notice.track() - shard.lastLimit : notice.track();
+    shard.lastLimit = notice.track();
+}
+
+
+void ShardedStreamingClient::_post(std::function<void(StreamingSink&)> event)
+{
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        _events.push_back(std::move(event));
+    }
+
+    _condition.notify_all();
+}
+
+
+void ShardedStreamingClient::_run()
+{
+    std::unique_lock<std::mutex> lock(_queueMutex);
+
+    while (!_stopping)
+    {
+        uint64_t now = _now();
+
+        std::deque<std::function<void(StreamingSink&)>> events;
+        std::swap(events, _events);
+
+        std::vector<std::shared_ptr<const Status>> statuses;
+
+        while (!_statuses.empty() && _statuses.top().releaseAt <= now)
+        {
+            statuses.push_back(_statuses.top().status);
+            _statuses.pop();
+        }
+
+        uint64_t wakeAt = _statuses.empty() ? 0 : _statuses.top().releaseAt;
+
+        lock.unlock();
+
+        if (_sink)
+        {
+            for (const auto& event: events) event(*_sink);
+            for (const auto& status: statuses) _sink->onStatus(*status);
+        }
+
+        {
+            std::unique_lock<std::mutex> rulesLock(_mutex);
+
+            if (_rebalanceInterval > 0)
+            {
+                if (now >= _rebalancedAt + _rebalanceInterval)
+                {
+                    bool limited = false;
+                    for (const auto& shard: _shards) limited |= shard->undelivered > 0;
+
+                    if (limited)
+                    {
+                        _rebalance();
+                    }
+                    else
+                    {
+                        _rebalancedAt = now;
+                    }
+                }
+
+                uint64_t rebalanceAt = _rebalancedAt + _rebalanceInterval;
+                wakeAt = wakeAt == 0 ? rebalanceAt : std::min(wakeAt, rebalanceAt);
+            }
+        }
+
+        lock.lock();
+
+        if (_stopping || !_events.empty())
+        {
+            continue;
+        }
+
+        if (!_statuses.empty())
+        {
+            wakeAt = wakeAt == 0 ? _statuses.top().releaseAt : std::min(wakeAt, _statuses.top().releaseAt);
+        }
+
+        now = _now();
+
+        if (wakeAt == 0)
+        {
+            _condition.wait(lock);
+        }
+        else if (wakeAt > now)
+        {
+            _condition.wait_for(lock, std::chrono::milliseconds(wakeAt - now));
+        }
+    }
+}
+
+
+uint64_t ShardedStreamingClient::_now()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+} } // namespace ofx::Twitter
@@ -9,6 +9,7 @@
 #include "ofx/Twitter/BaseUser.h"
 #include "ofx/Twitter/Entities.h"
 #include "ofx/Twitter/User.h"
+#include "ofx/Twitter/Trace.h"
 #include "ofx/Twitter/Utils.h"
 #include "ofLog.h"
 
@@ -23,13 +24,13 @@ namespace ofx {
 namespace Twitter {
 
 
-std::string Status::Metadata::isoLanguageCode() const
+const std::string& Status::Metadata::isoLanguageCode() const
 {
     return _isoLanguageCode;
 }
 
 
-std::string Status::Metadata::resultType() const
+const std::string& Status::Metadata::resultType() const
 {
     return _resultType;
 }
@@ -87,19 +88,19 @@ const User* Status::user() const
 }
 
 
-std::string Status::language() const
+const std::string& Status::language() const
 {
     return _language;
 }
 
 
-Status::Annotations Status::annotations() const
+const Status::Annotations& Status::annotations() const
 {
     return _annotations;
 }
 
 
-std::vector<BaseNamedUser> Status::contributors() const
+const std::vector<BaseNamedUser>& Status::contributors() const
 {
     return _contributors;
 }
@@ -129,13 +130,13 @@ int64_t Status::currentUserRetweet() const
 }
 
 
-Entities Status::entities() const
+const Entities& Status::entities() const
 {
     return _entities;
 }
 
 
-Entities Status::extendedEntities() const
+const Entities& Status::extendedEntities() const
 {
     return _extendedEntities;
 }
@@ -201,7 +202,7 @@ Status::FilterLevel Status::filterLevel() const
 }
 
 
-std::string Status::inReplyToScreenName() const
+const std::string& Status::inReplyToScreenName() const
 {
     return _inReplyToScreenName;
 }
@@ -225,7 +226,7 @@ bool Status::possiblySensitive() const
 }
 
 
-std::map<std::string, bool> Status::scopes() const
+const std::map<std::string, bool>& Status::scopes() const
 {
     return _scopes;
 }
@@ -249,19 +250,19 @@ const Status* Status::retweetedStatus() const
 }
 
 
-std::string Status::source() const
+const std::string& Status::source() const
 {
     return _source;
 }
 
 
-std::string Status::text() const
+const std::string& Status::text() const
 {
     return _text;
 }
 
 
-std::string Status::fullText() const
+const std::string& Status::fullText() const
 {
     return _fullText;
 }
@@ -303,13 +304,13 @@ bool Status::withheldCopyright() const
 }
 
 
-std::vector<std::string> Status::withheldInCountries() const
+const std::vector<std::string>& Status::withheldInCountries() const
 {
     return _withheldInCountries;
 }
 
 
-std::string Status::withheldScope() const
+const std::string& Status::withheldScope() const
 {
     return _withheldScope;
 }
@@ -321,7 +322,7 @@ const Place* Status::place() const
 }
 
 
-Status::Metadata Status::metadata() const
+const Status::Metadata& Status::metadata() const
 {
     return _metadata;
 }
@@ -333,14 +334,28 @@ uint64_t Status::timestamp() const
 }
 
 
-ofJson Status::json() const
+const ofJson& Status::json() const
 {
     return _json;
 }
 
 
+const std::vector<std::size_t>& Status::matchedTrackRules() const
+{
+    return _matchedTrackRules;
+}
+
+
+const std::vector<std::size_t>& Status::matchedLocations() const
+{
+    return _matchedLocations;
+}
+
+
 Status Status::fromJSON(const ofJson& json)
 {
+    OFX_TWITTER_TRACE_SCOPE("Status::fromJSON");
+
     Status status;
     status._json = json;
 
@@ -0,0 +1,376 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/StatusBatch.h"
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include "ofx/Twitter/Utils.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+
+template <typename T>
+void appendAll(std::vector<T>& target, std::vector<T>& source)
+{
+    target.insert(target.end(),
+                  std::make_move_iterator(source.begin()),
+                  std::make_move_iterator(source.end()));
+}
+
+
+template <typename T>
+void select(std::vector<T>& values, const std::vector<std::size_t>& rows)
+{
+    std::vector<T> selected;
+    selected.reserve(rows.size());
+    for (std::size_t row: rows) selected.push_back(std::move(values[row]));
+    values.swap(selected);
+}
+
+
+} // namespace
+
+
+std::size_t StatusBatch::append(const Status& status)
+{
+    _appendHot(status);
+
+    const Status* extended = status.extendedTweet();
+
+    Cold cold;
+    cold.text = extended ? extended->fullText() : (status.fullText().empty() ? status.text() : status.fullText());
+    cold.user = status._user;
+    cold.entities = extended ? extended->entities() : status.entities();
+    cold.place = status._place;
+    cold.json = status.json();
+    _cold.push_back(std::move(cold));
+
+    return size() - 1;
+}
+
+
+std::size_t StatusBatch::append(Status&& status)
+{
+    _appendHot(status);
+
+    // The extended tweet may be shared with other copies of the status, so
+    // its data is copied rather than moved.
+    const Status* extended = status.extendedTweet();
+
+    Cold cold;
+
+    if (extended)
+    {
+        cold.text = extended->fullText();
+        cold.entities = extended->entities();
+    }
+    else
+    {
+        cold.text = std::move(status._fullText.empty() ? status._text : status._fullText);
+        cold.entities = std::move(status._entities);
+    }
+
+    cold.user = std::move(status._user);
+    cold.place = std::move(status._place);
+    cold.json = std::move(status._json);
+    _cold.push_back(std::move(cold));
+
+    return size() - 1;
+}
+
+
+void StatusBatch::append(StatusBatch&& batch)
+{
+    appendAll(_ids, batch._ids);
+    appendAll(_createdAt, batch._createdAt);
+    appendAll(_timestamps, batch._timestamps);
+    appendAll(_favoriteCounts, batch._favoriteCounts);
+    appendAll(_retweetCounts, batch._retweetCounts);
+    appendAll(_quoteCounts, batch._quoteCounts);
+    appendAll(_replyCounts, batch._replyCounts);
+    appendAll(_userIds, batch._userIds);
+    appendAll(_flags, batch._flags);
+    appendAll(_cold, batch._cold);
+    batch.clear();
+}
+
+
+void StatusBatch::reserve(std::size_t rows)
+{
+    _ids.reserve(rows);
+    _createdAt.reserve(rows);
+    _timestamps.reserve(rows);
+    _favoriteCounts.reserve(rows);
+    _retweetCounts.reserve(rows);
+    _quoteCounts.reserve(rows);
+    _replyCounts.reserve(rows);
+    _userIds.reserve(rows);
+    _flags.reserve(rows);
+    _cold.reserve(rows);
+}
+
+
+std::size_t StatusBatch::size() const
+{
+    return _ids.size();
+}
+
+
+bool StatusBatch::empty() const
+{
+    return _ids.empty();
+}
+
+
+void StatusBatch::clear()
+{
+    *this = StatusBatch();
+}
+
+
+const std::vector<int64_t>& StatusBatch::ids() const
+{
+    return _ids;
+}
+
+
+const std::vector<int64_t>& StatusBatch::createdAt() const
+{
+    return _createdAt;
+}
+
+
+const std::vector<uint64_t>& StatusBatch::timestamps() const
+{
+    return _timestamps;
+}
+
+
+const std::vector<int64_t>& StatusBatch::favoriteCounts() const
+{
+    return _favoriteCounts;
+}
+
+
+const std::vector<int64_t>& StatusBatch::retweetCounts() const
+{
+    return _retweetCounts;
+}
+
+
+const std::vector<int64_t>& StatusBatch::quoteCounts() const
+{
+    return _quoteCounts;
+}
+
+
+const std::vector<int64_t>& StatusBatch::replyCounts() const
+{
+    return _replyCounts;
+}
+
+
+const std::vector<int64_t>& StatusBatch::userIds() const
+{
+    return _userIds;
+}
+
+
+const std::vector<uint8_t>& StatusBatch::flags() const
+{
+    return _flags;
+}
+
+
+bool StatusBatch::has(std::size_t row, uint8_t flags) const
+{
+    return (_flags[row] & flags) == flags;
+}
+
+
+const std::string& StatusBatch::text(std::size_t row) const
+{
+    return _cold[row].text;
+}
+
+
+const User* StatusBatch::user(std::size_t row) const
+{
+    return _cold[row].user.get();
+}
+
+
+const Entities& StatusBatch::entities(std::size_t row) const
+{
+    return _cold[row].entities;
+}
+
+
+const Place* StatusBatch::place(std::size_t row) const
+{
+    return _cold[row].place.get();
+}
+
+
+const ofJson& StatusBatch::json(std::size_t row) const
+{
+    return _cold[row].json;
+}
+
+
+std::vector<std::size_t> StatusBatch::sortedRows(Key key, bool descending) const
+{
+    return _withKeys(key, [&](const auto& keys)
+    {
+        std::vector<std::size_t> rows(keys.size());
+        std::iota(rows.begin(), rows.end(), 0);
+
+        if (descending)
+        {
+            std::stable_sort(rows.begin(), rows.end(), [&](std::size_t a, std::size_t b) {
+                return keys[a] > keys[b];
+            });
+        }
+        else
+        {
+            std::stable_sort(rows.begin(), rows.end(), [&](std::size_t a, std::size_t b) {
+                return keys[a] < keys[b];
+            });
+        }
+
+        return rows;
+    });
+}
+
+
+std::vector<std::size_t> StatusBatch::top(Key key, std::size_t count) const
+{
+    return _withKeys(key, [&](const auto& keys)
+    {
+        std::vector<std::size_t> rows(keys.size());
+        std::iota(rows.begin(), rows.end(), 0);
+
+        std::size_t n = std::min(count, rows.size());
+
+        // Ties are broken by row so the result does not depend on the
+        // partial sort implementation.
+        std::partial_sort(rows.begin(), rows.begin() + n, rows.end(), [&](std::size_t a, std::size_t b) {
+            return keys[a] != keys[b] ? keys[a] > keys[b] : a < b;
+        });
+
+        rows.resize(n);
+        return rows;
+    });
+}
+
+
+void StatusBatch::sort(Key key, bool descending)
+{
+    _select(sortedRows(key, descending));
+}
+
+
+std::size_t StatusBatch::evictBefore(uint64_t timestamp)
+{
+    std::vector<std::size_t> rows;
+    rows.reserve(size());
+
+    for (std::size_t row = 0; row < _timestamps.size(); ++row)
+    {
+        if (_timestamps[row] >= timestamp)
+        {
+            rows.push_back(row);
+        }
+    }
+
+    std::size_t removed = size() - rows.size();
+
+    if (removed > 0)
+    {
+        _select(rows);
+    }
+
+    return removed;
+}
+
+
+void StatusBatch::_appendHot(const Status& status)
+{
+    _ids.push_back(status.id());
+    _createdAt.push_back(status.createdAt().timestamp().epochMicroseconds() / 1000);
+    _timestamps.push_back(Utils::timestamp(status));
+    _favoriteCounts.push_back(status.favoriteCount());
+    _retweetCounts.push_back(status.retweetCount());
+    _quoteCounts.push_back(status.quoteCount());
+    _replyCounts.push_back(status.replyCount());
+    _userIds.push_back(status.user() ? status.user()->id() : -1);
+
+    uint8_t flags = 0;
+    if (status.retweetedStatus()) flags |= RETWEET;
+    if (status.isQuoteStatus()) flags |= QUOTE;
+    if (status.inReplyToStatusId() != -1) flags |= REPLY;
+    if (status.coordinates()) flags |= COORDINATES;
+    if (status.possiblySensitive()) flags |= POSSIBLY_SENSITIVE;
+    if (status.extendedTweet()) flags |= EXTENDED;
+    _flags.push_back(flags);
+}
+
+
+template <typename Function>
+std::vector<std::size_t> StatusBatch::_withKeys(Key key, Function function) const
+{
+    switch (key)
+    {
+        case Key::ID: return function(_ids);
+        case Key::CREATED_AT: return function(_createdAt);
+        case Key::TIMESTAMP: return function(_timestamps);
+        case Key::FAVORITE_COUNT: return function(_favoriteCounts);
+        case Key::RETWEET_COUNT: return function(_retweetCounts);
+        case Key::QUOTE_COUNT: return function(_quoteCounts);
+        case Key::REPLY_COUNT: return function(_replyCounts);
+        case Key::ENGAGEMENT:
+        {
+            std::vector<int64_t> keys(size());
+
+            for (std::size_t row = 0; row < keys.size(); ++row)
+            {
+                keys[row] = std::max(int64_t(0), _favoriteCounts[row])
+                          + std::max(int64_t(0), _retweetCounts[row])
+                          + std::max(int64_t(0), _quoteCounts[row])
+                          + std::max(int64_t(0), _replyCounts[row]);
+            }
+
+            return function(keys);
+        }
+    }
+
+    return function(_ids);
+}
+
+
+void StatusBatch::_select(const std::vector<std::size_t>& rows)
+{
+    select(_ids, rows);
+    select(_createdAt, rows);
+    select(_timestamps, rows);
+    select(_favoriteCounts, rows);
+    select(_retweetCounts, rows);
+    select(_quoteCounts, rows);
+    select(_replyCounts, rows);
+    select(_userIds, rows);
+    select(_flags, rows);
+    select(_cold, rows);
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,229 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/StatusPoster.h"
+#include "Poco/Exception.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t StatusPoster::DEFAULT_MAX_CONCURRENCY = 4;
+
+
+StatusPoster::StatusPoster(const HTTP::OAuth10Credentials& credentials,
+                           std::size_t maxConcurrency):
+    _uploader(credentials),
+    _postTransport([credentials](StatusUpdateRequest& request)
+    {
+        return execute(credentials, request);
+    }),
+    _pool(std::max(std::size_t(1), maxConcurrency))
+{
+}
+
+
+StatusPoster::StatusPoster(ChunkedMediaUpload::Transport uploadTransport,
+                           PostTransport postTransport,
+                           std::size_t maxConcurrency):
+    _uploader(uploadTransport),
+    _postTransport(postTransport),
+    _pool(std::max(std::size_t(1), maxConcurrency))
+{
+}
+
+
+StatusPoster::~StatusPoster()
+{
+}
+
+
+std::future<Status> StatusPoster::post(const std::string& status,
+                                       const std::vector<std::filesystem::path>& media)
+{
+    return post(std::make_unique<StatusUpdateRequest>(status), media);
+}
+
+
+std::future<Status> StatusPoster::post(std::unique_ptr<StatusUpdateRequest> request,
+                                       const std::vector<std::filesystem::path>& media)
+{
+    std::vector<Upload> uploads;
+
+    for (const auto& path: media)
+    {
+        uploads.push_back([this, path]()
+        {
+            return _uploader.upload(path).mediaId();
+        });
+    }
+
+    return _post(std::move(request), std::move(uploads));
+}
+
+
+std::future<Status> StatusPoster::postImages(const std::string& status,
+                                             std::vector<ofPixels> images,
+                                             ofImageFormat format,
+                                             ofImageQualityType quality)
+{
+    return postImages(std::make_unique<StatusUpdateRequest>(status),
+                      std::move(images),
+                      format,
+                      quality);
+}
+
+
+std::future<Status> StatusPoster::postImages(std::unique_ptr<StatusUpdateRequest> request,
+                                             std::vector<ofPixels> images,
+                                             ofImageFormat format,
+                                             ofImageQualityType quality)
+{
+    std::vector<Upload> uploads;
+
+    for (auto& image: images)
+    {
+        // The pixels are shared by the task rather than copied again.
+        auto pixels = std::make_shared<ofPixels>(std::move(image));
+
+        uploads.push_back([this, pixels, format, quality]()
+        {
+            // Encode into a pooled buffer on this worker and send the
+            // segments straight from it.
+            auto buffer = _encoder.encode(*pixels, format, quality);
+            return _uploader.upload(*buffer, ImageEncoder::mediaType(format)).mediaId();
+        });
+    }
+
+    return _post(std::move(request), std::move(uploads));
+}
+
+
+ChunkedMediaUpload& StatusPoster::uploader()
+{
+    return _uploader;
+}
+
+
+ofJson StatusPoster::execute(const HTTP::OAuth10Credentials& credentials,
+                             StatusUpdateRequest& request)
+{
+    HTTP::OAuth10HTTPClient client(credentials);
+
+    auto response = client.execute(request);
+
+    if (response == nullptr)
+    {
+        throw Poco::IOException("No response.");
+    }
+
+    ofBuffer buffer = response->buffer();
+    ofJson json = ofJson::parse(buffer.begin(), buffer.end(), nullptr, false);
+
+    if (json.is_discarded())
+    {
+        throw Poco::IOException(std::to_string(response->getStatus()) + " " + response->getReason());
+    }
+
+    // Error responses are returned as JSON and reported by the caller.
+    return json;
+}
+
+
+std::future<Status> StatusPoster::_post(std::unique_ptr<StatusUpdateRequest> request,
+                                        std::vector<Upload> uploads)
+{
+    auto post = std::make_shared<Post>();
+    post->request = std::move(request);
+    post->mediaIds.resize(uploads.size(), -1);
+    post->remaining = uploads.size();
+
+    std::future<Status> future = post->promise.get_future();
+
+    if (uploads.empty())
+    {
+        _pool.execute([this, post]() { _finish(post); });
+        return future;
+    }
+
+    for (std::size_t i = 0; i < uploads.size(); ++i)
+    {
+        _pool.execute([this, post, i, upload = std::move(uploads[i])]()
+        {
+            int64_t mediaId = -1;
+            std::exception_ptr error;
+
+            try
+            {
+                mediaId = upload();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            bool last = false;
+
+            {
+                std::unique_lock<std::mutex> lock(post->mutex);
+                post->mediaIds[i] = mediaId;
+
+                if (error && !post->error)
+                {
+                    post->error = error;
+                }
+
+                last = --post->remaining == 0;
+            }
+
+            if (last)
+            {
+                _finish(post);
+            }
+        });
+    }
+
+    return future;
+}
+
+
+void StatusPoster::_finish(std::shared_ptr<Post> post)
+{
+    if (post->error)
+    {
+        post->promise.set_exception(post->error);
+        return;
+    }
+
+    try
+    {
+        if (!post->mediaIds.empty())
+        {
+            post->request->setMediaIds(post->mediaIds);
+        }
+
+        StatusUpdateResponse response = StatusUpdateResponse::fromJSON(_postTransport(*post->request));
+
+        if (!response.errors().empty())
+        {
+            const Error& error = response.errors().front();
+            throw Poco::DataException(std::to_string(error.code()) + ": " + error.message());
+        }
+
+        post->promise.set_value(response.status());
+    }
+    catch (...)
+    {
+        ofLogError("StatusPoster::_finish") << "Unable to post status.";
+        post->promise.set_exception(std::current_exception());
+    }
+}
+
+
+} } // namespace ofx::Twitter
@@ -82,7 +82,7 @@ void StatusUpdateRequest::setTrimUser(bool trimUser)
 
 void StatusUpdateRequest::setMediaIds(std::vector<int64_t> ids)
 {
-    setFormField("media_ids", HTTP::HTTPUtils::join(ids, " "));
+    setFormField("media_ids", HTTP::HTTPUtils::join(ids, ","));
 }
 
 
@@ -92,20 +92,53 @@ void StatusUpdateRequest::setMediaId(int64_t id)
 }
 
 
+OAuth10Signer::EncodedParameters StatusUpdateRequest::formParameters() const
+{
+    return OAuth10Signer::EncodedParameters(_form);
+}
+
+
+StatusUpdateResponse::StatusUpdateResponse()
+{
+}
+
+
 StatusUpdateResponse::~StatusUpdateResponse()
 {
 }
 
 
-Status StatusUpdateResponse::status() const
+const Status& StatusUpdateResponse::status() const
 {
     return _status;
 }
 
 
-void StatusUpdateResponse::parseJSON(const ofJson& json)
+const std::vector<Error>& StatusUpdateResponse::errors() const
+{
+    return _errors;
+}
+
+
+StatusUpdateResponse StatusUpdateResponse::fromJSON(const ofJson& json)
 {
-    _status = Status::fromJSON(json);
+    StatusUpdateResponse response;
+
+    auto errors = json.find("errors");
+
+    if (errors != json.end())
+    {
+        for (const auto& error: *errors)
+        {
+            response._errors.push_back(Error::fromJSON(error));
+        }
+    }
+    else
+    {
+        response._status = Status::fromJSON(json);
+    }
+
+    return response;
 }
 
 
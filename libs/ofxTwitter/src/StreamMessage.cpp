@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/StreamMessage.h"
+#include <cstring>
+#include "ofx/Twitter/Notices.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool keyEquals(const char* key, std::size_t size, const char* name)
+{
+    return std::strlen(name) == size && std::memcmp(key, name, size) == 0;
+}
+
+}
+
+
+StreamMessage::Type StreamMessage::classify(const std::string& message)
+{
+    const char* p = message.data();
+    const char* end = p + message.size();
+
+    while (p < end && isSpace(*p)) ++p;
+
+    if (p == end)
+    {
+        return Type::KEEP_ALIVE;
+    }
+
+    if (*p++ != '{')
+    {
+        return Type::UNKNOWN;
+    }
+
+    while (p < end && isSpace(*p)) ++p;
+
+    if (p == end || *p++ != '"')
+    {
+        return Type::UNKNOWN;
+    }
+
+    const char* key = p;
+
+    // None of the known keys contain escapes, so any key that does is left
+    // for the DOM fallback.
+    while (p < end && *p != '"' && *p != '\\') ++p;
+
+    if (p == end || *p != '"')
+    {
+        return Type::UNKNOWN;
+    }
+
+    std::size_t size = p - key;
+
+    // Ordered roughly by frequency on the sample stream.
+    if (keyEquals(key, size, "created_at")) return Type::STATUS;
+    if (keyEquals(key, size, "delete")) return Type::STATUS_DELETED_NOTICE;
+    if (keyEquals(key, size, "limit")) return Type::LIMIT_NOTICE;
+    if (keyEquals(key, size, "scrub_geo")) return Type::LOCATION_DELETED_NOTICE;
+    if (keyEquals(key, size, "status_withheld")) return Type::STATUS_WITHHELD_NOTICE;
+    if (keyEquals(key, size, "user_withheld")) return Type::USER_WITHHELD_NOTICE;
+    if (keyEquals(key, size, "disconnect")) return Type::DISCONNECT_NOTICE;
+    if (keyEquals(key, size, "warning")) return Type::STALL_WARNING;
+
+    return Type::UNKNOWN;
+}
+
+
+bool StreamMessage::payload(const std::string& message,
+                            std::size_t& begin,
+                            std::size_t& end)
+{
+    const char* first = message.data();
+    const char* last = first + message.size();
+    const char* p = first;
+
+    while (p < last && isSpace(*p)) ++p;
+
+    if (p == last || *p++ != '{')
+    {
+        return false;
+    }
+
+    while (p < last && isSpace(*p)) ++p;
+
+    if (p == last || *p++ != '"')
+    {
+        return false;
+    }
+
+    while (p < last && *p != '"')
+    {
+        if (*p == '\\' && p + 1 < last) ++p;
+        ++p;
+    }
+
+    if (p == last)
+    {
+        return false;
+    }
+
+    ++p;
+
+    while (p < last && isSpace(*p)) ++p;
+
+    if (p == last || *p++ != ':')
+    {
+        return false;
+    }
+
+    while (p < last && isSpace(*p)) ++p;
+
+    if (p == last || *p != '{')
+    {
+        return false;
+    }
+
+    const char* value = p;
+    int depth = 0;
+    bool inString = false;
+
+    // Find the brace that closes the value, skipping over strings.
+    for (; p < last; ++p)
+    {
+        if (inString)
+        {
+            if (*p == '\\' && p + 1 < last) ++p;
+            else if (*p == '"') inString = false;
+        }
+        else if (*p == '"') inString = true;
+        else if (*p == '{' || *p == '[') ++depth;
+        else if ((*p == '}' || *p == ']') && --depth == 0) break;
+    }
+
+    if (p == last)
+    {
+        return false;
+    }
+
+    const char* valueEnd = ++p;
+
+    // Anything but the closing brace means there are more keys.
+    while (p < last && isSpace(*p)) ++p;
+
+    if (p == last || *p++ != '}')
+    {
+        return false;
+    }
+
+    while (p < last && isSpace(*p)) ++p;
+
+    if (p != last)
+    {
+        return false;
+    }
+
+    begin = value - first;
+    end = valueEnd - first;
+    return true;
+}
+
+
+StreamMessage::Type StreamMessage::classify(const ofJson& json)
+{
+    if (!json.is_object() || json.empty()) return Type::KEEP_ALIVE;
+    if (json.find(StatusDeletedNotice::JSON_KEY) != json.end()) return Type::STATUS_DELETED_NOTICE;
+    if (json.find(LocationDeletedNotice::JSON_KEY) != json.end()) return Type::LOCATION_DELETED_NOTICE;
+    if (json.find(LimitNotice::JSON_KEY) != json.end()) return Type::LIMIT_NOTICE;
+    if (json.find(StatusWithheldNotice::JSON_KEY) != json.end()) return Type::STATUS_WITHHELD_NOTICE;
+    if (json.find(UserWithheldNotice::JSON_KEY) != json.end()) return Type::USER_WITHHELD_NOTICE;
+    if (json.find(DisconnectNotice::JSON_KEY) != json.end()) return Type::DISCONNECT_NOTICE;
+    if (json.find(StallWarning::JSON_KEY) != json.end()) return Type::STALL_WARNING;
+    if (json.find("text") != json.end()) return Type::STATUS;
+    return Type::UNKNOWN;
+}
+
+
+} } // namespace ofx::Twitter
@@ -10,6 +10,8 @@
 #include "ofx/HTTP/GetRequest.h"
 #include "ofx/HTTP/PostRequest.h"
 #include "ofx/IO/ByteBufferUtils.h"
+#include "ofx/Twitter/StreamMessage.h"
+#include "ofx/Twitter/Trace.h"
 #include "ofx/Twitter/User.h"
 
 
@@ -18,6 +20,8 @@ namespace Twitter {
 
 
 const uint64_t BaseStreamingClient::TIMEOUT = 90000;
+const std::size_t BaseStreamingClient::DEFAULT_BATCH_SIZE = 1000;
+const uint64_t BaseStreamingClient::DEFAULT_BATCH_INTERVAL = 1000;
 const std::string BaseStreamingClient::USER_AGENT = "ofxTwitter (compatible; Client/1.0 +https://github.com/bakercp/ofxTwitter)";
 
 
@@ -88,6 +92,82 @@ BaseStreamingClient::StreamType BaseStreamingClient::streamType() const
 }
 
 
+void BaseStreamingClient::setTrackMatchingEnabled(bool value)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    _trackMatchingEnabled = value;
+}
+
+
+bool BaseStreamingClient::isTrackMatchingEnabled() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return _trackMatchingEnabled;
+}
+
+
+std::shared_ptr<const TrackMatcher> BaseStreamingClient::trackMatcher() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return _trackMatcher;
+}
+
+
+void BaseStreamingClient::setLocationMatchingEnabled(bool value)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    _locationMatchingEnabled = value;
+}
+
+
+bool BaseStreamingClient::isLocationMatchingEnabled() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return _locationMatchingEnabled;
+}
+
+
+std::shared_ptr<const LocationMatcher> BaseStreamingClient::locationMatcher() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return _locationMatcher;
+}
+
+
+void BaseStreamingClient::setBatchSink(BatchSink sink,
+                                       std::size_t batchSize,
+                                       uint64_t batchInterval)
+{
+    if (isRunning())
+    {
+        ofLogWarning("BaseStreamingClient::setBatchSink") << "The batch sink cannot be changed while the client is running.";
+        return;
+    }
+
+    _batchSink = sink;
+    _batchSize = std::max(std::size_t(1), batchSize);
+    _batchInterval = batchInterval;
+}
+
+
+void BaseStreamingClient::setTransport(Transport transport)
+{
+    if (isRunning())
+    {
+        ofLogWarning("BaseStreamingClient::setTransport") << "The transport cannot be changed while the client is running.";
+        return;
+    }
+
+    _transport = transport;
+}
+
+
+const ClientMetrics& BaseStreamingClient::metrics() const
+{
+    return _metrics;
+}
+
+
 void BaseStreamingClient::sample()
 {
     sample(SampleQuery());
@@ -97,6 +177,7 @@ void BaseStreamingClient::sample()
 void BaseStreamingClient::sample(const SampleQuery& query)
 {
     stopAndJoin();
+    _setMatchers(nullptr);
     _streamType = StreamType::SAMPLE;
     _parameters = query;
     _httpMethod = Poco::Net::HTTPRequest::HTTP_GET;
@@ -120,6 +201,7 @@ void BaseStreamingClient::filter(std::vector<std::string> track,
 void BaseStreamingClient::filter(const FilterQuery& query)
 {
     stopAndJoin();
+    _setMatchers(&query);
     _streamType = StreamType::FILTER;
     _parameters = query;
     _httpMethod = Poco::Net::HTTPRequest::HTTP_POST;
@@ -131,6 +213,7 @@ void BaseStreamingClient::filter(const FilterQuery& query)
 void BaseStreamingClient::user(const UserFilterQuery& query)
 {
     stopAndJoin();
+    _setMatchers(&query);
     _streamType = StreamType::USER;
     _parameters = query;
     _httpMethod = Poco::Net::HTTPRequest::HTTP_GET;
@@ -139,6 +222,27 @@ void BaseStreamingClient::user(const UserFilterQuery& query)
 }
 
 
+void BaseStreamingClient::_setMatchers(const BaseFilterQuery* query)
+{
+    std::shared_ptr<const TrackMatcher> trackMatcher = nullptr;
+    std::shared_ptr<const LocationMatcher> locationMatcher = nullptr;
+
+    if (query && query->has("track") && isTrackMatchingEnabled())
+    {
+        trackMatcher = std::make_shared<TrackMatcher>(*query);
+    }
+
+    if (query && query->has("locations") && isLocationMatchingEnabled())
+    {
+        locationMatcher = std::make_shared<LocationMatcher>(*query);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    _trackMatcher = trackMatcher;
+    _locationMatcher = locationMatcher;
+}
+
+
 void BaseStreamingClient::_run()
 {
     HTTP::ClientSessionSettings sessionSettings;
@@ -148,118 +252,308 @@ void BaseStreamingClient::_run()
     _client.context().setClientSessionSettings(sessionSettings);
     _client.setCredentials(_credentials);
 
+    std::shared_ptr<const TrackMatcher> trackMatcher = this->trackMatcher();
+    std::shared_ptr<const LocationMatcher> locationMatcher = this->locationMatcher();
+
     try
     {
         _lastMessageTime = ofGetElapsedTimeMillis();
 
-        _onConnect();
-
         HTTP::FormRequest request(_httpMethod,
                                   _url,
                                   Poco::Net::HTTPMessage::HTTP_1_1);
 
         request.addFormFields(_parameters);
 
-        auto response = _client.execute(request);
+        std::unique_ptr<HTTP::ClientResponse> response;
+        std::unique_ptr<std::istream> body;
+        std::istream* stream = nullptr;
 
-        if (!response->isSuccess())
+        if (_transport)
         {
-            ofBuffer result = response->buffer();
-
-            ofLogError("BaseStreamingClient::_run") << result;
+            body = _transport(request);
+            stream = body.get();
         }
         else
         {
-            std::istream& istr = response->stream();
+            response = _client.execute(request);
+
+            if (!response->isSuccess())
+            {
+                ofBuffer result = response->buffer();
+
+                ofLogError("BaseStreamingClient::_run") << result;
+            }
+            else
+            {
+                stream = &response->stream();
+            }
+        }
+
+        if (stream)
+        {
+            // The stream is open once the response arrives, even if no
+            // message follows for a while.
+            _metrics.increment(ClientMetrics::Event::CONNECT);
+            _onConnect();
+
+            std::istream& istr = *stream;
             std::string line;
 
+            uint64_t readStart = ClientMetrics::now();
+
             while (isRunning() && std::getline(istr, line))
             {
                 _lastMessageTime = ofGetElapsedTimeMillis();
 
+                if (!_batch.empty() && _lastMessageTime >= _batchStart + _batchInterval)
+                {
+                    _flushBatch();
+                }
+
+                uint64_t parseStart = _metrics.record(ClientMetrics::Stage::READ, readStart);
+                _metrics.addBytesReceived(line.size() + 1);
+
+                OFX_TWITTER_TRACE_SPAN("BaseStreamingClient::read", readStart, parseStart);
+
                 if (!istr.fail())
                 {
                     try
                     {
-                        // Parsing should take care of any leading / trailing
-                        // whitespace or new line characters that weren't
-                        // consumed by std::getline.
-                        ofJson json = ofJson::parse(line);
+                        // Identify the message from its first key so that
+                        // keep-alive lines are skipped without parsing and
+                        // only the matching decoder is run.
+                        StreamMessage::Type type = StreamMessage::classify(line);
 
-                        if (json.is_null() || json.empty())
+                        if (type == StreamMessage::Type::KEEP_ALIVE)
                         {
+                            readStart = ClientMetrics::now();
                             continue;
                         }
-                        else
-                        {
-                            _onMessage(json);
-                        }
-
 
-                        if (json.find(StatusDeletedNotice::JSON_KEY) != json.end())
-                        {
-                            _onStatusDeletedNotice(StatusDeletedNotice::fromJSON(json[StatusDeletedNotice::JSON_KEY]));
-                        }
-                        else if (json.find(LocationDeletedNotice::JSON_KEY) != json.end())
-                        {
-                            _onLocationDeletedNotice(LocationDeletedNotice::fromJSON(json[LocationDeletedNotice::JSON_KEY]));
-                        }
-                        else if (json.find(LimitNotice::JSON_KEY) != json.end())
+                        // The raw message is only built if a consumer asks
+                        // for it. Otherwise a notice is decoded from the
+                        // value of its key alone.
+                        bool wantsMessages = _wantsMessages();
+                        ofJson json;
+                        ofJson payload;
+                        std::size_t payloadBegin = 0;
+                        std::size_t payloadEnd = 0;
+
+                        bool isNotice = type != StreamMessage::Type::STATUS
+                                     && type != StreamMessage::Type::UNKNOWN;
+
+                        if (!wantsMessages
+                         && isNotice
+                         && StreamMessage::payload(line, payloadBegin, payloadEnd))
                         {
-                            _onLimitNotice(LimitNotice::fromJSON(json[LimitNotice::JSON_KEY]));
+                            OFX_TWITTER_TRACE_SCOPE("ofJson::parse");
+                            payload = ofJson::parse(line.begin() + payloadBegin,
+                                                    line.begin() + payloadEnd);
                         }
-                        else if (json.find(StatusWithheldNotice::JSON_KEY) != json.end())
-                        {
-                            _onStatusWithheldNotice(StatusWithheldNotice::fromJSON(json[StatusWithheldNotice::JSON_KEY]));
-                        }
-                        else if (json.find(UserWithheldNotice::JSON_KEY) != json.end())
+                        else
                         {
-                            _onUserWitheldNotice(UserWithheldNotice::fromJSON(json[UserWithheldNotice::JSON_KEY]));
+                            // Parsing should take care of any leading /
+                            // trailing whitespace or new line characters that
+                            // weren't consumed by std::getline.
+                            {
+                                OFX_TWITTER_TRACE_SCOPE("ofJson::parse");
+                                json = ofJson::parse(line);
+                            }
+
+                            if (json.is_null() || json.empty())
+                            {
+                                readStart = ClientMetrics::now();
+                                continue;
+                            }
+
+                            // A leading `created_at` is only a hint, so the
+                            // status is confirmed by its `text` like any other.
+                            if (type == StreamMessage::Type::UNKNOWN
+                             || (type == StreamMessage::Type::STATUS && json.find("text") == json.end()))
+                            {
+                                type = StreamMessage::classify(json);
+                            }
                         }
-                        else if (json.find(DisconnectNotice::JSON_KEY) != json.end())
+
+                        // The value under a notice's key.
+                        auto noticeValue = [&](const std::string& key) -> const ofJson&
                         {
-                            _onDisconnectNotice(DisconnectNotice::fromJSON(json[DisconnectNotice::JSON_KEY]));
-                        }
-                        else if (json.find(StallWarning::JSON_KEY) != json.end())
+                            return json.is_null() ? payload : json[key];
+                        };
+
+                        // Each message is recorded as a single parse stage,
+                        // spanning the JSON parse and the typed decode, and a
+                        // single delivery stage, spanning the raw message and
+                        // the typed callback. The callback is a template
+                        // argument so that no std::function is built per
+                        // message. A MESSAGE event has no typed callback.
+                        auto deliver = [&](ClientMetrics::Event event, auto&& callback)
                         {
-                            _onStallWarning(StallWarning::fromJSON(json[StallWarning::JSON_KEY]));
-                        }
-                        else if (json.find("text") != json.end())
+                            uint64_t deliverStart = _metrics.record(ClientMetrics::Stage::PARSE, parseStart);
+                            _metrics.increment(ClientMetrics::Event::MESSAGE);
+
+                            if (wantsMessages)
+                            {
+                                _onMessage(json);
+                            }
+
+                            if (event != ClientMetrics::Event::MESSAGE)
+                            {
+                                _metrics.increment(event);
+                                callback();
+                            }
+
+                            _metrics.record(ClientMetrics::Stage::DELIVER, deliverStart);
+                        };
+
+                        switch (type)
                         {
-                            _onStatus(Status::fromJSON(json));
+                            case StreamMessage::Type::STATUS_DELETED_NOTICE:
+                            {
+                                auto notice = StatusDeletedNotice::fromJSON(noticeValue(StatusDeletedNotice::JSON_KEY));
+                                deliver(ClientMetrics::Event::STATUS_DELETED_NOTICE,
+                                        [&]() { _onStatusDeletedNotice(notice); });
+                                break;
+                            }
+                            case StreamMessage::Type::LOCATION_DELETED_NOTICE:
+                            {
+                                auto notice = LocationDeletedNotice::fromJSON(noticeValue(LocationDeletedNotice::JSON_KEY));
+                                deliver(ClientMetrics::Event::LOCATION_DELETED_NOTICE,
+                                        [&]() { _onLocationDeletedNotice(notice); });
+                                break;
+                            }
+                            case StreamMessage::Type::LIMIT_NOTICE:
+                            {
+                                auto notice = LimitNotice::fromJSON(noticeValue(LimitNotice::JSON_KEY));
+                                _metrics.setLimitTrack(notice.track());
+                                deliver(ClientMetrics::Event::LIMIT_NOTICE,
+                                        [&]() { _onLimitNotice(notice); });
+                                break;
+                            }
+                            case StreamMessage::Type::STATUS_WITHHELD_NOTICE:
+                            {
+                                auto notice = StatusWithheldNotice::fromJSON(noticeValue(StatusWithheldNotice::JSON_KEY));
+                                deliver(ClientMetrics::Event::STATUS_WITHHELD_NOTICE,
+                                        [&]() { _onStatusWithheldNotice(notice); });
+                                break;
+                            }
+                            case StreamMessage::Type::USER_WITHHELD_NOTICE:
+                            {
+                                auto notice = UserWithheldNotice::fromJSON(noticeValue(UserWithheldNotice::JSON_KEY));
+                                deliver(ClientMetrics::Event::USER_WITHHELD_NOTICE,
+                                        [&]() { _onUserWitheldNotice(notice); });
+                                break;
+                            }
+                            case StreamMessage::Type::DISCONNECT_NOTICE:
+                            {
+                                auto notice = DisconnectNotice::fromJSON(noticeValue(DisconnectNotice::JSON_KEY));
+                                deliver(ClientMetrics::Event::DISCONNECT_NOTICE,
+                                        [&]() { _onDisconnectNotice(notice); });
+                                break;
+                            }
+                            case StreamMessage::Type::STALL_WARNING:
+                            {
+                                auto warning = StallWarning::fromJSON(noticeValue(StallWarning::JSON_KEY));
+                                deliver(ClientMetrics::Event::STALL_WARNING,
+                                        [&]() { _onStallWarning(warning); });
+                                break;
+                            }
+                            case StreamMessage::Type::STATUS:
+                            {
+                                auto status = Status::fromJSON(json);
+                                if (trackMatcher) trackMatcher->annotate(status);
+                                if (locationMatcher) locationMatcher->annotate(status);
+
+                                if (_batchSink)
+                                {
+                                    deliver(ClientMetrics::Event::STATUS, [&]()
+                                    {
+                                        if (_batch.empty()) _batchStart = _lastMessageTime;
+                                        _batch.append(std::move(status));
+                                        if (_batch.size() >= _batchSize) _flushBatch();
+                                    });
+                                }
+                                else
+                                {
+                                    deliver(ClientMetrics::Event::STATUS,
+                                            [&]() { _onStatus(status); });
+                                }
+                                break;
+                            }
+                            case StreamMessage::Type::KEEP_ALIVE:
+                            case StreamMessage::Type::UNKNOWN:
+                                deliver(ClientMetrics::Event::MESSAGE, []() {});
+                                break;
                         }
                     }
                     catch (const std::exception& exc)
                     {
                         ofLogError("BaseStreamingClient::_run") << exc.what();
+                        _metrics.increment(ClientMetrics::Event::EXCEPTION);
                         _onException(std::exception(exc));
                     }
                 }
+
+                readStart = ClientMetrics::now();
             }
         }
     }
     catch (const Poco::Exception& exc)
     {
         ofLogError("BaseStreamingClient::_run") << exc.displayText();
+        _metrics.increment(ClientMetrics::Event::EXCEPTION);
         _onException(std::exception(exc));
     }
     catch (const std::exception& exc)
     {
         ofLogError("BaseStreamingClient::_run") << exc.what();
+        _metrics.increment(ClientMetrics::Event::EXCEPTION);
         _onException(std::exception(exc));
     }
     catch (...)
     {
         Poco::Exception exc("Unknown exception.");
         ofLogError("BaseStreamingClient::_run") << exc.displayText();
+        _metrics.increment(ClientMetrics::Event::EXCEPTION);
         _onException(std::exception(exc));
     }
 
+    if (!_batch.empty())
+    {
+        _flushBatch();
+    }
+
+    _metrics.increment(ClientMetrics::Event::DISCONNECT);
     _onDisconnect();
 
 }
 
 
+bool BaseStreamingClient::_wantsMessages() const
+{
+    return true;
+}
+
+
+void BaseStreamingClient::_flushBatch()
+{
+    StatusBatch batch;
+    std::swap(batch, _batch);
+
+    try
+    {
+        _batchSink(std::move(batch));
+    }
+    catch (const std::exception& exc)
+    {
+        ofLogError("BaseStreamingClient::_flushBatch") << exc.what();
+        _metrics.increment(ClientMetrics::Event::EXCEPTION);
+        _onException(std::exception(exc));
+    }
+}
+
+
 StreamingClient::StreamingClient(bool autoEventSync):
     StreamingClient(HTTP::OAuth10Credentials())
 {
@@ -298,18 +592,26 @@ void StreamingClient::setAutoEventSync(bool value)
 
 void StreamingClient::syncEvents()
 {
-    for (const auto& v: _connectChannel.tryReceiveAll()) onConnect.notify(this);
-    for (const auto& v: _disconnectChannel.tryReceiveAll()) onDisconnect.notify(this);
-    for (const auto& v: _statusChannel.tryReceiveAll()) onStatus.notify(this, v);
-    for (const auto& v: _statusDeletedNoticeChannel.tryReceiveAll()) onStatusDeletedNotice.notify(this, v);
-    for (const auto& v: _locationDeletedNoticeChannel.tryReceiveAll()) onLocationDeletedNotice.notify(this, v);
-    for (const auto& v: _limitNoticeChannel.tryReceiveAll()) onLimitNotice.notify(this, v);
-    for (const auto& v: _statusWithheldNoticeChannel.tryReceiveAll()) onStatusWithheldNotice.notify(this, v);
-    for (const auto& v: _userWithheldNoticeChannel.tryReceiveAll()) onUserWitheldNotice.notify(this, v);
-    for (const auto& v: _disconnectNoticeChannel.tryReceiveAll()) onDisconnectNotice.notify(this, v);
-    for (const auto& v: _stallwarningChannel.tryReceiveAll()) onStallWarning.notify(this, v);
-    for (const auto& v: _exceptionChannel.tryReceiveAll()) onException.notify(this, v);
-    for (const auto& v: _messageChannel.tryReceiveAll()) onMessage.notify(this, v);
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::syncEvents");
+
+    for (const auto& v: _receiveAll(_connectChannel, ClientMetrics::Event::CONNECT)) onConnect.notify(this);
+    for (const auto& v: _receiveAll(_disconnectChannel, ClientMetrics::Event::DISCONNECT)) onDisconnect.notify(this);
+
+    for (const auto& v: _receiveAll(_statusChannel, ClientMetrics::Event::STATUS))
+    {
+        OFX_TWITTER_TRACE_SCOPE("StreamingClient::onStatus.notify");
+        onStatus.notify(this, v);
+    }
+
+    for (const auto& v: _receiveAll(_statusDeletedNoticeChannel, ClientMetrics::Event::STATUS_DELETED_NOTICE)) onStatusDeletedNotice.notify(this, v);
+    for (const auto& v: _receiveAll(_locationDeletedNoticeChannel, ClientMetrics::Event::LOCATION_DELETED_NOTICE)) onLocationDeletedNotice.notify(this, v);
+    for (const auto& v: _receiveAll(_limitNoticeChannel, ClientMetrics::Event::LIMIT_NOTICE)) onLimitNotice.notify(this, v);
+    for (const auto& v: _receiveAll(_statusWithheldNoticeChannel, ClientMetrics::Event::STATUS_WITHHELD_NOTICE)) onStatusWithheldNotice.notify(this, v);
+    for (const auto& v: _receiveAll(_userWithheldNoticeChannel, ClientMetrics::Event::USER_WITHHELD_NOTICE)) onUserWitheldNotice.notify(this, v);
+    for (const auto& v: _receiveAll(_disconnectNoticeChannel, ClientMetrics::Event::DISCONNECT_NOTICE)) onDisconnectNotice.notify(this, v);
+    for (const auto& v: _receiveAll(_stallwarningChannel, ClientMetrics::Event::STALL_WARNING)) onStallWarning.notify(this, v);
+    for (const auto& v: _receiveAll(_exceptionChannel, ClientMetrics::Event::EXCEPTION)) onException.notify(this, v);
+    for (const auto& v: _receiveAll(_messageChannel, ClientMetrics::Event::MESSAGE)) onMessage.notify(this, v);
 
     uint64_t now = ofGetElapsedTimeMillis();
 
@@ -337,74 +639,104 @@ void StreamingClient::_exit(ofEventArgs& args)
 
 void StreamingClient::_onConnect()
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::CONNECT);
     _connectChannel.send(ofEventArgs());
 }
 
 
 void StreamingClient::_onDisconnect()
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::DISCONNECT);
     _disconnectChannel.send(ofEventArgs());
 }
 
 
 void StreamingClient::_onStatus(const Status& status)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::STATUS);
     _statusChannel.send(status);
 }
 
 
 void StreamingClient::_onStatusDeletedNotice(const StatusDeletedNotice& notice)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::STATUS_DELETED_NOTICE);
     _statusDeletedNoticeChannel.send(notice);
 }
 
 
 void StreamingClient::_onLocationDeletedNotice(const LocationDeletedNotice& notice)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::LOCATION_DELETED_NOTICE);
     _locationDeletedNoticeChannel.send(notice);
 }
 
 
 void StreamingClient::_onLimitNotice(const LimitNotice& notice)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::LIMIT_NOTICE);
     _limitNoticeChannel.send(notice);
 }
 
 
 void StreamingClient::_onStatusWithheldNotice(const StatusWithheldNotice& notice)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::STATUS_WITHHELD_NOTICE);
     _statusWithheldNoticeChannel.send(notice);
 }
 
 
 void StreamingClient::_onUserWitheldNotice(const UserWithheldNotice& notice)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::USER_WITHHELD_NOTICE);
     _userWithheldNoticeChannel.send(notice);
 }
 
 
 void StreamingClient::_onDisconnectNotice(const DisconnectNotice& notice)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::DISCONNECT_NOTICE);
     _disconnectNoticeChannel.send(notice);
 }
 
 
 void StreamingClient::_onStallWarning(const StallWarning& notice)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::STALL_WARNING);
     _stallwarningChannel.send(notice);
 }
 
 
 void StreamingClient::_onException(const std::exception& exc)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::EXCEPTION);
     _exceptionChannel.send(exc);
 }
 
 
 void StreamingClient::_onMessage(const ofJson& message)
 {
+    OFX_TWITTER_TRACE_SCOPE("StreamingClient::send");
+    _metrics.addQueued(ClientMetrics::Event::MESSAGE);
     _messageChannel.send(message);
 }
 
+
+bool StreamingClient::_wantsMessages() const
+{
+    return onMessage.size() > 0;
+}
+
     
 } } // namespace ofx::Twitter
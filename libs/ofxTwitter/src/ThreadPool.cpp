@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/ThreadPool.h"
+#include <algorithm>
+#include <exception>
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        _threads.emplace_back(&ThreadPool::_work, this);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _condition.notify_all();
+
+    for (auto& thread: _threads)
+    {
+        thread.join();
+    }
+}
+
+
+void ThreadPool::execute(std::function<void()> task)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+
+    _condition.notify_one();
+}
+
+
+void ThreadPool::parallelFor(std::size_t count,
+                             const std::function<void(std::size_t)>& function,
+                             std::size_t chunkSize)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::size_t workers = _threads.size() + 1;
+
+    if (chunkSize == 0)
+    {
+        // Several chunks per worker keep the load balanced when the cost of
+        // each index varies.
+        chunkSize = std::max(std::size_t(1), count / (workers * 8));
+    }
+
+    struct State
+    {
+        std::atomic<std::size_t> next { 0 };
+        std::atomic<std::size_t> done { 0 };
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    auto state = std::make_shared<State>();
+
+    auto run = [state, count, chunkSize, &function]()
+    {
+        std::size_t processed = 0;
+
+        while (true)
+        {
+            std::size_t begin = state->next.fetch_add(chunkSize);
+
+            if (begin >= count)
+            {
+                break;
+            }
+
+            std::size_t end = std::min(count, begin + chunkSize);
+
+            try
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    function(i);
+                }
+            }
+            catch (...)
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                if (!state->exception) state->exception = std::current_exception();
+            }
+
+            processed += end - begin;
+        }
+
+        if (processed > 0 && state->done.fetch_add(processed) + processed == count)
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->condition.notify_all();
+        }
+    };
+
+    // Helpers that start after all chunks are claimed exit immediately, and
+    // the caller does not return until every claimed chunk is complete, so
+    // the helpers never outlive the reference to function.
+    std::size_t helpers = std::min(_threads.size(), (count + chunkSize - 1) / chunkSize - 1);
+
+    for (std::size_t i = 0; i < helpers; ++i)
+    {
+        execute(run);
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&]() { return state->done.load() == count; });
+
+    if (state->exception)
+    {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+
+std::size_t ThreadPool::size() const
+{
+    return _threads.size();
+}
+
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+
+void ThreadPool::_work()
+{
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+
+            if (_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        try
+        {
+            task();
+        }
+        catch (const std::exception& exc)
+        {
+            ofLogError("ThreadPool::_work") << "Uncaught exception: " << exc.what();
+        }
+        catch (...)
+        {
+            ofLogError("ThreadPool::_work") << "Uncaught unknown exception.";
+        }
+    }
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include "ofJson.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+const std::size_t Tracer::MAX_EVENTS_PER_THREAD = 1 << 20;
+
+
+Tracer::Tracer(): _enabled(false), _nextThreadId(1)
+{
+}
+
+
+Tracer::~Tracer()
+{
+}
+
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+
+void Tracer::start()
+{
+    _enabled.store(true, std::memory_order_release);
+}
+
+
+void Tracer::stop()
+{
+    _enabled.store(false, std::memory_order_release);
+}
+
+
+bool Tracer::isEnabled() const
+{
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+
+void Tracer::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto iter = std::remove_if(_buffers.begin(), _buffers.end(), [](const std::shared_ptr<ThreadBuffer>& buffer)
+    {
+        std::unique_lock<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+        return buffer->retired;
+    });
+
+    _buffers.erase(iter, _buffers.end());
+}
+
+
+bool Tracer::save(const std::filesystem::path& path) const
+{
+    std::ofstream ostr(path.string(), std::ios::binary);
+
+    if (!ostr)
+    {
+        ofLogError("Tracer::save") << "Unable to open " << path.string();
+        return false;
+    }
+
+    ostr << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& buffer: _buffers)
+    {
+        std::unique_lock<std::mutex> bufferLock(buffer->mutex);
+
+        for (const auto& event: buffer->events)
+        {
+            if (!first) ostr << ",";
+            first = false;
+
+            // Names are expected to be identifiers and string literals, so
+            // they are dumped through ofJson only to guarantee valid escaping.
+            ostr << "{\"name\":" << ofJson(event.name).dump()
+                 << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << event.start
+                 << ",\"dur\":" << event.duration << "}";
+        }
+    }
+
+    ostr << "]}";
+
+    return ostr.good();
+}
+
+
+void Tracer::record(const char* name, uint64_t start, uint64_t end)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    ThreadBuffer& buffer = _threadBuffer();
+
+    std::unique_lock<std::mutex> lock(buffer.mutex);
+
+    if (buffer.events.size() < MAX_EVENTS_PER_THREAD)
+    {
+        buffer.events.push_back({ name, start, end > start ? end - start : 0 });
+    }
+}
+
+
+uint64_t Tracer::now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+Tracer::ThreadBuffer& Tracer::_threadBuffer()
+{
+    // The buffer is shared with the registry so it outlives the thread and
+    // can still be saved after the thread exits. It is retired when the
+    // thread exits so short-lived threads do not grow the registry.
+    struct Registration
+    {
+        ~Registration()
+        {
+            if (buffer != nullptr)
+            {
+                Tracer::instance()._retire(buffer);
+            }
+        }
+
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+
+    thread_local Registration registration;
+
+    if (registration.buffer == nullptr)
+    {
+        registration.buffer = std::make_shared<ThreadBuffer>();
+        registration.buffer->threadId = _nextThreadId.fetch_add(1);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _buffers.push_back(registration.buffer);
+    }
+
+    return *registration.buffer;
+}
+
+
+void Tracer::_retire(const std::shared_ptr<ThreadBuffer>& buffer)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    std::unique_lock<std::mutex> bufferLock(buffer->mutex);
+
+    if (buffer->events.empty())
+    {
+        _buffers.erase(std::remove(_buffers.begin(), _buffers.end(), buffer), _buffers.end());
+    }
+    else
+    {
+        buffer->retired = true;
+    }
+}
+
+
+TraceScope::TraceScope(const char* name)
+{
+    if (Tracer::instance().isEnabled())
+    {
+        _name = name;
+        _start = Tracer::now();
+    }
+}
+
+
+TraceScope::~TraceScope()
+{
+    if (_name != nullptr)
+    {
+        Tracer::instance().record(_name, _start, Tracer::now());
+    }
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,359 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/TrackMatcher.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <sstream>
+#include "ofx/Twitter/Trace.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+/// Retweeted and quoted statuses are searched to at most this depth.
+const std::size_t MAX_DEPTH = 2;
+
+/// A transition that has not been assigned while building the trie.
+const uint32_t NO_STATE = 0xFFFFFFFF;
+
+inline char fold(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+inline bool isTokenChar(char c)
+{
+    // Bytes of multi-byte UTF-8 sequences are treated as token characters.
+    unsigned char u = static_cast<unsigned char>(c);
+    return u >= 0x80
+        || (c >= 'a' && c <= 'z')
+        || (c >= 'A' && c <= 'Z')
+        || (c >= '0' && c <= '9')
+        || c == '_';
+}
+
+inline void appendFolded(const std::string& text, std::string& buffer)
+{
+    std::size_t offset = buffer.size();
+    buffer.resize(offset + text.size() + 1);
+    for (std::size_t i = 0; i < text.size(); ++i) buffer[offset + i] = fold(text[i]);
+    buffer[offset + text.size()] = '\n';
+}
+
+}
+
+
+TrackMatcher::TrackMatcher()
+{
+    setTracks({});
+}
+
+
+TrackMatcher::TrackMatcher(const std::vector<std::string>& tracks)
+{
+    setTracks(tracks);
+}
+
+
+TrackMatcher::TrackMatcher(const BaseFilterQuery& query)
+{
+    std::vector<std::string> tracks;
+
+    if (query.has("track"))
+    {
+        std::istringstream istr(query.get("track"));
+        std::string track;
+        while (std::getline(istr, track, ',')) tracks.push_back(track);
+    }
+
+    setTracks(tracks);
+}
+
+
+void TrackMatcher::setTracks(const std::vector<std::string>& tracks)
+{
+    _tracks = tracks;
+    _ruleTermCounts.assign(tracks.size(), 0);
+    _terms.clear();
+
+    // Split each rule into distinct, case folded terms.
+    std::map<std::string, uint32_t> termIds;
+
+    for (std::size_t rule = 0; rule < tracks.size(); ++rule)
+    {
+        std::istringstream istr(tracks[rule]);
+        std::string word;
+        std::vector<uint32_t> ruleTerms;
+
+        while (istr >> word)
+        {
+            std::transform(word.begin(), word.end(), word.begin(), fold);
+
+            auto result = termIds.insert({ word, uint32_t(_terms.size()) });
+
+            if (result.second)
+            {
+                Term term;
+                term.length = word.size();
+                term.checkStart = isTokenChar(word.front());
+                term.checkEnd = isTokenChar(word.back());
+                _terms.push_back(term);
+            }
+
+            uint32_t termId = result.first->second;
+
+            if (std::find(ruleTerms.begin(), ruleTerms.end(), termId) == ruleTerms.end())
+            {
+                ruleTerms.push_back(termId);
+                _terms[termId].rules.push_back(uint32_t(rule));
+            }
+        }
+
+        _ruleTermCounts[rule] = uint32_t(ruleTerms.size());
+    }
+
+    // Reduce the alphabet to the bytes that occur in terms so that the
+    // transition table stays small.
+    std::memset(_symbols, 0, sizeof(_symbols));
+    _symbolCount = 1;
+
+    for (const auto& entry: termIds)
+    {
+        for (char c: entry.first)
+        {
+            uint8_t& symbol = _symbols[static_cast<unsigned char>(c)];
+            if (symbol == 0) symbol = uint8_t(_symbolCount++);
+        }
+    }
+
+    // Upper case input bytes share the symbol of their folded form.
+    for (int c = 'A'; c <= 'Z'; ++c)
+    {
+        _symbols[c] = _symbols[c - 'A' + 'a'];
+    }
+
+    // Build the trie.
+    _transitions.assign(_symbolCount, NO_STATE);
+    std::vector<std::vector<uint32_t>> outputs(1);
+
+    for (const auto& entry: termIds)
+    {
+        uint32_t state = 0;
+
+        for (char c: entry.first)
+        {
+            std::size_t index = state * _symbolCount + _symbols[static_cast<unsigned char>(c)];
+
+            if (_transitions[index] == NO_STATE)
+            {
+                uint32_t next = uint32_t(outputs.size());
+                _transitions[index] = next;
+                _transitions.resize(_transitions.size() + _symbolCount, NO_STATE);
+                outputs.emplace_back();
+            }
+
+            state = _transitions[index];
+        }
+
+        outputs[state].push_back(entry.second);
+    }
+
+    // Add failure transitions breadth first, turning the trie into a DFA.
+    std::vector<uint32_t> failure(outputs.size(), 0);
+    std::deque<uint32_t> queue;
+
+    for (std::size_t symbol = 0; symbol < _symbolCount; ++symbol)
+    {
+        uint32_t& next = _transitions[symbol];
+
+        if (next == NO_STATE)
+        {
+            next = 0;
+        }
+        else
+        {
+            failure[next] = 0;
+            queue.push_back(next);
+        }
+    }
+
+    while (!queue.empty())
+    {
+        uint32_t state = queue.front();
+        queue.pop_front();
+
+        const auto& inherited = outputs[failure[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+
+        for (std::size_t symbol = 0; symbol < _symbolCount; ++symbol)
+        {
+            uint32_t& next = _transitions[state * _symbolCount + symbol];
+            uint32_t fallback = _transitions[failure[state] * _symbolCount + symbol];
+
+            if (next == NO_STATE)
+            {
+                next = fallback;
+            }
+            else
+            {
+                failure[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    // Flatten the outputs.
+    _outputOffsets.assign(outputs.size() + 1, 0);
+    _outputs.clear();
+
+    for (std::size_t state = 0; state < outputs.size(); ++state)
+    {
+        _outputOffsets[state] = uint32_t(_outputs.size());
+        _outputs.insert(_outputs.end(), outputs[state].begin(), outputs[state].end());
+    }
+
+    _outputOffsets[outputs.size()] = uint32_t(_outputs.size());
+}
+
+
+const std::vector<std::string>& TrackMatcher::tracks() const
+{
+    return _tracks;
+}
+
+
+bool TrackMatcher::empty() const
+{
+    return _tracks.empty();
+}
+
+
+std::vector<std::size_t> TrackMatcher::match(const std::string& text) const
+{
+    std::string buffer;
+    appendFolded(text, buffer);
+    return _search(buffer);
+}
+
+
+std::vector<std::size_t> TrackMatcher::match(const Status& status) const
+{
+    OFX_TWITTER_TRACE_SCOPE("TrackMatcher::match");
+
+    if (_terms.empty())
+    {
+        return {};
+    }
+
+    std::string buffer;
+    _appendText(status, buffer, 0);
+    return _search(buffer);
+}
+
+
+void TrackMatcher::annotate(Status& status) const
+{
+    status._matchedTrackRules = match(status);
+}
+
+
+void TrackMatcher::_appendText(const Status& status,
+                               std::string& buffer,
+                               std::size_t depth)
+{
+    // Truncated statuses carry their complete text and entities in the
+    // extended tweet.
+    const Status& source = status.extendedTweet() ? *status.extendedTweet() : status;
+
+    appendFolded(source.fullText().empty() ? source.text() : source.fullText(), buffer);
+
+    for (const auto& entity: source.entities().urlEntities())
+    {
+        appendFolded(entity.expandedURL(), buffer);
+        appendFolded(entity.displayURL(), buffer);
+    }
+
+    for (const auto& entity: source.entities().mediaEntities())
+    {
+        appendFolded(entity.expandedURL(), buffer);
+        appendFolded(entity.displayURL(), buffer);
+    }
+
+    if (depth < MAX_DEPTH)
+    {
+        if (status.retweetedStatus()) _appendText(*status.retweetedStatus(), buffer, depth + 1);
+        if (status.quotedStatus()) _appendText(*status.quotedStatus(), buffer, depth + 1);
+    }
+}
+
+
+std::vector<std::size_t> TrackMatcher::_search(const std::string& buffer) const
+{
+    std::vector<std::size_t> matches;
+
+    if (_terms.empty())
+    {
+        return matches;
+    }
+
+    std::vector<uint8_t> termFound(_terms.size(), 0);
+    std::vector<uint32_t> ruleHits(_ruleTermCounts.size(), 0);
+
+    const char* data = buffer.data();
+    std::size_t size = buffer.size();
+    uint32_t state = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        state = _transitions[state * _symbolCount + _symbols[static_cast<unsigned char>(data[i])]];
+
+        for (uint32_t o = _outputOffsets[state]; o < _outputOffsets[state + 1]; ++o)
+        {
+            uint32_t termId = _outputs[o];
+
+            if (termFound[termId])
+            {
+                continue;
+            }
+
+            const Term& term = _terms[termId];
+            std::size_t start = i + 1 - term.length;
+
+            if (term.checkStart && start > 0 && isTokenChar(data[start - 1]))
+            {
+                continue;
+            }
+
+            if (term.checkEnd && i + 1 < size && isTokenChar(data[i + 1]))
+            {
+                continue;
+            }
+
+            termFound[termId] = 1;
+
+            for (uint32_t rule: term.rules)
+            {
+                if (++ruleHits[rule] == _ruleTermCounts[rule])
+                {
+                    matches.push_back(rule);
+                }
+            }
+        }
+    }
+
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+
+} } // namespace ofx::Twitter
@@ -0,0 +1,511 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/Twitter/TrendAggregator.h"
+#include <algorithm>
+#include <functional>
+#include "ofx/Twitter/Utils.h"
+
+
+namespace ofx {
+namespace Twitter {
+
+
+namespace {
+
+/// The first character of each internal key identifies its TermType.
+const char KEY_PREFIXES[] = { '#', '@', '$', '/' };
+
+const std::size_t TYPE_COUNT = sizeof(KEY_PREFIXES);
+
+inline std::size_t typeIndex(const std::string& key)
+{
+    return std::find(KEY_PREFIXES, KEY_PREFIXES + TYPE_COUNT, key[0]) - KEY_PREFIXES;
+}
+
+inline uint64_t mix(uint64_t x)
+{
+    // The splitmix64 finalizer.
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+}
+
+
+const std::vector<uint64_t> TrendAggregator::DEFAULT_WINDOWS = { 60000, 900000, 3600000 };
+const uint64_t TrendAggregator::DEFAULT_BUCKET_DURATION = 15000;
+const std::size_t TrendAggregator::DEFAULT_SKETCH_WIDTH = 2048;
+const std::size_t TrendAggregator::DEFAULT_SKETCH_DEPTH = 4;
+const std::size_t TrendAggregator::DEFAULT_TOP_CAPACITY = 64;
+
+
+TrendAggregator::TrendAggregator(const std::vector<uint64_t>& windows,
+                                 uint64_t bucketDuration,
+                                 std::size_t sketchWidth,
+                                 std::size_t sketchDepth,
+                                 std::size_t topCapacity):
+    _durations(windows),
+    _bucketDuration(std::max(bucketDuration, uint64_t(1))),
+    _width(std::max(sketchWidth, std::size_t(1))),
+    _depth(std::max(sketchDepth, std::size_t(1))),
+    _capacity(std::max(topCapacity, std::size_t(1)))
+{
+    std::sort(_durations.begin(), _durations.end());
+    _durations.erase(std::unique(_durations.begin(), _durations.end()), _durations.end());
+
+    int64_t ringSize = 1;
+
+    for (auto duration: _durations)
+    {
+        Window window;
+        window.duration = duration;
+        window.bucketCount = std::max(int64_t(1), int64_t((duration + _bucketDuration - 1) / _bucketDuration));
+        window.sketch.assign(_width * _depth, 0);
+        window.top.resize(TYPE_COUNT);
+        _windows.push_back(window);
+        ringSize = std::max(ringSize, window.bucketCount);
+    }
+
+    _buckets.resize(ringSize);
+
+    for (auto& bucket: _buckets)
+    {
+        bucket.sketch.assign(_width * _depth, 0);
+    }
+}
+
+
+void TrendAggregator::add(const Status& status)
+{
+    const Status& source = status.extendedTweet() ? *status.extendedTweet() : status;
+    const Entities& entities = source.entities();
+
+    std::vector<std::string> keys;
+
+    for (const auto& entity: entities.hashTagEntities())
+        keys.push_back(_key(TermType::HASHTAG, entity.hashTag()));
+
+    for (const auto& entity: entities.userMentionEntities())
+        keys.push_back(_key(TermType::MENTION, entity.screenName()));
+
+    for (const auto& entity: entities.symbolEntities())
+        keys.push_back(_key(TermType::SYMBOL, entity.symbol()));
+
+    for (const auto& entity: entities.urlEntities())
+        keys.push_back(_key(TermType::DOMAIN, domain(entity.expandedURL().empty() ? entity.url() : entity.expandedURL())));
+
+    uint64_t timestamp = Utils::timestamp(status);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& key: keys)
+    {
+        if (!key.empty())
+        {
+            _add(key, timestamp, 1);
+        }
+    }
+}
+
+
+void TrendAggregator::add(TermType type,
+                          const std::string& term,
+                          uint64_t timestamp,
+                          uint64_t count)
+{
+    std::string key = _key(type, term);
+
+    if (key.empty())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _add(key, timestamp, count);
+}
+
+
+void TrendAggregator::advance(uint64_t timestamp)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    int64_t index = int64_t(timestamp / _bucketDuration);
+
+    if (_current >= 0 && index > _current)
+    {
+        _advance(index);
+    }
+}
+
+
+uint64_t TrendAggregator::count(TermType type, const std::string& term, uint64_t window) const
+{
+    std::string key = _key(type, term);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    const Window* w = _window(window);
+    return (w && !key.empty()) ? _estimate(*w, key) : 0;
+}
+
+
+std::vector<TrendAggregator::Trend> TrendAggregator::top(uint64_t window,
+                                                         std::size_t size) const
+{
+    return _top(window, size, nullptr);
+}
+
+
+std::vector<TrendAggregator::Trend> TrendAggregator::top(uint64_t window,
+                                                         std::size_t size,
+                                                         TermType type) const
+{
+    return _top(window, size, &type);
+}
+
+
+const std::vector<uint64_t>& TrendAggregator::windows() const
+{
+    return _durations;
+}
+
+
+void TrendAggregator::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (auto& bucket: _buckets)
+    {
+        bucket.index = -1;
+        std::fill(bucket.sketch.begin(), bucket.sketch.end(), 0);
+    }
+
+    for (auto& window: _windows)
+    {
+        window.oldest = 0;
+        std::fill(window.sketch.begin(), window.sketch.end(), 0);
+
+        for (auto& top: window.top)
+        {
+            top.clear();
+        }
+    }
+
+    _current = -1;
+}
+
+
+std::string TrendAggregator::normalize(TermType type, const std::string& term)
+{
+    std::string result = term;
+
+    if (!result.empty() && (result[0] == '#' || result[0] == '@' || result[0] == '$'))
+    {
+        result.erase(0, 1);
+    }
+
+    std::transform(result.begin(), result.end(), result.begin(), [](char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+    });
+
+    if (type == TermType::DOMAIN && result.compare(0, 4, "www.") == 0)
+    {
+        result.erase(0, 4);
+    }
+
+    return result;
+}
+
+
+std::string TrendAggregator::domain(const std::string& url)
+{
+    std::size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+
+    std::size_t end = url.find_first_of("/:?#", start);
+    std::string host = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+    // Remove any user information.
+    std::size_t at = host.rfind('@');
+
+    if (at != std::string::npos)
+    {
+        host.erase(0, at + 1);
+    }
+
+    return host;
+}
+
+
+std::string TrendAggregator::_key(TermType type, const std::string& term)
+{
+    std::string normalized = normalize(type, term);
+
+    if (normalized.empty())
+    {
+        return normalized;
+    }
+
+    return KEY_PREFIXES[static_cast<std::size_t>(type)] + normalized;
+}
+
+
+void TrendAggregator::_add(const std::string& key, uint64_t timestamp, uint64_t count)
+{
+    int64_t index = int64_t(timestamp / _bucketDuration);
+    int64_t ringSize = int64_t(_buckets.size());
+
+    if (_current < 0)
+    {
+        _current = index;
+
+        for (auto& window: _windows)
+        {
+            window.oldest = index - window.bucketCount + 1;
+        }
+    }
+    else if (index > _current)
+    {
+        _advance(index);
+    }
+    else if (index <= _current - ringSize)
+    {
+        // Too old to be in any window.
+        return;
+    }
+
+    Bucket& bucket = _buckets[index % ringSize];
+
+    if (bucket.index != index)
+    {
+        std::fill(bucket.sketch.begin(), bucket.sketch.end(), 0);
+        bucket.index = index;
+    }
+
+    std::vector<std::size_t> offsets;
+    _hash(key, offsets);
+
+    for (auto offset: offsets)
+    {
+        bucket.sketch[offset] += uint32_t(count);
+    }
+
+    for (auto& window: _windows)
+    {
+        if (index >= window.oldest)
+        {
+            for (auto offset: offsets)
+            {
+                window.sketch[offset] += count;
+            }
+
+            _offer(window, key, _estimate(window, offsets));
+        }
+    }
+}
+
+
+void TrendAggregator::_hash(const std::string& key, std::vector<std::size_t>& offsets) const
+{
+    // Double hashing derives all rows from two hash values.
+    uint64_t h1 = mix(std::hash<std::string>()(key));
+    uint64_t h2 = mix(h1) | 1;
+
+    offsets.resize(_depth);
+
+    for (std::size_t row = 0; row < _depth; ++row)
+    {
+        offsets[row] = row * _width + std::size_t((h1 + row * h2) % _width);
+    }
+}
+
+
+void TrendAggregator::_advance(int64_t index)
+{
+    int64_t ringSize = int64_t(_buckets.size());
+
+    // Remove expired buckets from the window sums before their slots are
+    // reused.
+    for (auto& window: _windows)
+    {
+        int64_t oldest = index - window.bucketCount + 1;
+
+        if (oldest - window.oldest >= window.bucketCount)
+        {
+            std::fill(window.sketch.begin(), window.sketch.end(), 0);
+
+            for (auto& top: window.top)
+            {
+                top.clear();
+            }
+        }
+        else if (oldest > window.oldest)
+        {
+            for (int64_t i = window.oldest; i < oldest; ++i)
+            {
+                const Bucket& bucket = _buckets[i % ringSize];
+
+                if (bucket.index == i)
+                {
+                    for (std::size_t j = 0; j < window.sketch.size(); ++j)
+                    {
+                        window.sketch[j] -= bucket.sketch[j];
+                    }
+                }
+            }
+
+            _refresh(window);
+        }
+
+        window.oldest = oldest;
+    }
+
+    _current = index;
+}
+
+
+const TrendAggregator::Window* TrendAggregator::_window(uint64_t duration) const
+{
+    for (const auto& window: _windows)
+    {
+        if (window.duration == duration)
+        {
+            return &window;
+        }
+    }
+
+    return nullptr;
+}
+
+
+uint64_t TrendAggregator::_estimate(const Window& window, const std::string& key) const
+{
+    std::vector<std::size_t> offsets;
+    _hash(key, offsets);
+    return _estimate(window, offsets);
+}
+
+
+uint64_t TrendAggregator::_estimate(const Window& window, const std::vector<std::size_t>& offsets)
+{
+    uint64_t estimate = window.sketch[offsets[0]];
+
+    for (auto offset: offsets)
+    {
+        estimate = std::min(estimate, window.sketch[offset]);
+    }
+
+    return estimate;
+}
+
+
+void TrendAggregator::_offer(Window& window, const std::string& key, uint64_t estimate)
+{
+    auto& top = window.top[typeIndex(key)];
+    auto iter = top.find(key);
+
+    if (iter != top.end())
+    {
+        iter->second = estimate;
+    }
+    else if (top.size() < _capacity)
+    {
+        top.emplace(key, estimate);
+    }
+    else
+    {
+        auto minimum = std::min_element(top.begin(),
+                                        top.end(),
+                                        [](const std::pair<const std::string, uint64_t>& a,
+                                           const std::pair<const std::string, uint64_t>& b)
+                                        {
+                                            return a.second < b.second;
+                                        });
+
+        if (estimate > minimum->second)
+        {
+            top.erase(minimum);
+            top.emplace(key, estimate);
+        }
+    }
+}
+
+
+void TrendAggregator::_refresh(Window& window)
+{
+    for (auto& top: window.top)
+    {
+        for (auto iter = top.begin(); iter != top.end();)
+        {
+            iter->second = _estimate(window, iter->first);
+
+            if (iter->second == 0)
+            {
+                iter = top.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+}
+
+
+std::vector<TrendAggregator::Trend> TrendAggregator::_top(uint64_t duration,
+                                                          std::size_t size,
+                                                          const TermType* type) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::vector<Trend> results;
+
+    const Window* window = _window(duration);
+
+    if (window == nullptr || _current < 0)
+    {
+        return results;
+    }
+
+    for (std::size_t i = 0; i < TYPE_COUNT; ++i)
+    {
+        if (type != nullptr && i != static_cast<std::size_t>(*type))
+        {
+            continue;
+        }
+
+        for (const auto& entry: window->top[i])
+        {
+            Trend trend;
+            trend.type = static_cast<TermType>(i);
+            trend.term = entry.first.substr(1);
+            trend.count = _estimate(*window, entry.first);
+            results.push_back(trend);
+        }
+    }
+
+    std::sort(results.begin(), results.end(), [](const Trend& a, const Trend& b)
+    {
+        return a.count != b.count ? a.count > b.count : a.term < b.term;
+    });
+
+    if (results.size() > size)
+    {
+        results.resize(size);
+    }
+
+    return results;
+}
+
+
+} } // namespace ofx::Twitter
@@ -6,6 +6,7 @@
 
 
 #include "ofx/Twitter/User.h"
+#include "ofx/Twitter/Trace.h"
 #include "ofx/Twitter/Utils.h"
 #include "ofx/Twitter/Status.h"
 #include "ofLog.h"
@@ -62,13 +63,13 @@ bool User::defaultProfileImage() const
 }
 
 
-std::string User::description() const
+const std::string& User::description() const
 {
     return _description;
 }
 
 
-Entities User::entities() const
+const Entities& User::entities() const
 {
     return _entities;
 }
@@ -110,7 +111,7 @@ bool User::isTranslator() const
 }
 
 
-std::string User::language() const
+const std::string& User::language() const
 {
     return _language;
 }
@@ -122,13 +123,13 @@ int64_t User::listedCount() const
 }
 
 
-std::string User::location() const
+const std::string& User::location() const
 {
     return _location;
 }
 
 
-Profile User::profile() const
+const Profile& User::profile() const
 {
     return _profile;
 }
@@ -182,7 +183,7 @@ bool User::verified() const
 }
 
 
-std::vector<std::string> User::withheldInCountries() const
+const std::vector<std::string>& User::withheldInCountries() const
 {
     return _withheldInCountries;
 }
@@ -194,7 +195,7 @@ User::WithheldScope User::withheldScope() const
 }
 
 
-std::string User::translatorType() const
+const std::string& User::translatorType() const
 {
     return _translatorType;
 }
@@ -202,6 +203,8 @@ std::string User::translatorType() const
 
 User User::fromJSON(const ofJson& json)
 {
+    OFX_TWITTER_TRACE_SCOPE("User::fromJSON");
+
     User user;
 
     auto iter = json.cbegin();
@@ -9,6 +9,7 @@
 #include "Poco/DateTimeParser.h"
 #include "Poco/Exception.h"
 #include "ofLog.h"
+#include "ofx/Twitter/Status.h"
 
 
 namespace ofx {
@@ -25,6 +26,13 @@ bool Utils::endsWith(const std::string &str, const std::string &suffix)
 }
 
 
+bool Utils::startsWith(const std::string& str, const std::string& prefix)
+{
+    return str.size() >= prefix.size()
+        && str.compare(0, prefix.size(), prefix) == 0;
+}
+
+
 bool Utils::parse(const std::string& dateString, Poco::DateTime& date)
 {
     try
@@ -41,4 +49,54 @@ bool Utils::parse(const std::string& dateString, Poco::DateTime& date)
 }
 
 
+bool Utils::location(const Status& status, Geo::Coordinate& coordinate)
+{
+    if (status.coordinates())
+    {
+        coordinate = *status.coordinates();
+        return true;
+    }
+    else if (status.place())
+    {
+        coordinate = center(status.place()->boundingBox());
+        return true;
+    }
+
+    return false;
+}
+
+
+Geo::Coordinate Utils::center(const Geo::CoordinateBounds& bounds)
+{
+    double west = bounds.southwest().getLongitude();
+    double east = bounds.northeast().getLongitude();
+
+    if (west > east)
+    {
+        east += 360;
+    }
+
+    double longitude = (west + east) / 2;
+
+    if (longitude > 180)
+    {
+        longitude -= 360;
+    }
+
+    return Geo::Coordinate((bounds.southwest().getLatitude() + bounds.northeast().getLatitude()) / 2,
+                           longitude);
+}
+
+
+uint64_t Utils::timestamp(const Status& status)
+{
+    if (status.timestamp() > 0)
+    {
+        return status.timestamp();
+    }
+
+    return status.createdAt().timestamp().epochMicroseconds() / 1000;
+}
+
+
 } } // namespace ofx::Twitter
@@ -10,17 +10,44 @@
 
 #include "ofxGeo.h"
 #include "ofxHTTP.h"
+#include "ofx/Twitter/BinaryCodec.h"
+#include "ofx/Twitter/BulkDecoder.h"
+#include "ofx/Twitter/ChunkedMediaUpload.h"
+#include "ofx/Twitter/ClientMetrics.h"
+#include "ofx/Twitter/ColumnarBatch.h"
+#include "ofx/Twitter/CredentialPool.h"
+#include "ofx/Twitter/DirectStreamingClient.h"
 #include "ofx/Twitter/Entities.h"
+#include "ofx/Twitter/FilterRuleManager.h"
+#include "ofx/Twitter/GeoIndex.h"
+#include "ofx/Twitter/ImageEncoder.h"
+#include "ofx/Twitter/LocationMatcher.h"
+#include "ofx/Twitter/Lookup.h"
+#include "ofx/Twitter/LookupBatcher.h"
+#include "ofx/Twitter/MediaCache.h"
+#include "ofx/Twitter/MediaDecoder.h"
+#include "ofx/Twitter/MediaFetcher.h"
 #include "ofx/Twitter/MediaUpload.h"
+#include "ofx/Twitter/PixelPool.h"
+#include "ofx/Twitter/PostingQueue.h"
 #include "ofx/Twitter/Place.h"
 #include "ofx/Twitter/Profile.h"
 #include "ofx/Twitter/Notices.h"
+#include "ofx/Twitter/OAuth10Signer.h"
 #include "ofx/Twitter/RESTClient.h"
 #include "ofx/Twitter/Search.h"
 #include "ofx/Twitter/Status.h"
 #include "ofx/Twitter/SearchClient.h"
+#include "ofx/Twitter/ShardedStreamingClient.h"
+#include "ofx/Twitter/StatusBatch.h"
+#include "ofx/Twitter/StatusPoster.h"
 #include "ofx/Twitter/StatusUpdate.h"
+#include "ofx/Twitter/StreamMessage.h"
 #include "ofx/Twitter/StreamingClient.h"
+#include "ofx/Twitter/ThreadPool.h"
+#include "ofx/Twitter/Trace.h"
+#include "ofx/Twitter/TrackMatcher.h"
+#include "ofx/Twitter/TrendAggregator.h"
 #include "ofx/Twitter/User.h"
 
 
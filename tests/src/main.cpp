@@ -0,0 +1,1767 @@
+//
+// Copyright (c) 2009 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofAppNoWindow.h"
+#include "ofAppRunner.h"
+#include "ofxTwitter.h"
+#include "ofxUnitTests.h"
+
+
+/// \brief Writes BinaryCodec buffers by hand so every field can be set.
+struct CodecWriter
+{
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            body.push_back(char(value | 0x80));
+            value >>= 7;
+        }
+
+        body.push_back(char(value));
+    }
+
+    void integer(int64_t value)
+    {
+        varint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+    }
+
+    void real(double value)
+    {
+        char bytes[sizeof(double)];
+        std::memcpy(bytes, &value, sizeof(double));
+        body.append(bytes, sizeof(double));
+    }
+
+    void string(const std::string& value)
+    {
+        auto result = indices.insert(std::make_pair(value, table.size() + 1));
+        if (result.second) table.push_back(value);
+        varint(result.first->second);
+    }
+
+    /// \brief Write a presence bitmap with the first \p count bits set.
+    void all(int count)
+    {
+        varint((uint64_t(1) << count) - 1);
+    }
+
+    std::string finish(uint8_t kind) const
+    {
+        CodecWriter header;
+        header.body = ofxTwitter::BinaryCodec::MAGIC;
+        header.varint(ofxTwitter::BinaryCodec::VERSION);
+        header.body.push_back(char(kind));
+        header.varint(table.size());
+
+        for (const auto& str: table)
+        {
+            header.varint(str.size());
+            header.body.append(str);
+        }
+
+        return header.body + body;
+    }
+
+    std::string body;
+    std::map<std::string, uint64_t> indices;
+    std::vector<std::string> table;
+};
+
+
+class ofApp: public ofxUnitTestsApp
+{
+public:
+    void run() override
+    {
+        testColumnarBatch();
+        testStatusBatch();
+        testMediaCache();
+        testMediaFetcher();
+        testChunkedMediaUpload();
+        testMediaUploadRequest();
+        testPostingQueue();
+        testOAuth10Signer();
+        testFilterRuleManager();
+        testStreamMessage();
+        testBulkDecoder();
+        testBinaryCodec();
+        testShardedStreamingClient();
+        testRESTClient();
+        testLookupBatcher();
+        testCredentialPool();
+        testImageEncoder();
+        testMediaUploadImage();
+        testTracer();
+        testTrendAggregator();
+        testTrackMatcher();
+        testGeoIndex();
+        testLocationMatcher();
+        testPixelPool();
+        testMediaDecoder();
+        testStatusPoster();
+    }
+
+    void onPosted(const ofxTwitter::PostingQueue::Result& result)
+    {
+        posted.push_back(result);
+    }
+
+    void onFailed(const ofxTwitter::PostingQueue::Result& result)
+    {
+        failed.push_back(result);
+    }
+
+    void testColumnarBatch()
+    {
+        // Ids and counts that are not present are -1 in Status and must be
+        // exported as null values rather than as -1.
+        auto status = ofxTwitter::Status::fromJSON(ofJson::parse(R"({
+            "created_at": "Wed Aug 27 13:08:45 +0000 2008",
+            "id": 10,
+            "id_str": "10",
+            "text": "Not a reply.",
+            "in_reply_to_status_id": null
+        })"));
+
+        auto reply = ofxTwitter::Status::fromJSON(ofJson::parse(R"({
+            "created_at": "Wed Aug 27 13:08:45 +0000 2008",
+            "id": 11,
+            "id_str": "11",
+            "text": "A reply.",
+            "in_reply_to_status_id": 10,
+            "retweet_count": 0,
+            "favorite_count": 3
+        })"));
+
+        ofxTwitter::ColumnarBatch batch;
+        batch.append(status);
+        batch.append(reply);
+
+        ofxTestEq(batch.size(), std::size_t(2), "ColumnarBatch rows");
+        ofxTest(!batch.inReplyToStatusId.isValid(0), "Non-reply has a null in_reply_to_status_id.");
+        ofxTest(!batch.retweetCount.isValid(0), "Missing retweet_count is null.");
+        ofxTest(!batch.favoriteCount.isValid(0), "Missing favorite_count is null.");
+        ofxTest(!batch.quoteCount.isValid(0), "Missing quote_count is null.");
+        ofxTest(!batch.replyCount.isValid(0), "Missing reply_count is null.");
+
+        ofxTest(batch.inReplyToStatusId.isValid(1), "Reply has an in_reply_to_status_id.");
+        ofxTestEq(batch.inReplyToStatusId.values[1], int64_t(10), "in_reply_to_status_id value");
+        ofxTest(batch.retweetCount.isValid(1), "A zero retweet_count is valid.");
+        ofxTestEq(batch.retweetCount.values[1], int64_t(0), "retweet_count value");
+        ofxTestEq(batch.favoriteCount.values[1], int64_t(3), "favorite_count value");
+        ofxTest(!batch.quoteCount.isValid(1), "Missing quote_count is null.");
+    }
+
+    void testStatusBatch()
+    {
+        ofJson json = ofJson::parse(R"({
+            "search_metadata": {},
+            "statuses": [
+                { "id": 1, "id_str": "1", "text": "a", "favorite_count": 5, "retweet_count": 1 },
+                { "id": 2, "id_str": "2", "text": "b", "favorite_count": 1 },
+                { "id": 3, "id_str": "3", "text": "c", "favorite_count": 9 },
+                { "id": 4, "id_str": "4", "text": "d", "favorite_count": 7, "retweet_count": 4 }
+            ]
+        })");
+
+        // Search statuses are decoded straight into the batch.
+        ofxTwitter::StatusBatch batch;
+        auto response = ofxTwitter::SearchResponse::fromJSON(json, batch, 1);
+
+        ofxTest(response.statuses().empty(), "Batched statuses are not kept in the response.");
+        ofxTestEq(batch.size(), std::size_t(3), "Statuses at or before since_id are skipped.");
+        ofxTestEq(batch.text(0), std::string("b"), "Cold fields are kept.");
+
+        auto rows = batch.sortedRows(ofxTwitter::StatusBatch::Key::FAVORITE_COUNT);
+        ofxTest(rows == std::vector<std::size_t>({ 1, 2, 0 }), "Rows sorted by favorite count.");
+
+        rows = batch.sortedRows(ofxTwitter::StatusBatch::Key::ENGAGEMENT, false);
+        ofxTest(rows == std::vector<std::size_t>({ 0, 1, 2 }), "Rows sorted by engagement.");
+
+        rows = batch.top(ofxTwitter::StatusBatch::Key::ID, 2);
+        ofxTest(rows == std::vector<std::size_t>({ 2, 1 }), "Top rows by id.");
+    }
+
+    void testMediaCache()
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "ofxTwitter_tests" / "media_cache";
+        std::filesystem::remove_all(directory);
+
+        std::string small(100, 'a');
+        std::string large(1000, 'b');
+
+        {
+            ofxTwitter::MediaCache cache(directory, 500);
+
+            auto path = cache.put("small", ofBuffer(small.data(), small.size()), ".jpg");
+            ofxTest(std::filesystem::exists(path), "A file within the limit is cached.");
+
+            path = cache.put("large", ofBuffer(large.data(), large.size()), ".jpg");
+            ofxTest(path.empty(), "A file larger than the limit is refused.");
+            ofxTestEq(cache.count(), std::size_t(1), "The refused file is not counted.");
+
+            std::filesystem::path cached;
+            ofxTest(cache.get("small", cached), "Smaller files are kept.");
+        }
+
+        // Simulate a crash: a file written without its index entry and a
+        // leftover temporary file.
+        std::filesystem::remove(directory / "index.json");
+        std::string orphan(450, 'c');
+        ofBufferToFile(directory / (std::string(40, 'f') + ".png"), ofBuffer(orphan.data(), orphan.size()));
+        ofBufferToFile(directory / (std::string(40, 'e') + ".png.tmp"), ofBuffer(orphan.data(), orphan.size()));
+
+        {
+            ofxTwitter::MediaCache cache(directory, 500);
+
+            ofxTestEq(cache.count(), std::size_t(1), "Unindexed files count towards the limit.");
+            ofxTest(cache.size() <= 500, "The rebuilt cache is within the limit.");
+            ofxTest(!std::filesystem::exists(directory / (std::string(40, 'e') + ".png.tmp")), "Temporary files are removed.");
+        }
+    }
+
+    void testMediaFetcher()
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "ofxTwitter_tests" / "media_fetcher";
+        std::filesystem::remove_all(directory);
+
+        // A local stand-in for the media host.
+        std::atomic<int> downloads(0);
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+
+        auto transport = [&](const std::string& url)
+        {
+            ++downloads;
+            released.wait();
+            return ofBuffer(url.data(), url.size());
+        };
+
+        ofxTwitter::MediaFetcher fetcher(directory, 4, transport);
+
+        // The same media and size is shared across URLs.
+        auto first = fetcher.fetch(7, "https://pbs.twimg.com/media/abc.jpg:small");
+        auto second = fetcher.fetch(7, "http://pbs.twimg.com/media/abc.jpg:small");
+        auto other = fetcher.fetch(7, "https://pbs.twimg.com/media/abc.jpg:large");
+
+        release.set_value();
+
+        auto result = first.get();
+        second.get();
+        other.get();
+
+        ofxTest(result.isSuccess(), "Media is fetched.");
+        ofxTestEq(downloads.load(), 2, "Downloads are shared by media id and size.");
+        ofxTestEq(result.path.extension().string(), std::string(".jpg"), "The size variant is not part of the extension.");
+    }
+
+    void testChunkedMediaUpload()
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "ofxTwitter_tests" / "chunked_media_upload";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory / "media");
+
+        std::filesystem::path media = directory / "media" / "video.mp4";
+        std::filesystem::path stateDirectory = directory / "state";
+
+        {
+            std::ofstream ostr(media.string(), std::ios::binary);
+            ostr << "01234567";
+        }
+
+        // A local stand-in for the upload endpoint that fails the second
+        // segment until it is allowed to succeed.
+        std::atomic<bool> failing(true);
+        std::atomic<int> appends(0);
+
+        auto transport = [&](const Poco::Net::NameValueCollection& fields, const char*, std::size_t)
+        {
+            std::string command = fields.get("command");
+
+            if (command == "APPEND")
+            {
+                ++appends;
+
+                if (failing && fields.get("segment_index") == "1")
+                {
+                    throw Poco::IOException("Segment failed.");
+                }
+
+                return ofJson();
+            }
+
+            return ofJson::parse(R"({
+                "media_id": 5,
+                "media_key": "7_5",
+                "expires_after_secs": 86400,
+                "video": { "video_type": "video/mp4" }
+            })");
+        };
+
+        ofxTwitter::ChunkedMediaUpload upload(transport);
+        upload.setChunkSize(4);
+        upload.setMaxInFlight(1);
+        upload.setMaxRetries(0);
+
+        ofxTest(!upload.isResumable(), "Resumable uploads are off by default.");
+
+        bool failed = false;
+
+        try { upload.upload(media); } catch (const Poco::Exception&) { failed = true; }
+
+        ofxTest(failed, "A failed segment fails the upload.");
+        ofxTest(!std::filesystem::exists(upload.statePath(media)), "No state is written by default.");
+
+        upload.setResumable(true);
+        upload.setStateDirectory(stateDirectory);
+
+        failed = false;
+
+        try { upload.upload(media); } catch (const Poco::Exception&) { failed = true; }
+
+        ofxTest(failed, "A failed segment fails the resumable upload.");
+        ofxTest(std::filesystem::exists(upload.statePath(media)), "The state is written to the state directory.");
+        ofxTestEq(upload.statePath(media).parent_path().string(), stateDirectory.string(), "The state path is in the state directory.");
+        ofxTestEq(int(std::distance(std::filesystem::directory_iterator(media.parent_path()), std::filesystem::directory_iterator())), 1, "Nothing is written next to the media.");
+
+        failing = false;
+        appends = 0;
+
+        auto response = upload.upload(media);
+
+        ofxTestEq(appends.load(), 1, "Only the failed segment is sent again.");
+        ofxTest(!std::filesystem::exists(upload.statePath(media)), "The state is removed after the upload.");
+        ofxTestEq(response.mediaKey(), std::string("7_5"), "The media key is parsed.");
+        ofxTestEq(response.mediaType(), std::string("video/mp4"), "The video type is parsed.");
+    }
+
+    /// \brief Exposes the request body of a MediaUploadRequest.
+    class TestMediaUploadRequest: public ofxTwitter::MediaUploadRequest
+    {
+    public:
+        std::string body()
+        {
+            prepareRequest();
+            std::ostringstream ostr;
+            writeRequestBody(ostr);
+            return ostr.str();
+        }
+    };
+
+    void testMediaUploadRequest()
+    {
+        auto media = std::make_shared<ofBuffer>();
+        media->set("IMAGE", 5);
+
+        TestMediaUploadRequest request;
+        request.addFormField("media_category", "tweet_image");
+        request.addFormField("additional_owners", "12,34");
+        request.setMedia(media, "image/png");
+
+        std::string body = request.body();
+
+        std::size_t category = body.find("name=\"media_category\"\r\n\r\ntweet_image\r\n");
+        std::size_t owners = body.find("name=\"additional_owners\"\r\n\r\n12,34\r\n");
+        std::size_t data = body.find("IMAGE");
+
+        ofxTest(category != std::string::npos, "media_category is sent with the media.");
+        ofxTest(owners != std::string::npos, "additional_owners is sent with the media.");
+        ofxTest(category < data && owners < data, "Form fields precede the media.");
+        ofxTestEq(uint64_t(request.getContentLength()), uint64_t(body.size()), "The content length includes the form fields.");
+    }
+
+    /// \returns true if the condition became true within the timeout.
+    bool waitFor(std::function<bool()> condition, uint64_t timeout = 5000)
+    {
+        uint64_t start = ofGetElapsedTimeMillis();
+
+        while (!condition())
+        {
+            if (ofGetElapsedTimeMillis() > start + timeout)
+            {
+                return false;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        return true;
+    }
+
+    void testPostingQueue()
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "ofxTwitter_tests" / "posting_queue";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+
+        std::filesystem::path media = directory / "image.png";
+
+        {
+            std::ofstream ostr(media.string(), std::ios::binary);
+            ostr << "IMAGE";
+        }
+
+        // Local stand-ins for the status and upload endpoints.
+        std::atomic<int> updates(0);
+        std::atomic<int> uploads(0);
+        std::function<ofxTwitter::PostingQueue::Response()> respond;
+
+        auto transport = [&](ofxTwitter::StatusUpdateRequest&)
+        {
+            ++updates;
+            return respond();
+        };
+
+        auto uploadTransport = [&](const Poco::Net::NameValueCollection& fields, const char*, std::size_t)
+        {
+            if (fields.get("command") == "INIT") ++uploads;
+            return ofJson::parse(R"({ "media_id": 5 })");
+        };
+
+        auto success = []()
+        {
+            ofxTwitter::PostingQueue::Response response;
+            response.status = 200;
+            response.json = ofJson::parse(R"({
+                "created_at": "Wed Aug 27 13:08:45 +0000 2008",
+                "id": 1,
+                "id_str": "1",
+                "text": "Posted."
+            })");
+            return response;
+        };
+
+        {
+            ofxTwitter::PostingQueue queue(transport, uploadTransport, "", false);
+            queue.registerPostingEvents(this);
+
+            // Missing media is not retried.
+            respond = success;
+            uint64_t id = queue.post("Missing media.", { directory / "missing.png" });
+
+            ofxTest(waitFor([&]() { return queue.pending() == 0; }), "A post with missing media is finished.");
+            queue.syncEvents();
+            ofxTestEq(failed.size(), std::size_t(1), "A post with missing media fails.");
+            ofxTestEq(failed.back().id, id, "The failed post is reported.");
+            ofxTestEq(failed.back().attempts, std::size_t(1), "A post with missing media is not retried.");
+
+            // A post that is backing off can be cancelled.
+            respond = []() -> ofxTwitter::PostingQueue::Response
+            {
+                throw Poco::IOException("Network error.");
+            };
+
+            id = queue.post("Backing off.");
+
+            ofxTest(waitFor([&]() { return queue.cancel(id); }), "A post that is backing off is cancelled.");
+            ofxTestEq(queue.pending(), std::size_t(0), "The cancelled post is removed.");
+
+            // Media ids that Twitter rejects are uploaded again.
+            updates = 0;
+            uploads = 0;
+
+            respond = [&]()
+            {
+                if (updates > 1) return success();
+
+                ofxTwitter::PostingQueue::Response response;
+                response.status = 400;
+                response.json = ofJson::parse(R"({ "errors": [ { "code": 324, "message": "The validation of media ids failed." } ] })");
+                return response;
+            };
+
+            queue.post("Rejected media ids.", { media });
+
+            ofxTest(waitFor([&]() { return queue.pending() == 0; }), "A post with rejected media ids is finished.");
+            queue.syncEvents();
+            ofxTestEq(posted.size(), std::size_t(1), "A post with rejected media ids is posted.");
+            ofxTestEq(uploads.load(), 2, "Rejected media ids are uploaded again.");
+        }
+
+        // Persisted media ids are reused until they expire.
+        std::filesystem::path queuePath = directory / "queue.json";
+        uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        ofJson saved;
+        saved["next_id"] = 3;
+        saved["posts"] = {
+            { { "id", 1 }, { "parameters", { { "status", "Expired." } } }, { "media", { media.string() } }, { "media_ids", { 5 } }, { "media_uploaded_at", now - 24 * 60 * 60 * 1000 } },
+            { { "id", 2 }, { "parameters", { { "status", "Fresh." } } }, { "media", { media.string() } }, { "media_ids", { 5 } }, { "media_uploaded_at", now } }
+        };
+
+        {
+            std::ofstream ostr(queuePath.string(), std::ios::binary);
+            ostr << saved.dump();
+        }
+
+        updates = 0;
+        uploads = 0;
+        respond = success;
+
+        {
+            ofxTwitter::PostingQueue queue(transport, uploadTransport, queuePath, false);
+
+            ofxTest(waitFor([&]() { return queue.pending() == 0; }), "Restored posts are finished.");
+            ofxTestEq(updates.load(), 2, "Restored posts are sent.");
+            ofxTestEq(uploads.load(), 1, "Only expired media ids are uploaded again.");
+        }
+    }
+
+    /// \returns the lowercase hex encoding of a digest.
+    static std::string hex(const std::array<uint8_t, 20>& digest)
+    {
+        std::ostringstream ostr;
+
+        for (auto byte: digest)
+        {
+            ostr << std::hex << std::setw(2) << std::setfill('0') << int(byte);
+        }
+
+        return ostr.str();
+    }
+
+    /// \returns the value of a parameter in an Authorization header.
+    static std::string authorizationParameter(const std::string& header, const std::string& name)
+    {
+        std::size_t start = header.find(name + "=\"");
+
+        if (start == std::string::npos)
+        {
+            return "";
+        }
+
+        start += name.size() + 2;
+        return header.substr(start, header.find('"', start) - start);
+    }
+
+    void testOAuth10Signer()
+    {
+        using Signer = ofxTwitter::OAuth10Signer;
+
+        // RFC 3174 section 7.3.
+        std::string million(1000000, 'a');
+        std::string eighty;
+        for (int i = 0; i < 10; ++i) eighty += "01234567012345670123456701234567" "01234567012345670123456701234567";
+
+        ofxTestEq(hex(Signer::sha1("abc")), std::string("a9993e364706816aba3e25717850c26c9cd0d89d"), "SHA-1 test 1.");
+        ofxTestEq(hex(Signer::sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")), std::string("84983e441c3bd26ebaae4aa1f95129e5e54670f1"), "SHA-1 test 2.");
+        ofxTestEq(hex(Signer::sha1(million)), std::string("34aa973cd4c4daa4f61eeb2bdbad27316534016f"), "SHA-1 test 3.");
+        ofxTestEq(hex(Signer::sha1(eighty)), std::string("dea356a2cddd90c7a7ecedc5ebb563934f460452"), "SHA-1 test 4.");
+
+        // RFC 2202 section 3.
+        std::string key4;
+        for (char c = 0x01; c <= 0x19; ++c) key4 += c;
+
+        ofxTestEq(hex(Signer::hmacSHA1(std::string(20, '\x0b'), "Hi There")), std::string("b617318655057264e28bc0b6fb378c8ef146be00"), "HMAC-SHA1 test 1.");
+        ofxTestEq(hex(Signer::hmacSHA1("Jefe", "what do ya want for nothing?")), std::string("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"), "HMAC-SHA1 test 2.");
+        ofxTestEq(hex(Signer::hmacSHA1(std::string(20, '\xaa'), std::string(50, '\xdd'))), std::string("125d7342b9ac11cd91a39af48aa17b4f63f175d3"), "HMAC-SHA1 test 3.");
+        ofxTestEq(hex(Signer::hmacSHA1(key4, std::string(50, '\xcd'))), std::string("4c9007f4026250c6bc8414f9bf50c86c2d7235da"), "HMAC-SHA1 test 4.");
+        ofxTestEq(hex(Signer::hmacSHA1(std::string(20, '\x0c'), "Test With Truncation")), std::string("4c1a03424b55e07fe7f27be1d58bb9324a9a5a04"), "HMAC-SHA1 test 5.");
+        ofxTestEq(hex(Signer::hmacSHA1(std::string(80, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First")), std::string("aa4ae5e15272d00e95705637ce8a3b55ed402112"), "HMAC-SHA1 test 6.");
+        ofxTestEq(hex(Signer::hmacSHA1(std::string(80, '\xaa'), "Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data")), std::string("e8e99d0f45237d786d6bbaa7965c7808bbff1a91"), "HMAC-SHA1 test 7.");
+
+        // OAuth 1.0a section 3.4.1.2.
+        ofxTestEq(Signer::baseURI("HTTP://EXAMPLE.COM:80/r%20v/X?id=123"), std::string("http://example.com/r%20v/X"), "The base URI is normalized.");
+        ofxTestEq(Signer::baseURI("https://www.example.net:8080/?q=1"), std::string("https://www.example.net:8080/"), "Other ports are kept.");
+        ofxTestEq(Signer::baseURI("https://api.twitter.com:443"), std::string("https://api.twitter.com/"), "The default port is removed.");
+
+        // The example from Twitter's "Creating a signature" guide, with the
+        // query parameter in the URL and the status in the form.
+        ofxHTTP::OAuth10Credentials credentials("xvz1evFS4wEEPTGEFPHBog",
+                                                "kAcSOqF21Fu85e7zjz7ZN2U4ZRhfV3WpwPAoE3Z7kBw",
+                                                "370773112-GmHxMAgYyLbNEtIKZeRNFsMKPR9EyMZeS9weJAEb",
+                                                "LswwdoUaIvS8ltyTt5jkRh4J50vUPVVHtR2YPi5kE");
+
+        Signer signer(credentials);
+
+        std::string url = "https://api.twitter.com/1.1/statuses/update.json?include_entities=true";
+
+        Signer::EncodedParameters form;
+        form.add("status", "Hello Ladies + Gentlemen, a signed OAuth request!");
+
+        std::string header = signer.authorization("POST", url, form, "kYjzVBB8Y0ZFabxSWbWovY3uYSQ2pTgmZeNu2VS4cg", 1318622958);
+
+        ofxTestEq(authorizationParameter(header, "oauth_signature"), std::string("hCtSmYh%2BiHYCEqBWrE7C7hYmtUk%3D"), "The known signature is reproduced.");
+
+        // Requests sign the URL-encoded form fields they report.
+        ofxTwitter::StatusUpdateRequest request("Hello Ladies + Gentlemen, a signed OAuth request!");
+        signer.sign(request, request.formParameters());
+
+        std::string nonce = authorizationParameter(request.get("Authorization"), "oauth_nonce");
+        uint64_t timestamp = std::stoull(authorizationParameter(request.get("Authorization"), "oauth_timestamp"));
+
+        ofxTestEq(request.get("Authorization"), signer.authorization("POST", ofxTwitter::StatusUpdateRequest::RESOURCE_URL, form, nonce, timestamp), "Form fields are signed.");
+
+        // Multipart form fields are not.
+        ofxTwitter::MediaUploadRequest upload;
+        upload.addFormField("media_category", "tweet_image");
+        upload.setMedia(std::make_shared<ofBuffer>(), "image/png");
+        signer.sign(upload, upload.formParameters());
+
+        nonce = authorizationParameter(upload.get("Authorization"), "oauth_nonce");
+        timestamp = std::stoull(authorizationParameter(upload.get("Authorization"), "oauth_timestamp"));
+
+        ofxTestEq(upload.get("Authorization"), signer.authorization("POST", ofxTwitter::MediaUploadRequest::RESOURCE_URL, Signer::EncodedParameters(), nonce, timestamp), "Multipart form fields are not signed.");
+    }
+
+    void testFilterRuleManager()
+    {
+        // A local stand-in for a quiet stream, which only sends keep-alives.
+        std::atomic<int> opened(0);
+
+        auto transport = [&](ofxHTTP::Request&)
+        {
+            ++opened;
+            return std::unique_ptr<std::istream>(new std::istringstream("\r\n\r\n"));
+        };
+
+        ofxHTTP::OAuth10Credentials credentials("consumer", "consumer secret", "access", "access secret");
+        ofxHTTP::OAuth10Credentials standbyCredentials("consumer", "consumer secret", "standby", "standby secret");
+
+        {
+            ofxTwitter::FilterRuleManager manager(credentials, standbyCredentials, nullptr, 10);
+            manager.setTransport(transport);
+
+            manager.addTrack("quiet");
+            ofxTest(waitFor([&]() { return opened == 1; }), "The first stream is opened.");
+
+            manager.addTrack("quieter");
+            ofxTest(waitFor([&]() { return manager.switchCount() == 1; }), "A quiet stream takes over once it is connected.");
+            ofxTestEq(opened.load(), 2, "The new stream was opened once.");
+            ofxTest(!manager.isSwitching(), "No stream is waiting to take over.");
+            ofxTestEq(manager.activeQuery().get("track", ""), std::string("quiet,quieter"), "The active stream has the new rules.");
+        }
+
+        opened = 0;
+
+        {
+            ofxTwitter::FilterRuleManager manager(credentials, nullptr, 10);
+            manager.setTransport(transport);
+
+            manager.addTrack("quiet");
+            ofxTest(waitFor([&]() { return opened == 1; }), "The first stream is opened.");
+
+            manager.addTrack("quieter");
+            ofxTest(waitFor([&]() { return manager.activeQuery().get("track", "") == "quiet,quieter"; }), "A single account switches without an overlap.");
+            ofxTestEq(opened.load(), 2, "The new stream was opened once.");
+            ofxTest(!manager.isSwitching(), "No stream waits to take over without a second account.");
+        }
+    }
+
+    void testStreamMessage()
+    {
+        using Message = ofxTwitter::StreamMessage;
+
+        ofxTest(Message::classify(std::string("\r")) == Message::Type::KEEP_ALIVE, "A blank line is a keep-alive.");
+        ofxTest(Message::classify(std::string(R"({"limit":{"track":12}})")) == Message::Type::LIMIT_NOTICE, "A limit notice is classified by its key.");
+        ofxTest(Message::classify(std::string(R"({"created_at":"Wed Aug 27 13:08:45 +0000 2008","text":"A"})")) == Message::Type::STATUS, "A status is classified by its first key.");
+        ofxTest(Message::classify(ofJson::parse(R"({"created_at":"Wed Aug 27 13:08:45 +0000 2008","event":"follow"})")) == Message::Type::UNKNOWN, "An object without text is not a status.");
+
+        std::string limit = R"( {"limit": {"track": 12, "note": "} \"{"}} )";
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        ofxTest(Message::payload(limit, begin, end), "The payload of a notice is found.");
+        ofxTestEq(ofJson::parse(limit.substr(begin, end - begin))["track"].get<int>(), 12, "The payload is parsed on its own.");
+        ofxTest(!Message::payload(R"({"limit":{"track":12},"extra":1})", begin, end), "A message with more keys has no payload.");
+        ofxTest(!Message::payload(R"({"limit":{"track":12)", begin, end), "A truncated message has no payload.");
+
+        struct Sink: public ofxTwitter::StreamingSink
+        {
+            void onStatus(const ofxTwitter::Status&) override { ++statuses; }
+            void onLimitNotice(const ofxTwitter::LimitNotice& notice) override { track = notice.track(); }
+            void onMessage(const ofJson&) override { ++messages; }
+            bool wantsMessages() const override { return raw; }
+
+            std::atomic<int> statuses{0};
+            std::atomic<uint64_t> track{0};
+            std::atomic<int> messages{0};
+            bool raw = false;
+        };
+
+        auto transport = [](ofxHTTP::Request&)
+        {
+            return std::unique_ptr<std::istream>(new std::istringstream(
+                "{\"limit\":{\"track\":12}}\r\n"
+                "{\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\",\"event\":\"follow\"}\r\n"
+                "{\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\",\"id\":1,\"id_str\":\"1\",\"text\":\"A\"}\r\n"));
+        };
+
+        Sink sink;
+        ofxTwitter::DirectStreamingClient client(&sink);
+        client.setTransport(transport);
+
+        // The status is the last message, so the others were delivered once
+        // it arrives.
+        client.sample();
+        ofxTest(waitFor([&]() { return sink.statuses == 1; }), "Only the object with text is a status.");
+        ofxTestEq(sink.track.load(), uint64_t(12), "The limit notice is decoded from its payload.");
+        ofxTestEq(sink.messages.load(), 0, "No raw messages are built without a consumer.");
+
+        sink.raw = true;
+        client.sample();
+        ofxTest(waitFor([&]() { return sink.statuses == 2; }), "The stream is read again.");
+        ofxTestEq(sink.messages.load(), 3, "Raw messages are built for a consumer.");
+    }
+
+    void testBulkDecoder()
+    {
+        std::string data =
+            "{\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\",\"id\":1,\"id_str\":\"1\",\"text\":\"A\"}\n"
+            "{\"limit\":{\"track\":12}}\n"
+            "{\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\",\"event\":\"follow\"}\n"
+            "{\"created_at\":\n"
+            "{\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\",\"id\":2,\"id_str\":\"2\",\"text\":\"B\"}\n";
+
+        ofxTwitter::BulkDecoder decoder;
+
+        std::vector<ofxTwitter::Status> statuses = decoder.decode(data);
+        ofxTestEq(statuses.size(), std::size_t(2), "Only statuses are decoded.");
+        ofxTestEq(decoder.errorCount(), std::size_t(1), "The truncated line is counted.");
+
+        bool thrown = false;
+
+        try
+        {
+            decoder.decode(data.data(), data.size(), [](const ofxTwitter::Status&)
+            {
+                throw std::runtime_error("Sink failed.");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+
+        ofxTest(thrown, "Exceptions from the sink reach the caller.");
+        ofxTestEq(decoder.errorCount(), std::size_t(0), "Exceptions from the sink are not decode errors.");
+    }
+
+    void testBinaryCodec()
+    {
+        // Every presence bit of Status, User, Entities, Place and MediaEntity
+        // is set with a non-default value, so a value decoded from these
+        // bytes must serialize back to exactly the same bytes.
+        auto roundTrip = [](const std::string& bytes, auto value)
+        {
+            return ofxTwitter::BinaryCodec::deserialize(bytes, value)
+                && ofxTwitter::BinaryCodec::serialize(value) == bytes;
+        };
+
+        CodecWriter entities;
+        writeCodecEntities(entities);
+        ofxTest(roundTrip(entities.finish(4), ofxTwitter::Entities()), "Entities round trip.");
+
+        CodecWriter place;
+        writeCodecPlace(place);
+        ofxTest(roundTrip(place.finish(3), ofxTwitter::Place()), "Place round trips.");
+
+        CodecWriter user;
+        writeCodecUser(user);
+        ofxTest(roundTrip(user.finish(2), ofxTwitter::User()), "User round trips.");
+
+        CodecWriter writer;
+        writeCodecStatus(writer);
+        std::string bytes = writer.finish(1);
+        ofxTest(roundTrip(bytes, ofxTwitter::Status()), "Status round trips.");
+
+        ofxTwitter::Status status;
+        ofxTwitter::BinaryCodec::deserialize(bytes, status);
+        ofxTestEq(status.id(), int64_t(100), "The id is decoded.");
+        ofxTest(status.user() && status.user()->screenName() == "screen_name", "The user is decoded.");
+        ofxTest(status.place() && status.place()->fullName() == "Manhattan, NY", "The place is decoded.");
+        ofxTestEq(status.entities().mediaEntities().size(), std::size_t(1), "The media is decoded.");
+        ofxTestEq(status.entities().mediaEntities()[0].sizes().size(), std::size_t(2), "The media sizes are decoded.");
+
+        // Malformed input is rejected rather than read past the end.
+        ofxTest(!ofxTwitter::BinaryCodec::deserialize(bytes.substr(0, bytes.size() / 2), status), "A truncated buffer is rejected.");
+        ofxTest(!ofxTwitter::BinaryCodec::deserialize(bytes.substr(0, bytes.size() - 1), status), "A buffer missing its last byte is rejected.");
+        ofxTestEq(status.id(), int64_t(100), "A rejected buffer leaves the value unchanged.");
+
+        CodecWriter badIndex;
+        badIndex.varint(1);
+        badIndex.varint(1);
+        badIndex.varint(0);
+        badIndex.varint(3);
+        badIndex.varint(1);
+        ofxTwitter::Entities badEntities;
+        ofxTest(!ofxTwitter::BinaryCodec::deserialize(badIndex.finish(4), badEntities), "A string index past the table is rejected.");
+
+        // Statuses nested through retweeted_status, 32 deep and then 33 deep.
+        auto nested = [](int depth)
+        {
+            CodecWriter w;
+            for (int i = 1; i < depth; ++i) w.varint(uint64_t(1) << 28);
+            w.varint(0);
+            return w.finish(1);
+        };
+
+        ofxTest(ofxTwitter::BinaryCodec::deserialize(nested(32), status), "Nesting up to the maximum depth is accepted.");
+        ofxTest(!ofxTwitter::BinaryCodec::deserialize(nested(33), status), "Nesting past the maximum depth is rejected.");
+    }
+
+    static void writeCodecMinimalStatus(CodecWriter& w)
+    {
+        // Only the fields that are always written: created_at and both entities.
+        w.varint((uint64_t(1) << 5) | (uint64_t(1) << 8) | (uint64_t(1) << 9));
+        w.integer(1219842525000000);
+        w.varint(0);
+        w.varint(0);
+    }
+
+    static void writeCodecMinimalUser(CodecWriter& w)
+    {
+        // Only the fields that are always written: created_at, entities and
+        // the profile, whose colors have defaults.
+        w.varint((uint64_t(1) << 4) | (uint64_t(1) << 9) | (uint64_t(1) << 25));
+        w.integer(1219842525000000);
+        w.varint(0);
+        w.varint(3 | (uint64_t(7) << 7));
+        w.string("FFFFFF"); w.string("FFFFFF"); w.string("000000"); w.string("FFFFFF"); w.string("888888");
+    }
+
+    static void writeCodecStatus(CodecWriter& w)
+    {
+        w.all(42);
+        w.integer(100);
+        writeCodecUser(w);
+        w.varint(1); w.string("annotation"); w.string("value");
+        w.varint(1); w.integer(7); w.string("contributor"); w.string("Contributor");
+        w.real(40.5); w.real(-73.25);
+        w.integer(1219842525000000);
+        w.integer(-18000);
+        w.integer(101);
+        writeCodecEntities(w);
+        w.varint(0);
+        writeCodecMinimalStatus(w);
+        w.integer(3);
+        w.integer(4);
+        w.integer(5);
+        w.integer(102);
+        writeCodecMinimalStatus(w);
+        w.string("https://t.co/quoted"); w.string("twitter.com/quoted"); w.string("https://twitter.com/quoted");
+        w.varint(2);
+        w.string("reply_to");
+        w.integer(99);
+        w.integer(98);
+        w.string("en");
+        w.varint(1); w.string("followers"); w.varint(1);
+        w.integer(6);
+        writeCodecMinimalStatus(w);
+        w.string("web");
+        w.string("Text");
+        w.string("Full text");
+        w.varint(1);
+        w.varint(20);
+        w.varint(1); w.string("DE");
+        w.string("status");
+        writeCodecPlace(w);
+        w.string("en");
+        w.string("recent");
+        w.varint(1219842525000);
+    }
+
+    static void writeCodecUser(CodecWriter& w)
+    {
+        w.all(36);
+        w.integer(9);
+        w.string("screen_name");
+        w.string("Name");
+        w.integer(1219842525000000);
+        w.string("Description");
+        w.varint(0);
+        w.integer(10);
+        w.integer(11);
+        w.integer(12);
+        w.string("en");
+        w.integer(13);
+        w.string("Location");
+        w.all(10);
+        w.string("C0DEED"); w.string("1DA1F2");
+        w.string("http://abs.twimg.com/bg.png"); w.string("https://abs.twimg.com/bg.png");
+        w.string("https://pbs.twimg.com/banner"); w.string("FFFFFF"); w.string("DDEEF6"); w.string("333333");
+        writeCodecMinimalStatus(w);
+        w.integer(14);
+        w.string("Eastern Time (US & Canada)");
+        w.string("https://example.com");
+        w.integer(-18000);
+        w.varint(1); w.string("FR");
+        w.varint(1);
+        w.string("regular");
+    }
+
+    static void writeCodecPlace(CodecWriter& w)
+    {
+        w.all(10);
+        w.varint(1); w.string("street_address"); w.string("1 Main St");
+        w.real(40.0); w.real(-74.0); w.real(41.0); w.real(-73.0);
+        w.string("United States");
+        w.string("US");
+        w.string("Manhattan, NY");
+        w.string("01a9a39529b27f36");
+        w.varint(1); w.string("96683cc9126741d1");
+        w.string("Manhattan");
+        w.string("city");
+        w.string("https://api.twitter.com/1.1/geo/id/01a9a39529b27f36.json");
+    }
+
+    static void writeCodecEntities(CodecWriter& w)
+    {
+        w.all(5);
+        w.varint(1); w.varint(0); w.varint(4); w.string("tag");
+        w.varint(1); w.varint(5); w.varint(10); w.string("TWTR");
+        w.varint(1); writeCodecMediaEntity(w);
+        w.varint(1); w.varint(11); w.varint(34); w.string("https://t.co/url"); w.string("example.com"); w.string("https://example.com/page");
+        w.varint(1); w.varint(35); w.varint(47); w.integer(9); w.string("screen_name"); w.string("Name");
+    }
+
+    static void writeCodecMediaEntity(CodecWriter& w)
+    {
+        w.all(14);
+        w.varint(48);
+        w.varint(71);
+        w.string("https://t.co/media");
+        w.string("pic.twitter.com/media");
+        w.string("https://twitter.com/media");
+        w.string("http://pbs.twimg.com/media.jpg");
+        w.string("https://pbs.twimg.com/media.jpg");
+        w.integer(200);
+        w.varint(2);
+        w.varint(2);
+        w.varint(0); w.varint(0); w.varint(150); w.varint(150);
+        w.varint(3); w.varint(1); w.varint(1024); w.varint(576);
+        w.integer(103);
+        w.integer(9);
+        w.varint(16); w.varint(9); w.varint(30000);
+        w.varint(1); w.varint(832000); w.string("video/mp4"); w.string("https://video.twimg.com/video.mp4");
+        w.all(5);
+        w.string("Media description");
+        w.string("Media title");
+        writeCodecMinimalUser(w);
+    }
+
+    void testShardedStreamingClient()
+    {
+        // Every shard's stream sends the same statuses, out of order and with
+        // a duplicate.
+        std::string lines;
+
+        for (int id: { 3, 1, 2, 3, 5, 4 })
+        {
+            lines += "{\"created_at\":\"Wed Aug 27 13:08:45 +0000 2008\",\"id\":" + std::to_string(id)
+                   + ",\"id_str\":\"" + std::to_string(id) + "\",\"text\":\"A heavy status\"}\r\n";
+        }
+
+        std::atomic<int> opened(0);
+
+        auto transport = [&](ofxHTTP::Request&)
+        {
+            ++opened;
+            return std::unique_ptr<std::istream>(new std::istringstream(lines));
+        };
+
+        struct Sink: public ofxTwitter::StreamingSink
+        {
+            void onStatus(const ofxTwitter::Status& status) override
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ids.push_back(status.id());
+            }
+
+            std::size_t count()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                return ids.size();
+            }
+
+            std::mutex mutex;
+            std::vector<int64_t> ids;
+        };
+
+        ofxHTTP::OAuth10Credentials first("consumer", "consumer secret", "first", "first secret");
+        ofxHTTP::OAuth10Credentials second("consumer", "consumer secret", "second", "second secret");
+
+        Sink sink;
+
+        {
+            ofxTwitter::ShardedStreamingClient client({ first, second }, &sink, 200);
+            client.setTransport(transport);
+
+            client.setRules({ "heavy" });
+            ofxTest(waitFor([&]() { return sink.count() == 5; }), "The statuses are delivered.");
+            ofxTest(sink.ids == std::vector<int64_t>({ 1, 2, 3, 4, 5 }), "Statuses are released in id order, once.");
+            ofxTestEq(client.trackVolumes()["heavy"], uint64_t(5), "The volume of a phrase is counted once per status.");
+
+            // The heaviest phrase is placed first, on a shard of its own.
+            client.setRules({ "a", "b", "c", "heavy" });
+            ofxTestEq(client.shardQuery(0).get("track", ""), std::string("heavy"), "The heavy phrase is placed first.");
+            ofxTestEq(client.shardQuery(1).get("track", ""), std::string("a,b,c"), "The light phrases fill the other shard.");
+
+            ofxTest(waitFor([&]() { return opened >= 2; }), "The second shard is connected.");
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            ofxTestEq(sink.count(), std::size_t(5), "Statuses delivered by both shards are passed on once.");
+
+            // Without limited shards a rebalance moves nothing.
+            client.rebalance();
+            ofxTestEq(client.shardQuery(0).get("track", ""), std::string("heavy"), "An unlimited shard keeps its phrases.");
+            ofxTestEq(client.shardQuery(1).get("track", ""), std::string("a,b,c"), "An unlimited shard keeps its phrases.");
+
+            // Phrases over the combined capacity are dropped.
+            std::vector<std::string> tracks;
+
+            for (std::size_t i = 0; i < 2 * ofxTwitter::ShardedStreamingClient::MAX_TRACKS + 10; ++i)
+            {
+                tracks.push_back("track" + std::to_string(i));
+            }
+
+            client.setRules(tracks);
+
+            for (std::size_t shard = 0; shard < client.shardCount(); ++shard)
+            {
+                std::vector<std::string> assigned = ofSplitString(client.shardQuery(shard).get("track", ""), ",");
+                ofxTestEq(assigned.size(), ofxTwitter::ShardedStreamingClient::MAX_TRACKS, "Each shard is filled to capacity.");
+            }
+        }
+    }
+
+    void testRESTClient()
+    {
+        using Parameters = ofxTwitter::OAuth10Signer::EncodedParameters;
+
+        // A local stand-in for the search endpoint that records the query
+        // each request is signed with.
+        std::mutex mutex;
+        std::vector<std::string> signedQueries;
+
+        ofxTwitter::RESTClient client([&](ofxHTTP::Request& request, const Parameters& parameters)
+        {
+            std::string query;
+
+            for (const auto& fragment: parameters.fragments())
+            {
+                if (fragment.first == "q") query = fragment.second;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                signedQueries.push_back(query);
+            }
+
+            if (query == "offline")
+            {
+                throw Poco::IOException("Connection refused.");
+            }
+
+            ofxTwitter::RESTClient::Response response;
+
+            if (query == "broken")
+            {
+                response.status = 500;
+                response.reason = "Internal Server Error";
+                return response;
+            }
+
+            response.status = 200;
+            response.json = ofJson::parse(R"({
+                "statuses": [{
+                    "created_at": "Wed Aug 27 13:08:45 +0000 2008",
+                    "id": 1,
+                    "id_str": "1",
+                    "text": "A"
+                }]
+            })");
+            return response;
+        });
+
+        auto result = client.search("ofx").get();
+        ofxTest(result.isSuccess(), "A search succeeds through the future.");
+        ofxTestEq(result.response.statuses().size(), std::size_t(1), "The response is parsed.");
+        ofxTest(signedQueries.size() == 1 && signedQueries[0] == "ofx", "The query is signed.");
+
+        std::promise<ofxTwitter::RESTClient::Result<ofxTwitter::SearchResponse>> promise;
+
+        ofxTwitter::SearchQuery query("ofx");
+        auto request = std::make_unique<ofxHTTP::GetRequest>(ofxTwitter::SearchQuery::RESOURCE_URL);
+        request->addFormFields(query);
+
+        client.submit<ofxTwitter::SearchResponse>(std::move(request), [&](const ofxTwitter::RESTClient::Result<ofxTwitter::SearchResponse>& result)
+        {
+            promise.set_value(result);
+        }, query);
+
+        auto future = promise.get_future();
+        ofxTest(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready, "The callback is invoked.");
+        ofxTestEq(future.get().response.statuses().size(), std::size_t(1), "The callback receives the parsed response.");
+
+        result = client.search("offline").get();
+        ofxTest(!result.isSuccess() && result.error.find("Connection refused.") != std::string::npos, "Transport exceptions are reported as errors.");
+
+        result = client.search("broken").get();
+        ofxTestEq(result.error, std::string("500 Internal Server Error"), "Failed responses without JSON are reported as errors.");
+    }
+
+    void testLookupBatcher()
+    {
+        using Parameters = ofxTwitter::OAuth10Signer::EncodedParameters;
+
+        // A local stand-in for the lookup endpoints. User 7 does not exist,
+        // and the first status lookup is rate limited for a second.
+        std::mutex mutex;
+        std::vector<std::size_t> userBatches;
+        int statusRequests = 0;
+
+        ofxTwitter::RESTClient client([&](ofxHTTP::Request& request, const Parameters& parameters)
+        {
+            std::vector<int64_t> ids;
+
+            for (const auto& fragment: parameters.fragments())
+            {
+                if (fragment.first == "user_id" || fragment.first == "id")
+                {
+                    // The commas are percent-encoded.
+                    std::string list = fragment.second;
+
+                    for (auto i = list.find("%2C"); i != std::string::npos; i = list.find("%2C", i))
+                    {
+                        list.replace(i, 3, ",");
+                    }
+
+                    for (const auto& id: ofSplitString(list, ","))
+                    {
+                        ids.push_back(std::stoll(id));
+                    }
+                }
+            }
+
+            ofxTwitter::RESTClient::Response response;
+            response.status = 200;
+            response.json = ofJson::array();
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (request.getURI() == ofxTwitter::UserLookupRequest::RESOURCE_URL)
+            {
+                userBatches.push_back(ids.size());
+
+                for (auto id: ids)
+                {
+                    if (id == 7) continue;
+                    response.json.push_back({ { "id", id }, { "id_str", std::to_string(id) }, { "screen_name", "user" + std::to_string(id) } });
+                }
+            }
+            else if (statusRequests++ == 0)
+            {
+                using namespace std::chrono;
+                uint64_t now = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+
+                Poco::Net::NameValueCollection headers;
+                headers.set("x-rate-limit-limit", "900");
+                headers.set("x-rate-limit-remaining", "0");
+                headers.set("x-rate-limit-reset", std::to_string(now + 1));
+
+                response.status = 429;
+                response.reason = "Too Many Requests";
+                response.json = ofJson();
+                response.rateLimit = ofxTwitter::RateLimit::fromHeaders(headers);
+            }
+            else
+            {
+                for (auto id: ids)
+                {
+                    response.json.push_back({ { "created_at", "Wed Aug 27 13:08:45 +0000 2008" }, { "id", id }, { "id_str", std::to_string(id) }, { "text", "A" } });
+                }
+            }
+
+            return response;
+        });
+
+        ofxTwitter::LookupBatcher batcher(client, 10);
+
+        std::vector<int64_t> userIds;
+        for (int64_t id = 1; id <= 150; ++id) userIds.push_back(id);
+
+        auto users = batcher.users(userIds);
+
+        ofxTest(users[149].wait_for(std::chrono::seconds(5)) == std::future_status::ready, "The users are looked up.");
+        ofxTestEq(users[0].get().screenName(), std::string("user1"), "Each id receives its own user.");
+        ofxTestEq(users[149].get().screenName(), std::string("user150"), "Each id receives its own user.");
+
+        {
+            // Batches are sent concurrently, so they may complete in any order.
+            std::unique_lock<std::mutex> lock(mutex);
+            std::sort(userBatches.begin(), userBatches.end());
+            ofxTest(userBatches == std::vector<std::size_t>({ 50, 100 }), "Ids are sent in batches of at most 100.");
+        }
+
+        bool notFound = false;
+
+        try
+        {
+            users[6].get();
+        }
+        catch (const Poco::NotFoundException&)
+        {
+            notFound = true;
+        }
+
+        ofxTest(notFound, "An id missing from the response is not found.");
+
+        auto status = batcher.status(42);
+        ofxTest(status.wait_for(std::chrono::seconds(5)) == std::future_status::ready, "A rate limited lookup is sent again after the reset.");
+        ofxTestEq(status.get().id(), int64_t(42), "The rate limited lookup succeeds.");
+        ofxTestEq(statusRequests, 2, "The rate limited batch was sent twice.");
+        ofxTestEq(batcher.pending(), std::size_t(0), "No lookups are pending.");
+    }
+
+    void testCredentialPool()
+    {
+        using namespace std::chrono;
+        uint64_t now = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+
+        auto rateLimit = [](uint64_t remaining, uint64_t reset)
+        {
+            Poco::Net::NameValueCollection headers;
+            headers.set("x-rate-limit-limit", "180");
+            headers.set("x-rate-limit-remaining", std::to_string(remaining));
+            headers.set("x-rate-limit-reset", std::to_string(reset));
+            return ofxTwitter::RateLimit::fromHeaders(headers);
+        };
+
+        const std::string endpoint = ofxTwitter::SearchQuery::RESOURCE_URL;
+
+        auto pool = std::make_shared<ofxTwitter::CredentialPool>();
+
+        for (int i = 0; i < 3; ++i)
+        {
+            pool->add(ofxHTTP::OAuth10Credentials("consumer", "consumer secret", "access" + std::to_string(i), "access secret"));
+        }
+
+        // Credentials with unknown limits are tried first, one at a time.
+        std::size_t index = 99;
+        std::vector<std::size_t> acquired;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            ofxTest(pool->tryAcquire(endpoint, index), "Credentials with unknown limits are available.");
+            acquired.push_back(index);
+        }
+
+        ofxTest(acquired == std::vector<std::size_t>({ 0, 1, 2 }), "Each acquisition takes the least used credentials.");
+
+        pool->release(0, endpoint, rateLimit(5, now + 600));
+        pool->release(1, endpoint, rateLimit(50, now + 600));
+        pool->release(2, endpoint, rateLimit(10, now + 600));
+
+        ofxTest(pool->tryAcquire(endpoint, index), "Credentials with budget are available.");
+        ofxTestEq(index, std::size_t(1), "The credentials with the most budget are acquired.");
+        ofxTestEq(pool->remaining(endpoint), uint64_t(5 + 49 + 10), "Acquired requests are counted against the budget.");
+
+        // Responses that arrive out of order do not replace newer ones.
+        pool->release(1, endpoint, rateLimit(60, now + 600));
+        ofxTestEq(pool->rateLimit(1, endpoint).remaining(), uint64_t(50), "An earlier response in the same window is ignored.");
+
+        pool->release(1, endpoint, rateLimit(100, now + 300));
+        ofxTestEq(pool->rateLimit(1, endpoint).remaining(), uint64_t(50), "A response from an earlier window is ignored.");
+
+        pool->release(1, endpoint, rateLimit(40, now + 600));
+        ofxTestEq(pool->rateLimit(1, endpoint).remaining(), uint64_t(40), "A later response in the same window is used.");
+
+        ofxTestEq(pool->nextReset(endpoint), uint64_t(0), "Credentials are available now.");
+
+        pool->release(0, endpoint, rateLimit(0, now + 900));
+        pool->release(1, endpoint, rateLimit(0, now + 700));
+        pool->release(2, endpoint, rateLimit(0, now + 800));
+
+        ofxTest(!pool->tryAcquire(endpoint, index), "Exhausted credentials are not acquired.");
+        ofxTestEq(pool->nextReset(endpoint), now + 700, "The earliest reset is reported.");
+
+        // A search with exhausted credentials is reported as a rate limit
+        // error rather than skipped silently.
+        struct Search: public ofxTwitter::BaseSearchClient
+        {
+            ~Search() { stopAndJoin(); }
+
+            void _onStatus(const ofxTwitter::Status&) override {}
+            void _onError(const ofxTwitter::Error& error) override { code = error.code(); }
+            void _onException(const std::exception&) override {}
+            void _onMessage(const ofJson&) override {}
+
+            std::atomic<int64_t> code{0};
+        };
+
+        Search search;
+        search.setCredentialPool(pool);
+        search.search("ofx");
+
+        ofxTest(waitFor([&]() { return search.code != 0; }), "The exhausted search reports an error.");
+        ofxTestEq(search.code.load(), int64_t(88), "The error is a rate limit error.");
+    }
+
+    void testImageEncoder()
+    {
+        ofPixels pixels;
+        pixels.allocate(16, 8, 3);
+
+        std::shared_ptr<const ofBuffer> kept;
+
+        {
+            ofxTwitter::ImageEncoder encoder(2, 2);
+
+            auto encoded = encoder.encode(pixels);
+            const ofBuffer* first = encoded.get();
+            ofxTest(encoded->size() > 0, "The image is encoded.");
+            ofxTestEq(encoder.pooled(), std::size_t(0), "The buffer is in use.");
+
+            encoded.reset();
+            ofxTestEq(encoder.pooled(), std::size_t(1), "The released buffer returns to the pool.");
+
+            encoded = encoder.encode(pixels);
+            ofxTest(encoded.get() == first, "The pooled buffer is reused.");
+            ofxTestEq(encoder.pooled(), std::size_t(0), "The reused buffer leaves the pool.");
+            encoded.reset();
+
+            std::vector<std::future<std::shared_ptr<const ofBuffer>>> futures;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                futures.push_back(encoder.encodeAsync(pixels));
+            }
+
+            std::vector<std::shared_ptr<const ofBuffer>> buffers;
+
+            for (auto& future: futures)
+            {
+                buffers.push_back(future.get());
+            }
+
+            ofxTest(buffers[0]->getText() == buffers[2]->getText(), "Asynchronous encodes match.");
+
+            buffers.clear();
+            ofxTestEq(encoder.pooled(), std::size_t(2), "Idle buffers beyond the maximum are freed.");
+
+            bool threw = false;
+
+            try
+            {
+                encoder.encode(ofPixels());
+            }
+            catch (const Poco::IOException&)
+            {
+                threw = true;
+            }
+
+            ofxTest(threw, "Empty pixels are not encoded.");
+
+            // Pending encodes finish before the encoder is destroyed.
+            auto pending = encoder.encodeAsync(pixels);
+            kept = encoder.encode(pixels);
+        }
+
+        ofxTest(kept->size() > 0, "Buffers outlive the encoder.");
+    }
+
+    void testMediaUploadImage()
+    {
+        ofPixels pixels;
+        pixels.allocate(16, 8, 3);
+
+        ofxTwitter::ImageEncoder encoder(1, 2);
+
+        {
+            ofxTwitter::MediaUploadRequest request;
+            request.setImage(encoder, pixels, OF_IMAGE_FORMAT_PNG);
+            ofxTestEq(encoder.pooled(), std::size_t(0), "The request holds the encoded buffer.");
+        }
+
+        ofxTestEq(encoder.pooled(), std::size_t(1), "The buffer returns to the caller's encoder.");
+
+        {
+            ofxTwitter::MediaUploadRequest request;
+            request.setImage(encoder, pixels, OF_IMAGE_FORMAT_PNG);
+            ofxTestEq(encoder.pooled(), std::size_t(0), "The next request reuses the buffer.");
+        }
+    }
+
+    void testTracer()
+    {
+        auto& tracer = ofxTwitter::Tracer::instance();
+        auto path = std::filesystem::temp_directory_path() / "ofxTwitterTrace.json";
+
+        auto saved = [&]()
+        {
+            tracer.save(path);
+            return ofJson::parse(ofBufferFromFile(path).getText())["traceEvents"];
+        };
+
+        tracer.clear();
+        tracer.start();
+
+        std::thread thread([&]()
+        {
+            tracer.record("exited", 1, 3);
+        });
+
+        thread.join();
+        tracer.stop();
+
+        auto events = saved();
+        ofxTestEq(events.size(), std::size_t(1), "Spans of an exited thread are kept.");
+        ofxTest(events.size() == 1 && events[0]["name"] == "exited" && events[0]["dur"] == 2, "The span is saved.");
+
+        tracer.clear();
+        ofxTestEq(saved().size(), std::size_t(0), "Cleared spans are discarded.");
+
+        tracer.start();
+        tracer.record("current", 5, 6);
+        tracer.stop();
+
+        ofxTestEq(saved().size(), std::size_t(1), "The current thread's buffer is still registered.");
+
+        tracer.clear();
+        std::filesystem::remove(path);
+    }
+
+    void testTrendAggregator()
+    {
+        using TermType = ofxTwitter::TrendAggregator::TermType;
+
+        ofxTwitter::TrendAggregator trends({ 60000, 300000 }, 15000, 2048, 4, 3);
+
+        uint64_t now = 600000;
+
+        trends.add(TermType::HASHTAG, "#OpenFrameworks", now, 5);
+        trends.add(TermType::HASHTAG, "cats", now, 3);
+        trends.add(TermType::HASHTAG, "dogs", now + 1000, 4);
+        trends.add(TermType::MENTION, "@Bob", now, 2);
+        trends.add(TermType::DOMAIN, ofxTwitter::TrendAggregator::domain("https://user@WWW.Example.com:80/path"), now);
+
+        ofxTestEq(trends.count(TermType::HASHTAG, "openframeworks", 60000), uint64_t(5), "Terms are normalized and counted.");
+        ofxTestEq(trends.count(TermType::DOMAIN, "example.com", 60000), uint64_t(1), "Domains are normalized and counted.");
+        ofxTestEq(trends.count(TermType::MENTION, "openframeworks", 60000), uint64_t(0), "Terms of other types are not counted.");
+
+        auto top = trends.top(60000, 2);
+        ofxTest(top.size() == 2 && top[0].term == "openframeworks" && top[0].count == 5 && top[1].term == "dogs", "The top terms are ranked by count.");
+
+        top = trends.top(60000, 10, TermType::MENTION);
+        ofxTest(top.size() == 1 && top[0].term == "bob" && top[0].type == TermType::MENTION, "The top terms are filtered by type.");
+
+        // The summary keeps the three most frequent hashtags.
+        trends.add(TermType::HASHTAG, "rare", now, 1);
+        trends.add(TermType::HASHTAG, "birds", now, 10);
+
+        top = trends.top(60000, 10, TermType::HASHTAG);
+        ofxTest(top.size() == 3 && top[0].term == "birds" && top[1].term == "openframeworks" && top[2].term == "dogs", "Frequent terms replace the least frequent.");
+
+        // The shorter window expires while the longer one still counts.
+        trends.advance(now + 60000);
+
+        ofxTest(trends.top(60000, 10).empty(), "Expired terms leave the window.");
+        ofxTestEq(trends.count(TermType::HASHTAG, "birds", 60000), uint64_t(0), "Expired counts are removed.");
+        ofxTestEq(trends.count(TermType::HASHTAG, "birds", 300000), uint64_t(10), "Longer windows keep their counts.");
+        top = trends.top(300000, 1);
+        ofxTest(top.size() == 1 && top[0].term == "birds", "Longer windows keep their top terms.");
+
+        trends.add(TermType::SYMBOL, "$OFX", now + 60000);
+        top = trends.top(60000, 10);
+        ofxTest(top.size() == 1 && top[0].term == "ofx" && top[0].count == 1, "New terms enter the window.");
+
+        ofxTest(trends.top(12345, 10).empty(), "Unknown windows have no terms.");
+        ofxTestEq(trends.count(TermType::SYMBOL, "ofx", 12345), uint64_t(0), "Unknown windows have no counts.");
+
+        trends.clear();
+        ofxTest(trends.top(300000, 10).empty(), "Cleared terms are removed.");
+    }
+
+    void testTrackMatcher()
+    {
+        ofxTwitter::TrackMatcher matcher({ "twitter", "open frameworks", "cat dog" });
+
+        ofxTest(!matcher.empty(), "The rules are compiled.");
+        ofxTest(matcher.match("I love #Twitter!") == std::vector<std::size_t>({ 0 }), "Terms match hashtags ignoring case.");
+        ofxTest(matcher.match("@twitter's birthday") == std::vector<std::size_t>({ 0 }), "Punctuation delimits terms.");
+        ofxTest(matcher.match("twitters").empty(), "Terms match whole tokens.");
+        ofxTest(matcher.match("Frameworks are open").size() == 1, "Rule terms match in any order.");
+        ofxTest(matcher.match("open source").empty(), "Every rule term must be present.");
+        ofxTest(matcher.match("Twitter loves open frameworks") == std::vector<std::size_t>({ 0, 1 }), "Every matched rule is found.");
+
+        auto status = ofxTwitter::Status::fromJSON(ofJson::parse(R"({
+            "id": 1,
+            "text": "RT https://t.co/a",
+            "entities": { "urls": [ { "url": "https://t.co/a", "expanded_url": "https://twitter.com/cats", "display_url": "twitter.com/cats", "indices": [3, 17] } ] },
+            "retweeted_status": { "id": 2, "text": "My dog and my cat" }
+        })"));
+
+        matcher.annotate(status);
+        ofxTest(status.matchedTrackRules() == std::vector<std::size_t>({ 0, 2 }), "URLs and retweeted text are matched.");
+
+        ofxTwitter::TrackMatcher empty;
+        ofxTest(empty.empty() && empty.match("twitter").empty(), "An empty matcher matches nothing.");
+    }
+
+    void testGeoIndex()
+    {
+        auto ids = [](std::vector<ofxTwitter::GeoIndex::Entry> entries)
+        {
+            std::vector<int64_t> result;
+            for (const auto& entry: entries) result.push_back(entry.id);
+            std::sort(result.begin(), result.end());
+            return result;
+        };
+
+        ofxTwitter::GeoIndex index(1.0, 60000);
+
+        index.insert(1, ofx::Geo::Coordinate(40.0, -74.0), 1000);
+        index.insert(2, ofx::Geo::Coordinate(40.5, -73.5), 2000);
+        index.insert(3, ofx::Geo::Coordinate(51.5, -0.1), 3000);
+        index.insert(4, ofx::Geo::Coordinate(10.0, 179.5), 4000);
+
+        ofxTestEq(index.size(), std::size_t(4), "The locations are indexed.");
+
+        ofx::Geo::CoordinateBounds bounds(ofx::Geo::Coordinate(39.0, -75.0), ofx::Geo::Coordinate(41.0, -73.0));
+        ofxTest(ids(index.query(bounds)) == std::vector<int64_t>({ 1, 2 }), "Boxes contain the locations across cells.");
+        ofxTest(ids(index.query(bounds, 1500)) == std::vector<int64_t>({ 2 }), "Older locations are filtered.");
+
+        ofx::Geo::Coordinate center(40.0, -74.0);
+        ofxTest(ids(index.query(center, 100000)) == std::vector<int64_t>({ 1, 2 }), "The radius contains both locations.");
+        ofxTest(ids(index.query(center, 50000)) == std::vector<int64_t>({ 1 }), "The radius excludes farther locations.");
+
+        index.insert(5, ofx::Geo::Coordinate(40.1, -74.1), 62500);
+        ofxTestEq(index.size(), std::size_t(3), "Locations older than the maximum age are evicted.");
+        ofxTest(ids(index.query(bounds)) == std::vector<int64_t>({ 5 }), "Evicted locations are not found.");
+
+        index.evict(63000);
+        ofxTestEq(index.size(), std::size_t(0), "Locations are evicted by time.");
+
+        auto status = ofxTwitter::Status::fromJSON(ofJson::parse(R"({
+            "id": 6,
+            "timestamp_ms": "70000",
+            "coordinates": { "type": "Point", "coordinates": [-74.0, 40.0] }
+        })"));
+
+        ofxTest(index.insert(status), "Statuses with coordinates are indexed.");
+        ofxTest(!index.insert(ofxTwitter::Status()), "Statuses without a location are not indexed.");
+        ofxTest(ids(index.query(bounds)) == std::vector<int64_t>({ 6 }), "The status location is indexed.");
+
+        index.clear();
+        ofxTestEq(index.size(), std::size_t(0), "Cleared locations are removed.");
+    }
+
+    void testLocationMatcher()
+    {
+        auto box = [](double south, double west, double north, double east)
+        {
+            return ofx::Geo::CoordinateBounds(ofx::Geo::Coordinate(south, west), ofx::Geo::Coordinate(north, east));
+        };
+
+        // An odd number of boxes covers both the paired and single tests.
+        ofxTwitter::LocationMatcher matcher({
+            box(40, -75, 41, -73),
+            box(39, -80, 45, -70),
+            box(51, -1, 52, 1),
+            box(-34, 150, -33, 152),
+            box(40.5, -74.5, 40.6, -74.4)
+        });
+
+        ofxTest(!matcher.empty(), "The boxes are set.");
+        ofxTest(matcher.match(ofx::Geo::Coordinate(40.2, -74.0)) == std::vector<std::size_t>({ 0, 1 }), "Every containing box is found.");
+        ofxTest(matcher.match(ofx::Geo::Coordinate(40.55, -74.45)) == std::vector<std::size_t>({ 0, 1, 4 }), "Nested boxes are found.");
+        ofxTest(matcher.match(ofx::Geo::Coordinate(51.5, 0.0)) == std::vector<std::size_t>({ 2 }), "Boxes across the prime meridian are found.");
+        ofxTest(matcher.match(ofx::Geo::Coordinate(-33.0, 152.0)) == std::vector<std::size_t>({ 3 }), "Edges are inside the box.");
+        ofxTest(matcher.match(ofx::Geo::Coordinate(0.0, 0.0)).empty(), "Locations outside every box are not found.");
+
+        auto status = ofxTwitter::Status::fromJSON(ofJson::parse(R"({
+            "id": 1,
+            "coordinates": { "type": "Point", "coordinates": [-74.0, 40.2] }
+        })"));
+
+        matcher.annotate(status);
+        ofxTest(status.matchedLocations() == std::vector<std::size_t>({ 0, 1 }), "Status coordinates are matched.");
+        ofxTest(matcher.match(ofxTwitter::Status()).empty(), "Statuses without a location are not matched.");
+    }
+
+    void testPixelPool()
+    {
+        ofxTwitter::PixelPool pool(100);
+
+        auto pixels = pool.acquire(4, 4, 3);
+        ofPixels* first = pixels.get();
+        ofxTest(pixels->isAllocated() && pixels->getWidth() == 4 && pixels->getNumChannels() == 3, "Acquired pixels are allocated.");
+
+        pixels.reset();
+        ofxTestEq(pool.count(), std::size_t(1), "Released pixels return to the pool.");
+        ofxTestEq(pool.bytes(), std::size_t(48), "Idle bytes are counted.");
+
+        pixels = pool.acquire(4, 4, 3);
+        ofxTest(pixels.get() == first, "Pixels of the same size are reused.");
+        ofxTestEq(pool.count(), std::size_t(0), "Reused pixels leave the pool.");
+
+        auto other = pool.acquire(4, 4, 3);
+        auto large = pool.acquire(8, 8, 3);
+        pixels.reset();
+        other.reset();
+        large.reset();
+        ofxTest(pool.bytes() <= 100 && pool.count() == 2, "Idle pixels beyond the byte limit are freed.");
+
+        pool.setMaxBytes(0);
+        ofxTestEq(pool.count(), std::size_t(0), "Lowering the limit frees idle pixels.");
+    }
+
+    void testMediaDecoder()
+    {
+        using Size = ofxTwitter::MediaEntitySize;
+
+        Size::Resize resize = Size::Resize::CROP;
+        auto size = ofxTwitter::MediaDecoder::scaledSize(4000, 3000, {}, Size::Type::SMALL, resize);
+        ofxTest(size == std::make_pair(std::size_t(680), std::size_t(510)) && resize == Size::Resize::FIT, "Media is fit to the default size.");
+
+        size = ofxTwitter::MediaDecoder::scaledSize(4000, 3000, {}, Size::Type::THUMB, resize);
+        ofxTest(size == std::make_pair(std::size_t(150), std::size_t(150)) && resize == Size::Resize::CROP, "Thumbnails are cropped.");
+
+        size = ofxTwitter::MediaDecoder::scaledSize(100, 50, {}, Size::Type::LARGE, resize);
+        ofxTest(size == std::make_pair(std::size_t(100), std::size_t(50)), "Media is not upscaled.");
+
+        ofxTwitter::MediaEntity::Sizes sizes;
+        sizes.emplace(Size::Type::SMALL, Size(Size::Resize::FIT, 400, 300));
+        size = ofxTwitter::MediaDecoder::scaledSize(800, 800, sizes, Size::Type::SMALL, resize);
+        ofxTest(size == std::make_pair(std::size_t(300), std::size_t(300)), "The entity's sizes are used.");
+
+        ofPixels pixels;
+        pixels.allocate(800, 400, 3);
+        ofBuffer image;
+        ofSaveImage(pixels, image, OF_IMAGE_FORMAT_PNG);
+
+        ofxTwitter::MediaEntity entity;
+        ofxTwitter::MediaDecoder::Frame frame;
+
+        {
+            ofxTwitter::MediaDecoder decoder(1, 1);
+
+            decoder.setTargetSize(Size::Type::SMALL);
+            decoder.decode(entity, image);
+            decoder.setTargetSize(Size::Type::THUMB);
+            decoder.decode(entity, image);
+            decoder.clearTargetSize();
+            decoder.decode(entity, image);
+
+            // The queue holds one frame, so the worker waits for it to be
+            // received before delivering the next.
+            ofxTest(waitFor([&]() { return decoder.ready() == 1; }), "A frame is decoded.");
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            ofxTestEq(decoder.ready(), std::size_t(1), "The queue does not exceed its capacity.");
+            ofxTestEq(decoder.pending(), std::size_t(2), "Later media waits for space.");
+
+            ofxTest(decoder.receive(frame, 5000) && frame.isSuccess(), "The fit frame is received.");
+            ofxTest(frame.pixels->getWidth() == 680 && frame.pixels->getHeight() == 340, "The frame is fit to the target size.");
+
+            ofxTest(decoder.receive(frame, 5000) && frame.isSuccess(), "The cropped frame is received.");
+            ofxTest(frame.pixels->getWidth() == 150 && frame.pixels->getHeight() == 150, "The frame is cropped to the target size.");
+
+            ofxTest(decoder.receive(frame, 5000) && frame.isSuccess(), "The original frame is received.");
+            ofxTest(frame.pixels->getWidth() == 800 && frame.pixels->getHeight() == 400, "The frame keeps its size without a target.");
+
+            decoder.decode(entity, ofBuffer("not an image", 12));
+            ofxTest(decoder.receive(frame, 5000) && !frame.isSuccess() && !frame.error.empty(), "Undecodable media is reported.");
+            ofxTestEq(decoder.pending(), std::size_t(0), "All media is decoded.");
+        }
+    }
+
+    void testStatusPoster()
+    {
+        std::atomic<int64_t> nextMediaId(1);
+        std::atomic<int> finalized(0);
+        std::atomic<int> posts(0);
+        std::atomic<int> finalizedAtPost(-1);
+
+        auto uploadTransport = [&](const Poco::Net::NameValueCollection& fields, const char* data, std::size_t size)
+        {
+            std::string command = fields.get("command");
+
+            if (command == "INIT")
+            {
+                return ofJson({ { "media_id", nextMediaId++ } });
+            }
+            else if (command == "APPEND")
+            {
+                // The second image uploads slowest, so it is not the last
+                // to start but is the last to finish.
+                if (std::string(data, size).find("IMG 32") == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+                else if (std::string(data, size).find("IMG 13") == 0)
+                {
+                    throw Poco::IOException("Upload failed.");
+                }
+
+                return ofJson();
+            }
+
+            ++finalized;
+            return ofJson({ { "media_id", std::stoll(fields.get("media_id")) } });
+        };
+
+        auto postTransport = [&](ofxTwitter::StatusUpdateRequest&)
+        {
+            finalizedAtPost = finalized.load();
+            ++posts;
+            return ofJson::parse(R"({ "id": 99, "text": "Posted" })");
+        };
+
+        auto images = [](std::vector<std::size_t> widths)
+        {
+            std::vector<ofPixels> result;
+
+            for (auto width: widths)
+            {
+                ofPixels pixels;
+                pixels.allocate(width, 8, 3);
+                result.push_back(std::move(pixels));
+            }
+
+            return result;
+        };
+
+        ofxTwitter::StatusPoster poster(uploadTransport, postTransport, 4);
+
+        auto status = poster.postImages("Hello", images({ 16, 32, 24 })).get();
+        ofxTestEq(status.id(), int64_t(99), "The posted status is returned.");
+        ofxTestEq(posts.load(), 1, "The status is posted once.");
+        ofxTestEq(finalizedAtPost.load(), 3, "The status is posted after the last upload finishes.");
+
+        bool failed = false;
+
+        try
+        {
+            poster.postImages("Hello", images({ 16, 13 })).get();
+        }
+        catch (const Poco::IOException&)
+        {
+            failed = true;
+        }
+
+        ofxTest(failed, "A failed upload fails the post.");
+        ofxTestEq(posts.load(), 1, "A post with a failed upload is not sent.");
+
+        ofxTestEq(poster.post("No media").get().id(), int64_t(99), "Statuses without media are posted.");
+        ofxTestEq(posts.load(), 2, "The status without media is posted once.");
+    }
+
+    std::vector<ofxTwitter::PostingQueue::Result> posted;
+    std::vector<ofxTwitter::PostingQueue::Result> failed;
+
+};
+
+
+int main()
+{
+    ofInit();
+    auto window = std::make_shared<ofAppNoWindow>();
+    auto app = std::make_shared<ofApp>();
+    ofRunApp(window, app);
+    return ofRunMainLoop();
+}